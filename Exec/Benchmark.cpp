@@ -0,0 +1,42 @@
+struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error: 'identifier' was unexpected here" when using /permissive-
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "Sailor.h"
+#include "Engine/EngineLoop.h"
+
+using namespace Sailor;
+
+// SailorBenchmark [--frames N] [--objects N], the app always runs with the null graphics driver and without the main window
+int main(int argc, const char** argv)
+{
+	uint32_t numFrames = 256;
+	uint32_t numObjects = 4096;
+
+	std::vector<const char*> args(argv, argv + argc);
+
+	for (int32_t i = 1; i + 1 < argc; i++)
+	{
+		const std::string arg = argv[i];
+
+		if (arg == "--frames")
+		{
+			numFrames = (uint32_t)atoi(argv[++i]);
+		}
+		else if (arg == "--objects")
+		{
+			numObjects = (uint32_t)atoi(argv[++i]);
+		}
+	}
+
+	args.push_back("--nullrhi");
+
+	App::Initialize(args.data(), (int32_t)args.size());
+	RunFrameBenchmark(numFrames, numObjects);
+	App::Stop();
+	App::Shutdown();
+
+	return 0;
+}
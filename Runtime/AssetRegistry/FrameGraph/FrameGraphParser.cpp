@@ -1,5 +1,6 @@
 #include "FrameGraphParser.h"
 #include "FrameGraphAssetInfo.h"
+#include "TransientResourcePlanner.h"
 #include "AssetRegistry/FileId.h"
 #include "AssetRegistry/AssetRegistry.h"
 #include "Core/Utils.h"
@@ -87,7 +88,6 @@ FrameGraphPtr FrameGraphImporter::BuildFrameGraph(const FileId& uid, const Frame
 	for (const auto& renderTarget : frameGraphAsset->m_renderTargets)
 	{
 		const bool bUsedWithComputeShaders = renderTarget.m_second->m_bIsCompatibleWithComputeShaders;
-		const bool bShouldGenerateMips = renderTarget.m_second->m_bGenerateMips;
 		const bool bIsDepthFormat = RHI::IsDepthFormat(renderTarget.m_second->m_format);
 
 		const RHI::ETextureUsageFlags defaultUsage = (bIsDepthFormat ? RHI::ETextureUsageBit::DepthStencilAttachment_Bit : RHI::ETextureUsageBit::ColorAttachment_Bit) |
@@ -96,8 +96,7 @@ FrameGraphPtr FrameGraphImporter::BuildFrameGraph(const FileId& uid, const Frame
 			RHI::ETextureUsageBit::Sampled_Bit |
 			(bUsedWithComputeShaders ? RHI::ETextureUsageBit::Storage_Bit : 0);
 
-		const uint32_t maxExtent = std::max(renderTarget.m_second->m_width, renderTarget.m_second->m_height);
-		const uint32_t numMips = std::min(renderTarget.m_second->m_maxMipLevel, bShouldGenerateMips ? (uint32_t)std::floor(std::log2f((float)maxExtent)) + 1 : 1u);
+		const uint32_t numMips = renderTarget.m_second->GetNumMips();
 		const RHI::ETextureFiltration filtration = renderTarget.m_second->m_filtration;
 		const RHI::ETextureClamping clamping = renderTarget.m_second->m_clamping;
 		const  RHI::ESamplerReductionMode reduction = renderTarget.m_second->m_reduction;
@@ -197,10 +196,16 @@ FrameGraphPtr FrameGraphImporter::BuildFrameGraph(const FileId& uid, const Frame
 				pNewNode->SetRHIResource_Unresolved(param.m_first, *param.m_second);
 			}
 		}
-		// TODO: Build params
 		graph.Add(pNewNode);
 	}
 
+	pRhiFrameGraph->Compile();
+
+	const auto transientResourcePlan = TransientResourcePlan::Build(*frameGraphAsset);
+	SAILOR_LOG("FrameGraph render targets %.2fmb, with the transient aliasing %.2fmb in %zu heaps, could save %.2fmb",
+		transientResourcePlan.GetTotalSize() / (1024.0f * 1024.0f), transientResourcePlan.GetAliasedSize() / (1024.0f * 1024.0f),
+		transientResourcePlan.GetHeaps().Num(), transientResourcePlan.GetSavedSize() / (1024.0f * 1024.0f));
+
 	pFrameGraph->m_frameGraph = pRhiFrameGraph;
 
 	return pFrameGraph;
@@ -80,6 +80,12 @@ namespace Sailor
 
 			bool operator==(const RenderTarget& rhs) const { return m_name == rhs.m_name; }
 
+			uint32_t GetNumMips() const
+			{
+				const uint32_t maxExtent = std::max(m_width, m_height);
+				return std::min(m_maxMipLevel, m_bGenerateMips ? (uint32_t)std::floor(std::log2f((float)maxExtent)) + 1 : 1u);
+			}
+
 			static uint32_t ParseUintValue(const std::string& str)
 			{
 				uint32_t res = 1;
@@ -0,0 +1,153 @@
+#include "TransientResourcePlanner.h"
+#include "Core/LogMacros.h"
+#include <algorithm>
+
+using namespace Sailor;
+
+TransientResourcePlan::EAccess TransientResourcePlan::GetAccess(const std::string& param)
+{
+	return (param == "color" || param == "target" || param == "dst") ? EAccess::Write : EAccess::Read;
+}
+
+size_t TransientResourcePlan::GetRenderTargetSize(const FrameGraphAsset::RenderTarget& renderTarget)
+{
+	const size_t bitsPerPixel = RHI::GetBitsPerPixel(renderTarget.m_format);
+	const uint32_t numMips = renderTarget.GetNumMips();
+
+	size_t size = 0;
+	for (uint32_t mip = 0; mip < numMips; mip++)
+	{
+		const size_t width = std::max(1u, renderTarget.m_width >> mip);
+		const size_t height = std::max(1u, renderTarget.m_height >> mip);
+
+		size += (width * height * bitsPerPixel + 7) / 8;
+	}
+
+	// The msaa samples are driver settings, so we count the surface target as the single sampled texture
+	return renderTarget.m_bIsSurface ? size * 2 : size;
+}
+
+const TransientResourcePlan::Resource* TransientResourcePlan::GetResource(const std::string& name) const
+{
+	for (const auto& resource : m_resources)
+	{
+		if (resource.m_name == name)
+		{
+			return &resource;
+		}
+	}
+
+	return nullptr;
+}
+
+TransientResourcePlan TransientResourcePlan::Build(const FrameGraphAsset& frameGraphAsset)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	TransientResourcePlan plan;
+
+	for (const auto& renderTarget : frameGraphAsset.m_renderTargets)
+	{
+		Resource resource;
+		resource.m_name = renderTarget.m_first;
+		resource.m_size = GetRenderTargetSize(*renderTarget.m_second);
+		resource.m_bIsTransient = !renderTarget.m_second->m_bIsSurface && !renderTarget.m_first.starts_with("g_");
+
+		plan.m_resources.Add(std::move(resource));
+	}
+
+	plan.m_resources.Sort([](const Resource& lhs, const Resource& rhs) { return lhs.m_name < rhs.m_name; });
+
+	TMap<std::string, uint32_t> indices;
+	for (uint32_t i = 0; i < plan.m_resources.Num(); i++)
+	{
+		indices[plan.m_resources[i].m_name] = i;
+	}
+
+	// The intervals of use in the node order
+	for (uint32_t nodeIndex = 0; nodeIndex < frameGraphAsset.m_nodes.Num(); nodeIndex++)
+	{
+		for (const auto& param : frameGraphAsset.m_nodes[nodeIndex].m_renderTargets)
+		{
+			uint32_t* pIndex = nullptr;
+			if (!indices.Find(*param.m_second, pIndex))
+			{
+				// Samplers and per frame render targets (DepthBuffer, BackBuffer, etc...)
+				continue;
+			}
+
+			Resource* resource = &plan.m_resources[*pIndex];
+
+			if (resource->m_firstUse == InvalidIndex)
+			{
+				resource->m_firstUse = nodeIndex;
+			}
+
+			// The first node reads the content from the previous frame
+			if (resource->m_firstUse == nodeIndex && GetAccess(param.m_first) == EAccess::Read)
+			{
+				resource->m_bIsTransient = false;
+			}
+
+			resource->m_lastUse = nodeIndex;
+		}
+	}
+
+	TVector<uint32_t> transients;
+	for (uint32_t i = 0; i < plan.m_resources.Num(); i++)
+	{
+		Resource& resource = plan.m_resources[i];
+		plan.m_totalSize += resource.m_size;
+
+		if (resource.m_firstUse == InvalidIndex)
+		{
+			resource.m_bIsTransient = false;
+		}
+
+		if (resource.m_bIsTransient)
+		{
+			transients.Add(i);
+		}
+		else
+		{
+			plan.m_aliasedSize += resource.m_size;
+		}
+	}
+
+	// The greedy colouring of the interval graph, the biggest resources go first and open the heaps,
+	// so the heap is as big as its first resource
+	transients.Sort([&](const uint32_t& lhs, const uint32_t& rhs)
+		{
+			const Resource& a = plan.m_resources[lhs];
+			const Resource& b = plan.m_resources[rhs];
+			return a.m_size != b.m_size ? a.m_size > b.m_size : a.m_firstUse < b.m_firstUse;
+		});
+
+	for (uint32_t index : transients)
+	{
+		Resource& resource = plan.m_resources[index];
+
+		for (uint32_t heapIndex = 0; heapIndex < plan.m_heaps.Num() && resource.m_heap == InvalidIndex; heapIndex++)
+		{
+			const auto& heap = plan.m_heaps[heapIndex];
+			const bool bOverlaps = std::any_of(heap.m_resources.begin(), heap.m_resources.end(),
+				[&](uint32_t member) { return plan.m_resources[member].Overlaps(resource); });
+
+			if (!bOverlaps)
+			{
+				resource.m_heap = heapIndex;
+			}
+		}
+
+		if (resource.m_heap == InvalidIndex)
+		{
+			resource.m_heap = (uint32_t)plan.m_heaps.Num();
+			plan.m_heaps.Add(Heap{ resource.m_size });
+			plan.m_aliasedSize += resource.m_size;
+		}
+
+		plan.m_heaps[resource.m_heap].m_resources.Add(index);
+	}
+
+	return plan;
+}
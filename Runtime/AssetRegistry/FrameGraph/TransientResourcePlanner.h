@@ -0,0 +1,78 @@
+#pragma once
+#include "Core/Defines.h"
+#include <string>
+#include "Containers/Vector.h"
+#include "AssetRegistry/FrameGraph/FrameGraphParser.h"
+
+namespace Sailor
+{
+	/* The lifetime of the frame graph render targets over one frame and their packing into the shared memory heaps.
+	*  The render target is transient when its content is produced and consumed within the frame, so the render targets
+	*  with the non overlapping [first use, last use] intervals could alias the same memory.
+	*  The render target stays persistent (own memory) when:
+	*   - it is the surface,
+	*   - it is bound by name outside of the nodes ('g_' prefix, like g_AO),
+	*   - none of the nodes reference it (it could be resolved by name in the code),
+	*   - it is read before written, so it keeps the content between the frames (like DepthHighZ).
+	*/
+	class TransientResourcePlan
+	{
+	public:
+
+		static constexpr uint32_t InvalidIndex = (uint32_t)-1;
+
+		enum class EAccess : uint8_t
+		{
+			Read = 0,
+			Write
+		};
+
+		struct Resource
+		{
+			std::string m_name;
+			size_t m_size = 0;
+			uint32_t m_firstUse = InvalidIndex;
+			uint32_t m_lastUse = InvalidIndex;
+			uint32_t m_heap = InvalidIndex;
+			bool m_bIsTransient = false;
+
+			bool Overlaps(const Resource& rhs) const { return m_firstUse <= rhs.m_lastUse && rhs.m_firstUse <= m_lastUse; }
+		};
+
+		struct Heap
+		{
+			size_t m_size = 0;
+			TVector<uint32_t> m_resources;
+		};
+
+		SAILOR_API static TransientResourcePlan Build(const FrameGraphAsset& frameGraphAsset);
+
+		// The node params don't declare the access, the attachments the nodes render into are 'color', 'target' and 'dst'
+		SAILOR_API static EAccess GetAccess(const std::string& param);
+
+		// The mip chain of the texture, the surface also holds the resolved texture
+		SAILOR_API static size_t GetRenderTargetSize(const FrameGraphAsset::RenderTarget& renderTarget);
+
+		SAILOR_API const Resource* GetResource(const std::string& name) const;
+
+		SAILOR_API const TVector<Resource>& GetResources() const { return m_resources; }
+		SAILOR_API const TVector<Heap>& GetHeaps() const { return m_heaps; }
+
+		// All render targets in the own memory
+		SAILOR_API size_t GetTotalSize() const { return m_totalSize; }
+
+		// The persistent render targets and the heaps
+		SAILOR_API size_t GetAliasedSize() const { return m_aliasedSize; }
+		SAILOR_API size_t GetSavedSize() const { return m_totalSize - m_aliasedSize; }
+
+	protected:
+
+		TVector<Resource> m_resources;
+		TVector<Heap> m_heaps;
+
+		size_t m_totalSize = 0;
+		size_t m_aliasedSize = 0;
+	};
+
+	SAILOR_API void RunTransientResourcePlannerTests();
+}
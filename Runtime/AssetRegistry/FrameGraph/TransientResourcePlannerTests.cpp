@@ -0,0 +1,160 @@
+#include "TransientResourcePlanner.h"
+#include "AssetRegistry/AssetRegistry.h"
+#include "AssetRegistry/FrameGraph/FrameGraphImporter.h"
+#include "Core/LogMacros.h"
+
+using namespace Sailor;
+
+namespace
+{
+	/* The nodes go in order N0..N4:
+	*  A, B, C are produced and consumed within the frame, A and C don't overlap and share the heap,
+	*  History is read before written, g_Global is bound by name, Surface is the surface,
+	*  Unused has no nodes and InPlace is read by the node that writes it first.
+	*/
+	const char* TestFrameGraph = R"(
+renderTargets:
+- name: A
+  format: R16G16B16A16_SFLOAT
+  width: 256
+  height: 256
+- name: B
+  format: R8_UNORM
+  width: 256
+  height: 256
+- name: C
+  format: R16G16B16A16_SFLOAT
+  width: 256
+  height: 256
+- name: History
+  format: R32_SFLOAT
+  width: 256
+  height: 256
+- name: g_Global
+  format: R8_UNORM
+  width: 256
+  height: 256
+- name: Surface
+  format: R16G16B16A16_SFLOAT
+  width: 256
+  height: 256
+  bIsSurface: true
+- name: Unused
+  format: R16G16B16A16_SFLOAT
+  width: 256
+  height: 256
+- name: InPlace
+  format: R8_UNORM
+  width: 256
+  height: 256
+frame:
+- name: N0
+  renderTargets:
+  - historySampler: History
+  - color: A
+- name: N1
+  renderTargets:
+  - colorSampler: A
+  - color: B
+- name: N2
+  renderTargets:
+  - aoSampler: B
+  - color: C
+  - dst: History
+- name: N3
+  renderTargets:
+  - colorSampler: C
+  - target: Surface
+  - color: g_Global
+  - depthStencil: DepthBuffer
+- name: N4
+  renderTargets:
+  - target: InPlace
+  - colorSampler: InPlace
+)";
+
+	bool CheckResource(const TransientResourcePlan& plan, const std::string& name, bool bIsTransient, uint32_t firstUse, uint32_t lastUse)
+	{
+		const auto* resource = plan.GetResource(name);
+		return resource &&
+			resource->m_bIsTransient == bIsTransient &&
+			resource->m_firstUse == firstUse &&
+			resource->m_lastUse == lastUse &&
+			(resource->m_heap != TransientResourcePlan::InvalidIndex) == bIsTransient;
+	}
+
+	bool SanityCheck()
+	{
+		const uint32_t Invalid = TransientResourcePlan::InvalidIndex;
+
+		FrameGraphAsset frameGraphAsset;
+		frameGraphAsset.Deserialize(YAML::Load(TestFrameGraph));
+
+		const auto plan = TransientResourcePlan::Build(frameGraphAsset);
+
+		const size_t rgba16 = 256 * 256 * 8;
+		const size_t r8 = 256 * 256;
+		const size_t r32 = 256 * 256 * 4;
+
+		if (plan.GetResources().Num() != 8 ||
+			!CheckResource(plan, "A", true, 0, 1) ||
+			!CheckResource(plan, "B", true, 1, 2) ||
+			!CheckResource(plan, "C", true, 2, 3) ||
+			!CheckResource(plan, "History", false, 0, 2) ||
+			!CheckResource(plan, "g_Global", false, 3, 3) ||
+			!CheckResource(plan, "Surface", false, 3, 3) ||
+			!CheckResource(plan, "Unused", false, Invalid, Invalid) ||
+			!CheckResource(plan, "InPlace", false, 4, 4))
+		{
+			return false;
+		}
+
+		if (plan.GetHeaps().Num() != 2 ||
+			plan.GetResource("A")->m_heap != plan.GetResource("C")->m_heap ||
+			plan.GetResource("A")->m_heap == plan.GetResource("B")->m_heap ||
+			plan.GetHeaps()[plan.GetResource("A")->m_heap].m_size != rgba16 ||
+			plan.GetHeaps()[plan.GetResource("B")->m_heap].m_size != r8)
+		{
+			return false;
+		}
+
+		const size_t total = rgba16 * 3 + r8 * 3 + r32 + rgba16 * 2;
+		return plan.GetResource("Surface")->m_size == rgba16 * 2 &&
+			plan.GetTotalSize() == total &&
+			plan.GetSavedSize() == rgba16;
+	}
+}
+
+void Sailor::RunTransientResourcePlannerTests()
+{
+	printf("\nStarting Transient resource planner tests...\n");
+	printf("Sanity check passed: %d\n", SanityCheck());
+
+	auto assetInfo = App::GetSubmodule<AssetRegistry>()->GetAssetInfoPtr<AssetInfoPtr>("DefaultRenderer.renderer");
+	if (!assetInfo)
+	{
+		return;
+	}
+
+	if (auto frameGraphAsset = App::GetSubmodule<FrameGraphImporter>()->LoadFrameGraphAsset(assetInfo->GetFileId()))
+	{
+		const auto plan = TransientResourcePlan::Build(*frameGraphAsset);
+
+		for (const auto& resource : plan.GetResources())
+		{
+			if (resource.m_bIsTransient)
+			{
+				SAILOR_LOG("%s: %.2fmb, nodes [%u, %u], heap %u", resource.m_name.c_str(), resource.m_size / (1024.0f * 1024.0f),
+					resource.m_firstUse, resource.m_lastUse, resource.m_heap);
+			}
+			else
+			{
+				SAILOR_LOG("%s: %.2fmb, persistent", resource.m_name.c_str(), resource.m_size / (1024.0f * 1024.0f));
+			}
+		}
+
+		SAILOR_LOG("DefaultRenderer render targets %.2fmb, with aliasing %.2fmb in %zu heaps, saved %.2fmb",
+			plan.GetTotalSize() / (1024.0f * 1024.0f), plan.GetAliasedSize() / (1024.0f * 1024.0f),
+			plan.GetHeaps().Num(), plan.GetSavedSize() / (1024.0f * 1024.0f));
+	}
+}
@@ -13,6 +13,7 @@ YAML::Node ModelAssetInfo::Serialize() const
 	outData = AssetInfo::Serialize();
 	outData["bShouldGenerateMaterials"] = m_bShouldGenerateMaterials;
 	outData["bShouldBatchByMaterial"] = m_bShouldBatchByMaterials;
+	outData["bShouldBuildBLAS"] = m_bShouldBuildBLAS;
 	outData["defaultMaterials"] = m_materials;
 	return outData;
 }
@@ -31,6 +32,11 @@ void ModelAssetInfo::Deserialize(const YAML::Node& outData)
 		m_bShouldBatchByMaterials = outData["bShouldBatchByMaterial"].as<bool>();;
 	}
 
+	if (outData["bShouldBuildBLAS"])
+	{
+		m_bShouldBuildBLAS = outData["bShouldBuildBLAS"].as<bool>();
+	}
+
 	if (outData["defaultMaterials"])
 	{
 		m_materials = outData["defaultMaterials"].as<TVector<FileId>>();
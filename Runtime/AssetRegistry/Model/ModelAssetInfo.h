@@ -18,6 +18,9 @@ namespace Sailor
 		SAILOR_API bool ShouldGenerateMaterials() const { return m_bShouldGenerateMaterials; }
 		SAILOR_API bool ShouldBatchByMaterial() const { return m_bShouldBatchByMaterials; }
 
+		// The BLAS keeps the CPU copy of the triangles, so it is only built for the models used by the raycasts
+		SAILOR_API bool ShouldBuildBLAS() const { return m_bShouldBuildBLAS; }
+
 		SAILOR_API const TVector<FileId>& GetDefaultMaterials() const { return m_materials; }
 		SAILOR_API TVector<FileId>& GetDefaultMaterials() { return m_materials; }
 
@@ -26,6 +29,7 @@ namespace Sailor
 		TVector<FileId> m_materials;
 		bool m_bShouldGenerateMaterials = true;
 		bool m_bShouldBatchByMaterials = true;
+		bool m_bShouldBuildBLAS = false;
 	};
 
 	using ModelAssetInfoPtr = ModelAssetInfo*;
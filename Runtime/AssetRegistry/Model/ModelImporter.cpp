@@ -364,6 +364,7 @@ Tasks::TaskPtr<ModelPtr> ModelImporter::LoadModel(FileId uid, ModelPtr& outModel
 		// The way to drop qualifiers inside lambda
 		auto& boundsSphere = model->m_boundsSphere;
 		auto& boundsAabb = model->m_boundsAabb;
+		auto& blas = model->m_blas;
 
 		struct Data
 		{
@@ -372,10 +373,17 @@ Tasks::TaskPtr<ModelPtr> ModelImporter::LoadModel(FileId uid, ModelPtr& outModel
 		};
 
 		promise = Tasks::CreateTaskWithResult<TSharedPtr<Data>>("Load model",
-			[model, assetInfo, this, &boundsAabb, &boundsSphere]()
+			[model, assetInfo, this, &boundsAabb, &boundsSphere, &blas]()
 			{
 				TSharedPtr<Data> res = TSharedPtr<Data>::Make();
 				res->m_bIsImported = ImportModel(assetInfo, res->m_parsedMeshes, boundsAabb, boundsSphere);
+
+				// The CPU copy of the geometry is only alive here
+				if (res->m_bIsImported && assetInfo->ShouldBuildBLAS())
+				{
+					blas = BuildBLAS(res->m_parsedMeshes);
+				}
+
 				return res;
 			})->Then<ModelPtr>([model](TSharedPtr<Data> data) mutable
 				{
@@ -443,6 +451,47 @@ bool ModelImporter::ImportModel(ModelAssetInfoPtr assetInfo, TVector<MeshContext
 	return true;
 }
 
+TSharedPtr<Raytracing::BVH> ModelImporter::BuildBLAS(const TVector<MeshContext>& parsedMeshes)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	TVector<Math::Triangle> tris;
+	for (uint32_t meshIndex = 0; meshIndex < parsedMeshes.Num(); meshIndex++)
+	{
+		const auto& mesh = parsedMeshes[meshIndex];
+		for (uint32_t i = 0; i + 2 < mesh.outIndices.Num(); i += 3)
+		{
+			Math::Triangle& tri = tris[tris.Emplace()];
+
+			for (uint32_t j = 0; j < 3; j++)
+			{
+				const auto& vertex = mesh.outVertices[mesh.outIndices[i + j]];
+
+				tri.m_vertices[j] = vertex.m_position;
+				tri.m_normals[j] = vertex.m_normal;
+				tri.m_tangent[j] = vertex.m_tangent;
+				tri.m_bitangent[j] = vertex.m_bitangent;
+				tri.m_uvs[j] = vertex.m_texcoord;
+				tri.m_uvs2[j] = vertex.m_texcoord;
+			}
+
+			tri.m_centroid = (tri.m_vertices[0] + tri.m_vertices[1] + tri.m_vertices[2]) * 0.333f;
+			tri.m_materialIndex = (u8)(std::min)(meshIndex, 255u);
+		}
+	}
+
+	if (tris.Num() == 0)
+	{
+		return TSharedPtr<Raytracing::BVH>();
+	}
+
+	// We're already on the worker thread, the models are loaded in parallel
+	TSharedPtr<Raytracing::BVH> bvh = TSharedPtr<Raytracing::BVH>::Make();
+	bvh->BuildBVH(tris, false);
+
+	return bvh;
+}
+
 Tasks::TaskPtr<bool> ModelImporter::LoadDefaultMaterials(FileId uid, TVector<MaterialPtr>& outMaterials)
 {
 	outMaterials.Clear();
@@ -18,6 +18,7 @@
 #include "RHI/Mesh.h"
 #include "RHI/Material.h"
 #include "Math/Bounds.h"
+#include "Raytracing/BVH.h"
 
 namespace Sailor::RHI
 {
@@ -48,6 +49,10 @@ namespace Sailor
 		SAILOR_API const Math::AABB& GetBoundsAABB() const { return m_boundsAabb; }
 		SAILOR_API const Math::Sphere& GetBoundsSphere() const { return m_boundsSphere; }
 
+		// Model space BVH for the CPU raycasts, shared by all instances of the model.
+		// Null unless the asset is imported with bShouldBuildBLAS.
+		SAILOR_API const TSharedPtr<Raytracing::BVH>& GetBLAS() const { return m_blas; }
+
 	protected:
 
 		TVector<RHI::RHIMeshPtr> m_meshes;
@@ -56,6 +61,8 @@ namespace Sailor
 		Math::AABB m_boundsAabb;
 		Math::Sphere m_boundsSphere;
 
+		TSharedPtr<Raytracing::BVH> m_blas;
+
 		friend class ModelImporter;
 	};
 
@@ -87,6 +94,7 @@ namespace Sailor
 	protected:
 
 		SAILOR_API static bool ImportModel(ModelAssetInfoPtr assetInfo, TVector<MeshContext>& outParsedMeshes, Math::AABB& outBoundsAabb, Math::Sphere& outBoundsSphere);
+		SAILOR_API static TSharedPtr<Raytracing::BVH> BuildBLAS(const TVector<MeshContext>& parsedMeshes);
 
 		SAILOR_API void GenerateMaterialAssets(ModelAssetInfoPtr assetInfo);
 
@@ -6,7 +6,7 @@
 #include "Components/Component.h"
 #include "AssetRegistry/Model/ModelImporter.h"
 #include "ECS/StaticMeshRendererECS.h"
-#include "Containers/Octree.h"
+#include "Containers/Octree2.h"
 #include "Framegraph/SkyNode.h"
 #include "Math/Math.h"
 
@@ -32,7 +32,7 @@ namespace Sailor
 
 		TVector<glm::vec4> m_lightVelocities;
 		TVector<GameObjectPtr> m_lights;
-		TOctree<Math::AABB> m_octree{};
+		TOctree2<Math::AABB> m_octree{};
 		TVector<GameObjectPtr> m_objects;
 
 		TVector<Math::AABB> m_culledBoxes{};
@@ -0,0 +1,468 @@
+#pragma once
+#include <cassert>
+#include <memory>
+#include <atomic>
+#include <type_traits>
+#include <algorithm>
+#include "Core/Defines.h"
+#include "Math/Math.h"
+#include "Containers/Concepts.h"
+#include "Memory/MallocAllocator.hpp"
+
+namespace Sailor
+{
+	/* Bounded multi-producer multi-consumer queue (Dmitry Vyukov's array based queue).
+	*  Each cell holds the sequence number, that tells producers and consumers whether the cell is free or filled for the current lap.
+	*  There are no locks and only one CAS per operation, the capacity is rounded up to the power of 2.
+	*/
+	template<typename TElementType, typename TAllocator = Memory::MallocAllocator>
+	class TConcurrentBoundedQueue final
+	{
+		struct TCell
+		{
+			std::atomic<size_t> m_sequence;
+			alignas(TElementType) uint8_t m_storage[sizeof(TElementType)];
+
+			__forceinline TElementType* GetPtr() { return reinterpret_cast<TElementType*>(&m_storage[0]); }
+		};
+
+	public:
+
+		TConcurrentBoundedQueue(size_t capacity = 1024)
+		{
+			m_capacity = Math::UpperPowOf2((uint32_t)capacity);
+			m_mask = m_capacity - 1;
+
+			m_pCells = static_cast<TCell*>(m_allocator.Allocate(sizeof(TCell) * m_capacity, alignof(TCell)));
+			for (size_t i = 0; i < m_capacity; i++)
+			{
+				new (&m_pCells[i].m_sequence) std::atomic<size_t>(i);
+			}
+		}
+
+		TConcurrentBoundedQueue(const TConcurrentBoundedQueue&) = delete;
+		TConcurrentBoundedQueue(TConcurrentBoundedQueue&&) = delete;
+		TConcurrentBoundedQueue& operator=(const TConcurrentBoundedQueue&) = delete;
+		TConcurrentBoundedQueue& operator=(TConcurrentBoundedQueue&&) = delete;
+
+		~TConcurrentBoundedQueue()
+		{
+			if constexpr (!IsTriviallyDestructible<TElementType>)
+			{
+				TElementType element;
+				while (TryDequeue(element));
+			}
+
+			m_allocator.Free(m_pCells);
+		}
+
+		template<typename... TArgs>
+		bool TryEmplace(TArgs&& ... args)
+		{
+			size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+			TCell* pCell = nullptr;
+
+			while (true)
+			{
+				pCell = &m_pCells[pos & m_mask];
+				const size_t sequence = pCell->m_sequence.load(std::memory_order_acquire);
+				const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+				if (diff == 0)
+				{
+					if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (diff < 0)
+				{
+					// Full
+					return false;
+				}
+				else
+				{
+					pos = m_enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			new (pCell->GetPtr()) TElementType(std::forward<TArgs>(args)...);
+			pCell->m_sequence.store(pos + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		__forceinline bool TryEnqueue(const TElementType& element) requires IsCopyConstructible<TElementType> { return TryEmplace(element); }
+		__forceinline bool TryEnqueue(TElementType&& element) { return TryEmplace(std::move(element)); }
+
+		bool TryDequeue(TElementType& outElement)
+		{
+			size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+			TCell* pCell = nullptr;
+
+			while (true)
+			{
+				pCell = &m_pCells[pos & m_mask];
+				const size_t sequence = pCell->m_sequence.load(std::memory_order_acquire);
+				const intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+				if (diff == 0)
+				{
+					if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (diff < 0)
+				{
+					// Empty
+					return false;
+				}
+				else
+				{
+					pos = m_dequeuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			TElementType* pElement = pCell->GetPtr();
+			outElement = std::move(*pElement);
+			pElement->~TElementType();
+
+			// Free the cell for the next lap
+			pCell->m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		// Approximate value, the queue could be modified concurrently
+		__forceinline size_t Num() const
+		{
+			const size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+			const size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+			return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+		}
+
+		__forceinline bool IsEmpty() const { return Num() == 0; }
+		__forceinline size_t Capacity() const { return m_capacity; }
+
+	protected:
+
+		TCell* m_pCells = nullptr;
+		size_t m_capacity = 0;
+		size_t m_mask = 0;
+
+		// Producers and consumers are placed in different cache lines to avoid false sharing
+		alignas(64) std::atomic<size_t> m_enqueuePos = 0;
+		alignas(64) std::atomic<size_t> m_dequeuePos = 0;
+
+		TAllocator m_allocator{};
+	};
+
+	/* Unbounded multi-producer multi-consumer queue built from the linked fixed size segments.
+	*  Producers claim the slot with one fetch_add, consumers with one CAS, the new segment is linked only when the tail is full.
+	*  The consumed segments are retired with the current epoch and released when all operations
+	*  that could have loaded the pointers are finished (two epochs, the operations are counted per epoch parity),
+	*  so the memory is reclaimed even if the queue is never idle.
+	*/
+	template<typename TElementType, typename TAllocator = Memory::MallocAllocator, const size_t SegmentSize = 1024>
+	class TConcurrentQueue final
+	{
+		enum class ESlotState : uint8_t
+		{
+			Empty = 0,
+			Written = 1
+		};
+
+		struct TSlot
+		{
+			std::atomic<ESlotState> m_state = ESlotState::Empty;
+			alignas(TElementType) uint8_t m_storage[sizeof(TElementType)];
+
+			__forceinline TElementType* GetPtr() { return reinterpret_cast<TElementType*>(&m_storage[0]); }
+		};
+
+		struct TSegment
+		{
+			alignas(64) std::atomic<size_t> m_enqueuePos = 0;
+			alignas(64) std::atomic<size_t> m_dequeuePos = 0;
+
+			std::atomic<TSegment*> m_next = nullptr;
+			TSegment* m_nextRetired = nullptr;
+
+			// The allocator could ignore the alignment, so the segment is placed manually
+			void* m_pRaw = nullptr;
+
+			TSlot m_slots[SegmentSize];
+		};
+
+		// Tracks the operation in flight in the epoch it was started
+		class TOperationScope
+		{
+		public:
+
+			TOperationScope(TConcurrentQueue* pQueue) : m_pQueue(pQueue) { m_epoch = m_pQueue->EnterOperation(); }
+			~TOperationScope() { m_pQueue->LeaveOperation(m_epoch); }
+
+		protected:
+
+			TConcurrentQueue* m_pQueue;
+			uint64_t m_epoch;
+		};
+
+	public:
+
+		TConcurrentQueue()
+		{
+			TSegment* pSegment = AllocateSegment();
+			m_head.store(pSegment, std::memory_order_relaxed);
+			m_tail.store(pSegment, std::memory_order_relaxed);
+		}
+
+		TConcurrentQueue(const TConcurrentQueue&) = delete;
+		TConcurrentQueue(TConcurrentQueue&&) = delete;
+		TConcurrentQueue& operator=(const TConcurrentQueue&) = delete;
+		TConcurrentQueue& operator=(TConcurrentQueue&&) = delete;
+
+		~TConcurrentQueue()
+		{
+			TSegment* pSegment = m_head.load(std::memory_order_relaxed);
+			while (pSegment)
+			{
+				const size_t first = pSegment->m_dequeuePos.load(std::memory_order_relaxed);
+				const size_t last = (std::min)(pSegment->m_enqueuePos.load(std::memory_order_relaxed), SegmentSize);
+
+				for (size_t i = first; i < last; i++)
+				{
+					if (pSegment->m_slots[i].m_state.load(std::memory_order_relaxed) == ESlotState::Written)
+					{
+						pSegment->m_slots[i].GetPtr()->~TElementType();
+					}
+				}
+
+				TSegment* pNext = pSegment->m_next.load(std::memory_order_relaxed);
+				FreeSegment(pSegment);
+				pSegment = pNext;
+			}
+
+			FreeRetiredSegments(m_retired[0].exchange(nullptr));
+			FreeRetiredSegments(m_retired[1].exchange(nullptr));
+		}
+
+		template<typename... TArgs>
+		void Emplace(TArgs&& ... args)
+		{
+			TOperationScope scope(this);
+
+			while (true)
+			{
+				TSegment* pTail = m_tail.load(std::memory_order_acquire);
+				const size_t index = pTail->m_enqueuePos.fetch_add(1, std::memory_order_relaxed);
+
+				if (index < SegmentSize)
+				{
+					TSlot& slot = pTail->m_slots[index];
+					new (slot.GetPtr()) TElementType(std::forward<TArgs>(args)...);
+					slot.m_state.store(ESlotState::Written, std::memory_order_release);
+
+					m_num.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+
+				// The segment is full, link the next one and help to move the tail
+				TSegment* pNext = pTail->m_next.load(std::memory_order_acquire);
+				if (!pNext)
+				{
+					TSegment* pNewSegment = AllocateSegment();
+					if (pTail->m_next.compare_exchange_strong(pNext, pNewSegment, std::memory_order_acq_rel))
+					{
+						pNext = pNewSegment;
+					}
+					else
+					{
+						FreeSegment(pNewSegment);
+					}
+				}
+
+				m_tail.compare_exchange_strong(pTail, pNext, std::memory_order_acq_rel);
+			}
+		}
+
+		__forceinline void Enqueue(const TElementType& element) requires IsCopyConstructible<TElementType> { Emplace(element); }
+		__forceinline void Enqueue(TElementType&& element) { Emplace(std::move(element)); }
+
+		bool TryDequeue(TElementType& outElement)
+		{
+			TOperationScope scope(this);
+
+			while (true)
+			{
+				TSegment* pHead = m_head.load(std::memory_order_acquire);
+				size_t pos = pHead->m_dequeuePos.load(std::memory_order_acquire);
+
+				if (pos >= SegmentSize)
+				{
+					TSegment* pNext = pHead->m_next.load(std::memory_order_acquire);
+					if (!pNext)
+					{
+						return false;
+					}
+
+					// The tail should never point to the retired segment
+					TSegment* pExpectedTail = pHead;
+					m_tail.compare_exchange_strong(pExpectedTail, pNext, std::memory_order_acq_rel);
+
+					if (m_head.compare_exchange_strong(pHead, pNext, std::memory_order_seq_cst))
+					{
+						Retire(pHead);
+					}
+					continue;
+				}
+
+				TSlot& slot = pHead->m_slots[pos];
+				if (slot.m_state.load(std::memory_order_acquire) != ESlotState::Written)
+				{
+					// Empty or the producer hasn't finished the write yet
+					return false;
+				}
+
+				if (pHead->m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel))
+				{
+					TElementType* pElement = slot.GetPtr();
+					outElement = std::move(*pElement);
+					pElement->~TElementType();
+
+					m_num.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+		}
+
+		// Approximate value, the queue could be modified concurrently
+		__forceinline size_t Num() const { return (size_t)(std::max)(0ll, (long long)m_num.load(std::memory_order_relaxed)); }
+		__forceinline bool IsEmpty() const { return Num() == 0; }
+
+	protected:
+
+		TSegment* AllocateSegment()
+		{
+			void* pRaw = m_allocator.Allocate(sizeof(TSegment) + alignof(TSegment) - 1, alignof(TSegment));
+			const uintptr_t aligned = (reinterpret_cast<uintptr_t>(pRaw) + alignof(TSegment) - 1) & ~(uintptr_t)(alignof(TSegment) - 1);
+
+			TSegment* pSegment = new (reinterpret_cast<void*>(aligned)) TSegment();
+			pSegment->m_pRaw = pRaw;
+
+			return pSegment;
+		}
+
+		void FreeSegment(TSegment* pSegment)
+		{
+			void* pRaw = pSegment->m_pRaw;
+
+			pSegment->~TSegment();
+			m_allocator.Free(pRaw);
+		}
+
+		void FreeRetiredSegments(TSegment* pSegment)
+		{
+			while (pSegment)
+			{
+				TSegment* pNext = pSegment->m_nextRetired;
+				FreeSegment(pSegment);
+				pSegment = pNext;
+			}
+		}
+
+		// The operations that start after the epoch is read cannot see the unlinked segment
+		void Retire(TSegment* pSegment)
+		{
+			const uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+			PushRetired(m_retired[epoch & 1], pSegment, pSegment);
+		}
+
+		static void PushRetired(std::atomic<TSegment*>& retired, TSegment* pFirst, TSegment* pLast)
+		{
+			TSegment* pRetired = retired.load(std::memory_order_relaxed);
+			do
+			{
+				pLast->m_nextRetired = pRetired;
+			} while (!retired.compare_exchange_weak(pRetired, pFirst, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		uint64_t EnterOperation()
+		{
+			while (true)
+			{
+				const uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+				m_numActiveOperations[epoch & 1].fetch_add(1, std::memory_order_seq_cst);
+
+				// The epoch could be advanced before the operation was counted
+				if (m_epoch.load(std::memory_order_seq_cst) == epoch)
+				{
+					return epoch;
+				}
+
+				m_numActiveOperations[epoch & 1].fetch_sub(1, std::memory_order_seq_cst);
+			}
+		}
+
+		void LeaveOperation(uint64_t epoch)
+		{
+			m_numActiveOperations[epoch & 1].fetch_sub(1, std::memory_order_seq_cst);
+
+			if (m_retired[0].load(std::memory_order_relaxed) || m_retired[1].load(std::memory_order_relaxed))
+			{
+				TryAdvanceEpoch();
+			}
+		}
+
+		/* The epoch is advanced from E to E + 1 only when all operations of E - 1 are finished,
+		*  the new operations of E + 1 share the counter with E - 1. At that point
+		*  the segments retired in E - 1 are not reachable by any operation in flight.
+		*/
+		void TryAdvanceEpoch()
+		{
+			uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+			const uint64_t next = epoch + 1;
+
+			if (m_numActiveOperations[next & 1].load(std::memory_order_seq_cst) != 0)
+			{
+				return;
+			}
+
+			// Taken before the epoch is changed, so the segments retired in E + 1 don't get into the list
+			TSegment* pSegments = m_retired[next & 1].exchange(nullptr, std::memory_order_acq_rel);
+
+			if (!m_epoch.compare_exchange_strong(epoch, next, std::memory_order_seq_cst))
+			{
+				if (pSegments)
+				{
+					TSegment* pLast = pSegments;
+					while (pLast->m_nextRetired)
+					{
+						pLast = pLast->m_nextRetired;
+					}
+
+					// The list is released later, that is safe
+					PushRetired(m_retired[next & 1], pSegments, pLast);
+				}
+				return;
+			}
+
+			FreeRetiredSegments(pSegments);
+		}
+
+		alignas(64) std::atomic<TSegment*> m_head = nullptr;
+		alignas(64) std::atomic<TSegment*> m_tail = nullptr;
+		alignas(64) std::atomic<int64_t> m_num = 0;
+
+		std::atomic<uint64_t> m_epoch = 0;
+		std::atomic<uint32_t> m_numActiveOperations[2]{};
+		std::atomic<TSegment*> m_retired[2]{};
+
+		TAllocator m_allocator{};
+
+		friend class TOperationScope;
+	};
+
+	SAILOR_API void RunConcurrentQueueBenchmark();
+}
@@ -0,0 +1,239 @@
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include "Core/Utils.h"
+#include "Containers/Vector.h"
+#include "Containers/ConcurrentQueue.h"
+
+using namespace Sailor;
+using Timer = Utils::Timer;
+
+struct Result
+{
+	std::string m_className;
+
+	Result() = default;
+	Result(std::string className) : m_className(className) {}
+
+	size_t m_spsc = 0;
+	size_t m_mpmc = 0;
+	size_t m_mpmcHighContention = 0;
+
+	bool m_bSanityPassed = false;
+
+	void PrintLog()
+	{
+		SAILOR_LOG("\nClassName: %s", m_className.c_str());
+		SAILOR_LOG("Sanity check passed: %d", m_bSanityPassed);
+		SAILOR_LOG("Performance test 1 producer/1 consumer: %llums", m_spsc);
+		SAILOR_LOG("Performance test 2 producers/2 consumers: %llums", m_mpmc);
+		SAILOR_LOG("Performance test 4 producers/4 consumers: %llums\n", m_mpmcHighContention);
+	}
+};
+
+// The same interface for all the queues, the producers back off when the queue has more than Capacity elements
+static constexpr size_t Capacity = 4096;
+
+template<typename TElement>
+class TMutexQueue
+{
+public:
+
+	bool TryEnqueue(const TElement& element)
+	{
+		const std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_queue.Num() >= Capacity)
+		{
+			return false;
+		}
+
+		m_queue.Add(element);
+		return true;
+	}
+
+	bool TryDequeue(TElement& outElement)
+	{
+		const std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_queue.Num() == 0)
+		{
+			return false;
+		}
+
+		outElement = m_queue[0];
+		m_queue.RemoveAt(0);
+		return true;
+	}
+
+protected:
+
+	std::mutex m_mutex;
+	TVector<TElement> m_queue;
+};
+
+template<typename TElement>
+class TUnboundedQueue
+{
+public:
+
+	bool TryEnqueue(const TElement& element)
+	{
+		if (m_queue.Num() >= Capacity)
+		{
+			return false;
+		}
+
+		m_queue.Enqueue(element);
+		return true;
+	}
+
+	bool TryDequeue(TElement& outElement) { return m_queue.TryDequeue(outElement); }
+
+protected:
+
+	TConcurrentQueue<TElement> m_queue;
+};
+
+template<typename TElement>
+class TBoundedQueue
+{
+public:
+
+	bool TryEnqueue(const TElement& element) { return m_queue.TryEnqueue(element); }
+	bool TryDequeue(TElement& outElement) { return m_queue.TryDequeue(outElement); }
+
+protected:
+
+	TConcurrentBoundedQueue<TElement> m_queue{ Capacity };
+};
+
+template<typename TContainer>
+class TestCase_ConcurrentQueuePerformance
+{
+	static constexpr size_t NumElements = 1 << 21;
+
+public:
+
+	static Result RunTests(std::string className)
+	{
+		Result r(className);
+
+		r.m_spsc = PerformanceTest(1, 1);
+		r.m_mpmc = PerformanceTest(2, 2);
+		r.m_mpmcHighContention = PerformanceTest(4, 4);
+		r.m_bSanityPassed = SanityCheck();
+
+		return r;
+	}
+
+	static size_t PerformanceTest(size_t numProducers, size_t numConsumers)
+	{
+		Timer timer;
+
+		uint64_t sum = 0;
+		timer.Start();
+		const bool bRes = Run(numProducers, numConsumers, NumElements, sum);
+		timer.Stop();
+
+		check(bRes);
+		return timer.ResultMs();
+	}
+
+	static bool SanityCheck()
+	{
+		const size_t count = 65536 * 3 + 17;
+
+		bool bRes = true;
+		uint64_t sum = 0;
+
+		// Each element should be consumed exactly once
+		bRes &= Run(3, 5, count, sum) && sum == (uint64_t)count * (count - 1) / 2;
+		bRes &= Run(5, 3, count, sum) && sum == (uint64_t)count * (count - 1) / 2;
+
+		return bRes;
+	}
+
+	static bool Run(size_t numProducers, size_t numConsumers, size_t count, uint64_t& outSum)
+	{
+		TContainer container;
+
+		std::atomic<size_t> numConsumed = 0;
+		std::atomic<uint64_t> sum = 0;
+		std::atomic<bool> bDuplicate = false;
+
+		std::unique_ptr<std::atomic<uint8_t>[]> visited(new std::atomic<uint8_t>[count]{});
+		TVector<std::thread> threads;
+
+		for (size_t p = 0; p < numProducers; p++)
+		{
+			threads.Emplace([&container, p, numProducers, count]()
+				{
+					for (size_t i = p; i < count; i += numProducers)
+					{
+						while (!container.TryEnqueue((uint32_t)i))
+						{
+							std::this_thread::yield();
+						}
+					}
+				});
+		}
+
+		for (size_t c = 0; c < numConsumers; c++)
+		{
+			threads.Emplace([&]()
+				{
+					uint64_t localSum = 0;
+					uint32_t value = 0;
+
+					while (numConsumed.load(std::memory_order_relaxed) < count)
+					{
+						if (!container.TryDequeue(value))
+						{
+							std::this_thread::yield();
+							continue;
+						}
+
+						if (visited[value].exchange(1) != 0)
+						{
+							bDuplicate = true;
+						}
+
+						localSum += value;
+						numConsumed++;
+					}
+
+					sum += localSum;
+				});
+		}
+
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		outSum = sum;
+
+		uint32_t value = 0;
+		return !bDuplicate && numConsumed == count && !container.TryDequeue(value);
+	}
+};
+
+void Sailor::RunConcurrentQueueBenchmark()
+{
+	printf("\nStarting ConcurrentQueue benchmark...\n");
+
+	TVector<Result> res;
+
+	res.Add(TestCase_ConcurrentQueuePerformance<TMutexQueue<uint32_t>>::RunTests("std::mutex + TVector"));
+	res.Add(TestCase_ConcurrentQueuePerformance<TUnboundedQueue<uint32_t>>::RunTests("TConcurrentQueue"));
+	res.Add(TestCase_ConcurrentQueuePerformance<TBoundedQueue<uint32_t>>::RunTests("TConcurrentBoundedQueue"));
+
+	for (auto& r : res)
+	{
+		r.PrintLog();
+	}
+
+	printf("\n\n");
+}
@@ -5,6 +5,8 @@
 #include "Containers/List.h"
 #include "Containers/Set.h"
 #include "Containers/Map.h"
+#include "Containers/FlatSet.h"
+#include "Containers/FlatMap.h"
 #include "Containers/ConcurrentSet.h"
 #include "Containers/ConcurrentMap.h"
 #include "Containers/Vector.h"
@@ -0,0 +1,209 @@
+#pragma once
+#include <cassert>
+#include <memory>
+#include <concepts>
+#include <type_traits>
+#include "Core/Defines.h"
+#include "Containers/Vector.h"
+#include "Containers/FlatSet.h"
+#include "Containers/Pair.h"
+
+namespace Sailor
+{
+	/* Open addressing hash map, the pairs are stored inline in the slots of TFlatSet and hashed by the key.
+	*  In contrast to TMap there are no buckets and no separate storage for the values,
+	*  so the lookup touches the control bytes and the single slot in the common case.
+	*  The iterators and references are invalidated by the insertion.
+	*/
+	template<typename TKeyType, typename TValueType, typename TAllocator = Memory::DefaultGlobalAllocator>
+	class TFlatMap final : public TFlatSet<TPair<TKeyType, TValueType>, TAllocator>
+	{
+	public:
+
+		using Super = Sailor::TFlatSet<TPair<TKeyType, TValueType>, TAllocator>;
+		using TElementType = Sailor::TPair<TKeyType, TValueType>;
+		using TIterator = typename Super::TIterator;
+		using TConstIterator = typename Super::TConstIterator;
+
+		TFlatMap(const uint32_t desiredNumElements = 0) : Super(desiredNumElements) {}
+
+		TFlatMap(std::initializer_list<TElementType> initList) : Super((uint32_t)initList.size())
+		{
+			for (const auto& el : initList)
+			{
+				Insert(el.m_first, el.m_second);
+			}
+		}
+
+		TFlatMap(const TFlatMap&) = default;
+		TFlatMap(TFlatMap&&) noexcept = default;
+		TFlatMap& operator=(const TFlatMap&) = default;
+		TFlatMap& operator=(TFlatMap&&) noexcept = default;
+		~TFlatMap() = default;
+
+		void Add(const TKeyType& key, const TValueType& value) requires IsCopyConstructible<TValueType>
+		{
+			Insert(key, value);
+		}
+
+		void Add(const TKeyType& key, TValueType&& value) requires IsMoveConstructible<TValueType>
+		{
+			Insert(key, std::move(value));
+		}
+
+		// Overrides the value if the key is already in the map
+		void Insert(const TKeyType& key, const TValueType& value) requires IsCopyConstructible<TValueType>
+		{
+			const size_t hash = Sailor::GetHash(key);
+			const size_t existingIndex = FindKey(hash, key);
+
+			if (existingIndex != Super::InvalidIndex)
+			{
+				Super::m_pSlots[existingIndex].m_second = value;
+				return;
+			}
+
+			const size_t index = Super::PrepareInsert(hash);
+			new (&Super::m_pSlots[index]) TElementType(key, value);
+		}
+
+		void Insert(const TKeyType& key, TValueType&& value) requires IsMoveConstructible<TValueType>
+		{
+			const size_t hash = Sailor::GetHash(key);
+			const size_t existingIndex = FindKey(hash, key);
+
+			if (existingIndex != Super::InvalidIndex)
+			{
+				Super::m_pSlots[existingIndex].m_second = std::move(value);
+				return;
+			}
+
+			const size_t index = Super::PrepareInsert(hash);
+			new (&Super::m_pSlots[index]) TElementType(key, std::move(value));
+		}
+
+		bool Remove(const TKeyType& key)
+		{
+			const size_t index = FindKey(Sailor::GetHash(key), key);
+			if (index == Super::InvalidIndex)
+			{
+				return false;
+			}
+
+			Super::EraseAt(index);
+			return true;
+		}
+
+		// The missing value is default constructed, the other types are added with Insert
+		TValueType& operator[] (const TKeyType& key) requires IsDefaultConstructible<TValueType>
+		{
+			return GetOrAdd(key).m_second;
+		}
+
+		const TValueType& operator[] (const TKeyType& key) const
+		{
+			const size_t index = FindKey(Sailor::GetHash(key), key);
+			check(index != Super::InvalidIndex);
+
+			return Super::m_pSlots[index].m_second;
+		}
+
+		bool Find(const TKeyType& key, TValueType*& out)
+		{
+			const size_t index = FindKey(Sailor::GetHash(key), key);
+			if (index != Super::InvalidIndex)
+			{
+				out = &Super::m_pSlots[index].m_second;
+				return true;
+			}
+			return false;
+		}
+
+		bool Find(const TKeyType& key, TValueType const*& out) const
+		{
+			const size_t index = FindKey(Sailor::GetHash(key), key);
+			if (index != Super::InvalidIndex)
+			{
+				out = &Super::m_pSlots[index].m_second;
+				return true;
+			}
+			return false;
+		}
+
+		TIterator Find(const TKeyType& key)
+		{
+			const size_t index = FindKey(Sailor::GetHash(key), key);
+			return index != Super::InvalidIndex ? TIterator(this, index) : Super::end();
+		}
+
+		TConstIterator Find(const TKeyType& key) const
+		{
+			const size_t index = FindKey(Sailor::GetHash(key), key);
+			return index != Super::InvalidIndex ? TConstIterator(this, index) : Super::end();
+		}
+
+		bool ContainsKey(const TKeyType& key) const
+		{
+			return FindKey(Sailor::GetHash(key), key) != Super::InvalidIndex;
+		}
+
+		bool ContainsValue(const TValueType& value) const
+		{
+			for (const auto& el : *this)
+			{
+				if (el.m_second == value)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		TVector<TKeyType> GetKeys() const
+		{
+			TVector<TKeyType> res;
+			res.Reserve(Super::Num());
+
+			for (const auto& el : *this)
+			{
+				res.Add(el.m_first);
+			}
+
+			return res;
+		}
+
+		TVector<TValueType> GetValues() const
+		{
+			TVector<TValueType> res;
+			res.Reserve(Super::Num());
+
+			for (const auto& el : *this)
+			{
+				res.Add(el.m_second);
+			}
+
+			return res;
+		}
+
+	protected:
+
+		__forceinline size_t FindKey(size_t hash, const TKeyType& key) const
+		{
+			return Super::FindIndex(hash, [&](const TElementType& el) { return el.m_first == key; });
+		}
+
+		TElementType& GetOrAdd(const TKeyType& key) requires IsDefaultConstructible<TValueType>
+		{
+			const size_t hash = Sailor::GetHash(key);
+			size_t index = FindKey(hash, key);
+
+			if (index == Super::InvalidIndex)
+			{
+				index = Super::PrepareInsert(hash);
+				new (&Super::m_pSlots[index]) TElementType(key, TValueType());
+			}
+
+			return Super::m_pSlots[index];
+		}
+	};
+}
@@ -0,0 +1,549 @@
+#pragma once
+#include <cassert>
+#include <memory>
+#include <concepts>
+#include <type_traits>
+#include <bit>
+#include <cstring>
+#include <emmintrin.h>
+#include "Core/Defines.h"
+#include "Memory/Memory.h"
+#include "Containers/Concepts.h"
+#include "Containers/Vector.h"
+#include "Containers/Pair.h"
+#include "Containers/Hash.h"
+
+namespace Sailor
+{
+	/* Open addressing hash set with the group probing (Swiss table).
+	*  The elements are stored in the flat array and each slot has the control byte:
+	*  Empty, Deleted or 7 bits of the hash for the filled slot. The control bytes are probed by groups of 16 with SSE2,
+	*  so the lookup compares the key only for the slots with matching 7 bits of the hash and stops at the group with an empty slot.
+	*  The iterators and pointers are invalidated by Insert, the iterators are unordered.
+	*/
+	namespace Internal::FlatHash
+	{
+		constexpr size_t GroupSize = 16;
+
+		constexpr uint8_t Empty = 0x80;
+		constexpr uint8_t Deleted = 0xFE;
+
+		__forceinline bool IsFull(uint8_t control) { return (control & 0x80) == 0; }
+
+		// The hash is mixed since std::hash for the integers is weak
+		__forceinline size_t MixHash(size_t hash)
+		{
+			hash *= 0x9E3779B97F4A7C15ull;
+			return hash ^ (hash >> 32);
+		}
+
+		__forceinline uint8_t H2(size_t mixedHash) { return (uint8_t)(mixedHash & 0x7F); }
+		__forceinline size_t H1(size_t mixedHash) { return mixedHash >> 7; }
+
+		class Group
+		{
+		public:
+
+			__forceinline explicit Group(const uint8_t* pControl) : m_control(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pControl))) {}
+
+			__forceinline uint32_t Match(uint8_t h2) const { return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8((char)h2), m_control)); }
+			__forceinline uint32_t MatchEmpty() const { return Match(Empty); }
+
+			// Empty and Deleted have the high bit set
+			__forceinline uint32_t MatchEmptyOrDeleted() const { return (uint32_t)_mm_movemask_epi8(m_control); }
+			__forceinline uint32_t MatchFull() const { return ~MatchEmptyOrDeleted() & 0xFFFF; }
+
+		protected:
+
+			__m128i m_control;
+		};
+
+		// The pairs are hashed by the key, so TFlatMap could look up the elements by the key only
+		template<typename TElementType>
+		struct THashKey
+		{
+			static __forceinline size_t GetHash(const TElementType& element) { return Sailor::GetHash(element); }
+		};
+
+		template<typename TKeyType, typename TValueType>
+		struct THashKey<TPair<TKeyType, TValueType>>
+		{
+			static __forceinline size_t GetHash(const TPair<TKeyType, TValueType>& element) { return Sailor::GetHash(element.m_first); }
+		};
+	}
+
+	template<typename TElementType, typename TAllocator = Memory::DefaultGlobalAllocator>
+	class TFlatSet
+	{
+	public:
+
+		template<typename TDataType, typename TSetType>
+		class TBaseIterator
+		{
+		public:
+
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = TDataType;
+			using difference_type = int64_t;
+			using pointer = TDataType*;
+			using reference = TDataType&;
+
+			TBaseIterator() = default;
+			TBaseIterator(const TBaseIterator&) = default;
+			TBaseIterator(TBaseIterator&&) = default;
+			~TBaseIterator() = default;
+
+			TBaseIterator(TSetType* set, size_t index) : m_set(set), m_index(index), m_remainingInGroup(set->GetNextFullInGroup(index)) {}
+
+			operator TBaseIterator<const TDataType, const TSetType>() const { return TBaseIterator<const TDataType, const TSetType>(m_set, m_index); }
+
+			TBaseIterator& operator=(const TBaseIterator& rhs) = default;
+			TBaseIterator& operator=(TBaseIterator&& rhs) = default;
+
+			bool operator==(const TBaseIterator& rhs) const { return m_index == rhs.m_index; }
+			bool operator!=(const TBaseIterator& rhs) const { return m_index != rhs.m_index; }
+
+			pointer operator->() const { return &m_set->m_pSlots[m_index]; }
+			reference operator*() const { return m_set->m_pSlots[m_index]; }
+
+			TBaseIterator& operator++()
+			{
+				// The full slots of the current group are cached, so the control bytes are loaded once per group
+				if (m_remainingInGroup)
+				{
+					const uint32_t offset = std::countr_zero(m_remainingInGroup) + 1;
+					m_index += offset;
+					m_remainingInGroup >>= offset;
+				}
+				else
+				{
+					m_index = m_set->NextFull((m_index | (Internal::FlatHash::GroupSize - 1)) + 1);
+					m_remainingInGroup = m_set->GetNextFullInGroup(m_index);
+				}
+
+				return *this;
+			}
+
+			TBaseIterator operator++(int)
+			{
+				TBaseIterator res = *this;
+				++(*this);
+				return res;
+			}
+
+			__forceinline size_t GetIndex() const { return m_index; }
+
+		protected:
+
+			TSetType* m_set = nullptr;
+			size_t m_index = 0;
+			uint32_t m_remainingInGroup = 0;
+		};
+
+		using TIterator = TBaseIterator<TElementType, TFlatSet>;
+		using TConstIterator = TBaseIterator<const TElementType, const TFlatSet>;
+
+		TFlatSet(const uint32_t desiredNumElements = 0) { Reserve(desiredNumElements); }
+
+		TFlatSet(std::initializer_list<TElementType> initList) : TFlatSet((uint32_t)initList.size())
+		{
+			for (const auto& el : initList)
+			{
+				Insert(el);
+			}
+		}
+
+		TFlatSet(const TFlatSet& rhs) requires IsCopyConstructible<TElementType> : TFlatSet((uint32_t)rhs.Num())
+		{
+			for (const auto& el : rhs)
+			{
+				Insert(el);
+			}
+		}
+
+		TFlatSet& operator=(const TFlatSet& rhs) requires IsCopyConstructible<TElementType>
+		{
+			if (this != &rhs)
+			{
+				Clear();
+				Reserve(rhs.Num());
+
+				for (const auto& el : rhs)
+				{
+					Insert(el);
+				}
+			}
+			return *this;
+		}
+
+		TFlatSet(TFlatSet&& rhs) noexcept { Swap(*this, rhs); }
+
+		TFlatSet& operator=(TFlatSet&& rhs) noexcept
+		{
+			Swap(*this, rhs);
+			return *this;
+		}
+
+		~TFlatSet() { Release(); }
+
+		__forceinline bool IsEmpty() const { return m_num == 0; }
+		__forceinline size_t Num() const { return m_num; }
+		__forceinline size_t Capacity() const { return m_capacity; }
+
+		bool Contains(const TElementType& element) const
+		{
+			return FindIndex(HashElement(element), [&](const TElementType& el) { return el == element; }) != InvalidIndex;
+		}
+
+		TIterator Find(const TElementType& element)
+		{
+			const size_t index = FindIndex(HashElement(element), [&](const TElementType& el) { return el == element; });
+			return index != InvalidIndex ? TIterator(this, index) : end();
+		}
+
+		TConstIterator Find(const TElementType& element) const
+		{
+			const size_t index = FindIndex(HashElement(element), [&](const TElementType& el) { return el == element; });
+			return index != InvalidIndex ? TConstIterator(this, index) : end();
+		}
+
+		// Returns false if the element is already in the set
+		bool Insert(TElementType element)
+		{
+			const size_t hash = HashElement(element);
+			if (FindIndex(hash, [&](const TElementType& el) { return el == element; }) != InvalidIndex)
+			{
+				return false;
+			}
+
+			// PrepareInsert could rehash, so the slots are taken after it
+			const size_t index = PrepareInsert(hash);
+			new (&m_pSlots[index]) TElementType(std::move(element));
+			return true;
+		}
+
+		bool Remove(const TElementType& element)
+		{
+			const size_t index = FindIndex(HashElement(element), [&](const TElementType& el) { return el == element; });
+			if (index == InvalidIndex)
+			{
+				return false;
+			}
+
+			EraseAt(index);
+			return true;
+		}
+
+		size_t RemoveAll(const TPredicate<TElementType>& predicate)
+		{
+			size_t num = 0;
+			for (size_t i = NextFull(0); i < m_capacity; i = NextFull(i + 1))
+			{
+				if (predicate(m_pSlots[i]))
+				{
+					EraseAt(i);
+					num++;
+				}
+			}
+
+			return num;
+		}
+
+		TVector<TElementType> ToVector() const
+		{
+			TVector<TElementType> res;
+			res.Reserve(Num());
+
+			for (const auto& el : *this)
+			{
+				res.Add(el);
+			}
+
+			return res;
+		}
+
+		// Keeps the storage
+		void Clear()
+		{
+			if constexpr (!IsTriviallyDestructible<TElementType>)
+			{
+				for (size_t i = NextFull(0); i < m_capacity; i = NextFull(i + 1))
+				{
+					m_pSlots[i].~TElementType();
+				}
+			}
+
+			if (m_pControl)
+			{
+				memset(m_pControl, Internal::FlatHash::Empty, m_capacity);
+			}
+
+			m_num = 0;
+			m_numDeleted = 0;
+		}
+
+		void Reserve(size_t numElements)
+		{
+			const size_t capacity = GetCapacityForElements(numElements);
+			if (capacity > m_capacity)
+			{
+				Rehash(capacity);
+			}
+		}
+
+		bool operator==(const TFlatSet& rhs) const
+		{
+			if (rhs.Num() != Num())
+			{
+				return false;
+			}
+
+			for (const auto& el : rhs)
+			{
+				if (!Contains(el))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		static void Swap(TFlatSet& lhs, TFlatSet& rhs)
+		{
+			std::swap(lhs.m_pControl, rhs.m_pControl);
+			std::swap(lhs.m_pSlots, rhs.m_pSlots);
+			std::swap(lhs.m_capacity, rhs.m_capacity);
+			std::swap(lhs.m_num, rhs.m_num);
+			std::swap(lhs.m_numDeleted, rhs.m_numDeleted);
+			std::swap(lhs.m_allocator, rhs.m_allocator);
+		}
+
+		// Support ranged for
+		TIterator begin() { return TIterator(this, NextFull(0)); }
+		TIterator end() { return TIterator(this, m_capacity); }
+
+		TConstIterator begin() const { return TConstIterator(this, NextFull(0)); }
+		TConstIterator end() const { return TConstIterator(this, m_capacity); }
+
+	protected:
+
+		static constexpr size_t InvalidIndex = (size_t)-1;
+		static constexpr size_t MinCapacity = Internal::FlatHash::GroupSize;
+
+		// The max load factor is 7/8 including the deleted slots
+		static __forceinline size_t GetMaxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+		static size_t GetCapacityForElements(size_t numElements)
+		{
+			if (numElements == 0)
+			{
+				return 0;
+			}
+
+			return (std::max)(MinCapacity, std::bit_ceil(numElements + numElements / 7 + 1));
+		}
+
+		template<typename TPredicate>
+		size_t FindIndex(size_t hash, TPredicate&& predicate) const
+		{
+			using namespace Internal::FlatHash;
+
+			if (m_num == 0)
+			{
+				return InvalidIndex;
+			}
+
+			const size_t mixedHash = MixHash(hash);
+			const uint8_t h2 = H2(mixedHash);
+			const size_t groupMask = m_capacity / GroupSize - 1;
+
+			// Quadratic probing over the groups, visits each group once since the number of groups is power of 2
+			size_t group = H1(mixedHash) & groupMask;
+			for (size_t step = 1; ; step++)
+			{
+				const uint8_t* pControl = m_pControl + group * GroupSize;
+				const Group controlGroup(pControl);
+
+				for (uint32_t match = controlGroup.Match(h2); match; match &= match - 1)
+				{
+					const size_t index = group * GroupSize + std::countr_zero(match);
+					if (predicate(m_pSlots[index]))
+					{
+						return index;
+					}
+				}
+
+				if (controlGroup.MatchEmpty() || step > groupMask)
+				{
+					return InvalidIndex;
+				}
+
+				group = (group + step) & groupMask;
+			}
+		}
+
+		// Returns the index of the free slot for the new element, the control byte is already set
+		size_t PrepareInsert(size_t hash)
+		{
+			using namespace Internal::FlatHash;
+
+			if (m_num + m_numDeleted + 1 > GetMaxLoad(m_capacity))
+			{
+				// Reuse the storage if the tombstones take a lot of space
+				const size_t capacity = m_num + 1 > GetMaxLoad(m_capacity) / 2 ? (std::max)(MinCapacity, m_capacity * 2) : m_capacity;
+				Rehash(capacity);
+			}
+
+			const size_t mixedHash = MixHash(hash);
+			const size_t index = FindFreeSlot(mixedHash);
+
+			if (m_pControl[index] == Deleted)
+			{
+				m_numDeleted--;
+			}
+
+			m_pControl[index] = H2(mixedHash);
+			m_num++;
+
+			return index;
+		}
+
+		size_t FindFreeSlot(size_t mixedHash) const
+		{
+			using namespace Internal::FlatHash;
+
+			const size_t groupMask = m_capacity / GroupSize - 1;
+
+			size_t group = H1(mixedHash) & groupMask;
+			for (size_t step = 1; ; step++)
+			{
+				const uint32_t match = Group(m_pControl + group * GroupSize).MatchEmptyOrDeleted();
+				if (match)
+				{
+					return group * GroupSize + std::countr_zero(match);
+				}
+
+				check(step <= groupMask);
+				group = (group + step) & groupMask;
+			}
+		}
+
+		void EraseAt(size_t index)
+		{
+			using namespace Internal::FlatHash;
+
+			m_pSlots[index].~TElementType();
+			m_num--;
+
+			// The lookups stop at the group with an empty slot, so no probe sequence passes through such group
+			// and the slot could be marked as empty instead of the tombstone
+			const size_t groupStart = index & ~(GroupSize - 1);
+			if (Group(m_pControl + groupStart).MatchEmpty())
+			{
+				m_pControl[index] = Empty;
+			}
+			else
+			{
+				m_pControl[index] = Deleted;
+				m_numDeleted++;
+			}
+		}
+
+		size_t NextFull(size_t index) const
+		{
+			using namespace Internal::FlatHash;
+
+			while (index < m_capacity)
+			{
+				const size_t groupStart = index & ~(GroupSize - 1);
+				const uint32_t match = Group(m_pControl + groupStart).MatchFull() >> (index - groupStart);
+
+				if (match)
+				{
+					return index + std::countr_zero(match);
+				}
+
+				index = groupStart + GroupSize;
+			}
+
+			return m_capacity;
+		}
+
+		// The mask of the full slots after the index within its group
+		__forceinline uint32_t GetNextFullInGroup(size_t index) const
+		{
+			using namespace Internal::FlatHash;
+
+			if (index >= m_capacity)
+			{
+				return 0;
+			}
+
+			const size_t groupStart = index & ~(GroupSize - 1);
+			return Group(m_pControl + groupStart).MatchFull() >> (index - groupStart + 1);
+		}
+
+		void Rehash(size_t capacity)
+		{
+			check(capacity >= MinCapacity && std::has_single_bit(capacity));
+
+			uint8_t* pOldControl = m_pControl;
+			TElementType* pOldSlots = m_pSlots;
+			const size_t oldCapacity = m_capacity;
+
+			// The control bytes are followed by the slots in the single allocation
+			const size_t slotsOffset = (capacity + alignof(TElementType) - 1) & ~(alignof(TElementType) - 1);
+			m_pControl = static_cast<uint8_t*>(m_allocator.Allocate(slotsOffset + capacity * sizeof(TElementType), (std::max)(alignof(TElementType), (size_t)16)));
+			m_pSlots = reinterpret_cast<TElementType*>(m_pControl + slotsOffset);
+			m_capacity = capacity;
+			m_numDeleted = 0;
+
+			memset(m_pControl, Internal::FlatHash::Empty, capacity);
+
+			for (size_t i = 0; i < oldCapacity; i++)
+			{
+				if (Internal::FlatHash::IsFull(pOldControl[i]))
+				{
+					const size_t mixedHash = Internal::FlatHash::MixHash(HashElement(pOldSlots[i]));
+					const size_t index = FindFreeSlot(mixedHash);
+
+					m_pControl[index] = Internal::FlatHash::H2(mixedHash);
+					new (&m_pSlots[index]) TElementType(std::move(pOldSlots[i]));
+					pOldSlots[i].~TElementType();
+				}
+			}
+
+			if (pOldControl)
+			{
+				m_allocator.Free(pOldControl);
+			}
+		}
+
+		void Release()
+		{
+			Clear();
+
+			if (m_pControl)
+			{
+				m_allocator.Free(m_pControl);
+			}
+
+			m_pControl = nullptr;
+			m_pSlots = nullptr;
+			m_capacity = 0;
+		}
+
+		static __forceinline size_t HashElement(const TElementType& element) { return Internal::FlatHash::THashKey<TElementType>::GetHash(element); }
+
+		uint8_t* m_pControl = nullptr;
+		TElementType* m_pSlots = nullptr;
+		size_t m_capacity = 0;
+		size_t m_num = 0;
+		size_t m_numDeleted = 0;
+		TAllocator m_allocator{};
+
+		template<typename TDataType, typename TSetType>
+		friend class TBaseIterator;
+	};
+}
@@ -1,5 +1,6 @@
 #include <unordered_map>
 #include "Containers/Map.h"
+#include "Containers/FlatMap.h"
 #include "Containers/ConcurrentMap.h"
 #include "Core/Utils.h"
 #include <random>
@@ -733,6 +734,132 @@ namespace Sailor
 		}
 	};
 
+	struct LookupResult
+	{
+		std::string m_className;
+
+		LookupResult() = default;
+		LookupResult(std::string className) : m_className(className) {}
+
+		size_t m_insert = 0;
+		size_t m_lookupHit = 0;
+		size_t m_lookupMiss = 0;
+		size_t m_iterate = 0;
+
+		bool m_bSanityPassed = false;
+
+		void PrintLog()
+		{
+			SAILOR_LOG("\nClassName: %s", m_className.c_str());
+			SAILOR_LOG("Sanity check passed: %d", m_bSanityPassed);
+			SAILOR_LOG("Performance test insert: %llums", m_insert);
+			SAILOR_LOG("Performance test lookup (hits): %llums", m_lookupHit);
+			SAILOR_LOG("Performance test lookup (misses): %llums", m_lookupMiss);
+			SAILOR_LOG("Performance test iterate: %llums", m_iterate);
+		}
+	};
+
+	// Compares the hash maps on the same workload, the containers differ only in the lookup and the iteration syntax
+	template<typename TContainer>
+	class TestCase_MapLookupPerformance
+	{
+		static constexpr size_t Count = 1000000;
+		static constexpr size_t NumIterations = 20;
+
+	public:
+
+		static LookupResult RunTests()
+		{
+			LookupResult res(typeid(TContainer).name());
+
+			TContainer container;
+			Timer timer;
+
+			timer.Start();
+			for (size_t i = 0; i < Count; i++)
+			{
+				container[i * 7] = i;
+			}
+			timer.Stop();
+			res.m_insert = timer.ResultMs();
+
+			std::mt19937 g(0);
+			volatile size_t numFound = 0;
+
+			timer.Clear();
+			timer.Start();
+			for (size_t i = 0; i < Count; i++)
+			{
+				numFound += Contains(container, (g() % Count) * 7) ? 1 : 0;
+			}
+			timer.Stop();
+			res.m_lookupHit = timer.ResultMs();
+
+			const bool bAllHits = numFound == Count;
+
+			numFound = 0;
+			timer.Clear();
+			timer.Start();
+			for (size_t i = 0; i < Count; i++)
+			{
+				numFound += Contains(container, (g() % Count) * 7 + 1 + g() % 6) ? 1 : 0;
+			}
+			timer.Stop();
+			res.m_lookupMiss = timer.ResultMs();
+
+			const bool bAllMisses = numFound == 0;
+
+			size_t sum = 0;
+			timer.Clear();
+			timer.Start();
+			for (size_t i = 0; i < NumIterations; i++)
+			{
+				sum += Sum(container);
+			}
+			timer.Stop();
+			res.m_iterate = timer.ResultMs();
+
+			res.m_bSanityPassed = bAllHits && bAllMisses && sum == NumIterations * (Count * (Count - 1) / 2);
+
+			return res;
+		}
+
+	protected:
+
+		static __forceinline bool Contains(const TContainer& container, size_t key)
+		{
+			if constexpr (requires { container.ContainsKey(key); })
+			{
+				return container.ContainsKey(key);
+			}
+			else
+			{
+				return container.find(key) != container.end();
+			}
+		}
+
+		static size_t Sum(TContainer& container)
+		{
+			size_t sum = 0;
+			for (const auto& el : container)
+			{
+				if constexpr (requires { el.second; })
+				{
+					sum += el.second;
+				}
+				else if constexpr (std::is_pointer_v<std::remove_cvref_t<decltype(el.m_second)>>)
+				{
+					sum += *el.m_second;
+				}
+				else
+				{
+					sum += el.m_second;
+				}
+			}
+			return sum;
+		}
+	};
+
 	void Sailor::RunMapBenchmark()
 	{
 		using TDeepData = TDeepData<1024>;
@@ -761,6 +888,19 @@ namespace Sailor
 			r.PrintLog();
 		}
 
+		printf("\nStarting flat map benchmark...\n");
+
+		TVector<LookupResult> lookupRes;
+
+		lookupRes.Add(TestCase_MapLookupPerformance<std::unordered_map<size_t, size_t>>::RunTests());
+		lookupRes.Add(TestCase_MapLookupPerformance<Sailor::TMap<size_t, size_t>>::RunTests());
+		lookupRes.Add(TestCase_MapLookupPerformance<Sailor::TFlatMap<size_t, size_t>>::RunTests());
+
+		for (auto& r : lookupRes)
+		{
+			r.PrintLog();
+		}
+
 		printf("\n\n");
 	}
 }
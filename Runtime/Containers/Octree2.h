@@ -1,425 +1,527 @@
 #pragma once
 #include <cassert>
 #include <memory>
-#include <functional>
 #include <concepts>
 #include <type_traits>
-#include <iterator>
 #include <algorithm>
+#include <bit>
 #include "Core/Defines.h"
 #include "Math/Math.h"
+#include "Math/Bounds.h"
 #include "Memory/Memory.h"
 #include "Containers/Concepts.h"
-#include "Containers/Map.h"
+#include "Containers/Vector.h"
+#include "Containers/FlatMap.h"
 #include "RHI/DebugContext.h"
 
-// Not used, more memory friendly solution
 namespace Sailor
 {
+	/* Linear octree with the same interface as TOctree, but without the pointers and the maps in the nodes.
+	*  The nodes are stored in the contiguous pool, the children of the node are the block of 8 nodes in the pool.
+	*  Each node is identified by the locational code: the leading 1 and 3 bits of the octant per level (Morton order),
+	*  so the smallest cell that contains the element is calculated with a few bit ops from the codes of its corners.
+	*  The elements are stored in the packed array and linked into the list of their node by the indices.
+	*  The element is placed into the deepest existing node on the path to its cell: the moved element is updated in place
+	*  while it stays in the cell and is reinserted from the common ancestor of the old and the new cell otherwise.
+	*  The empty nodes are collapsed on the removal.
+	*/
 	template<typename TElementType, typename TAllocator = Memory::DefaultGlobalAllocator>
 	class TOctree2
 	{
 		static constexpr uint32_t NumElementsInNode = 8u;
+		static constexpr uint32_t InvalidIndex = (uint32_t)(-1);
+
+		// 3 bits per level and the leading bit in the 64 bit code
+		static constexpr uint32_t MaxDepth = 21u;
 
 	protected:
 
-		struct TBounds
+		struct TNode
 		{
-			TBounds() = default;
-			TBounds(const glm::ivec3& pos, const glm::ivec3& extents) : m_position(pos), m_extents(extents) {}
-
-			bool operator==(const TBounds& rhs) const { return m_position == rhs.m_position || m_extents == rhs.m_extents; }
+			uint64_t m_code = 1;
+			glm::vec3 m_center{};
+			float m_halfSize = 0.0f;
+			uint32_t m_parent = InvalidIndex;
+			uint32_t m_firstChild = InvalidIndex;
+			uint32_t m_firstElement = InvalidIndex;
+			uint32_t m_numElements = 0;
+
+			__forceinline bool IsLeaf() const { return m_firstChild == InvalidIndex; }
+			__forceinline bool IsEmptyLeaf() const { return IsLeaf() && m_numElements == 0; }
+		};
 
+		struct TElement
+		{
 			glm::ivec3 m_position{};
+			uint32_t m_node = InvalidIndex;
 			glm::ivec3 m_extents{};
+			uint32_t m_next = InvalidIndex;
+			uint64_t m_cell = 1;
+			uint32_t m_prev = InvalidIndex;
+			TElementType m_element{};
 		};
 
-		struct TNode
+	public:
+
+		// Constructors & Destructor
+		TOctree2(glm::ivec3 center = glm::ivec3(0, 0, 0), uint32_t size = 16536u, uint32_t minSize = 4)
+		{
+			m_center = center;
+			m_size = size;
+			m_minSize = minSize;
+
+			// The node is split while it is bigger than the min size, the same as TOctree
+			m_depth = 0;
+			while ((m_size >> m_depth) > m_minSize && m_depth < MaxDepth)
+			{
+				m_depth++;
+			}
+
+			m_origin = glm::vec3(center) - (float)size * 0.5f;
+			m_invCellSize = (float)(1u << m_depth) / (float)size;
+
+			Clear();
+		}
+
+		TOctree2(const TOctree2&) = default;
+		TOctree2(TOctree2&&) noexcept = default;
+		TOctree2& operator=(const TOctree2&) = default;
+		TOctree2& operator=(TOctree2&&) noexcept = default;
+		~TOctree2() = default;
+
+		void Clear()
 		{
-			// Bottom   Top
-			// |0|1|    |4|5|
-			// |2|3|    |6|7|
-			__forceinline constexpr uint32_t GetIndex(int32_t x, int32_t y, int32_t z) const { return (z < 0 ? 0 : 1) + (x < 0 ? 1 : 0) * 2 + (y < 0 ? 0 : 1) * 4; }
+			m_nodes.Clear();
+			m_elements.Clear();
+			m_freeBlocks.Clear();
+			m_map.Clear();
+
+			TNode& root = m_nodes[m_nodes.Emplace()];
+			root.m_center = glm::vec3(m_center);
+			root.m_halfSize = (float)m_size * 0.5f;
+
+			m_numNodes = 1;
+		}
+
+		bool Contains(const TElementType& element) const { return m_map.ContainsKey(element); }
+		size_t Num() const { return m_elements.Num(); }
+		size_t NumNodes() const { return m_numNodes; }
 
-			__forceinline bool IsLeaf() const { return m_bIsLeaf; }
-			__forceinline bool Contains(const glm::ivec3& pos, const glm::ivec3& extents) const
+		bool Insert(const glm::ivec3& pos, const glm::ivec3& extents, const TElementType& element)
+		{
+			if (!IsInside(pos, extents) || m_map.ContainsKey(element))
 			{
-				const int32_t halfSize = m_size / 2;
-				return m_center.x - halfSize < pos.x - extents.x &&
-					m_center.y - halfSize < pos.y - extents.y &&
-					m_center.z - halfSize < pos.z - extents.z &&
-					m_center.x + halfSize > pos.x + extents.x &&
-					m_center.y + halfSize > pos.y + extents.y &&
-					m_center.z + halfSize > pos.z + extents.z;
+				return false;
 			}
 
-			__forceinline bool Overlaps(const glm::ivec3& pos, const glm::ivec3& extents) const
+			const uint32_t slot = (uint32_t)m_elements.Num();
+
+			TElement& el = m_elements[m_elements.Emplace()];
+			el.m_position = pos;
+			el.m_extents = extents;
+			el.m_cell = CalculateCell(pos, extents);
+			el.m_element = element;
+
+			m_map[element] = slot;
+			Insert_Internal(slot, 0);
+
+			return true;
+		}
+
+		bool Update(const glm::ivec3& pos, const glm::ivec3& extents, const TElementType& element)
+		{
+			uint32_t* pSlot = nullptr;
+			if (!m_map.Find(element, pSlot))
 			{
-				const int32_t halfSize = m_size / 2;
-				return
-					(m_center.x - halfSize < pos.x + extents.x) && (m_center.x + halfSize > pos.x - extents.x) &&
-					(m_center.y - halfSize < pos.y + extents.y) && (m_center.y + halfSize > pos.y - extents.y) &&
-					(m_center.z - halfSize < pos.z + extents.z) && (m_center.z + halfSize > pos.z - extents.z);
+				return Insert(pos, extents, element);
 			}
 
-			__forceinline bool CanCollapse() const
+			// Cannot keep the element in the octree
+			if (!IsInside(pos, extents))
 			{
-				if (IsLeaf())
-				{
-					return false;
-				}
+				Remove(element);
+				return false;
+			}
 
-				for (uint32_t i = 0; i < 8; i++)
-				{
-					if (m_internal[i] && (!m_internal[i]->IsLeaf() || m_internal[i]->m_elements.Num() > 0))
-					{
-						return false;
-					}
-				}
+			const uint32_t slot = *pSlot;
+			const uint64_t cell = CalculateCell(pos, extents);
+
+			TElement& el = m_elements[slot];
+			el.m_position = pos;
+			el.m_extents = extents;
 
+			if (cell == el.m_cell)
+			{
 				return true;
 			}
 
-			__forceinline void Insert(const TElementType& element, const glm::ivec3& pos, const glm::ivec3& extents)
+			el.m_cell = cell;
+
+			// The node is still the deepest existing node on the path to the new cell
+			const uint32_t node = el.m_node;
+			if (IsAncestorOrSelf(m_nodes[node].m_code, cell) && (m_nodes[node].IsLeaf() || GetDepth(m_nodes[node].m_code) == GetDepth(cell)))
 			{
-				m_elements[element] = TBounds(pos, extents);
+				return true;
 			}
 
-			__forceinline bool Remove(const TElementType& element)
+			uint32_t ancestor = node;
+			while (!IsAncestorOrSelf(m_nodes[ancestor].m_code, cell))
 			{
-				return m_elements.Remove(element);
+				ancestor = m_nodes[ancestor].m_parent;
 			}
 
-			uint32_t m_size = 1;
-			glm::ivec3 m_center{};
-			TNode* m_internal[8]{};
-			bool m_bIsLeaf = true;
-			TMap<TElementType, TBounds> m_elements{ NumElementsInNode };
-		};
+			Unlink(slot);
+			Insert_Internal(slot, ancestor);
 
-	public:
+			// The old node is collapsed after the insertion, so the ancestor is alive while the element is placed
+			TryCollapse(node);
 
-		// Constructors & Destructor
-		TOctree2(glm::ivec3 center = glm::ivec3(0, 0, 0), uint32_t size = 16536u, uint32_t minSize = 4) : m_map(size)
-		{
-			m_minSize = minSize;
-			m_root = Memory::New<TNode>(m_allocator);
-			m_root->m_size = size;
-			m_root->m_center = center;
+			return true;
 		}
 
-		virtual ~TOctree2()
+		bool Remove(const TElementType& element)
 		{
-			Clear();
+			uint32_t* pSlot = nullptr;
+			if (!m_map.Find(element, pSlot))
+			{
+				return false;
+			}
 
-			Memory::Delete<TNode>(m_allocator, m_root);
-			m_root = nullptr;
-		}
+			const uint32_t slot = *pSlot;
+			const uint32_t node = m_elements[slot].m_node;
 
-		TOctree2(const TOctree2& octree) {}
-		TOctree2& operator= (const TOctree2& octree) {}
+			m_map.Remove(element);
 
-		TOctree2(TOctree2&& octree) { Swap(std::move(*this), octree); }
-		TOctree2& operator= (TOctree2&& octree)
-		{
-			Swap(std::move(*this), octree);
-			return this;
-		}
+			Unlink(slot);
+			RemoveSlot(slot);
+			TryCollapse(node);
 
-		static void Swap(TOctree2&& lhs, TOctree2&& rhs)
-		{
-			std::swap(rhs->m_root, lhs->m_root);
-			std::swap(rhs->m_allocator, lhs->m_allocator);
-			std::swap(rhs->m_num, lhs->m_num);
-			std::swap(rhs->m_minSize, lhs->m_minSize);
-			std::swap(rhs->m_map, lhs->m_map);
+			return true;
 		}
 
-		void Clear()
+		// The empty nodes are collapsed on the removal, nothing is left to resolve
+		__forceinline void Resolve() {}
+
+		void DrawOctree(RHI::DebugContext& context, float duration = 0.0f) const
 		{
-			if (m_root)
+			for (uint32_t i = 0; i < m_nodes.Num(); i++)
 			{
-				Clear_Internal(*m_root);
-			}
-			m_map.Clear();
-		}
-
-		bool Contains(const TElementType& element) const { return m_root && m_map.ContainsKey(element); }
-		size_t Num() const { return m_num; }
-		size_t NumNodes() const { return m_numNodes; }
+				const TNode& node = m_nodes[i];
+				if (node.m_halfSize <= 0.0f)
+				{
+					continue;
+				}
 
-		//TVector<TElementType, TAllocator> GetElements(glm::ivec3 extents) const { return TVector(); }
+				const glm::vec4 color = node.IsEmptyLeaf() ? glm::vec4(1.0f, 0.2f, 0.2f, 1.0f) : glm::vec4(0.2f, 1.0f, 0.2f, 1.0f);
+				context.DrawAABB(Math::AABB(node.m_center, glm::vec3(node.m_halfSize)), color, duration);
 
-		bool Insert(const glm::ivec3& pos, const glm::ivec3& extents, const TElementType& element)
-		{
-			if (Insert_Internal(*m_root, pos, extents, element))
-			{
-				m_num++;
-				return true;
+				for (uint32_t j = node.m_firstElement; j != InvalidIndex; j = m_elements[j].m_next)
+				{
+					context.DrawAABB(Math::AABB(glm::vec3(m_elements[j].m_position), glm::vec3(m_elements[j].m_extents)), glm::vec4(0.2f, 0.2f, 1.0f, 1.0f), duration);
+				}
 			}
-			return false;
 		}
 
-		bool Update(const glm::ivec3& pos, const glm::ivec3& extents, const TElementType& element)
+		void Trace(const Math::Frustum& frustum, TVector<TElementType>& outElements) const
 		{
-			TNode** node;
-			if (m_map.Find(element, node))
+			outElements.Clear(false);
+
+			// Depth first, each level adds at most 7 nodes to the stack
+			uint32_t stack[MaxDepth * 7 + 8];
+			uint32_t stackSize = 0;
+			stack[stackSize++] = 0;
+
+			while (stackSize > 0)
 			{
-				// If we're still in the octant then we just update the bounds
-				if ((*node)->Contains(pos, extents))
+				const TNode& node = m_nodes[stack[--stackSize]];
+
+				if (!frustum.OverlapsAABB(Math::AABB(node.m_center, glm::vec3(node.m_halfSize))))
 				{
-					(*node)->m_elements[element] = TBounds(pos, extents);
-					return true;
+					continue;
 				}
 
-				// If not then remove & reinsert
-				if ((*node)->Remove(element))
+				for (uint32_t i = node.m_firstElement; i != InvalidIndex; i = m_elements[i].m_next)
 				{
-					Resolve_Internal(**node);
+					const TElement& el = m_elements[i];
+					if (frustum.OverlapsAABB(Math::AABB(glm::vec3(el.m_position), glm::vec3(el.m_extents))))
+					{
+						outElements.Add(el.m_element);
+					}
 				}
 
-				if (Insert_Internal(*m_root, pos, extents, element))
+				if (!node.IsLeaf())
 				{
-					return true;
+					for (uint32_t i = 0; i < 8; i++)
+					{
+						if (!m_nodes[node.m_firstChild + i].IsEmptyLeaf())
+						{
+							stack[stackSize++] = node.m_firstChild + i;
+						}
+					}
 				}
-
-				// Cannot insert the element into octree
-				m_map.Remove(element);
 			}
-
-			return Insert_Internal(*m_root, pos, extents, element);
 		}
 
-		bool Remove(const TElementType& element)
+	protected:
+
+		static __forceinline uint32_t GetDepth(uint64_t code) { return (63u - (uint32_t)std::countl_zero(code)) / 3u; }
+
+		static __forceinline bool IsAncestorOrSelf(uint64_t code, uint64_t cell)
 		{
-			TNode** node;
-			if (m_map.Find(element, node))
-			{
-				if ((*node)->Remove(element))
-				{
-					Resolve_Internal(**node);
-					m_map.Remove(element);
-					m_num--;
+			const uint32_t depth = GetDepth(code);
+			const uint32_t cellDepth = GetDepth(cell);
 
-					return true;
-				}
-			}
-			return false;
+			return depth <= cellDepth && (cell >> (3 * (cellDepth - depth))) == code;
 		}
 
-		__forceinline void Resolve()
+		// Inserts 2 zero bits between the bits of the value
+		static __forceinline uint64_t SplitBy3(uint32_t value)
 		{
-			Resolve_Internal(*m_root);
+			uint64_t x = value & 0x1fffff;
+			x = (x | x << 32) & 0x1f00000000ffff;
+			x = (x | x << 16) & 0x1f0000ff0000ff;
+			x = (x | x << 8) & 0x100f00f00f00f00f;
+			x = (x | x << 4) & 0x10c30c30c30c30c3;
+			x = (x | x << 2) & 0x1249249249249249;
+			return x;
 		}
 
-		void DrawOctree(RHI::DebugContext& context, float duration = 0.0f) const
+		__forceinline uint64_t CalculateMortonCode(const glm::vec3& point) const
 		{
-			DrawOctree_Internal(*m_root, context, duration);
+			const int32_t maxCoord = (int32_t)(1u << m_depth) - 1;
+			const glm::ivec3 q = glm::clamp(glm::ivec3(glm::floor((point - m_origin) * m_invCellSize)), glm::ivec3(0), glm::ivec3(maxCoord));
+
+			return SplitBy3((uint32_t)q.x) | (SplitBy3((uint32_t)q.y) << 1) | (SplitBy3((uint32_t)q.z) << 2);
 		}
 
-	protected:
+		// The locational code of the smallest cell that contains the bounds, the common prefix of the corners
+		__forceinline uint64_t CalculateCell(const glm::ivec3& pos, const glm::ivec3& extents) const
+		{
+			const uint64_t minCode = CalculateMortonCode(glm::vec3(pos - extents));
+			const uint64_t maxCode = CalculateMortonCode(glm::vec3(pos + extents));
+			const uint64_t diff = minCode ^ maxCode;
+
+			const uint32_t numCutLevels = diff ? (63u - (uint32_t)std::countl_zero(diff)) / 3u + 1u : 0u;
+			const uint32_t depth = m_depth - numCutLevels;
+
+			return (1ull << (3 * depth)) | (minCode >> (3 * numCutLevels));
+		}
 
-		void DrawOctree_Internal(const TNode& node, RHI::DebugContext& context, float duration = 0.0f) const
+		__forceinline bool IsInside(const glm::ivec3& pos, const glm::ivec3& extents) const
 		{
-			if (!node.IsLeaf())
-			{
-				for (uint32_t i = 0; i < 8; i++)
-				{
-					if (node.m_internal[i])
-					{
-						DrawOctree_Internal(*node.m_internal[i], context, duration);
-					}
-				}
-			}
+			const int32_t halfSize = (int32_t)m_size / 2;
+			return glm::all(glm::lessThan(m_center - halfSize, pos - extents)) &&
+				glm::all(glm::greaterThan(m_center + halfSize, pos + extents));
+		}
 
-			glm::vec4 color = glm::vec4(0.2f, 1.0f, 0.2f, 1.0f);
+		// Finds the deepest existing node on the path to the cell
+		__forceinline uint32_t FindNode(uint32_t node, uint64_t cell) const
+		{
+			const uint32_t cellDepth = GetDepth(cell);
 
-			if (node.IsLeaf() && node.m_elements.Num() == 0)
+			uint32_t depth = GetDepth(m_nodes[node].m_code);
+			while (!m_nodes[node].IsLeaf() && depth < cellDepth)
 			{
-				color = glm::vec4(1.0f, 0.2f, 0.2f, 1.0f);
-				//return;
+				const uint32_t octant = (uint32_t)(cell >> (3 * (cellDepth - depth - 1))) & 7u;
+				node = m_nodes[node].m_firstChild + octant;
+				depth++;
 			}
 
-			Math::AABB aabb;
-			aabb.m_min = glm::vec3(node.m_center) - (float)node.m_size * glm::vec3(0.5f, 0.5f, 0.5f);
-			aabb.m_max = glm::vec3(node.m_center) + (float)node.m_size * glm::vec3(0.5f, 0.5f, 0.5f);
+			return node;
+		}
 
-			context.DrawAABB(aabb, color, duration);
+		void Insert_Internal(uint32_t slot, uint32_t startNode)
+		{
+			const uint32_t node = FindNode(startNode, m_elements[slot].m_cell);
+			Link(slot, node);
 
-			for (auto& el : node.m_elements)
+			if (m_nodes[node].IsLeaf() && m_nodes[node].m_numElements >= NumElementsInNode && GetDepth(m_nodes[node].m_code) < m_depth)
 			{
-				Math::AABB aabb;
-				aabb.m_min = glm::vec3(el.m_second.m_position - el.m_second.m_extents);
-				aabb.m_max = glm::vec3(el.m_second.m_position + el.m_second.m_extents);
-
-				const auto color = glm::vec4((0x4 & reinterpret_cast<size_t>(&node)) / 16.0f,
-					(0x4 & reinterpret_cast<size_t>(&node) >> 4) / 16.0f,
-					(0x4 & reinterpret_cast<size_t>(&node) >> 8) / 16.0f,
-					(0x4 & reinterpret_cast<size_t>(&node) >> 12) / 16.0f);
-
-				context.DrawAABB(aabb, color, duration);
+				Split(node);
 			}
 		}
 
-		void Resolve_Internal(TNode& node)
+		void Split(uint32_t node)
 		{
-			if (node.m_elements.Num())
-			{
-				return;
-			}
+			Subdivide(node);
+
+			const uint32_t depth = GetDepth(m_nodes[node].m_code);
+			const uint32_t firstChild = m_nodes[node].m_firstChild;
 
-			if (!node.IsLeaf())
+			// The elements that fit into the octants are moved down, the rest stay in the node
+			uint32_t slot = m_nodes[node].m_firstElement;
+			while (slot != InvalidIndex)
 			{
-				for (uint32_t i = 0; i < 8; i++)
+				const uint32_t next = m_elements[slot].m_next;
+				const uint64_t cell = m_elements[slot].m_cell;
+				const uint32_t cellDepth = GetDepth(cell);
+
+				if (cellDepth > depth)
 				{
-					if (node.m_internal[i])
-					{
-						Resolve_Internal(*node.m_internal[i]);
-					}
+					Unlink(slot);
+					Link(slot, firstChild + ((uint32_t)(cell >> (3 * (cellDepth - depth - 1))) & 7u));
 				}
+
+				slot = next;
 			}
 
-			if (node.CanCollapse())
+			for (uint32_t i = 0; i < 8; i++)
 			{
-				Collapse(node);
+				if (m_nodes[firstChild + i].m_numElements >= NumElementsInNode && depth + 1 < m_depth)
+				{
+					Split(firstChild + i);
+				}
 			}
 		}
 
-		void Clear_Internal(TNode& node)
+		void Subdivide(uint32_t node)
 		{
-			node.m_elements.Clear();
+			check(m_nodes[node].IsLeaf());
 
-			if (node.IsLeaf())
+			uint32_t firstChild = 0;
+			if (m_freeBlocks.Num() > 0)
+			{
+				firstChild = m_freeBlocks[m_freeBlocks.Num() - 1];
+				m_freeBlocks.RemoveLast();
+			}
+			else
 			{
-				return;
+				firstChild = (uint32_t)m_nodes.Num();
+				m_nodes.AddDefault(8);
 			}
 
+			const TNode& parent = m_nodes[node];
+			const float quarterSize = parent.m_halfSize * 0.5f;
+
 			for (uint32_t i = 0; i < 8; i++)
 			{
-				if (node.m_internal[i] != nullptr)
-				{
-					Clear_Internal(*node.m_internal[i]);
-				}
+				const glm::vec3 offset = glm::vec3((float)(i & 1u), (float)((i >> 1) & 1u), (float)((i >> 2) & 1u)) * 2.0f - 1.0f;
+
+				TNode& child = m_nodes[firstChild + i];
+				child = TNode();
+				child.m_code = (parent.m_code << 3) | i;
+				child.m_center = parent.m_center + offset * quarterSize;
+				child.m_halfSize = quarterSize;
+				child.m_parent = node;
 			}
 
-			Collapse(node);
+			m_nodes[node].m_firstChild = firstChild;
+			m_numNodes += 8;
 		}
 
-		__forceinline TNode& GetOrAddChildNode(TNode& node, size_t i)
+		void TryCollapse(uint32_t node)
 		{
-			// Bottom   Top
-			// |0|1|    |4|5|
-			// |2|3|    |6|7|
-			const glm::ivec3 offset[] = { glm::ivec3(1, -1, -1), glm::ivec3(1, -1, 1), glm::ivec3(-1, -1, -1), glm::ivec3(-1, -1, 1),
-										  glm::ivec3(1, 1, -1), glm::ivec3(1, 1, 1), glm::ivec3(-1, 1, -1), glm::ivec3(-1, 1, 1) };
+			while (node != 0 && m_nodes[node].IsEmptyLeaf())
+			{
+				const uint32_t parent = m_nodes[node].m_parent;
+				const uint32_t firstChild = m_nodes[parent].m_firstChild;
 
-			const int32_t quarterSize = node.m_size / 4;
+				for (uint32_t i = 0; i < 8; i++)
+				{
+					if (!m_nodes[firstChild + i].IsEmptyLeaf())
+					{
+						return;
+					}
+				}
 
-			if (!node.m_internal[i])
-			{
-				node.m_internal[i] = Memory::New<TNode>(m_allocator);
-				node.m_internal[i]->m_size = quarterSize * 2;
-				node.m_internal[i]->m_center = offset[i] * quarterSize + node.m_center;
-				node.m_bIsLeaf = false;
-				m_numNodes += 1;
-			}
+				// The freed block is marked to be skipped by DrawOctree
+				for (uint32_t i = 0; i < 8; i++)
+				{
+					m_nodes[firstChild + i].m_halfSize = 0.0f;
+				}
 
-			return *node.m_internal[i];
+				m_freeBlocks.Add(firstChild);
+				m_nodes[parent].m_firstChild = InvalidIndex;
+				m_numNodes -= 8;
+
+				node = parent;
+			}
 		}
 
-		__forceinline void Collapse(TNode& node)
+		__forceinline void Link(uint32_t slot, uint32_t node)
 		{
-			for (uint32_t i = 0; i < 8; i++)
-			{
-				if (node.m_internal[i] == nullptr)
-				{
-					continue;
-				}
+			TElement& el = m_elements[slot];
+			TNode& dst = m_nodes[node];
+
+			el.m_node = node;
+			el.m_prev = InvalidIndex;
+			el.m_next = dst.m_firstElement;
 
-				m_numNodes -= 1;
-				Memory::Delete<TNode>(m_allocator, node.m_internal[i]);
-				node.m_internal[i] = nullptr;
+			if (dst.m_firstElement != InvalidIndex)
+			{
+				m_elements[dst.m_firstElement].m_prev = slot;
 			}
 
-			node.m_bIsLeaf = true;
+			dst.m_firstElement = slot;
+			dst.m_numElements++;
 		}
 
-		bool Insert_Internal(TNode& node, const glm::ivec3& pos, const glm::ivec3& extents, const TElementType& element)
+		__forceinline void Unlink(uint32_t slot)
 		{
-			const bool bIsLeaf = node.IsLeaf();
-			const bool bContains = node.Contains(pos, extents);
+			TElement& el = m_elements[slot];
+			TNode& src = m_nodes[el.m_node];
 
-			if (!bContains)
+			if (el.m_prev != InvalidIndex)
 			{
-				return false;
+				m_elements[el.m_prev].m_next = el.m_next;
+			}
+			else
+			{
+				src.m_firstElement = el.m_next;
 			}
 
-			if (bIsLeaf)
+			if (el.m_next != InvalidIndex)
 			{
-				node.Insert(element, pos, extents);
+				m_elements[el.m_next].m_prev = el.m_prev;
+			}
 
-				if (node.m_elements.Num() == NumElementsInNode && node.m_size > m_minSize)
-				{
-					auto elements = std::move(node.m_elements);
-					node.m_elements.Clear();
-					node.m_bIsLeaf = false;
+			src.m_numElements--;
+			el.m_node = el.m_prev = el.m_next = InvalidIndex;
+		}
 
-					for (auto& el : elements)
-					{
-						const glm::ivec3 delta = el.m_second.m_position - node.m_center;
-						const size_t innerNodeIndex = node.GetIndex(delta.x, delta.y, delta.z);
+		// The last element is moved into the unlinked slot to keep the array packed
+		void RemoveSlot(uint32_t slot)
+		{
+			const uint32_t last = (uint32_t)m_elements.Num() - 1;
 
-						if (std::min(abs(delta.x), (int32_t)node.m_size / 2 - abs(delta.x)) > el.m_second.m_extents.x &&
-							std::min(abs(delta.y), (int32_t)node.m_size / 2 - abs(delta.y)) > el.m_second.m_extents.y &&
-							std::min(abs(delta.z), (int32_t)node.m_size / 2 - abs(delta.z)) > el.m_second.m_extents.z)
-						{
-							if (!Insert_Internal(GetOrAddChildNode(node, innerNodeIndex), pos, extents, element))
-							{
-								node.Insert(el.m_first, pos, extents);
-								m_map[element] = &node;
-							}
-						}
-					}
+			if (slot != last)
+			{
+				TElement& el = m_elements[slot];
+				el = std::move(m_elements[last]);
 
-					return true;
+				if (el.m_prev != InvalidIndex)
+				{
+					m_elements[el.m_prev].m_next = slot;
 				}
-
-				m_map[element] = &node;
-
-				return true;
-			}
-			else
-			{
-				const glm::ivec3 delta = pos - node.m_center;
-				const size_t innerNodeIndex = node.GetIndex(delta.x, delta.y, delta.z);
-
-				// Octant contains the object
-				if (node.m_elements.Num() >= NumElementsInNode &&
-					std::min(abs(delta.x), (int32_t)node.m_size / 2 - abs(delta.x)) > extents.x &&
-					std::min(abs(delta.y), (int32_t)node.m_size / 2 - abs(delta.y)) > extents.y &&
-					std::min(abs(delta.z), (int32_t)node.m_size / 2 - abs(delta.z)) > extents.z)
+				else
 				{
-					if (Insert_Internal(GetOrAddChildNode(node, innerNodeIndex), pos, extents, element))
-					{
-						return true;
-					}
+					m_nodes[el.m_node].m_firstElement = slot;
+				}
 
-					check(false);
+				if (el.m_next != InvalidIndex)
+				{
+					m_elements[el.m_next].m_prev = slot;
 				}
 
-				node.Insert(element, pos, extents);
-				m_map[element] = &node;
+				m_map[el.m_element] = slot;
 			}
 
-			return true;
+			m_elements.RemoveLast();
 		}
 
-		TNode* m_root{};
-		size_t m_num = 0u;
+		glm::ivec3 m_center{};
+		uint32_t m_size = 1;
 		uint32_t m_minSize = 1;
+		uint32_t m_depth = 0;
+
+		glm::vec3 m_origin{};
+		float m_invCellSize = 1.0f;
+
+		TVector<TNode, TAllocator> m_nodes;
+		TVector<TElement, TAllocator> m_elements;
+		TVector<uint32_t, TAllocator> m_freeBlocks;
 		size_t m_numNodes = 1u;
-		TAllocator m_allocator{};
-		TMap<TElementType, TNode*> m_map{};
-	};
 
-}
\ No newline at end of file
+		TFlatMap<TElementType, uint32_t, TAllocator> m_map{};
+	};
+}
@@ -1,12 +1,60 @@
 #include "Containers/Octree.h"
 #include "Containers/Octree2.h"
 #include "Core/Utils.h"
+#include "glm/glm/gtc/matrix_transform.hpp"
 #include <random>
 
 using namespace Sailor;
 using namespace Sailor::Memory;
 using Timer = Utils::Timer;
 
+namespace
+{
+	struct Data
+	{
+		glm::ivec3 m_pos;
+		glm::ivec3 m_extents;
+		size_t m_data;
+	};
+
+	TVector<Data> GenerateData(uint32_t count, uint32_t seed)
+	{
+		std::mt19937 gen(seed);
+		TVector<Data> data(count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			data[i].m_pos = glm::ivec3((int32_t)(gen() % 1000) - 512, (int32_t)(gen() % 1000) - 512, (int32_t)(gen() % 1000) - 512);
+
+			// Mostly small objects with the rare big ones
+			const int32_t maxExtents = i % 64 == 0 ? 100 : 16;
+			data[i].m_extents = glm::ivec3((int32_t)(gen() % maxExtents), (int32_t)(gen() % maxExtents), (int32_t)(gen() % maxExtents));
+			data[i].m_data = i;
+		}
+
+		return data;
+	}
+
+	// The cameras inside of the scene looking at the random directions
+	TVector<Math::Frustum> GenerateFrustums(uint32_t count, uint32_t seed)
+	{
+		std::mt19937 gen(seed);
+		std::uniform_real_distribution<float> dist(-400.0f, 400.0f);
+
+		TVector<Math::Frustum> frustums(count);
+		for (auto& frustum : frustums)
+		{
+			const glm::vec3 eye = glm::vec3(dist(gen), dist(gen), dist(gen));
+			const glm::vec3 target = glm::vec3(dist(gen), dist(gen), dist(gen));
+			const glm::mat4 cameraWorld = glm::inverse(glm::lookAt(eye, target, glm::vec3(0, 1, 0)));
+
+			frustum.ExtractFrustumPlanes(cameraWorld, 16.0f / 9.0f, 60.0f, 1.0f, 600.0f);
+		}
+
+		return frustums;
+	}
+}
+
 template<typename TContainer>
 class TestCase_OctreePerfromance
 {
@@ -19,37 +67,78 @@ public:
 		printf("%s\n", tOctreeClassName.c_str());
 		printf("Sanity check passed: %d\n", SanityCheck());
 		printf("\n");
-		PerformanceTests(10000);
+		PerformanceTests(100000);
 		printf("\n");
-		PerformanceTests(25000);
+		PerformanceTests(250000);
 		printf("\n");
 		PerformanceTests(1000000);
 		printf("\n");
 	}
 
+	// Trace should return the same elements as the brute force test of all the bounds
 	static bool SanityCheck()
 	{
-		return true;
-	}
+		const uint32_t count = 10000;
 
-	static void PerformanceTests(const uint32_t count)
-	{
-		struct Data
+		TVector<Data> data = GenerateData(count, 7);
+		TVector<Math::Frustum> frustums = GenerateFrustums(16, 7);
+		TContainer container(glm::ivec3(0, 0, 0), 2048u, 2u);
+
+		for (size_t i = 0; i < count; i++)
 		{
-			glm::ivec3 m_pos;
-			glm::ivec3 m_extents;
-			size_t m_data;
-		};
+			container.Insert(data[i].m_pos, data[i].m_extents, data[i].m_data);
+		}
 
-		TVector<Data> data(count);
+		// Half of the elements are moved far away, so they change the nodes
+		for (size_t i = 0; i < count; i += 2)
+		{
+			data[i].m_pos = glm::ivec3(data[i].m_pos.y, data[i].m_pos.z, data[i].m_pos.x);
+			container.Update(data[i].m_pos, data[i].m_extents, data[i].m_data);
+		}
 
-		for (size_t i = 0; i < count; i++)
+		for (size_t i = 0; i < count; i += 3)
 		{
-			data[i].m_pos = glm::ivec3(rand() % 1000 - 512, rand() % 1000 - 512, rand() % 1000 - 512);
-			data[i].m_extents = glm::ivec3(rand() % 100, rand() % 100, rand() % 100);
-			data[i].m_data = i;
+			container.Remove(data[i].m_data);
+		}
+
+		TVector<size_t> traced;
+		for (const auto& frustum : frustums)
+		{
+			container.Trace(frustum, traced);
+
+			size_t expected = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (i % 3 != 0 && frustum.OverlapsAABB(Math::AABB(glm::vec3(data[i].m_pos), glm::vec3(data[i].m_extents))))
+				{
+					expected++;
+				}
+			}
+
+			if (traced.Num() != expected)
+			{
+				return false;
+			}
+
+			for (size_t element : traced)
+			{
+				if (element % 3 == 0 || !frustum.OverlapsAABB(Math::AABB(glm::vec3(data[element].m_pos), glm::vec3(data[element].m_extents))))
+				{
+					return false;
+				}
+			}
 		}
 
+		return true;
+	}
+
+	static void PerformanceTests(const uint32_t count)
+	{
+		const uint32_t NumFrustums = 64;
+
+		TVector<Data> data = GenerateData(count, count);
+		TVector<Math::Frustum> frustums = GenerateFrustums(NumFrustums, count);
+
 		Timer tOctree;
 		TContainer container(glm::ivec3(0, 0, 0), 2048u, 2u);
 
@@ -60,19 +149,32 @@ public:
 			check(bInserted);
 		}
 		tOctree.Stop();
-		SAILOR_LOG("Performance test insert:\n\t TOctree %llums, nodes:%llu, elements:%llu", tOctree.ResultMs(), container.NumNodes(), container.Num());
+		SAILOR_LOG("Performance test insert %u:\n\t %llums, nodes:%llu, elements:%llu", count, tOctree.ResultMs(), container.NumNodes(), container.Num());
 
+		std::mt19937 gen(count);
 		tOctree.Clear();
 		tOctree.Start();
 		const auto shiftMax = 4;
 		for (size_t i = 0; i < count; i++)
 		{
-			const auto shift = glm::ivec3(rand() % shiftMax - shiftMax /2, rand() % shiftMax - shiftMax / 2, rand() % shiftMax - shiftMax / 2);
+			const auto shift = glm::ivec3((int32_t)(gen() % shiftMax) - shiftMax / 2, (int32_t)(gen() % shiftMax) - shiftMax / 2, (int32_t)(gen() % shiftMax) - shiftMax / 2);
 			const bool bUpdated = container.Update(data[i].m_pos + shift, data[i].m_extents, data[i].m_data);
 			//check(bUpdated);
 		}
 		tOctree.Stop();
-		SAILOR_LOG("Performance test update:\n\t TOctree %llums, nodes:%llu, elements:%llu", tOctree.ResultMs(), container.NumNodes(), container.Num());
+		SAILOR_LOG("Performance test update %u:\n\t %llums, nodes:%llu, elements:%llu", count, tOctree.ResultMs(), container.NumNodes(), container.Num());
+
+		size_t numTraced = 0;
+		TVector<size_t> traced;
+		tOctree.Clear();
+		tOctree.Start();
+		for (const auto& frustum : frustums)
+		{
+			container.Trace(frustum, traced);
+			numTraced += traced.Num();
+		}
+		tOctree.Stop();
+		SAILOR_LOG("Performance test trace %u frustums:\n\t %llums, traced elements:%llu", NumFrustums, tOctree.ResultMs(), numTraced);
 
 		tOctree.Clear();
 		tOctree.Start();
@@ -82,13 +184,13 @@ public:
 			//check(bRemoved);
 		}
 		tOctree.Stop();
-		SAILOR_LOG("Performance test remove:\n\t TOctree %llums, nodes:%llu, elements:%llu", tOctree.ResultMs(), container.NumNodes(), container.Num());
+		SAILOR_LOG("Performance test remove %u:\n\t %llums, nodes:%llu, elements:%llu", count, tOctree.ResultMs(), container.NumNodes(), container.Num());
 
 		tOctree.Clear();
 		tOctree.Start();
 		container.Resolve();
 		tOctree.Stop();
-		SAILOR_LOG("Performance test resolve:\n\t TOctree %llums, nodes:%llu, elements:%llu", tOctree.ResultMs(), container.NumNodes(), container.Num());
+		SAILOR_LOG("Performance test resolve:\n\t %llums, nodes:%llu, elements:%llu", tOctree.ResultMs(), container.NumNodes(), container.Num());
 	}
 };
 
@@ -97,5 +199,5 @@ void Sailor::RunOctreeBenchmark()
 	printf("\nStarting Octree benchmark...\n");
 
 	TestCase_OctreePerfromance<Sailor::TOctree<size_t>>::RunTests();
-	//TestCase_OctreePerfromance<Sailor::TOctree2<size_t>>::RunTests();
+	TestCase_OctreePerfromance<Sailor::TOctree2<size_t>>::RunTests();
 }
@@ -1,5 +1,6 @@
 #include <unordered_set>
 #include "Containers/Set.h"
+#include "Containers/FlatSet.h"
 #include "Containers/ConcurrentSet.h"
 #include "Core/Utils.h"
 #include <random>
@@ -103,6 +104,29 @@ public:
 		stdSet.Clear();
 		tSet.Clear();
 
+		volatile size_t stdSum = 0;
+		stdSet.Start();
+		for (const auto& el : ideal)
+		{
+			stdSum += el;
+		}
+		stdSet.Stop();
+
+		volatile size_t tSum = 0;
+		tSet.Start();
+		for (const auto& el : container)
+		{
+			tSum += el;
+		}
+		tSet.Stop();
+
+		check(stdSum == tSum);
+
+		SAILOR_LOG("Performance test iterate:\n\tstd::set %llums\n\tTSet %llums", stdSet.ResultMs(), tSet.ResultMs());
+		/////////////////////////////////////////////
+		stdSet.Clear();
+		tSet.Clear();
+
 		tSet.Start();
 		for (size_t i = 0; i < count; i++)
 		{
@@ -186,6 +210,9 @@ void Sailor::RunSetBenchmark()
 	printf("\nStarting set benchmark...\n");
 	TestCase_SetPerfromance<Sailor::TSet<size_t>>::RunTests();
 
+	printf("\nStarting flat set benchmark...\n");
+	TestCase_SetPerfromance<Sailor::TFlatSet<size_t>>::RunTests();
+
 	printf("\nStarting concurrent set benchmark...\n");
 	TestCase_SetPerfromance<Sailor::TConcurrentSet<size_t>>::RunTests();
 }
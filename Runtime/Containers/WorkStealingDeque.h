@@ -0,0 +1,183 @@
+#pragma once
+#include <cassert>
+#include <memory>
+#include <atomic>
+#include <type_traits>
+#include "Core/Defines.h"
+#include "Containers/Vector.h"
+#include "Memory/MallocAllocator.hpp"
+
+namespace Sailor
+{
+	/* Chase-Lev work stealing deque (Le, Pop, Cohen, Nardelli 'Correct and Efficient Work-Stealing for Weak Memory Models').
+	*  The owner thread pushes and pops elements from the bottom, any other thread could steal elements from the top.
+	*  The elements are copied by value while racing, so only trivially copyable types (raw pointers, handles) are allowed.
+	*  The ring buffer grows on demand, old buffers are released only with the container since thieves could still read them.
+	*/
+	template<typename TElementType, typename TAllocator = Memory::MallocAllocator>
+	class TWorkStealingDeque final
+	{
+		static_assert(std::is_trivially_copyable_v<TElementType>, "TWorkStealingDeque supports only trivially copyable elements");
+
+		class TRingBuffer
+		{
+		public:
+
+			TRingBuffer(int64_t capacity, TAllocator& allocator) : m_capacity(capacity), m_mask(capacity - 1)
+			{
+				check((capacity & (capacity - 1)) == 0);
+				m_pData = static_cast<std::atomic<TElementType>*>(allocator.Allocate(sizeof(std::atomic<TElementType>) * capacity, alignof(std::atomic<TElementType>)));
+			}
+
+			__forceinline int64_t Capacity() const { return m_capacity; }
+
+			__forceinline void Put(int64_t index, TElementType element) { m_pData[index & m_mask].store(element, std::memory_order_relaxed); }
+			__forceinline TElementType Get(int64_t index) const { return m_pData[index & m_mask].load(std::memory_order_relaxed); }
+
+			TRingBuffer* Grow(int64_t bottom, int64_t top, TAllocator& allocator) const
+			{
+				TRingBuffer* pRes = new (allocator.Allocate(sizeof(TRingBuffer))) TRingBuffer(m_capacity * 2, allocator);
+				for (int64_t i = top; i != bottom; i++)
+				{
+					pRes->Put(i, Get(i));
+				}
+				return pRes;
+			}
+
+			void Release(TAllocator& allocator)
+			{
+				allocator.Free(m_pData);
+				m_pData = nullptr;
+			}
+
+		protected:
+
+			int64_t m_capacity = 0;
+			int64_t m_mask = 0;
+			std::atomic<TElementType>* m_pData = nullptr;
+		};
+
+	public:
+
+		TWorkStealingDeque(int64_t initialCapacity = 1024)
+		{
+			m_pBuffer.store(new (m_allocator.Allocate(sizeof(TRingBuffer))) TRingBuffer(Math::UpperPowOf2((uint32_t)initialCapacity), m_allocator), std::memory_order_relaxed);
+		}
+
+		TWorkStealingDeque(const TWorkStealingDeque&) = delete;
+		TWorkStealingDeque(TWorkStealingDeque&&) = delete;
+		TWorkStealingDeque& operator=(const TWorkStealingDeque&) = delete;
+		TWorkStealingDeque& operator=(TWorkStealingDeque&&) = delete;
+
+		~TWorkStealingDeque()
+		{
+			ReleaseBuffer(m_pBuffer.load(std::memory_order_relaxed));
+
+			for (auto& pBuffer : m_garbage)
+			{
+				ReleaseBuffer(pBuffer);
+			}
+		}
+
+		// Could be called only by the owner thread
+		void Push(TElementType element)
+		{
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+			const int64_t top = m_top.load(std::memory_order_acquire);
+			TRingBuffer* pBuffer = m_pBuffer.load(std::memory_order_relaxed);
+
+			if (bottom - top > pBuffer->Capacity() - 1)
+			{
+				TRingBuffer* pGrown = pBuffer->Grow(bottom, top, m_allocator);
+				m_garbage.Add(pBuffer);
+				m_pBuffer.store(pGrown, std::memory_order_release);
+				pBuffer = pGrown;
+			}
+
+			pBuffer->Put(bottom, element);
+			std::atomic_thread_fence(std::memory_order_release);
+			m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		// Could be called only by the owner thread, LIFO order
+		bool Pop(TElementType& outElement)
+		{
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			TRingBuffer* pBuffer = m_pBuffer.load(std::memory_order_relaxed);
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = m_top.load(std::memory_order_relaxed);
+
+			if (top > bottom)
+			{
+				// Empty
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			outElement = pBuffer->Get(bottom);
+			if (top == bottom)
+			{
+				// The last element, race against thieves
+				const bool bWon = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return bWon;
+			}
+
+			return true;
+		}
+
+		// Could be called by any thread, FIFO order
+		bool Steal(TElementType& outElement)
+		{
+			int64_t top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+			if (top >= bottom)
+			{
+				return false;
+			}
+
+			TRingBuffer* pBuffer = m_pBuffer.load(std::memory_order_acquire);
+			const TElementType element = pBuffer->Get(top);
+
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				// Lost the race against other thief or the owner
+				return false;
+			}
+
+			outElement = element;
+			return true;
+		}
+
+		// Approximate value, the deque could be modified concurrently
+		__forceinline size_t Num() const
+		{
+			const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+			const int64_t top = m_top.load(std::memory_order_relaxed);
+			return bottom > top ? (size_t)(bottom - top) : 0;
+		}
+
+		__forceinline bool IsEmpty() const { return Num() == 0; }
+
+	protected:
+
+		void ReleaseBuffer(TRingBuffer* pBuffer)
+		{
+			pBuffer->Release(m_allocator);
+			pBuffer->~TRingBuffer();
+			m_allocator.Free(pBuffer);
+		}
+
+		// Top and bottom are placed in different cache lines to avoid false sharing between owner and thieves
+		alignas(64) std::atomic<int64_t> m_top = 0;
+		alignas(64) std::atomic<int64_t> m_bottom = 0;
+		alignas(64) std::atomic<TRingBuffer*> m_pBuffer = nullptr;
+
+		// Accessed only by the owner thread
+		TVector<TRingBuffer*, TAllocator> m_garbage;
+		TAllocator m_allocator{};
+	};
+}
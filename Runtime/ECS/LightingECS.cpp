@@ -7,6 +7,8 @@
 #include "RHI/DebugContext.h"
 #include "Engine/GameObject.h"
 #include "FrameGraph/ShadowPrepassNode.h"
+#include "Tasks/ParallelFor.h"
+#include "Memory/FrameAllocator.h"
 
 using namespace Sailor;
 using namespace Sailor::Tasks;
@@ -86,10 +88,9 @@ Tasks::ITaskPtr LightingECS::Tick(float deltaTime)
 
 	driverCommands->BeginDebugRegion(cmdList, "LightingECS:Update Lights", RHI::DebugContext::Color_CmdTransfer);
 
-	TVector<LightShaderData> shaderDataBatch;
-	shaderDataBatch.Reserve(64);
-	bool bShouldWrite = true;
-	size_t startIndex = 0;
+	// Skip list is maintained on the current thread, the changed lights are collected to be processed in parallel
+	TVector<size_t, Memory::FrameAllocator> changedLights;
+	changedLights.Reserve(64);
 
 	uint32_t skipIndex = 0;
 	for (size_t index = 0; index < m_components.Num(); index++)
@@ -148,46 +149,53 @@ Tasks::ITaskPtr LightingECS::Tick(float deltaTime)
 		if (!data.m_bIsActive)
 			continue;
 
-		const auto& ownerTransform = owner->GetTransformComponent();
-
 		if (data.m_bIsDirty || data.m_frameLastChange < owner->GetFrameLastChange())
 		{
-			if (bShouldWrite)
-			{
-				bShouldWrite = false;
-				startIndex = index;
-			}
-
-			const auto& lightData = m_components[index];
-
-			LightShaderData shaderData;
-			shaderData.m_type = (uint32_t)lightData.m_type;
-			shaderData.m_shadowType = (uint32_t)lightData.m_shadowType;
-			shaderData.m_attenuation = lightData.m_attenuation;
-			shaderData.m_bounds = lightData.m_bounds;
-			shaderData.m_intensity = lightData.m_intensity;
-			shaderData.m_direction = ownerTransform.GetForwardVector();
-			shaderData.m_worldPosition = ownerTransform.GetWorldPosition();
-			shaderData.m_cutOff = vec2(glm::cos(glm::radians(lightData.m_cutOff.x)), glm::cos(glm::radians(lightData.m_cutOff.y)));
-			shaderDataBatch.Emplace(std::move(shaderData));
-
-			data.m_frameLastChange = owner->GetFrameLastChange();
-			data.m_bIsDirty = false;
-		}
-		else
-		{
-			bShouldWrite = true;
+			changedLights.Add(index);
 		}
+	}
+
+	TVector<LightShaderData, Memory::FrameAllocator> shaderData(changedLights.Num());
 
-		if ((bShouldWrite || index == m_components.Num() - 1) && shaderDataBatch.Num() > 0)
+	Tasks::ParallelFor("LightingECS:Update Lights", 0, changedLights.Num(), 64,
+		[&](size_t i)
 		{
+			auto& lightData = m_components[changedLights[i]];
+
+			// Raw pointer to avoid touching the ref counter from the worker threads
+			GameObject* owner = static_cast<GameObject*>(lightData.m_owner.GetRawPtr());
+			const auto& ownerTransform = owner->GetTransformComponent();
+
+			LightShaderData& res = shaderData[i];
+			res.m_type = (uint32_t)lightData.m_type;
+			res.m_shadowType = (uint32_t)lightData.m_shadowType;
+			res.m_attenuation = lightData.m_attenuation;
+			res.m_bounds = lightData.m_bounds;
+			res.m_intensity = lightData.m_intensity;
+			res.m_direction = ownerTransform.GetForwardVector();
+			res.m_worldPosition = ownerTransform.GetWorldPosition();
+			res.m_cutOff = vec2(glm::cos(glm::radians(lightData.m_cutOff.x)), glm::cos(glm::radians(lightData.m_cutOff.y)));
+
+			lightData.m_frameLastChange = owner->GetFrameLastChange();
+			lightData.m_bIsDirty = false;
+		});
+
+	// Upload the contiguous ranges of the changed lights
+	size_t batchStart = 0;
+	for (size_t i = 0; i < changedLights.Num(); i++)
+	{
+		const bool bLast = i == changedLights.Num() - 1;
+		if (bLast || changedLights[i + 1] != changedLights[i] + 1)
+		{
+			const size_t numLights = i - batchStart + 1;
+
 			RHI::Renderer::GetDriverCommands()->UpdateShaderBinding(cmdList, binding,
-				shaderDataBatch.GetData(),
-				sizeof(LightingECS::LightShaderData) * shaderDataBatch.Num(),
+				&shaderData[batchStart],
+				sizeof(LightingECS::LightShaderData) * numLights,
 				binding->GetBufferOffset() +
-				sizeof(LightingECS::LightShaderData) * startIndex);
+				sizeof(LightingECS::LightShaderData) * changedLights[batchStart]);
 
-			shaderDataBatch.Clear();
+			batchStart = i + 1;
 		}
 	}
 
@@ -263,7 +271,9 @@ TVector<RHI::RHIUpdateShadowMapCommand> LightingECS::PrepareCSMPasses(
 	const RHI::RHISceneViewPtr& sceneView,
 	const Math::Transform& cameraTransform,
 	const CameraData& cameraData,
-	const TVector<RHI::RHILightProxy>& directionalLights)
+	const TVector<RHI::RHILightProxy>& directionalLights,
+	const Math::Frustum& cameraFrustum,
+	TVector<uint32_t>& outCameraVisibleInstances)
 {
 	SAILOR_PROFILE_FUNCTION();
 
@@ -271,6 +281,12 @@ TVector<RHI::RHIUpdateShadowMapCommand> LightingECS::PrepareCSMPasses(
 	TVector<RHI::RHIUpdateShadowMapCommand> updateShadowMaps{};
 	updateShadowMaps.Reserve(directionalLights.Num() * NumCascades);
 
+	// The camera goes last after the cascades of all the lights, the scene is culled in one pass
+	TVector<glm::mat4> lightMatrices;
+	TVector<Math::Frustum> frustums;
+	lightMatrices.Reserve(directionalLights.Num() * NumCascades);
+	frustums.Reserve(directionalLights.Num() * NumCascades + 1);
+
 	for (const auto& directionalLight : directionalLights)
 	{
 		auto lightCascadesMatrices = ShadowPrepassNode::CalculateLightProjectionForCascades(directionalLight.m_lightMatrix,
@@ -280,20 +296,38 @@ TVector<RHI::RHIUpdateShadowMapCommand> LightingECS::PrepareCSMPasses(
 			cameraData.GetZNear(),
 			cameraData.GetZFar());
 
-		TVector<Math::Frustum> frustums(lightCascadesMatrices.Num());
+		check(lightCascadesMatrices.Num() == NumCascades);
+
+		for (uint32_t k = 0; k < NumCascades; k++)
+		{
+			lightMatrices.Add(lightCascadesMatrices[k] * directionalLight.m_lightMatrix);
+			frustums.Add(Math::Frustum(lightMatrices[lightMatrices.Num() - 1]));
+		}
+	}
+
+	frustums.Add(cameraFrustum);
+
+	TVector<TVector<uint32_t>> visibleInstances;
+	sceneView->m_cullingScene.Cull(frustums.GetData(), (uint32_t)frustums.Num(), visibleInstances);
+
+	outCameraVisibleInstances = std::move(visibleInstances[visibleInstances.Num() - 1]);
+
+	for (uint32_t l = 0; l < directionalLights.Num(); l++)
+	{
+		const auto& directionalLight = directionalLights[l];
+		const uint32_t firstCascade = l * NumCascades;
 
 		RHI::EShadowType bCascadeAdded[NumCascades];
 		const uint32_t alreadyPlacedPasses = (uint32_t)updateShadowMaps.Num();
 
-		for (uint32_t k = 0; k < lightCascadesMatrices.Num(); k++)
+		for (uint32_t k = 0; k < NumCascades; k++)
 		{
 			bCascadeAdded[k] = RHI::EShadowType::None;
 
-			auto lightMatrix = lightCascadesMatrices[k] * directionalLight.m_lightMatrix;
-			frustums[k].ExtractFrustumPlanes(lightMatrix);
+			const auto& lightMatrix = lightMatrices[firstCascade + k];
 
 			RHI::RHIUpdateShadowMapCommand cascade;
-			cascade.m_meshList = sceneView->TraceScene(frustums[k], true);
+			cascade.m_meshList = sceneView->GatherProxies(visibleInstances[firstCascade + k], true);
 			cascade.m_shadowMap = m_csmShadowMaps[k];
 			cascade.m_lightMatrix = lightMatrix;
 			cascade.m_lighMatrixIndex = k;
@@ -318,9 +352,9 @@ TVector<RHI::RHIUpdateShadowMapCommand> LightingECS::PrepareCSMPasses(
 					}
 
 					// Don't duplicate data for higher cascades
-					const uint32_t removed = (uint32_t)cascade.m_meshList.RemoveAll([z, &frustums, bCascadeAdded](const auto& m)
+					const uint32_t removed = (uint32_t)cascade.m_meshList.RemoveAll([z, &frustums, firstCascade](const auto& m)
 						{
-							return frustums[z].OverlapsAABB(m.m_worldAabb);
+							return frustums[firstCascade + z].OverlapsAABB(m.m_worldAabb);
 						});
 
 					// We store cascade dependencies
@@ -396,8 +430,10 @@ void LightingECS::FillLightingData(RHI::RHISceneViewPtr& sceneView)
 			m_csmSnapshots.Reserve(numCsmSnapshots);
 		}
 
-		auto updateShadowMaps = PrepareCSMPasses(sceneView, sceneView->m_cameraTransforms[i], camera, directionalLights);
+		TVector<uint32_t> visibleInstances;
+		auto updateShadowMaps = PrepareCSMPasses(sceneView, sceneView->m_cameraTransforms[i], camera, directionalLights, frustum, visibleInstances);
 		sceneView->m_shadowMapsToUpdate.Add(std::move(updateShadowMaps));
+		sceneView->m_visibleInstances.Add(std::move(visibleInstances));
 	}
 
 	// TODO: Pass only active lights
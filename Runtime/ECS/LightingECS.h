@@ -95,7 +95,9 @@ namespace Sailor
 			const RHI::RHISceneViewPtr& sceneView,
 			const Math::Transform& cameraTransform,
 			const CameraData& cameraData, 
-			const TVector<RHI::RHILightProxy>& directionalLights);
+			const TVector<RHI::RHILightProxy>& directionalLights,
+			const Math::Frustum& cameraFrustum,
+			TVector<uint32_t>& outCameraVisibleInstances);
 		
 		SAILOR_API void GetLightsInFrustum(const Math::Frustum& frustum,
 			const Math::Transform& cameraTransform,
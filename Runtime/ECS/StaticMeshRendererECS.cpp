@@ -76,7 +76,8 @@ Tasks::ITaskPtr StaticMeshRendererECS::Tick(float deltaTime)
 			
 			for (auto& t : task->m_result)
 			{
-				m_sceneViewProxiesCache->m_stationaryOctree.Update(glm::vec4(t.m_second.GetCenter(), 1), t.m_second.GetExtents(), t.m_first);
+				UpdateSceneViewProxy(t.m_first, t.m_second);
+				UpdateRaycastInstance(m_components[t.m_first.m_staticMeshEcs], t.m_first.m_worldMatrix);
 			}
 
 			break;
@@ -91,7 +92,8 @@ Tasks::ITaskPtr StaticMeshRendererECS::Tick(float deltaTime)
 		task->Wait();
 		for (auto& t : task->m_result)
 		{
-			m_sceneViewProxiesCache->m_stationaryOctree.Update(glm::vec4(t.m_second.GetCenter(), 1), t.m_second.GetExtents(), t.m_first);
+			UpdateSceneViewProxy(t.m_first, t.m_second);
+			UpdateRaycastInstance(m_components[t.m_first.m_staticMeshEcs], t.m_first.m_worldMatrix);
 		}
 	}
 
@@ -111,23 +113,13 @@ Tasks::ITaskPtr StaticMeshRendererECS::Tick(float deltaTime)
 
 					if (ownerTransform.GetFrameLastChange() > data.m_frameLastChange && adjustedBounds.IsValid())
 					{
-						RHI::RHISceneViewProxy proxy;
+						RHI::RHIMeshProxy proxy;
 						proxy.m_staticMeshEcs = GetComponentIndex(&data);
 						proxy.m_worldMatrix = ownerTransform.GetCachedWorldMatrix();
-						proxy.m_meshes = data.GetModel()->GetMeshes();
-						proxy.m_worldAabb = data.GetModel()->GetBoundsAABB();
-						proxy.m_worldAabb.Apply(proxy.m_worldMatrix);
-						proxy.m_bCastShadows = data.ShouldCastShadow();
-
-						proxy.m_overrideMaterials.Clear();
-						for (size_t i = 0; i < proxy.m_meshes.Num(); i++)
-						{
-							size_t materialIndex = (std::min)(i, data.GetMaterials().Num() - 1);
-							proxy.m_overrideMaterials.Add(data.GetMaterials()[materialIndex]->GetOrAddRHI(proxy.m_meshes[i]->m_vertexDescription));
-						}
 
 						adjustedBounds.Apply(proxy.m_worldMatrix);
-						m_sceneViewProxiesCache->m_staticOctree.Update(glm::vec4(adjustedBounds.GetCenter(), 1), adjustedBounds.GetExtents(), proxy);
+						UpdateSceneViewProxy(proxy, adjustedBounds);
+						UpdateRaycastInstance(data, proxy.m_worldMatrix);
 
 						data.m_frameLastChange = ownerTransform.GetFrameLastChange();
 
@@ -142,17 +134,91 @@ Tasks::ITaskPtr StaticMeshRendererECS::Tick(float deltaTime)
 
 		updateStaticTask->Wait();
 
+		// The moved objects are refitted, the new ones rebuild the top level
+		m_raycastScene.Update();
+
 		return nullptr;
 }
 
+void StaticMeshRendererECS::UpdateRaycastInstance(StaticMeshRendererData& data, const glm::mat4& worldMatrix)
+{
+	const auto& blas = data.GetModel()->GetBLAS();
+
+	if (data.m_raycastInstance == Raytracing::TLAS::InvalidInstance)
+	{
+		if (!blas)
+		{
+			return;
+		}
+
+		data.m_raycastInstance = m_raycastScene.AddInstance(blas, worldMatrix, (uint32_t)GetComponentIndex(&data));
+	}
+	else
+	{
+		m_raycastScene.UpdateInstance(data.m_raycastInstance, blas, worldMatrix);
+	}
+}
+
+void StaticMeshRendererECS::UnregisterComponent(size_t index)
+{
+	if (index != ECS::InvalidIndex)
+	{
+		// The reused component starts without the instance
+		auto& data = m_components[index];
+		if (data.m_raycastInstance != Raytracing::TLAS::InvalidInstance)
+		{
+			m_raycastScene.RemoveInstance(data.m_raycastInstance);
+			data.m_raycastInstance = Raytracing::TLAS::InvalidInstance;
+		}
+
+		RemoveSceneViewProxy(index);
+	}
+
+	TSystem::UnregisterComponent(index);
+}
+
+void StaticMeshRendererECS::UpdateSceneViewProxy(const RHI::RHIMeshProxy& proxy, const Math::AABB& worldBounds)
+{
+	const uint32_t instance = (uint32_t)proxy.m_staticMeshEcs;
+
+	if (instance >= m_sceneViewProxiesCache->m_meshProxies.Num())
+	{
+		m_sceneViewProxiesCache->m_meshProxies.AddDefault(instance + 1 - m_sceneViewProxiesCache->m_meshProxies.Num());
+	}
+
+	m_sceneViewProxiesCache->m_meshProxies[instance] = proxy;
+	m_sceneViewProxiesCache->m_cullingScene.Update(instance, worldBounds);
+}
+
+void StaticMeshRendererECS::RemoveSceneViewProxy(size_t index)
+{
+	if (!m_sceneViewProxiesCache || index >= m_sceneViewProxiesCache->m_meshProxies.Num())
+	{
+		return;
+	}
+
+	auto& cullingScene = m_sceneViewProxiesCache->m_cullingScene;
+	auto& meshProxies = m_sceneViewProxiesCache->m_meshProxies;
+
+	cullingScene.Remove((uint32_t)index);
+	meshProxies[index].m_staticMeshEcs = ECS::InvalidIndex;
+
+	// The proxies follow the slots of the culling scene
+	if (meshProxies.Num() > cullingScene.GetNumInstances())
+	{
+		meshProxies.RemoveAt(cullingScene.GetNumInstances(), meshProxies.Num() - cullingScene.GetNumInstances());
+	}
+}
+
 void StaticMeshRendererECS::CopySceneView(RHI::RHISceneViewPtr& outProxies)
 {
-	outProxies->m_stationaryOctree = m_sceneViewProxiesCache->m_stationaryOctree;
-	outProxies->m_staticOctree = m_sceneViewProxiesCache->m_staticOctree;
+	outProxies->m_cullingScene = m_sceneViewProxiesCache->m_cullingScene;
+	outProxies->m_meshProxies = m_sceneViewProxiesCache->m_meshProxies;
 }
 
 void StaticMeshRendererECS::EndPlay()
 {
 	ECS::TSystem<StaticMeshRendererECS, StaticMeshRendererData>::EndPlay();
 	m_sceneViewProxiesCache.Clear();
+	m_raycastScene = Raytracing::TLAS();
 }
@@ -8,6 +8,7 @@
 #include "Memory/Memory.h"
 #include "RHI/SceneView.h"
 #include "Memory/UniquePtr.hpp"
+#include "Raytracing/TLAS.h"
 
 namespace Sailor
 {
@@ -22,10 +23,14 @@ namespace Sailor
 		SAILOR_API __forceinline ModelPtr& GetModel() { return m_model; }
 		SAILOR_API __forceinline bool ShouldCastShadow() const { return true; }
 
+		// The freed component is skipped by Tick until the model is set again
+		SAILOR_API virtual void Clear() override { m_model.Clear(); m_materials.Clear(); m_frameLastChange = 0; }
+
 	protected:
 
 		ModelPtr m_model;
 		TVector<MaterialPtr> m_materials;
+		uint32_t m_raycastInstance = Raytracing::TLAS::InvalidInstance;
 
 		friend class StaticMeshRendererECS;
 	};
@@ -37,14 +42,28 @@ namespace Sailor
 		virtual void BeginPlay() override;
 		virtual void EndPlay() override;
 
+		virtual void UnregisterComponent(size_t index) override;
+
 		virtual Tasks::ITaskPtr Tick(float deltaTime) override;
 		void CopySceneView(RHI::RHISceneViewPtr& outProxies);
 
+		// The raycasts return the index of the component as the instance,
+		// the queries should not overlap with Tick.
+		// Only the Static and Stationary objects are traced, the Dynamic ones are not processed by the system.
+		const Raytracing::TLAS& GetRaycastScene() const { return m_raycastScene; }
+
 		virtual uint32_t GetOrder() const override { return 1000; }
 
 	protected:
 
+		void UpdateRaycastInstance(StaticMeshRendererData& data, const glm::mat4& worldMatrix);
+
+		// The culling instance is the index of the component
+		void UpdateSceneViewProxy(const RHI::RHIMeshProxy& proxy, const Math::AABB& worldBounds);
+		void RemoveSceneViewProxy(size_t index);
+
 		RHI::RHISceneViewPtr m_sceneViewProxiesCache;
+		Raytracing::TLAS m_raycastScene;
 	};
 
 	template ECS::TSystem<StaticMeshRendererECS, StaticMeshRendererData>;
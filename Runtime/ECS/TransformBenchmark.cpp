@@ -0,0 +1,158 @@
+#include <random>
+#include <algorithm>
+#include "ECS/TransformECS.h"
+#include "Core/Utils.h"
+#include "Core/LogMacros.h"
+#include "Containers/Vector.h"
+#include <glm/glm/gtx/quaternion.hpp>
+
+using namespace Sailor;
+using Timer = Utils::Timer;
+
+/* Compares the previous update (the scalar glm math, the recursion from the dirty roots on one thread)
+*  with TransformECS::UpdateMatrices on the same hierarchy. The components are shuffled between the levels,
+*  so the depth order doesn't match the order of the components.
+*/
+void Sailor::RunTransformBenchmark()
+{
+	printf("\nStarting Transform benchmark...\n");
+
+	const uint32_t NumTransforms = 200000;
+	const uint32_t NumFrames = 16;
+	const uint32_t Depths[] = { 1, 4, 16 };
+	const float DirtyRatios[] = { 0.001f, 0.01f, 0.1f, 1.0f };
+
+	std::mt19937 gen(NumTransforms);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	const auto randomTransform = [&]()
+		{
+			const glm::quat rotation = glm::normalize(glm::quat(dist(gen), dist(gen), dist(gen), dist(gen)));
+			return Math::Transform(glm::vec4(dist(gen), dist(gen), dist(gen), 1.0f) * 10.0f, rotation, glm::vec4(1.0f + 0.1f * dist(gen)));
+		};
+
+	// The previous TransformECS pass, with the world matrix of the parent
+	const auto updateRecursive = [](auto& self, TVector<TransformComponent>& components, TransformComponent& data, bool bParentChanged) -> void
+		{
+			const bool bChanged = data.m_bIsDirty || bParentChanged;
+			if (bChanged)
+			{
+				if (data.m_bIsDirty)
+				{
+					const Math::Transform& t = data.m_transform;
+					data.m_cachedRelativeMatrix = glm::translate(glm::mat4(1), vec3(t.m_position)) * glm::toMat4(t.m_rotation) * glm::scale(glm::mat4(1), vec3(t.m_scale));
+				}
+
+				data.m_cachedWorldMatrix = data.m_parent != ECS::InvalidIndex ?
+					components[data.m_parent].m_cachedWorldMatrix * data.m_cachedRelativeMatrix :
+					data.m_cachedRelativeMatrix;
+
+				data.m_bIsDirty = false;
+			}
+
+			for (size_t child : data.m_children)
+			{
+				self(self, components, components[child], bChanged);
+			}
+		};
+
+	for (uint32_t depth : Depths)
+	{
+		TransformECS ecs;
+
+		TVector<size_t> indices(NumTransforms);
+		for (size_t i = 0; i < NumTransforms; i++)
+		{
+			indices[i] = ecs.RegisterComponent();
+			ecs.m_components[indices[i]].m_transform = randomTransform();
+		}
+
+		// The equal levels, the parent is the random component of the previous level
+		std::shuffle(indices.GetData(), indices.GetData() + indices.Num(), gen);
+
+		const size_t levelSize = NumTransforms / depth;
+		for (size_t i = levelSize; i < depth * levelSize; i++)
+		{
+			const size_t parentLevel = i / levelSize - 1;
+			ecs.SetParent(indices[i], indices[parentLevel * levelSize + gen() % levelSize]);
+		}
+
+		for (auto& data : ecs.m_components)
+		{
+			if (!data.m_bIsDirty)
+			{
+				data.m_bIsDirty = true;
+				ecs.MarkDirty(&data);
+			}
+		}
+
+		ecs.UpdateMatrices(0);
+		ecs.PostTick();
+
+		TVector<TransformComponent> reference = ecs.m_components;
+
+		for (float dirtyRatio : DirtyRatios)
+		{
+			const size_t numDirty = std::max((size_t)1, (size_t)(NumTransforms * dirtyRatio));
+
+			Timer tReference;
+			Timer tParallel;
+
+			for (uint32_t frame = 1; frame <= NumFrames; frame++)
+			{
+				std::shuffle(indices.GetData(), indices.GetData() + indices.Num(), gen);
+
+				TVector<size_t> dirty;
+				for (size_t i = 0; i < numDirty; i++)
+				{
+					const size_t index = indices[i];
+					const Math::Transform transform = randomTransform();
+
+					ecs.m_components[index].m_transform = transform;
+					ecs.m_components[index].m_bIsDirty = true;
+					ecs.MarkDirty(&ecs.m_components[index]);
+
+					reference[index].m_transform = transform;
+					reference[index].m_bIsDirty = true;
+					dirty.Add(index);
+				}
+
+				tReference.Start();
+				dirty.Sort();
+				for (size_t index : dirty)
+				{
+					bool bIsRoot = true;
+					for (size_t ancestor = reference[index].m_parent; bIsRoot && ancestor != ECS::InvalidIndex; ancestor = reference[ancestor].m_parent)
+					{
+						bIsRoot = !reference[ancestor].m_bIsDirty;
+					}
+
+					if (bIsRoot && reference[index].m_bIsDirty)
+					{
+						updateRecursive(updateRecursive, reference, reference[index], false);
+					}
+				}
+				tReference.Stop();
+
+				tParallel.Start();
+				ecs.UpdateMatrices(frame);
+				tParallel.Stop();
+
+				ecs.PostTick();
+			}
+
+			float maxError = 0.0f;
+			for (size_t i = 0; i < NumTransforms; i++)
+			{
+				for (uint32_t column = 0; column < 4; column++)
+				{
+					const glm::vec4 error = glm::abs(reference[i].m_cachedWorldMatrix[column] - ecs.m_components[i].m_cachedWorldMatrix[column]);
+					maxError = std::max(maxError, std::max(std::max(error.x, error.y), std::max(error.z, error.w)));
+				}
+			}
+
+			SAILOR_LOG("Transforms %u, depth %u, dirty %.1f%%, %u frames:\n\t reference %llums, parallel %llums, max error %f",
+				NumTransforms, depth, dirtyRatio * 100.0f, NumFrames, tReference.ResultAccumulatedMs(), tParallel.ResultAccumulatedMs(), maxError);
+		}
+	}
+}
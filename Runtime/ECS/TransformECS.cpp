@@ -1,5 +1,6 @@
 #include "ECS/TransformECS.h"
 #include "Engine/GameObject.h"
+#include "Tasks/ParallelFor.h"
 
 using namespace Sailor;
 using namespace Sailor::Tasks;
@@ -57,6 +58,84 @@ void TransformECS::MarkDirty(TransformComponent* ptr)
 	m_dirtyComponents.Add(TransformECS::GetComponentIndex(ptr));
 }
 
+size_t TransformECS::RegisterComponent()
+{
+	m_bHierarchyChanged = true;
+	return TSystem::RegisterComponent();
+}
+
+void TransformECS::UnregisterComponent(size_t index)
+{
+	if (index != ECS::InvalidIndex)
+	{
+		SetParent(index, ECS::InvalidIndex);
+
+		// The children become the roots
+		auto& data = m_components[index];
+		for (size_t child : data.m_children)
+		{
+			auto& childData = m_components[child];
+			childData.m_parent = ECS::InvalidIndex;
+
+			if (!childData.m_bIsDirty)
+			{
+				childData.m_bIsDirty = true;
+				MarkDirty(&childData);
+			}
+		}
+
+		data.m_children.Clear();
+		m_bHierarchyChanged = true;
+	}
+
+	TSystem::UnregisterComponent(index);
+}
+
+void TransformECS::EndPlay()
+{
+	TSystem::EndPlay();
+
+	m_dirtyComponents.Clear();
+	m_depthOrder.Clear();
+	m_depthLevels.Clear();
+	m_changed.Clear();
+	m_bHierarchyChanged = true;
+}
+
+void TransformECS::SetParent(size_t child, size_t parent)
+{
+	auto& data = m_components[child];
+
+	if (data.m_parent == parent)
+	{
+		return;
+	}
+
+	for (size_t ancestor = parent; ancestor != ECS::InvalidIndex; ancestor = m_components[ancestor].m_parent)
+	{
+		check(ancestor != child);
+	}
+
+	if (data.m_parent != ECS::InvalidIndex)
+	{
+		m_components[data.m_parent].m_children.RemoveFirst(child);
+	}
+
+	if (parent != ECS::InvalidIndex)
+	{
+		m_components[parent].m_children.Add(child);
+	}
+
+	data.m_parent = parent;
+	m_bHierarchyChanged = true;
+
+	if (!data.m_bIsDirty)
+	{
+		data.m_bIsDirty = true;
+		MarkDirty(&data);
+	}
+}
+
 Tasks::ITaskPtr TransformECS::PostTick()
 {
 	m_dirtyComponents.Clear(false);
@@ -67,96 +146,163 @@ Tasks::ITaskPtr TransformECS::Tick(float deltaTime)
 {
 	SAILOR_PROFILE_FUNCTION();
 
-	// We guess that the amount of changed transform during frame
-	// Could be much less than the whole transforms num
+	UpdateMatrices(GetWorld()->GetCurrentFrame());
 
-	const float NLogN_Algo = 2.0f * (float)m_dirtyComponents.Num() * std::max(1.0f, std::logf((float)m_dirtyComponents.Num()));
-	const float N_Algo = 2.0f * (float)m_components.Num();
+	return nullptr;
+}
 
-	if (NLogN_Algo < N_Algo)
-	{
-		// We should sort the dirty components to make the pass
-		// more cache-friendly
-		m_dirtyComponents.Sort();
+void TransformECS::UpdateDepthOrder()
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	m_depthOrder.Clear(false);
+	m_depthLevels.Clear(false);
+	m_depthOrder.Reserve(m_components.Num());
 
-		// Update only changed transforms
-		for (auto& i : m_dirtyComponents)
+	for (size_t i = 0; i < m_components.Num(); i++)
+	{
+		if (m_components[i].m_parent == ECS::InvalidIndex)
 		{
-			auto& data = m_components[i];
+			m_depthOrder.Add(i);
+		}
+	}
 
-			if (data.m_bIsActive)
+	// Breadth-first, each level is the children of the previous one
+	size_t first = 0;
+	while (first < m_depthOrder.Num())
+	{
+		const size_t last = m_depthOrder.Num();
+		m_depthLevels.Add(first);
+
+		for (size_t i = first; i < last; i++)
+		{
+			for (size_t child : m_components[m_depthOrder[i]].m_children)
 			{
-				data.m_cachedRelativeMatrix = data.m_transform.Matrix();
+				m_depthOrder.Add(child);
 			}
 		}
 
-		// Recalculate only root transforms
-		for (int32_t i = 0; i < m_dirtyComponents.Num(); i++)
-		{
-			auto& data = m_components[m_dirtyComponents[i]];
+		first = last;
+	}
 
-			if (data.m_parent == ECS::InvalidIndex && data.m_bIsActive)
-			{
-				CalculateMatrices(data);
+	m_depthLevels.Add(m_depthOrder.Num());
+	m_bHierarchyChanged = false;
+}
 
-				m_dirtyComponents.RemoveAtSwap(i);
-				i--;
-			}
-		}
+bool TransformECS::UpdateWorldMatrix(TransformComponent& data, bool bParentChanged, size_t currentFrame)
+{
+	if (!data.m_bIsActive || !(data.m_bIsDirty || bParentChanged))
+	{
+		return false;
+	}
 
-		// Recalculate not calculated transforms
-		for (int32_t i = 0; i < m_dirtyComponents.Num(); i++)
-		{
-			auto& data = m_components[m_dirtyComponents[i]];
+	if (data.m_bIsDirty)
+	{
+		Math::CalculateMatrix(data.m_transform, data.m_cachedRelativeMatrix);
+	}
 
-			if (data.m_bIsDirty)
-			{
-				CalculateMatrices(data);
-			}
-		}
+	if (data.m_parent != ECS::InvalidIndex)
+	{
+		Math::MultiplyMatrices(m_components[data.m_parent].m_cachedWorldMatrix, data.m_cachedRelativeMatrix, data.m_cachedWorldMatrix);
 	}
 	else
 	{
-		for (auto& data : m_components)
-		{
-			if (data.m_bIsDirty && data.m_bIsActive)
-			{
-				data.m_cachedRelativeMatrix = data.m_transform.Matrix();
-			}
-		}
+		data.m_cachedWorldMatrix = data.m_cachedRelativeMatrix;
+	}
 
-		for (auto& data : m_components)
-		{
-			if (data.m_bIsDirty && data.m_bIsActive)
-			{
-				CalculateMatrices(data);
-			}
-		}
+	// The children are moved with the parent, so they are changed in this frame too
+	data.m_frameLastChange = currentFrame;
+	data.m_bIsDirty = false;
+
+	// Each game object has one transform, so the game objects are not shared between the threads.
+	// The components without the owner are created by the benchmark.
+	if (data.GetOwner())
+	{
+		UpdateGameObject(data.GetOwner().StaticCast<GameObject>(), currentFrame);
 	}
 
-	return nullptr;
+	return true;
 }
 
-void TransformECS::CalculateMatrices(TransformComponent& parent)
+void TransformECS::UpdateSubtree(TransformComponent& root, bool bParentChanged, size_t currentFrame)
 {
-	const glm::mat4x4& parentMatrix = parent.GetCachedRelativeMatrix();
+	const bool bChanged = UpdateWorldMatrix(root, bParentChanged, currentFrame);
 
-	if (parent.m_parent == ECS::InvalidIndex)
+	for (size_t child : root.m_children)
 	{
-		parent.m_cachedWorldMatrix = parent.m_cachedRelativeMatrix;
+		UpdateSubtree(m_components[child], bChanged, currentFrame);
 	}
+}
 
-	for (auto& child : parent.GetChildren())
+void TransformECS::UpdateMatrices(size_t currentFrame)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	if (m_dirtyComponents.Num() == 0)
 	{
-		m_components[child].m_cachedWorldMatrix = parentMatrix * m_components[child].m_cachedRelativeMatrix;
+		return;
+	}
 
-		CalculateMatrices(m_components[child]);
+	if (m_bHierarchyChanged)
+	{
+		UpdateDepthOrder();
 	}
 
-	if (parent.m_bIsDirty)
+	// We guess that the amount of changed transform during frame
+	// Could be much less than the whole transforms num
+
+	const float NLogN_Algo = 2.0f * (float)m_dirtyComponents.Num() * std::max(1.0f, std::logf((float)m_dirtyComponents.Num()));
+	const float N_Algo = 2.0f * (float)m_components.Num();
+
+	if (NLogN_Algo < N_Algo)
 	{
-		UpdateGameObject(parent.GetOwner().StaticCast<GameObject>(), GetWorld()->GetCurrentFrame());
+		// Update only the subtrees of the dirty components that have no dirty ancestors,
+		// so the subtrees don't intersect and are updated in parallel
+		TVector<size_t> roots;
+		roots.Reserve(m_dirtyComponents.Num());
+
+		for (size_t i : m_dirtyComponents)
+		{
+			bool bIsRoot = m_components[i].m_bIsDirty;
+			for (size_t ancestor = m_components[i].m_parent; bIsRoot && ancestor != ECS::InvalidIndex; ancestor = m_components[ancestor].m_parent)
+			{
+				bIsRoot = !m_components[ancestor].m_bIsDirty;
+			}
+
+			if (bIsRoot)
+			{
+				roots.Add(i);
+			}
+		}
+
+		// We should sort the roots to make the pass more cache-friendly
+		roots.Sort();
+
+		Tasks::ParallelFor("TransformECS:Dirty subtrees", 0, roots.Num(), 64,
+			[this, &roots, currentFrame](size_t i)
+			{
+				UpdateSubtree(m_components[roots[i]], false, currentFrame);
+			});
 	}
+	else
+	{
+		// The whole hierarchy level by level, the parents of the level are updated by the previous one
+		m_changed.Resize(m_components.Num());
 
-	parent.m_bIsDirty = false;
+		for (size_t level = 0; level + 1 < m_depthLevels.Num(); level++)
+		{
+			Tasks::ParallelFor("TransformECS:Hierarchy level", m_depthLevels[level], m_depthLevels[level + 1], 1024,
+				[this, currentFrame](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; i++)
+					{
+						const size_t index = m_depthOrder[i];
+						auto& data = m_components[index];
+
+						const bool bParentChanged = data.m_parent != ECS::InvalidIndex && m_changed[data.m_parent];
+						m_changed[index] = UpdateWorldMatrix(data, bParentChanged, currentFrame);
+					}
+				});
+		}
+	}
 }
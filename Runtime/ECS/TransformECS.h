@@ -49,8 +49,15 @@ namespace Sailor
 		TVector<size_t, Memory::TInlineAllocator<4 * sizeof(size_t)>> m_children;
 		
 		friend class TransformECS;
+		friend void RunTransformBenchmark();
 	};
 
+	SAILOR_API void RunTransformBenchmark();
+
+	/* The world matrices are updated level by level of the hierarchy, the parents before the children.
+	*  The components are not moved, instead m_depthOrder keeps the indices sorted by the depth,
+	*  so each level is processed in parallel once the previous one is done.
+	*/
 	class SAILOR_API TransformECS : public ECS::TSystem<TransformECS, TransformComponent>
 	{
 	public:
@@ -58,13 +65,36 @@ namespace Sailor
 		virtual Tasks::ITaskPtr PostTick() override;
 		virtual Tasks::ITaskPtr Tick(float deltaTime) override;
 
+		virtual size_t RegisterComponent() override;
+		virtual void UnregisterComponent(size_t index) override;
+		virtual void EndPlay() override;
+
 		void MarkDirty(TransformComponent* ptr);
-		void CalculateMatrices(TransformComponent& root);
+
+		// InvalidIndex detaches the child, the relative transform is kept
+		void SetParent(size_t child, size_t parent);
 
 		virtual uint32_t GetOrder() const override { return 0; }
 
 	protected:
 
+		void UpdateMatrices(size_t currentFrame);
+		void UpdateSubtree(TransformComponent& root, bool bParentChanged, size_t currentFrame);
+		void UpdateDepthOrder();
+
+		// Returns true if the world matrix is changed
+		bool UpdateWorldMatrix(TransformComponent& data, bool bParentChanged, size_t currentFrame);
+
 		TVector<size_t> m_dirtyComponents;
+
+		// m_depthOrder[m_depthLevels[i], m_depthLevels[i + 1]) are the components on the depth i
+		TVector<size_t> m_depthOrder;
+		TVector<size_t> m_depthLevels;
+		bool m_bHierarchyChanged = true;
+
+		// The world matrices changed during the tick, by the component index
+		TVector<uint8_t> m_changed;
+
+		friend void RunTransformBenchmark();
 	};
 }
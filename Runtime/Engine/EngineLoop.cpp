@@ -12,14 +12,21 @@
 #include "Components/TestComponent.h"
 #include "ECS/TransformECS.h"
 #include "Submodules/ImGuiApi.h"
+#include "Memory/FrameAllocator.h"
 #include "RHI/Types.h"
 #include "RHI/CommandList.h"
 
 using namespace Sailor;
 
-TSharedPtr<World> EngineLoop::CreateWorld(std::string name)
+TSharedPtr<World> EngineLoop::CreateEmptyWorld(std::string name)
 {
 	m_worlds.Emplace(TSharedPtr<World>::Make(std::move(name)));
+	return m_worlds[m_worlds.Num() - 1];
+}
+
+TSharedPtr<World> EngineLoop::CreateWorld(std::string name)
+{
+	CreateEmptyWorld(std::move(name));
 
 	auto gameObject = m_worlds[0]->Instantiate();
 	auto cameraComponent = gameObject->AddComponent<CameraComponent>();
@@ -37,12 +44,17 @@ void EngineLoop::ProcessCpuFrame(FrameState& currentInputState)
 
 	timer.Start();
 	SAILOR_PROFILE_BLOCK("CPU Frame");
+
+	// The transient allocations of the frames in flight are still valid
+	Memory::FrameAllocator::BeginFrame();
 	App::GetSubmodule<ImGuiApi>()->NewFrame();
 
+	m_worldTickTimer.Start();
 	for (auto& world : m_worlds)
 	{
 		world->Tick(currentInputState);
 	}
+	m_worldTickTimer.Stop();
 
 	auto& task = currentInputState.GetDrawImGuiTask();
 
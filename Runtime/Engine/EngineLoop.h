@@ -6,6 +6,7 @@
 #include "Memory/UniquePtr.hpp"
 #include "Memory/SharedPtr.hpp"
 #include "Frame.h"
+#include "Core/Utils.h"
 
 namespace Sailor
 {
@@ -15,15 +16,21 @@ namespace Sailor
 
 		SAILOR_API void ProcessCpuFrame(FrameState& currentInputState);
 		SAILOR_API uint32_t GetCpuFps() const { return m_cpuFps; }
+		SAILOR_API Utils::Timer& GetWorldTickTimer() { return m_worldTickTimer; }
 
 		EngineLoop() = default;
 		SAILOR_API ~EngineLoop() override;
 
 		SAILOR_API TSharedPtr<World> CreateWorld(std::string name);
+		SAILOR_API TSharedPtr<World> CreateEmptyWorld(std::string name);
 
 	protected:
 
 		uint32_t m_cpuFps = 0u;
+		Utils::Timer m_worldTickTimer{};
 		TVector<TSharedPtr<World>> m_worlds;
 	};
+
+	// Runs the frames over the synthetic scene and reports the CPU time of the frame stages
+	SAILOR_API void RunFrameBenchmark(uint32_t numFrames, uint32_t numObjects);
 }
\ No newline at end of file
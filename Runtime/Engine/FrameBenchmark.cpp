@@ -0,0 +1,120 @@
+#include <random>
+#include "Engine/EngineLoop.h"
+#include "Engine/GameObject.h"
+#include "Engine/World.h"
+#include "Components/MeshRendererComponent.h"
+#include "Components/CameraComponent.h"
+#include "Components/LightComponent.h"
+#include "RHI/Renderer.h"
+#include "Tasks/Scheduler.h"
+#include "Core/Utils.h"
+#include "Core/LogMacros.h"
+
+using namespace Sailor;
+using Timer = Utils::Timer;
+
+/* The frames are processed one by one, the main thread waits for the render thread after each frame,
+*  so the stages are measured without the overlap. With --nullrhi the main window is not created, nothing is executed
+*  on the GPU and the results are the CPU cost of World::Tick, the scene view copy and RHIFrameGraph::Process.
+*/
+void Sailor::RunFrameBenchmark(uint32_t numFrames, uint32_t numObjects)
+{
+	printf("\nStarting Frame benchmark...\n");
+
+	// Until the models are loaded and the frame graph is instantiated
+	const uint32_t NumWarmupFrames = 16;
+
+	auto engineLoop = App::GetSubmodule<EngineLoop>();
+	auto renderer = App::GetSubmodule<RHI::Renderer>();
+	auto scheduler = App::GetSubmodule<Tasks::Scheduler>();
+
+	TSharedPtr<World> world = engineLoop->CreateEmptyWorld("FrameBenchmark");
+
+	auto camera = world->Instantiate();
+	camera->GetTransformComponent().SetPosition(vec3(0.0f, 500.0f, 2000.0f));
+	camera->AddComponent<CameraComponent>();
+
+	auto light = world->Instantiate();
+	light->GetTransformComponent().SetPosition(vec3(0.0f, 3000.0f, 1000.0f));
+	light->GetTransformComponent().SetRotation(quat(vec3(-45, 12.5f, 0)));
+	light->AddComponent<LightComponent>()->SetLightType(ELightType::Directional);
+
+	std::mt19937 gen(numObjects);
+	std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+
+	for (uint32_t i = 0; i < numObjects; i++)
+	{
+		auto gameObject = world->Instantiate();
+		gameObject->GetTransformComponent().SetPosition(vec3(dist(gen), dist(gen), dist(gen)));
+		gameObject->GetTransformComponent().SetScale(vec4(10, 10, 10, 1));
+		gameObject->AddComponent<MeshRendererComponent>()->LoadModel("Models/Box/Box.gltf");
+	}
+
+	const FrameInputState inputState{};
+	const glm::ivec2 centerPoint = App::GetMainWindow()->GetCenterPointClient();
+
+	Timer cpuFrame;
+	Timer pushFrame;
+	Timer renderFrame;
+
+	FrameState lastFrame;
+	uint32_t numSkippedFrames = 0;
+
+	for (uint32_t i = 0; i < NumWarmupFrames + numFrames; i++)
+	{
+		if (i == NumWarmupFrames)
+		{
+			scheduler->WaitIdle({ Tasks::EThreadType::Worker, Tasks::EThreadType::Render, Tasks::EThreadType::RHI });
+
+			cpuFrame.Clear();
+			pushFrame.Clear();
+			renderFrame.Clear();
+			engineLoop->GetWorldTickTimer().Clear();
+			renderer->GetFrameGraphTimer().Clear();
+		}
+
+		if (App::GetMainWindow()->IsCreated())
+		{
+			Win32::Window::ProcessWin32Msgs();
+		}
+
+		scheduler->ProcessTasksOnMainThread();
+
+		FrameState currentFrame(world.GetRawPtr(), Utils::GetCurrentTimeMs(), inputState, centerPoint, i == 0 ? nullptr : &lastFrame);
+
+		cpuFrame.Start();
+		engineLoop->ProcessCpuFrame(currentFrame);
+		cpuFrame.Stop();
+
+		pushFrame.Start();
+		const bool bIsPushed = renderer->PushFrame(currentFrame);
+		pushFrame.Stop();
+
+		renderFrame.Start();
+		scheduler->WaitIdle({ Tasks::EThreadType::Render, Tasks::EThreadType::RHI });
+		renderFrame.Stop();
+
+		if (bIsPushed)
+		{
+			lastFrame = currentFrame;
+		}
+		else if (i >= NumWarmupFrames)
+		{
+			numSkippedFrames++;
+		}
+
+		uint32_t index = 0;
+		while (auto submodule = App::GetSubmodule(index))
+		{
+			submodule->CollectGarbage();
+			index++;
+		}
+	}
+
+	const auto perFrame = [=](const Timer& timer) { return (float)timer.ResultAccumulatedMs() / numFrames; };
+
+	printf("Frames: %u, skipped: %u, objects: %u, submitted command lists: %u\n", numFrames, numSkippedFrames, numObjects, renderer->GetDriver()->GetNumSubmittedCommandBuffers());
+	printf("World::Tick: %.3fms, CPU frame: %.3fms\n", perFrame(engineLoop->GetWorldTickTimer()), perFrame(cpuFrame));
+	printf("PushFrame: %.3fms\n", perFrame(pushFrame));
+	printf("RHIFrameGraph::Process: %.3fms, Render thread: %.3fms\n", perFrame(renderer->GetFrameGraphTimer()), perFrame(renderFrame));
+}
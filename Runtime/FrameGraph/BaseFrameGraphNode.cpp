@@ -2,6 +2,8 @@
 #include "RHI/Surface.h"
 #include "RHI/RenderTarget.h"
 #include "RHI/Texture.h"
+#include "FrameGraph/RHIFrameGraph.h"
+#include "AssetRegistry/FrameGraph/TransientResourcePlanner.h"
 
 using namespace Sailor;
 using namespace Sailor::RHI;
@@ -81,4 +83,138 @@ bool BaseFrameGraphNode::TryGetString(const std::string& name, string& string) c
 	}
 
 	return false;
-}
\ No newline at end of file
+}
+
+void BaseFrameGraphNode::Compile()
+{
+	m_compiledStringParams.Clear();
+	m_compiledVectorParams.Clear();
+	m_compiledFloatParams.Clear();
+	m_compiledResourceParams.Clear();
+	m_compiledUnresolvedResourceParams.Clear();
+	m_bIsResourceWritten.Clear();
+	m_bIsUnresolvedResourceWritten.Clear();
+
+	for (const auto& param : m_stringParams)
+	{
+		m_compiledStringParams.Set(FrameGraphParam::Register(param.m_first), *param.m_second);
+	}
+
+	for (const auto& param : m_vectorParams)
+	{
+		m_compiledVectorParams.Set(FrameGraphParam::Register(param.m_first), *param.m_second);
+	}
+
+	for (const auto& param : m_floatParams)
+	{
+		m_compiledFloatParams.Set(FrameGraphParam::Register(param.m_first), *param.m_second);
+	}
+
+	for (const auto& param : m_resourceParams)
+	{
+		m_compiledResourceParams.Set(FrameGraphParam::Register(param.m_first), *param.m_second);
+		m_bIsResourceWritten.Add(TransientResourcePlan::GetAccess(param.m_first) == TransientResourcePlan::EAccess::Write);
+	}
+
+	for (const auto& param : m_unresolvedResourceParams)
+	{
+		m_compiledUnresolvedResourceParams.Set(FrameGraphParam::Register(param.m_first), FrameGraphParam::Register(*param.m_second));
+		m_bIsUnresolvedResourceWritten.Add(TransientResourcePlan::GetAccess(param.m_first) == TransientResourcePlan::EAccess::Write);
+	}
+}
+
+RHIResourcePtr BaseFrameGraphNode::GetRHIResource(const ResourceParam& param) const
+{
+	const RHIResourcePtr* resource = m_compiledResourceParams.Find(param.GetIndex());
+	return resource ? *resource : RHIResourcePtr();
+}
+
+RHITexturePtr BaseFrameGraphNode::GetResolvedAttachment(const ResourceParam& param) const
+{
+	RHIResourcePtr resource = GetRHIResource(param);
+	if (!resource)
+	{
+		return RHITexturePtr();
+	}
+
+	if (RHISurfacePtr surface = resource.DynamicCast<RHISurface>())
+	{
+		return surface->GetResolved();
+	}
+
+	return resource.DynamicCast<RHITexture>();
+}
+
+const glm::vec4& BaseFrameGraphNode::GetVec4(const Vec4Param& param) const
+{
+	static const glm::vec4 zero{ 0.0f };
+
+	const glm::vec4* value = m_compiledVectorParams.Find(param.GetIndex());
+	return value ? *value : zero;
+}
+
+float BaseFrameGraphNode::GetFloat(const FloatParam& param) const
+{
+	const float* value = m_compiledFloatParams.Find(param.GetIndex());
+	return value ? *value : 0.0f;
+}
+
+const std::string& BaseFrameGraphNode::GetString(const StringParam& param) const
+{
+	static const std::string empty = "";
+
+	const std::string* value = m_compiledStringParams.Find(param.GetIndex());
+	return value ? *value : empty;
+}
+
+bool BaseFrameGraphNode::TryGetString(const StringParam& param, string& string) const
+{
+	if (const std::string* value = m_compiledStringParams.Find(param.GetIndex()))
+	{
+		string = *value;
+		return true;
+	}
+
+	return false;
+}
+
+RHIRenderTargetPtr BaseFrameGraphNode::GetUnresolvedRenderTarget(RHI::RHIFrameGraphPtr frameGraph, const ResourceParam& param) const
+{
+	if (const uint32_t* renderTarget = m_compiledUnresolvedResourceParams.Find(param.GetIndex()))
+	{
+		return frameGraph->GetRenderTarget(RenderTargetParam::FromIndex(*renderTarget));
+	}
+
+	return RHIRenderTargetPtr();
+}
+
+RHITexturePtr BaseFrameGraphNode::GetResolvedAttachment(RHI::RHIFrameGraphPtr frameGraph, const ResourceParam& param) const
+{
+	if (RHITexturePtr attachment = GetResolvedAttachment(param))
+	{
+		return attachment;
+	}
+
+	return GetUnresolvedRenderTarget(frameGraph, param);
+}
+
+void BaseFrameGraphNode::GetResourceAccesses(RHI::RHIFrameGraphPtr frameGraph, TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const
+{
+	outAccesses.Clear(false);
+
+	for (size_t i = 0; i < m_compiledResourceParams.Num(); i++)
+	{
+		outAccesses.Add({ (FrameGraphRecordingSchedule::ResourceId)m_compiledResourceParams.GetValue(i).GetRawPtr(), m_bIsResourceWritten[i] });
+	}
+
+	for (size_t i = 0; i < m_compiledUnresolvedResourceParams.Num(); i++)
+	{
+		const auto renderTargetParam = RenderTargetParam::FromIndex(m_compiledUnresolvedResourceParams.GetValue(i));
+		if (auto renderTarget = frameGraph->GetRenderTarget(renderTargetParam))
+		{
+			outAccesses.Add({ (FrameGraphRecordingSchedule::ResourceId)renderTarget.GetRawPtr(), m_bIsUnresolvedResourceWritten[i] });
+		}
+	}
+
+	GetSamplerAccesses(outAccesses);
+}
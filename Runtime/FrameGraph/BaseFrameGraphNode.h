@@ -4,6 +4,8 @@
 #include "Engine/Object.h"
 #include "RHI/Types.h"
 #include "RHI/Renderer.h"
+#include "FrameGraph/FrameGraphRecordingSchedule.h"
+#include "FrameGraph/FrameGraphParam.h"
 
 namespace Sailor::Framegraph
 {
@@ -30,10 +32,43 @@ namespace Sailor::Framegraph
 		SAILOR_API const std::string& GetString(const std::string& name) const;		
 		SAILOR_API bool TryGetString(const std::string& name, string& string) const;
 
+		// Resolves the param names to the slots, should be called when all params are set
+		SAILOR_API void Compile();
+
+		// The compiled params that are used during the frame recording
+		SAILOR_API RHI::RHITexturePtr GetResolvedAttachment(const ResourceParam& param) const;
+		SAILOR_API RHI::RHIResourcePtr GetRHIResource(const ResourceParam& param) const;
+		SAILOR_API const glm::vec4& GetVec4(const Vec4Param& param) const;
+		SAILOR_API float GetFloat(const FloatParam& param) const;
+		SAILOR_API const std::string& GetString(const StringParam& param) const;
+		SAILOR_API bool TryGetString(const StringParam& param, string& string) const;
+
+		// The per frame render target (DepthBuffer, BackBuffer, etc...) the unresolved param refers to
+		SAILOR_API RHI::RHIRenderTargetPtr GetUnresolvedRenderTarget(RHI::RHIFrameGraphPtr frameGraph, const ResourceParam& param) const;
+
+		// The bound attachment, otherwise the unresolved render target
+		SAILOR_API RHI::RHITexturePtr GetResolvedAttachment(RHI::RHIFrameGraphPtr frameGraph, const ResourceParam& param) const;
+
 		SAILOR_API virtual Sailor::Tasks::TaskPtr<void, void> Prepare(RHI::RHIFrameGraphPtr frameGraph, const RHI::RHISceneViewSnapshot& sceneView) { return Sailor::Tasks::TaskPtr<void, void>(); }
 		SAILOR_API virtual void Process(RHI::RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView) = 0;
 		SAILOR_API virtual void Clear() = 0;
 
+		// The nodes that execute the nested secondary command lists should be recorded in the primary command list
+		SAILOR_API virtual bool CanRecordInSecondaryCommandList() const { return true; }
+
+		// The nodes that set the frame graph samplers or mark the other nodes dirty are recorded on the render thread
+		// before the parallel recording starts, so the other nodes only read the frame graph state
+		SAILOR_API virtual bool ChangesFrameGraphState() const { return false; }
+
+		// The frame graph samplers (g_*) the node reads by GetSampler or writes by SetSampler
+		SAILOR_API virtual void GetSamplerAccesses(TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const {}
+
+		// The resources from the params and the frame graph samplers, the attachments the node renders into are written
+		SAILOR_API void GetResourceAccesses(RHI::RHIFrameGraphPtr frameGraph, TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const;
+
+		// The frame graph sampler is tracked by the slot, since the texture could be replaced while recording
+		SAILOR_API static FrameGraphRecordingSchedule::ResourceId GetSamplerResourceId(const SamplerParam& param) { return ~(FrameGraphRecordingSchedule::ResourceId)param.GetIndex(); }
+
 		SAILOR_API const std::string& GetTag() const { return m_tag; }
 		SAILOR_API void SetTag(const std::string& tag) { m_tag = tag; }
 
@@ -45,6 +80,18 @@ namespace Sailor::Framegraph
 		TMap<std::string, RHI::RHIResourcePtr> m_resourceParams;
 		TMap<std::string, std::string> m_unresolvedResourceParams;
 
+		TFrameGraphParamSlots<std::string> m_compiledStringParams;
+		TFrameGraphParamSlots<glm::vec4> m_compiledVectorParams;
+		TFrameGraphParamSlots<float> m_compiledFloatParams;
+		TFrameGraphParamSlots<RHI::RHIResourcePtr> m_compiledResourceParams;
+
+		// The values are the indices of the frame graph render targets
+		TFrameGraphParamSlots<uint32_t> m_compiledUnresolvedResourceParams;
+
+		// Per slot, whether the node writes into the resource
+		TVector<bool> m_bIsResourceWritten;
+		TVector<bool> m_bIsUnresolvedResourceWritten;
+
 		std::string m_tag{};
 	};
 
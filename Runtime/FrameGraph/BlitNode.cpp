@@ -17,6 +17,12 @@ using namespace Sailor::Framegraph;
 const char* BlitNode::m_name = "Blit";
 #endif
 
+namespace
+{
+	const ResourceParam SrcParam("src");
+	const ResourceParam DstParam("dst");
+}
+
 void BlitNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -48,20 +54,8 @@ void BlitNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr trans
 		m_blitToMsaaTargetMaterial = driver->CreateMaterial(vertexDescription, EPrimitiveTopology::TriangleList, renderState, m_pShader, m_shaderBindings);
 	}
 
-	RHI::RHITexturePtr src = GetResolvedAttachment("src");
-	RHI::RHITexturePtr dst = GetResolvedAttachment("dst");
-
-	for (const auto& r : m_unresolvedResourceParams)
-	{
-		if (r.First() == "src")
-		{
-			src = frameGraph->GetRenderTarget(*r.Second());
-		}
-		else if (r.First() == "dst")
-		{
-			dst = frameGraph->GetRenderTarget(*r.Second());
-		}
-	}
+	RHI::RHITexturePtr src = GetResolvedAttachment(frameGraph, SrcParam);
+	RHI::RHITexturePtr dst = GetResolvedAttachment(frameGraph, DstParam);
 
 	const bool bIsDepthFormat = RHI::IsDepthFormat(src->GetFormat()) || RHI::IsDepthFormat(dst->GetFormat());
 
@@ -88,13 +82,13 @@ void BlitNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr trans
 	commands->ImageMemoryBarrier(commandList, dst, dst->GetFormat(), RHI::EImageLayout::TransferDstOptimal, dst->GetDefaultLayout());
 
 	// Blit to MSAA targets
-	RHISurfacePtr dstSurface = GetRHIResource("dst").DynamicCast<RHISurface>();
+	RHISurfacePtr dstSurface = GetRHIResource(DstParam).DynamicCast<RHISurface>();
 	if (dstSurface && dstSurface->NeedsResolve())
 	{
 		bool bBlitIsSuccesful = false;
 
 		// First try to blit MSAA src to MSAA dst
-		if (RHISurfacePtr srcSurface = GetRHIResource("src").DynamicCast<RHISurface>())
+		if (RHISurfacePtr srcSurface = GetRHIResource(SrcParam).DynamicCast<RHISurface>())
 		{
 			auto src2 = srcSurface->GetTarget();
 			auto dst2 = dstSurface->GetTarget();
@@ -17,6 +17,21 @@ using namespace Sailor::Framegraph;
 const char* BloomNode::m_name = "Bloom";
 #endif
 
+namespace
+{
+	const ResourceParam BloomParam("bloom");
+	const Vec4Param ThresholdParam("threshold");
+	const Vec4Param KneeParam("knee");
+	const Vec4Param BloomIntensityParam("bloomIntensity");
+	const Vec4Param DirtIntensityParam("dirtIntensity");
+	const SamplerParam LensDirtSamplerParam("g_lensDirtSampler");
+}
+
+void BloomNode::GetSamplerAccesses(TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const
+{
+	outAccesses.Add({ GetSamplerResourceId(LensDirtSamplerParam), false });
+}
+
 void BloomNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -25,7 +40,7 @@ void BloomNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr tran
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 	commands->BeginDebugRegion(commandList, GetName(), DebugContext::Color_CmdCompute);
 
-	RHI::RHIRenderTargetPtr bloomRenderTarget = GetResolvedAttachment("bloom").DynamicCast<RHIRenderTarget>();
+	RHI::RHIRenderTargetPtr bloomRenderTarget = GetResolvedAttachment(BloomParam).DynamicCast<RHIRenderTarget>();
 
 	const size_t numMipBindings = bloomRenderTarget->GetMipLevels() - 1;
 
@@ -53,7 +68,7 @@ void BloomNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr tran
 
 	if (m_computeUpscaleBindings.Num() == 0)
 	{
-		RHI::RHITexturePtr lensDirtTexture = frameGraph->GetSampler("g_lensDirtSampler");
+		RHI::RHITexturePtr lensDirtTexture = frameGraph->GetSampler(LensDirtSamplerParam);
 
 		m_computeUpscaleBindings.Resize(bloomRenderTarget->GetMipLevels());
 
@@ -85,8 +100,8 @@ void BloomNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr tran
 		}
 	}
 
-	const glm::vec4 threshold = GetVec4("threshold");
-	const glm::vec4 knee = GetVec4("knee");
+	const glm::vec4 threshold = GetVec4(ThresholdParam);
+	const glm::vec4 knee = GetVec4(KneeParam);
 	const auto& bloomTextureSize = bloomRenderTarget->GetExtent();
 
 	PushConstantsDownscale downscaleParams{};
@@ -119,8 +134,8 @@ void BloomNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr tran
 	}
 
 	PushConstantsUpscale upscaleParams{};
-	upscaleParams.m_bloomIntensity = GetVec4("bloomIntensity").x;
-	upscaleParams.m_dirtIntensity = GetVec4("dirtIntensity").x;
+	upscaleParams.m_bloomIntensity = GetVec4(BloomIntensityParam).x;
+	upscaleParams.m_dirtIntensity = GetVec4(DirtIntensityParam).x;
 
 	// Bloom Upscale
 	for (uint32_t i = (uint32_t)bloomRenderTarget->GetMipLevels() - 1; i >= 1; --i)
@@ -16,6 +16,8 @@ namespace Sailor::Framegraph
 		SAILOR_API virtual void Process(RHI::RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView) override;
 		SAILOR_API virtual void Clear() override;
 
+		SAILOR_API virtual void GetSamplerAccesses(TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const override;
+
 	protected:
 
 		static const char* m_name;
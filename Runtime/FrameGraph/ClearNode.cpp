@@ -16,6 +16,14 @@ using namespace Sailor::Framegraph;
 const char* ClearNode::m_name = "Clear";
 #endif
 
+namespace
+{
+	const ResourceParam TargetParam("target");
+	const FloatParam ClearDepthParam("clearDepth");
+	const FloatParam ClearStencilParam("clearStencil");
+	const Vec4Param ClearColorParam("clearColor");
+}
+
 void ClearNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -24,15 +32,15 @@ void ClearNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr tran
 
 	RHITexturePtr dst{};
 
-	if (RHI::RHISurfacePtr surfaceAttachment = GetRHIResource("target").DynamicCast<RHISurface>())
+	if (RHI::RHISurfacePtr surfaceAttachment = GetRHIResource(TargetParam).DynamicCast<RHISurface>())
 	{
 		RHITexturePtr dst2 = surfaceAttachment->GetTarget();
 
 		commands->ImageMemoryBarrier(commandList, dst2, dst2->GetFormat(), dst2->GetDefaultLayout(), EImageLayout::TransferDstOptimal);
 		if (RHI::IsDepthFormat(dst2->GetFormat()))
 		{
-			float clearDepth = GetFloat("clearDepth");
-			float clearStencil = GetFloat("clearStencil");
+			float clearDepth = GetFloat(ClearDepthParam);
+			float clearStencil = GetFloat(ClearStencilParam);
 
 			commands->BeginDebugRegion(commandList, GetName(), glm::vec4(1.0f));
 			commands->ClearDepthStencil(commandList, dst2, clearDepth, (uint32_t)clearStencil);
@@ -40,7 +48,7 @@ void ClearNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr tran
 		}
 		else
 		{
-			glm::vec4 clearColor = GetVec4("clearColor");
+			glm::vec4 clearColor = GetVec4(ClearColorParam);
 			commands->BeginDebugRegion(commandList, GetName(), glm::vec4(clearColor.x, clearColor.y, clearColor.z, 0.5f));
 			commands->ClearImage(commandList, dst2, clearColor);
 			commands->EndDebugRegion(commandList);
@@ -54,27 +62,20 @@ void ClearNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr tran
 			return;
 		}
 	}
-	else if (RHI::RHITexturePtr colorAttachment = GetRHIResource("target").DynamicCast<RHITexture>())
+	else if (RHI::RHITexturePtr colorAttachment = GetRHIResource(TargetParam).DynamicCast<RHITexture>())
 	{
 		dst = colorAttachment;
 	}
 	else
 	{
-		for (const auto& r : m_unresolvedResourceParams)
-		{
-			if (r.First() == "target")
-			{
-				dst = frameGraph->GetRenderTarget(*r.Second());
-				break;
-			}
-		}
+		dst = GetUnresolvedRenderTarget(frameGraph, TargetParam);
 	}
 
 	commands->ImageMemoryBarrier(commandList, dst, dst->GetFormat(), dst->GetDefaultLayout(), EImageLayout::TransferDstOptimal);
 	if (RHI::IsDepthFormat(dst->GetFormat()))
 	{
-		float clearDepth = GetFloat("clearDepth");
-		float clearStencil = GetFloat("clearStencil");
+		float clearDepth = GetFloat(ClearDepthParam);
+		float clearStencil = GetFloat(ClearStencilParam);
 
 		commands->BeginDebugRegion(commandList, GetName(), glm::vec4(1.0f));
 		commands->ClearDepthStencil(commandList, dst, clearDepth, (uint32_t)clearStencil);
@@ -82,7 +83,7 @@ void ClearNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr tran
 	}
 	else
 	{
-		glm::vec4 clearColor = GetVec4("clearColor");
+		glm::vec4 clearColor = GetVec4(ClearColorParam);
 		commands->BeginDebugRegion(commandList, GetName(), glm::vec4(clearColor.x, clearColor.y, clearColor.z, 0.5f));
 		commands->ClearImage(commandList, dst, clearColor);
 		commands->EndDebugRegion(commandList);
@@ -16,6 +16,11 @@ using namespace Sailor::Framegraph;
 const char* CopyTextureToRamNode::m_name = "CopyTextureToRam";
 #endif
 
+namespace
+{
+	const ResourceParam SrcParam("src");
+}
+
 void CopyTextureToRamNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	if (!m_captureThisFrame)
@@ -25,7 +30,7 @@ void CopyTextureToRamNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandL
 	auto& driver = App::GetSubmodule<RHI::Renderer>()->GetDriver();
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 
-	if (m_texture = GetResolvedAttachment("src"))
+	if (m_texture = GetResolvedAttachment(SrcParam))
 	{
 		commands->ImageMemoryBarrier(commandList, m_texture, m_texture->GetFormat(), m_texture->GetDefaultLayout(), EImageLayout::TransferSrcOptimal);
 		if (!m_cpuBuffer || m_cpuBuffer->GetSize() < m_texture->GetSize())
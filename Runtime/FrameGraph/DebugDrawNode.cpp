@@ -16,6 +16,12 @@ using namespace Sailor::Framegraph;
 const char* DebugDrawNode::m_name = "DebugDraw";
 #endif
 
+namespace
+{
+	const ResourceParam ColorParam("color");
+	const ResourceParam DepthStencilParam("depthStencil");
+}
+
 void DebugDrawNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -23,14 +29,14 @@ void DebugDrawNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 	commands->BeginDebugRegion(commandList, GetName(), DebugContext::Color_CmdDebug);
 
-	auto colorAttachmentSurface = GetRHIResource("color").DynamicCast<RHI::RHISurface>();
-	auto colorAttachmentRT = GetRHIResource("color").DynamicCast<RHI::RHIRenderTarget>();
-	auto target = GetResolvedAttachment("color");
+	auto colorAttachmentSurface = GetRHIResource(ColorParam).DynamicCast<RHI::RHISurface>();
+	auto colorAttachmentRT = GetRHIResource(ColorParam).DynamicCast<RHI::RHIRenderTarget>();
+	auto target = GetResolvedAttachment(ColorParam);
 
-	auto depthAttachment = GetRHIResource("depthStencil").DynamicCast<RHI::RHITexture>();
+	auto depthAttachment = GetRHIResource(DepthStencilParam).DynamicCast<RHI::RHITexture>();
 	if (!depthAttachment)
 	{
-		depthAttachment = frameGraph->GetRenderTarget("DepthBuffer");
+		depthAttachment = frameGraph->GetRenderTarget(RHIFrameGraph::DepthBuffer);
 	}
 
 	if (!colorAttachmentSurface && !colorAttachmentRT)
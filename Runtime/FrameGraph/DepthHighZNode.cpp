@@ -17,6 +17,12 @@ using namespace Sailor::Framegraph;
 const char* DepthHighZNode::m_name = "DepthHighZ";
 #endif
 
+namespace
+{
+	const ResourceParam SrcParam("src");
+	const ResourceParam DstParam("dst");
+}
+
 void DepthHighZNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -24,13 +30,13 @@ void DepthHighZNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr
 	auto& driver = App::GetSubmodule<RHI::Renderer>()->GetDriver();
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 
-	RHI::RHITexturePtr depthAttachment = GetRHIResource("src").DynamicCast<RHI::RHIRenderTarget>()->GetDepthAspect();
+	RHI::RHITexturePtr depthAttachment = GetRHIResource(SrcParam).DynamicCast<RHI::RHIRenderTarget>()->GetDepthAspect();
 	if (!depthAttachment)
 	{
-		depthAttachment = frameGraph->GetRenderTarget("DepthBuffer")->GetDepthAspect();
+		depthAttachment = frameGraph->GetRenderTarget(RHIFrameGraph::DepthBuffer)->GetDepthAspect();
 	}
 
-	RHI::RHIRenderTargetPtr highZRenderTarget = GetResolvedAttachment("dst").DynamicCast<RHIRenderTarget>();
+	RHI::RHIRenderTargetPtr highZRenderTarget = GetResolvedAttachment(DstParam).DynamicCast<RHIRenderTarget>();
 
 	const size_t numMipBindings = highZRenderTarget->GetMipLevels() - 1;
 
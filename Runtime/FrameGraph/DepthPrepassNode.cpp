@@ -15,6 +15,16 @@ using namespace Sailor::RHI;
 const char* DepthPrepassNode::m_name = "DepthPrepass";
 #endif
 
+namespace
+{
+	const StringParam SortingParam("Sorting");
+	const StringParam TagParam("Tag");
+	const StringParam ClearDepthParam("ClearDepth");
+	const StringParam GPUCullingParam("GPUCulling");
+	const ResourceParam DepthHighZParam("depthHighZ");
+	const ResourceParam DepthStencilParam("depthStencil");
+}
+
 RHI::RHIMaterialPtr DepthPrepassNode::GetOrAddDepthMaterial(RHI::RHIVertexDescriptionPtr vertexDescription)
 {
 	auto& material = m_depthOnlyMaterials[vertexDescription->GetVertexAttributeBits()];
@@ -36,7 +46,7 @@ RHI::RHIMaterialPtr DepthPrepassNode::GetOrAddDepthMaterial(RHI::RHIVertexDescri
 
 RHI::ESortingOrder DepthPrepassNode::GetSortingOrder() const
 {
-	const std::string& sortOrder = GetString("Sorting");
+	const std::string& sortOrder = GetString(SortingParam);
 
 	if (!sortOrder.empty())
 	{
@@ -50,7 +60,7 @@ Tasks::TaskPtr<void, void> DepthPrepassNode::Prepare(RHI::RHIFrameGraphPtr frame
 {
 	SAILOR_PROFILE_FUNCTION();
 
-	const std::string QueueTag = GetString("Tag");
+	const std::string QueueTag = GetString(TagParam);
 	const size_t QueueTagHash = GetHash(QueueTag);
 
 	Tasks::TaskPtr res = Tasks::CreateTask("Prepare DepthPrepassNode " + std::to_string(sceneView.m_frame),
@@ -138,24 +148,24 @@ void DepthPrepassNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListP
 	m_syncSharedResources.Lock();
 
 	std::string temp;
-	TryGetString("ClearDepth", temp);
+	TryGetString(ClearDepthParam, temp);
 	const bool bShouldClearDepth = temp == "true";
 
 	temp.clear();
-	TryGetString("GPUCulling", temp);
+	TryGetString(GPUCullingParam, temp);
 	const bool bGpuCullingEnabled = temp == "true";
 
-	const std::string QueueTag = GetString("Tag");
+	const std::string QueueTag = GetString(TagParam);
 	const size_t QueueTagHash = GetHash(QueueTag);
 
 	auto scheduler = App::GetSubmodule<Tasks::Scheduler>();
 	auto& driver = App::GetSubmodule<RHI::Renderer>()->GetDriver();
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 
-	auto depthAttachment = GetRHIResource("depthStencil").StaticCast<RHI::RHITexture>();
+	auto depthAttachment = GetRHIResource(DepthStencilParam).StaticCast<RHI::RHITexture>();
 	if (!depthAttachment)
 	{
-		depthAttachment = frameGraph->GetRenderTarget("DepthBuffer");
+		depthAttachment = frameGraph->GetRenderTarget(RHIFrameGraph::DepthBuffer);
 	}
 
 	if (bGpuCullingEnabled)
@@ -170,7 +180,7 @@ void DepthPrepassNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListP
 
 		if (!m_computeMeshCullingBindings.IsValid())
 		{
-			auto depthHighZ = GetResolvedAttachment("depthHighZ").StaticCast<RHI::RHITexture>();
+			auto depthHighZ = GetResolvedAttachment(DepthHighZParam).StaticCast<RHI::RHITexture>();
 			m_computeMeshCullingBindings = driver->CreateShaderBindings();
 			driver->AddSamplerToShaderBindings(m_computeMeshCullingBindings, "depthHighZ", depthHighZ, 0);
 		}
@@ -20,6 +20,23 @@ using namespace Sailor::Framegraph;
 const char* EnvironmentNode::m_name = "Environment";
 #endif
 
+namespace
+{
+	const StringParam EnvironmentMapParam("EnvironmentMap");
+	const SamplerParam SkyCubemapParam("g_skyCubemap");
+	const SamplerParam BrdfSamplerParam("g_brdfSampler");
+	const SamplerParam EnvCubemapParam("g_envCubemap");
+	const SamplerParam IrradianceCubemapParam("g_irradianceCubemap");
+}
+
+void EnvironmentNode::GetSamplerAccesses(TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const
+{
+	outAccesses.Add({ GetSamplerResourceId(SkyCubemapParam), false });
+	outAccesses.Add({ GetSamplerResourceId(BrdfSamplerParam), true });
+	outAccesses.Add({ GetSamplerResourceId(EnvCubemapParam), true });
+	outAccesses.Add({ GetSamplerResourceId(IrradianceCubemapParam), true });
+}
+
 void EnvironmentNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -97,7 +114,7 @@ void EnvironmentNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 		if (!m_envMapTexture)
 		{
 			string envMapFilepath;
-			if (TryGetString("EnvironmentMap", envMapFilepath))
+			if (TryGetString(EnvironmentMapParam, envMapFilepath))
 			{
 				if (const auto& assetInfo = App::GetSubmodule<AssetRegistry>()->GetAssetInfoPtr(envMapFilepath))
 				{
@@ -131,7 +148,7 @@ void EnvironmentNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 			}
 			commands->EndDebugRegion(commandList);
 		}
-		else if (auto g_skyCubemap = frameGraph->GetSampler("g_skyCubemap").DynamicCast<RHICubemap>())
+		else if (auto g_skyCubemap = frameGraph->GetSampler(SkyCubemapParam).DynamicCast<RHICubemap>())
 		{
 			rawEnvCubemap = g_skyCubemap;
 		}
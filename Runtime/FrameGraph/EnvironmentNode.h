@@ -24,6 +24,10 @@ namespace Sailor::Framegraph
 		SAILOR_API virtual void Process(RHI::RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView) override;
 		SAILOR_API virtual void Clear() override;
 
+		// Sets g_brdfSampler, g_envCubemap and g_irradianceCubemap
+		SAILOR_API virtual bool ChangesFrameGraphState() const override { return true; }
+		SAILOR_API virtual void GetSamplerAccesses(TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const override;
+
 		SAILOR_API void MarkDirty() { m_bIsDirty = true; };
 
 	protected:
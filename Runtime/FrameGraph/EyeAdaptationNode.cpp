@@ -18,6 +18,15 @@ using namespace Sailor::Framegraph;
 const char* EyeAdaptationNode::m_name = "EyeAdaptation";
 #endif
 
+namespace
+{
+	const ResourceParam ColorParam("color");
+	const ResourceParam HdrColorParam("hdrColor");
+	const ResourceParam ColorSamplerParam("colorSampler");
+	const StringParam ToneMappingShaderParam("toneMappingShader");
+	const StringParam ToneMappingDefinesParam("toneMappingDefines");
+}
+
 void EyeAdaptationNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -26,7 +35,7 @@ void EyeAdaptationNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandList
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 	commands->BeginDebugRegion(commandList, GetName(), DebugContext::Color_CmdCompute);
 
-	RHI::RHITexturePtr target = GetResolvedAttachment("color");
+	RHI::RHITexturePtr target = GetResolvedAttachment(ColorParam);
 
 	if (!m_pComputeHistogramShader)
 	{
@@ -46,10 +55,10 @@ void EyeAdaptationNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandList
 
 	if (!m_pToneMappingShader)
 	{
-		auto shaderPath = GetString("toneMappingShader");
+		auto shaderPath = GetString(ToneMappingShaderParam);
 		check(!shaderPath.empty());
 
-		auto definesStr = GetString("toneMappingDefines");
+		auto definesStr = GetString(ToneMappingDefinesParam);
 		TVector<std::string> defines = Sailor::Utils::SplitString(definesStr, " ");
 
 		if (auto shaderInfo = App::GetSubmodule<AssetRegistry>()->GetAssetInfoPtr(shaderPath))
@@ -58,8 +67,8 @@ void EyeAdaptationNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandList
 		}
 	}
 
-	RHI::RHITexturePtr quarterResolution = GetResolvedAttachment("hdrColor");
-	RHI::RHITexturePtr fullResolution = GetResolvedAttachment("colorSampler");
+	RHI::RHITexturePtr quarterResolution = GetResolvedAttachment(HdrColorParam);
+	RHI::RHITexturePtr fullResolution = GetResolvedAttachment(ColorSamplerParam);
 
 	if (!m_computeHistogramShaderBindings)
 	{
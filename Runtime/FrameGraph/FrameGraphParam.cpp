@@ -0,0 +1,78 @@
+#include "FrameGraphParam.h"
+#include "Containers/Map.h"
+#include "Core/SpinLock.h"
+#include "Memory/UniquePtr.hpp"
+
+using namespace Sailor;
+using namespace Sailor::Framegraph;
+
+namespace
+{
+	// The handles are mostly created during the static initialization, so the registry is lazy
+	struct ParamRegistry
+	{
+		SpinLock m_lock;
+		TMap<std::string, uint32_t> m_indices;
+
+		// The names are allocated separately to keep the references valid
+		TVector<TUniquePtr<std::string>> m_names;
+	};
+
+	ParamRegistry& GetRegistry()
+	{
+		static ParamRegistry registry;
+		return registry;
+	}
+}
+
+uint32_t FrameGraphParam::Register(const std::string& name)
+{
+	auto& registry = GetRegistry();
+
+	registry.m_lock.Lock();
+
+	uint32_t* pIndex = nullptr;
+	uint32_t index = 0;
+
+	if (registry.m_indices.Find(name, pIndex))
+	{
+		index = *pIndex;
+	}
+	else
+	{
+		index = (uint32_t)registry.m_names.Num();
+		registry.m_indices[name] = index;
+		registry.m_names.Emplace(TUniquePtr<std::string>::Make(name));
+	}
+
+	registry.m_lock.Unlock();
+
+	return index;
+}
+
+uint32_t FrameGraphParam::Find(const std::string& name)
+{
+	auto& registry = GetRegistry();
+
+	registry.m_lock.Lock();
+
+	uint32_t* pIndex = nullptr;
+	const uint32_t index = registry.m_indices.Find(name, pIndex) ? *pIndex : InvalidIndex;
+
+	registry.m_lock.Unlock();
+
+	return index;
+}
+
+const std::string& FrameGraphParam::GetName(uint32_t index)
+{
+	static const std::string invalidName = "";
+
+	auto& registry = GetRegistry();
+
+	registry.m_lock.Lock();
+	const std::string* name = index < registry.m_names.Num() ? registry.m_names[index].GetRawPtr() : &invalidName;
+	registry.m_lock.Unlock();
+
+	return *name;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Containers/Vector.h"
+#include "RHI/Types.h"
+
+namespace Sailor::Framegraph
+{
+	/* The name of the param that is resolved to the dense index once.
+	*  The frame graph compiles the params to the slots at the load time,
+	*  so the nodes look up the params by the index instead of hashing the strings every frame.
+	*/
+	class FrameGraphParam
+	{
+	public:
+
+		static constexpr uint32_t InvalidIndex = (uint32_t)-1;
+
+		SAILOR_API explicit FrameGraphParam(const std::string& name) : m_index(Register(name)) {}
+
+		SAILOR_API uint32_t GetIndex() const { return m_index; }
+		SAILOR_API const std::string& GetName() const { return GetName(m_index); }
+
+		SAILOR_API static uint32_t Register(const std::string& name);
+		SAILOR_API static uint32_t Find(const std::string& name);
+		SAILOR_API static const std::string& GetName(uint32_t index);
+
+	protected:
+
+		FrameGraphParam() = default;
+
+		uint32_t m_index = InvalidIndex;
+	};
+
+	// The handle is typed, so the float param cannot be read as the texture
+	template<typename T>
+	class TFrameGraphParam : public FrameGraphParam
+	{
+	public:
+
+		explicit TFrameGraphParam(const std::string& name) : FrameGraphParam(name) {}
+
+		static TFrameGraphParam FromIndex(uint32_t index)
+		{
+			TFrameGraphParam param;
+			param.m_index = index;
+			return param;
+		}
+
+	protected:
+
+		TFrameGraphParam() = default;
+	};
+
+	using FloatParam = TFrameGraphParam<float>;
+	using Vec4Param = TFrameGraphParam<glm::vec4>;
+	using StringParam = TFrameGraphParam<std::string>;
+	using ResourceParam = TFrameGraphParam<RHI::RHIResourcePtr>;
+	using SamplerParam = TFrameGraphParam<RHI::RHITexturePtr>;
+	using RenderTargetParam = TFrameGraphParam<RHI::RHIRenderTargetPtr>;
+	using SurfaceParam = TFrameGraphParam<RHI::RHISurfacePtr>;
+
+	// The compiled params, the values are packed densely and the slots are indexed by the param index
+	template<typename T>
+	class TFrameGraphParamSlots
+	{
+	public:
+
+		void Clear()
+		{
+			m_slots.Clear();
+			m_values.Clear();
+			m_indices.Clear();
+		}
+
+		// Returns the slot of the value
+		uint32_t Set(uint32_t index, T value)
+		{
+			if (index >= m_slots.Num())
+			{
+				const size_t num = m_slots.Num();
+				m_slots.Resize(index + 1);
+
+				for (size_t i = num; i < m_slots.Num(); i++)
+				{
+					m_slots[i] = FrameGraphParam::InvalidIndex;
+				}
+			}
+
+			if (m_slots[index] == FrameGraphParam::InvalidIndex)
+			{
+				m_slots[index] = (uint32_t)m_values.Num();
+				m_values.Add(std::move(value));
+				m_indices.Add(index);
+			}
+			else
+			{
+				m_values[m_slots[index]] = std::move(value);
+			}
+
+			return m_slots[index];
+		}
+
+		const T* Find(uint32_t index) const
+		{
+			if (index >= m_slots.Num() || m_slots[index] == FrameGraphParam::InvalidIndex)
+			{
+				return nullptr;
+			}
+
+			return &m_values[m_slots[index]];
+		}
+
+		size_t Num() const { return m_values.Num(); }
+		uint32_t GetIndex(size_t slot) const { return m_indices[slot]; }
+		const T& GetValue(size_t slot) const { return m_values[slot]; }
+
+	protected:
+
+		TVector<uint32_t> m_slots;
+		TVector<T> m_values;
+		TVector<uint32_t> m_indices;
+	};
+}
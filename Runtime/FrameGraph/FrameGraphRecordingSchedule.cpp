@@ -0,0 +1,80 @@
+#include "FrameGraphRecordingSchedule.h"
+
+using namespace Sailor;
+using namespace Sailor::Framegraph;
+
+void FrameGraphRecordingSchedule::Clear()
+{
+	m_nodes.Clear(false);
+	m_resources.Clear();
+	m_lastBarrier = 0;
+}
+
+uint32_t FrameGraphRecordingSchedule::AddNode(const TVector<Access>& accesses, bool bIsRecordedInSecondaryCommandList)
+{
+	const uint32_t index = (uint32_t)m_nodes.Num();
+
+	Node node;
+	node.m_bIsRecordedInSecondaryCommandList = bIsRecordedInSecondaryCommandList;
+
+	for (const auto& access : accesses)
+	{
+		const ResourceState& state = m_resources[access.m_resource];
+
+		if (state.m_lastWriter != (uint32_t)-1)
+		{
+			node.m_dependencies.Add(state.m_lastWriter);
+		}
+
+		if (access.m_bIsWrite)
+		{
+			for (uint32_t reader : state.m_readers)
+			{
+				if (reader != index)
+				{
+					node.m_dependencies.Add(reader);
+				}
+			}
+		}
+	}
+
+	// The states are updated when all accesses are resolved, so the node doesn't depend on itself
+	for (const auto& access : accesses)
+	{
+		ResourceState& state = m_resources[access.m_resource];
+
+		if (access.m_bIsWrite)
+		{
+			state.m_lastWriter = index;
+			state.m_readers.Clear(false);
+		}
+		else if (state.m_lastWriter != index && !state.m_readers.Contains(index))
+		{
+			state.m_readers.Add(index);
+		}
+	}
+
+	node.m_dependencies.Sort();
+	for (size_t i = 1; i < node.m_dependencies.Num(); )
+	{
+		if (node.m_dependencies[i] == node.m_dependencies[i - 1])
+		{
+			node.m_dependencies.RemoveAt(i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	// The barrier syncs all previous nodes
+	if (node.m_dependencies.Num() > 0 && node.m_dependencies[node.m_dependencies.Num() - 1] >= m_lastBarrier)
+	{
+		node.m_bNeedsBarrier = true;
+		m_lastBarrier = index;
+	}
+
+	m_nodes.Add(std::move(node));
+
+	return index;
+}
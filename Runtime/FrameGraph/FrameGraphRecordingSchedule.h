@@ -0,0 +1,57 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Containers/Vector.h"
+#include "Containers/Map.h"
+
+namespace Sailor::Framegraph
+{
+	/* The dependencies between the frame graph nodes that are recorded in the separate command lists.
+	*  The nodes are added in the order of execution with the resources they read and write,
+	*  the edges go from the last writer to the readers (RAW) and from the readers and the last writer to the next writer (WAR, WAW).
+	*  The node needs the barrier when it depends on any node recorded after the previous barrier.
+	*/
+	class FrameGraphRecordingSchedule
+	{
+	public:
+
+		using ResourceId = size_t;
+
+		struct Access
+		{
+			ResourceId m_resource = 0;
+			bool m_bIsWrite = false;
+		};
+
+		SAILOR_API void Clear();
+
+		SAILOR_API uint32_t AddNode(const TVector<Access>& accesses, bool bIsRecordedInSecondaryCommandList);
+
+		SAILOR_API uint32_t Num() const { return (uint32_t)m_nodes.Num(); }
+		SAILOR_API const TVector<uint32_t>& GetDependencies(uint32_t node) const { return m_nodes[node].m_dependencies; }
+		SAILOR_API bool NeedsBarrier(uint32_t node) const { return m_nodes[node].m_bNeedsBarrier; }
+		SAILOR_API bool IsRecordedInSecondaryCommandList(uint32_t node) const { return m_nodes[node].m_bIsRecordedInSecondaryCommandList; }
+
+	protected:
+
+		struct Node
+		{
+			TVector<uint32_t> m_dependencies;
+			bool m_bNeedsBarrier = false;
+			bool m_bIsRecordedInSecondaryCommandList = false;
+		};
+
+		struct ResourceState
+		{
+			uint32_t m_lastWriter = (uint32_t)-1;
+
+			// Since the last write
+			TVector<uint32_t> m_readers;
+		};
+
+		TVector<Node> m_nodes;
+		TMap<ResourceId, ResourceState> m_resources;
+		uint32_t m_lastBarrier = 0;
+	};
+
+	SAILOR_API void RunFrameGraphRecordingScheduleTests();
+}
@@ -0,0 +1,219 @@
+#include <thread>
+#include "FrameGraph/FrameGraphRecordingSchedule.h"
+#include "FrameGraph/RHIFrameGraph.h"
+#include "RHI/Renderer.h"
+#include "RHI/SceneView.h"
+#include "RHI/CommandList.h"
+#include "ECS/CameraECS.h"
+#include "GraphicsDriver/Null/NullGraphicsDriver.h"
+#include "Core/LogMacros.h"
+
+using namespace Sailor;
+using namespace Sailor::Framegraph;
+
+namespace
+{
+	enum EResource : FrameGraphRecordingSchedule::ResourceId
+	{
+		Depth = 1,
+		LinearDepth,
+		Sky,
+		Main,
+		HalfDepth,
+		InPlace
+	};
+
+	FrameGraphRecordingSchedule::Access Read(EResource resource) { return { resource, false }; }
+	FrameGraphRecordingSchedule::Access Write(EResource resource) { return { resource, true }; }
+
+	// The simplified DefaultRenderer with the expected dependencies and barriers
+	bool SanityCheck()
+	{
+		struct Expected
+		{
+			TVector<FrameGraphRecordingSchedule::Access> m_accesses;
+			TVector<uint32_t> m_dependencies;
+			bool m_bNeedsBarrier;
+		};
+
+		const TVector<Expected> nodes =
+		{
+			{ { Write(Depth) }, {}, false },
+			{ { Read(Depth), Write(LinearDepth) }, { 0 }, true },
+			{ { Write(Sky), Read(LinearDepth) }, { 1 }, true },
+			{ { Write(Main) }, {}, false },
+			{ { Read(Sky), Write(Main) }, { 2, 3 }, true },
+			// Synced by the barrier before the node 1
+			{ { Read(Depth), Write(HalfDepth) }, { 0 }, false },
+			{ { Read(HalfDepth), Read(Main) }, { 4, 5 }, true },
+			// WAR with the node 6 and WAW with the node 4
+			{ { Write(Main) }, { 4, 6 }, true },
+			// The node doesn't depend on itself
+			{ { Write(InPlace), Read(InPlace) }, {}, false },
+			{ { Read(InPlace), Read(Main) }, { 7, 8 }, true },
+		};
+
+		FrameGraphRecordingSchedule schedule;
+		for (uint32_t i = 0; i < nodes.Num(); i++)
+		{
+			const uint32_t index = schedule.AddNode(nodes[i].m_accesses, i % 2 == 0);
+
+			if (index != i ||
+				!(schedule.GetDependencies(i) == nodes[i].m_dependencies) ||
+				schedule.NeedsBarrier(i) != nodes[i].m_bNeedsBarrier ||
+				schedule.IsRecordedInSecondaryCommandList(i) != (i % 2 == 0))
+			{
+				return false;
+			}
+		}
+
+		schedule.Clear();
+		return schedule.Num() == 0 && schedule.AddNode({ Read(Main) }, true) == 0 && !schedule.NeedsBarrier(0);
+	}
+
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+
+	// Pushes its index, so the secondary command lists are told apart in the primary one
+	class RecordingTestNode : public BaseFrameGraphNode
+	{
+	public:
+
+		RecordingTestNode(uint32_t index, TVector<FrameGraphRecordingSchedule::Access> samplers, bool bIsSecondary, bool bChangesFrameGraphState) :
+			m_index(index),
+			m_samplers(std::move(samplers)),
+			m_bIsSecondary(bIsSecondary),
+			m_bChangesFrameGraphState(bChangesFrameGraphState)
+		{}
+
+		virtual void Process(RHI::RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView) override
+		{
+			RHI::Renderer::GetDriverCommands()->PushConstants(commandList, nullptr, sizeof(m_index), &m_index);
+
+			m_commandList = commandList;
+			m_recordingThread = std::this_thread::get_id();
+		}
+
+		virtual void Clear() override {}
+
+		virtual bool CanRecordInSecondaryCommandList() const override { return m_bIsSecondary; }
+		virtual bool ChangesFrameGraphState() const override { return m_bChangesFrameGraphState; }
+		virtual void GetSamplerAccesses(TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const override { outAccesses.AddRange(m_samplers); }
+
+		RHI::RHICommandListPtr m_commandList;
+		std::thread::id m_recordingThread;
+
+	protected:
+
+		uint32_t m_index;
+		TVector<FrameGraphRecordingSchedule::Access> m_samplers;
+		bool m_bIsSecondary;
+		bool m_bChangesFrameGraphState;
+	};
+
+	// Records the frame graph in parallel on the null driver and compares the command stream of the primary command list:
+	// the secondaries are executed in the node order, the barriers are placed before the dependent nodes
+	// and the node that changes the frame graph state is recorded on the calling thread.
+	bool ProcessCheck()
+	{
+		using namespace Sailor::GraphicsDriver::Null;
+
+		const auto First = BaseFrameGraphNode::GetSamplerResourceId(SamplerParam("g_recordingTestFirst"));
+		const auto Second = BaseFrameGraphNode::GetSamplerResourceId(SamplerParam("g_recordingTestSecond"));
+
+		auto frameGraph = RHI::RHIFrameGraphPtr::Make();
+
+		TVector<TRefPtr<RecordingTestNode>> nodes;
+		nodes.Add(TRefPtr<RecordingTestNode>::Make(0u, TVector<FrameGraphRecordingSchedule::Access>{ { First, true } }, true, false));
+		nodes.Add(TRefPtr<RecordingTestNode>::Make(1u, TVector<FrameGraphRecordingSchedule::Access>{ { Second, true } }, true, false));
+		// RAW with the node 0
+		nodes.Add(TRefPtr<RecordingTestNode>::Make(2u, TVector<FrameGraphRecordingSchedule::Access>{ { First, false } }, true, false));
+		// Recorded in the primary command list, synced by the barrier before the node 2
+		nodes.Add(TRefPtr<RecordingTestNode>::Make(3u, TVector<FrameGraphRecordingSchedule::Access>{ { Second, false } }, false, false));
+		// WAR with the node 2
+		nodes.Add(TRefPtr<RecordingTestNode>::Make(4u, TVector<FrameGraphRecordingSchedule::Access>{ { First, true } }, true, true));
+
+		for (auto& node : nodes)
+		{
+			frameGraph->GetGraph().Add(node);
+		}
+
+		frameGraph->Compile();
+		frameGraph->SetParallelRecording(true);
+
+		RHI::RHISceneViewPtr sceneView = RHI::RHISceneViewPtr::Make();
+		sceneView->m_snapshots.Emplace();
+		sceneView->m_snapshots[0].m_camera = TUniquePtr<CameraData>::Make();
+
+		TVector<RHI::RHICommandListPtr> transferCommandLists;
+		TVector<RHI::RHICommandListPtr> commandLists;
+		RHI::RHISemaphorePtr waitSemaphore;
+
+		frameGraph->Process(sceneView, transferCommandLists, commandLists, waitSemaphore);
+		frameGraph->Clear();
+
+		if (commandLists.Num() != 1)
+		{
+			return false;
+		}
+
+		const TVector<ENullCommand> expectedCommands =
+		{
+			ENullCommand::BeginCommandList,
+			ENullCommand::BeginDebugRegion,
+			ENullCommand::ExecuteSecondaryCommandList,
+			ENullCommand::ExecuteSecondaryCommandList,
+			ENullCommand::MemoryBarrier,
+			ENullCommand::ExecuteSecondaryCommandList,
+			ENullCommand::PushConstants,
+			ENullCommand::MemoryBarrier,
+			ENullCommand::ExecuteSecondaryCommandList,
+			ENullCommand::EndDebugRegion,
+			ENullCommand::EndCommandList
+		};
+
+		const TVector<const RHI::RHICommandList*> expectedSecondaries =
+		{
+			nodes[0]->m_commandList.GetRawPtr(),
+			nodes[1]->m_commandList.GetRawPtr(),
+			nodes[2]->m_commandList.GetRawPtr(),
+			nodes[4]->m_commandList.GetRawPtr()
+		};
+
+		if (!(NullGraphicsDriver::GetRecordedCommands(commandLists[0]) == expectedCommands) ||
+			!(NullGraphicsDriver::GetExecutedCommandLists(commandLists[0]) == expectedSecondaries) ||
+			!(nodes[3]->m_commandList == commandLists[0]) ||
+			nodes[4]->m_recordingThread != std::this_thread::get_id())
+		{
+			return false;
+		}
+
+		const TVector<ENullCommand> expectedSecondaryCommands = { ENullCommand::BeginCommandList, ENullCommand::PushConstants, ENullCommand::EndCommandList };
+		for (uint32_t i : { 0u, 1u, 2u, 4u })
+		{
+			if (!(NullGraphicsDriver::GetRecordedCommands(nodes[i]->m_commandList) == expectedSecondaryCommands))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+#endif
+}
+
+void Sailor::Framegraph::RunFrameGraphRecordingScheduleTests()
+{
+	printf("\nStarting FrameGraph recording schedule tests...\n");
+	printf("Sanity check passed: %d\n", SanityCheck());
+
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (RHI::Renderer::GetDriver().DynamicCast<GraphicsDriver::Null::NullGraphicsDriver>())
+	{
+		printf("Process check passed: %d\n", ProcessCheck());
+	}
+	else
+	{
+		printf("Process check is skipped, it runs with --nullrhi\n");
+	}
+#endif
+}
@@ -16,6 +16,11 @@ using namespace Sailor::Framegraph;
 const char* LightCullingNode::m_name = "LightCulling";
 #endif
 
+namespace
+{
+	const ResourceParam DepthStencilParam("depthStencil");
+}
+
 void LightCullingNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -35,10 +40,10 @@ void LightCullingNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListP
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 	commands->BeginDebugRegion(commandList, GetName(), DebugContext::Color_CmdCompute);
 
-	auto depthAttachment = GetRHIResource("depthStencil").DynamicCast<RHI::RHITexture>();
+	auto depthAttachment = GetRHIResource(DepthStencilParam).DynamicCast<RHI::RHITexture>();
 	if (!depthAttachment)
 	{
-		depthAttachment = frameGraph->GetRenderTarget("DepthBuffer").DynamicCast<RHI::RHITexture>();
+		depthAttachment = frameGraph->GetRenderTarget(RHIFrameGraph::DepthBuffer).DynamicCast<RHI::RHITexture>();
 	}
 
 #ifdef _DEBUG
@@ -18,6 +18,12 @@ using namespace Sailor::Framegraph;
 const char* LinearizeDepthNode::m_name = "LinearizeDepth";
 #endif
 
+namespace
+{
+	const ResourceParam DepthStencilParam("depthStencil");
+	const ResourceParam TargetParam("target");
+}
+
 void LinearizeDepthNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -26,15 +32,7 @@ void LinearizeDepthNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandLis
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 	commands->BeginDebugRegion(commandList, GetName(), DebugContext::Color_CmdGraphics);
 
-	auto depthAttachment = GetResolvedAttachment("depthStencil");
-	for (const auto& r : m_unresolvedResourceParams)
-	{
-		if (r.First() == "depthStencil")
-		{
-			depthAttachment = frameGraph->GetRenderTarget(*r.Second());
-			break;
-		}
-	}
+	auto depthAttachment = GetResolvedAttachment(frameGraph, DepthStencilParam);
 
 	if (!m_pLinearizeDepthShader)
 	{
@@ -42,7 +40,7 @@ void LinearizeDepthNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandLis
 		App::GetSubmodule<ShaderCompiler>()->LoadShader(computeShaderInfo->GetFileId(), m_pLinearizeDepthShader);
 	}
 
-	auto target = GetResolvedAttachment("target");
+	auto target = GetResolvedAttachment(TargetParam);
 
 	if (!m_pLinearizeDepthShader || !target || !m_pLinearizeDepthShader->IsReady())
 	{
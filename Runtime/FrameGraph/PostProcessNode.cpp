@@ -18,6 +18,13 @@ using namespace Sailor::Framegraph;
 const char* PostProcessNode::m_name = "PostProcess";
 #endif
 
+namespace
+{
+	const ResourceParam ColorParam("color");
+	const StringParam ShaderParam("shader");
+	const StringParam DefinesParam("defines");
+}
+
 void PostProcessNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -25,30 +32,29 @@ void PostProcessNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 	auto& driver = App::GetSubmodule<RHI::Renderer>()->GetDriver();
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 
-	RHI::RHITexturePtr target = GetResolvedAttachment("color");
-	RHI::RHISurfacePtr targetMsaa = GetRHIResource("color").DynamicCast<RHISurface>();
+	RHI::RHITexturePtr target = GetResolvedAttachment(ColorParam);
+	RHI::RHISurfacePtr targetMsaa = GetRHIResource(ColorParam).DynamicCast<RHISurface>();
 
 	const bool bShouldUseMsaaTarget = targetMsaa.IsValid() && targetMsaa->NeedsResolve();
 
 	if (!target)
 	{
-		if (m_unresolvedResourceParams.ContainsKey("color"))
+		if (m_compiledUnresolvedResourceParams.Find(ColorParam.GetIndex()))
 		{
-			const std::string colorAttachment = m_unresolvedResourceParams["color"];
-			target = frameGraph->GetRenderTarget(colorAttachment);
+			target = GetUnresolvedRenderTarget(frameGraph, ColorParam);
 		}
 		else
 		{
-			target = frameGraph->GetRenderTarget("BackBuffer");
+			target = frameGraph->GetRenderTarget(RHIFrameGraph::BackBuffer);
 		}
 	}
 
 	if (!m_pShader)
 	{
-		auto shaderPath = GetString("shader");
+		auto shaderPath = GetString(ShaderParam);
 		check(!shaderPath.empty());
 
-		auto definesStr = GetString("defines");
+		auto definesStr = GetString(DefinesParam);
 		TVector<std::string> defines = Sailor::Utils::SplitString(definesStr, " ");
 
 		if (auto shaderInfo = App::GetSubmodule<AssetRegistry>()->GetAssetInfoPtr(shaderPath))
@@ -62,7 +68,7 @@ void PostProcessNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 		return;
 	}
 
-	const std::string shaderName = std::string(GetName()) + ":" + GetString("shader");
+	const std::string shaderName = std::string(GetName()) + ":" + GetString(ShaderParam);
 	commands->BeginDebugRegion(commandList, shaderName, DebugContext::Color_CmdPostProcess);
 
 	if (!m_postEffectMaterial)
@@ -107,18 +113,19 @@ void PostProcessNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 	}
 
 	bool bShouldRecalculateCompatibility = false;
-	for (const auto& r : m_unresolvedResourceParams)
+	for (size_t i = 0; i < m_compiledUnresolvedResourceParams.Num(); i++)
 	{
-		if (r.m_first != "color")
+		const uint32_t paramIndex = m_compiledUnresolvedResourceParams.GetIndex(i);
+		if (paramIndex != ColorParam.GetIndex())
 		{
-			RHI::RHIRenderTargetPtr rhiTexture = frameGraph->GetRenderTarget(*r.m_second);
+			RHI::RHIRenderTargetPtr rhiTexture = frameGraph->GetRenderTarget(RenderTargetParam::FromIndex(m_compiledUnresolvedResourceParams.GetValue(i)));
 			RHITexturePtr target = rhiTexture;
 			if (RHI::IsDepthStencilFormat(rhiTexture->GetFormat()))
 			{
 				target = rhiTexture->GetDepthAspect();
 			}
 
-			driver->UpdateShaderBinding(m_shaderBindings, r.First(), target);
+			driver->UpdateShaderBinding(m_shaderBindings, FrameGraphParam::GetName(paramIndex), target);
 			bShouldRecalculateCompatibility = true;
 		}
 	}
@@ -11,6 +11,17 @@
 using namespace Sailor;
 using namespace Sailor::RHI;
 
+namespace
+{
+	const SamplerParam IrradianceCubemapParam("g_irradianceCubemap");
+	const SamplerParam BrdfSamplerParam("g_brdfSampler");
+	const SamplerParam EnvCubemapParam("g_envCubemap");
+	const RenderTargetParam AOParam("g_AO");
+}
+
+const RenderTargetParam RHIFrameGraph::BackBuffer("BackBuffer");
+const RenderTargetParam RHIFrameGraph::DepthBuffer("DepthBuffer");
+
 void RHIFrameGraph::Clear()
 {
 	m_samplers.Clear();
@@ -18,6 +29,7 @@ void RHIFrameGraph::Clear()
 	m_values.Clear();
 	m_renderTargets.Clear();
 	m_surfaces.Clear();
+	m_recordingSchedule.Clear();
 }
 
 FrameGraphNodePtr RHIFrameGraph::GetGraphNode(const std::string& tag)
@@ -33,17 +45,34 @@ FrameGraphNodePtr RHIFrameGraph::GetGraphNode(const std::string& tag)
 
 void RHIFrameGraph::SetSampler(const std::string& name, RHI::RHITexturePtr sampler)
 {
-	m_samplers[name] = sampler;
+	m_samplers.Set(FrameGraphParam::Register(name), sampler);
 }
 
 void RHIFrameGraph::SetRenderTarget(const std::string& name, RHI::RHIRenderTargetPtr sampler)
 {
-	m_renderTargets[name] = sampler;
+	m_renderTargets.Set(FrameGraphParam::Register(name), sampler);
+}
+
+void RHIFrameGraph::SetRenderTarget(const RenderTargetParam& param, RHI::RHIRenderTargetPtr renderTarget)
+{
+	m_renderTargets.Set(param.GetIndex(), renderTarget);
 }
 
 void RHIFrameGraph::SetSurface(const std::string& name, RHI::RHISurfacePtr surface)
 {
-	m_surfaces[name] = surface;
+	m_surfaces.Set(FrameGraphParam::Register(name), surface);
+}
+
+void RHIFrameGraph::Compile()
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	for (auto& node : m_graph)
+	{
+		node->Compile();
+	}
+
+	m_recordingSchedule.Clear();
 }
 
 void RHIFrameGraph::FillFrameData(RHI::RHICommandListPtr transferCmdList, RHI::RHISceneViewSnapshot& snapshot, float deltaTime, float worldTime) const
@@ -74,6 +103,22 @@ void RHIFrameGraph::FillFrameData(RHI::RHICommandListPtr transferCmdList, RHI::R
 	RHI::Renderer::GetDriverCommands()->UpdateShaderBinding(transferCmdList, snapshot.m_frameBindings->GetOrAddShaderBinding("frameData"), &frameData, sizeof(frameData));
 }
 
+void RHIFrameGraph::BuildRecordingSchedule()
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	auto frameRefPtr = this->ToRefPtr<RHIFrameGraph>();
+
+	m_recordingSchedule.Clear();
+
+	TVector<Framegraph::FrameGraphRecordingSchedule::Access> accesses;
+	for (auto& node : m_graph)
+	{
+		node->GetResourceAccesses(frameRefPtr, accesses);
+		m_recordingSchedule.AddNode(accesses, node->CanRecordInSecondaryCommandList());
+	}
+}
+
 TVector<Sailor::Tasks::TaskPtr<void, void>> RHIFrameGraph::Prepare(RHI::RHISceneViewPtr rhiSceneView)
 {
 	TVector<Sailor::Tasks::TaskPtr<void, void>> res;
@@ -128,7 +173,7 @@ void RHIFrameGraph::Process(RHI::RHISceneViewPtr rhiSceneView,
 	}
 
 	bool bShouldRecalculateCompatibility = false;
-	if (auto g_irradianceCubemap = GetSampler("g_irradianceCubemap"))
+	if (auto g_irradianceCubemap = GetSampler(IrradianceCubemapParam))
 	{
 		if (g_irradianceCubemap != rhiSceneView->m_rhiLightsData->GetOrAddShaderBinding("g_irradianceCubemap")->GetTextureBinding())
 		{
@@ -137,7 +182,7 @@ void RHIFrameGraph::Process(RHI::RHISceneViewPtr rhiSceneView,
 		}
 	}
 
-	if (auto g_brdfSampler = GetSampler("g_brdfSampler"))
+	if (auto g_brdfSampler = GetSampler(BrdfSamplerParam))
 	{
 		if (g_brdfSampler != rhiSceneView->m_rhiLightsData->GetOrAddShaderBinding("g_brdfSampler")->GetTextureBinding())
 		{
@@ -146,7 +191,7 @@ void RHIFrameGraph::Process(RHI::RHISceneViewPtr rhiSceneView,
 		}
 	}
 
-	if (auto g_envCubemap = GetSampler("g_envCubemap"))
+	if (auto g_envCubemap = GetSampler(EnvCubemapParam))
 	{
 		if (g_envCubemap != rhiSceneView->m_rhiLightsData->GetOrAddShaderBinding("g_envCubemap")->GetTextureBinding())
 		{
@@ -156,7 +201,7 @@ void RHIFrameGraph::Process(RHI::RHISceneViewPtr rhiSceneView,
 	}
 
 	// TODO: Move to another place
-	if (auto g_aoSampler = GetRenderTarget("g_AO"))
+	if (auto g_aoSampler = GetRenderTarget(AOParam))
 	{
 		if (g_aoSampler != rhiSceneView->m_rhiLightsData->GetOrAddShaderBinding("g_aoSampler")->GetTextureBinding())
 		{
@@ -170,6 +215,12 @@ void RHIFrameGraph::Process(RHI::RHISceneViewPtr rhiSceneView,
 		rhiSceneView->m_rhiLightsData->RecalculateCompatibility();
 	}
 
+	if (m_bParallelRecording)
+	{
+		// The unresolved render targets (BackBuffer, DepthBuffer) could be changed every frame
+		BuildRecordingSchedule();
+	}
+
 	for (auto& snapshot : rhiSceneView->m_snapshots)
 	{
 		SAILOR_PROFILE_BLOCK("FrameGraph");
@@ -198,9 +249,112 @@ void RHIFrameGraph::Process(RHI::RHISceneViewPtr rhiSceneView,
 		tasks.Reserve(2);
 
 		auto frameRefPtr = this->ToRefPtr<RHIFrameGraph>();
-		for (auto& node : m_graph)
+
+		TVector<RHI::RHICommandListPtr> nodeCommandLists;
+		TVector<RHI::RHICommandListPtr> nodeTransferCommandLists;
+		TVector<Tasks::ITaskPtr> recordingTasks;
+
+		// Records the node in its own secondary command lists, the recording tasks reference it until they are stitched
+		auto recordNode = [&](uint32_t i)
+			{
+				auto& node = m_graph[i];
+
+				auto nodeCmdList = driver->CreateCommandList(true, RHI::ECommandListQueue::Graphics);
+				auto nodeTransferCmdList = driver->CreateCommandList(true, RHI::ECommandListQueue::Compute);
+
+				driver->SetDebugName(nodeCmdList, "FrameGraph:" + node->GetTag());
+				driver->SetDebugName(nodeTransferCmdList, "FrameGraph:Transfer:" + node->GetTag());
+
+				driverCommands->BeginCommandList(nodeCmdList, true);
+				driverCommands->BeginCommandList(nodeTransferCmdList, true);
+
+				node->Process(frameRefPtr, nodeTransferCmdList, nodeCmdList, snapshot);
+
+				driverCommands->EndCommandList(nodeCmdList);
+				driverCommands->EndCommandList(nodeTransferCmdList);
+
+				nodeCommandLists[i] = std::move(nodeCmdList);
+				nodeTransferCommandLists[i] = std::move(nodeTransferCmdList);
+			};
+
+		if (m_bParallelRecording)
+		{
+			SAILOR_PROFILE_BLOCK("Create recording tasks");
+
+			nodeCommandLists.Resize(m_graph.Num());
+			nodeTransferCommandLists.Resize(m_graph.Num());
+			recordingTasks.Resize(m_graph.Num());
+
+			// The nodes that set the samplers or mark the other nodes dirty are recorded in order before the tasks start,
+			// so the frame graph state is not changed while the other nodes are recorded
+			for (uint32_t i = 0; i < m_graph.Num(); i++)
+			{
+				if (m_recordingSchedule.IsRecordedInSecondaryCommandList(i) && m_graph[i]->ChangesFrameGraphState())
+				{
+					recordNode(i);
+				}
+			}
+
+			for (uint32_t i = 0; i < m_graph.Num(); i++)
+			{
+				if (!m_recordingSchedule.IsRecordedInSecondaryCommandList(i) || m_graph[i]->ChangesFrameGraphState())
+				{
+					continue;
+				}
+
+				recordingTasks[i] = Tasks::CreateTask("Record FrameGraph node in secondary command list",
+					[&recordNode, i = i]() { recordNode(i); });
+
+				recordingTasks[i]->Run();
+			}
+
+			SAILOR_PROFILE_END_BLOCK();
+		}
+
+		for (uint32_t i = 0; i < m_graph.Num(); i++)
 		{
-			node->Process(frameRefPtr, transferCmdList, cmdList, snapshot);
+			auto& node = m_graph[i];
+
+			if (!m_bParallelRecording)
+			{
+				node->Process(frameRefPtr, transferCmdList, cmdList, snapshot);
+			}
+			else
+			{
+				// The nodes keep the layout transitions, so only the memory between the dependent nodes is synced
+				if (m_recordingSchedule.NeedsBarrier(i))
+				{
+					driverCommands->MemoryBarrier(cmdList,
+						(EAccessFlags)EAccessBit::MemoryWrite_Bit,
+						(EAccessFlags)EAccessBit::MemoryRead_Bit | (EAccessFlags)EAccessBit::MemoryWrite_Bit);
+				}
+
+				if (m_recordingSchedule.IsRecordedInSecondaryCommandList(i))
+				{
+					SAILOR_PROFILE_BLOCK("Stitch secondary command lists");
+
+					if (recordingTasks[i].IsValid())
+					{
+						recordingTasks[i]->Wait();
+					}
+
+					if (nodeTransferCommandLists[i]->GetNumRecordedCommands() > 0)
+					{
+						driverCommands->ExecuteSecondaryCommandList(transferCmdList, nodeTransferCommandLists[i]);
+					}
+
+					if (nodeCommandLists[i]->GetNumRecordedCommands() > 0)
+					{
+						driverCommands->ExecuteSecondaryCommandList(cmdList, nodeCommandLists[i]);
+					}
+
+					SAILOR_PROFILE_END_BLOCK();
+				}
+				else
+				{
+					node->Process(frameRefPtr, transferCmdList, cmdList, snapshot);
+				}
+			}
 
 			const uint32_t numRecordedCommands = transferCmdList->GetNumRecordedCommands() + cmdList->GetNumRecordedCommands();
 			const uint32_t gpuCost = transferCmdList->GetGPUCost() + cmdList->GetGPUCost();
@@ -294,30 +448,33 @@ void RHIFrameGraph::Process(RHI::RHISceneViewPtr rhiSceneView,
 
 RHI::RHITexturePtr RHIFrameGraph::GetSampler(const std::string& name)
 {
-	if (!m_samplers.ContainsKey(name))
-	{
-		return RHITexturePtr();
-	}
-
-	return m_samplers[name];
+	return GetSampler(SamplerParam::FromIndex(FrameGraphParam::Find(name)));
 }
 
 RHI::RHIRenderTargetPtr RHIFrameGraph::GetRenderTarget(const std::string& name)
 {
-	if (!m_renderTargets.ContainsKey(name))
-	{
-		return nullptr;
-	}
-
-	return m_renderTargets[name];
+	return GetRenderTarget(RenderTargetParam::FromIndex(FrameGraphParam::Find(name)));
 }
 
 RHI::RHISurfacePtr RHIFrameGraph::GetSurface(const std::string& name)
 {
-	if (!m_surfaces.ContainsKey(name))
-	{
-		return nullptr;
-	}
+	return GetSurface(SurfaceParam::FromIndex(FrameGraphParam::Find(name)));
+}
+
+RHI::RHITexturePtr RHIFrameGraph::GetSampler(const SamplerParam& param) const
+{
+	const RHI::RHITexturePtr* sampler = m_samplers.Find(param.GetIndex());
+	return sampler ? *sampler : RHITexturePtr();
+}
+
+RHI::RHIRenderTargetPtr RHIFrameGraph::GetRenderTarget(const RenderTargetParam& param) const
+{
+	const RHI::RHIRenderTargetPtr* renderTarget = m_renderTargets.Find(param.GetIndex());
+	return renderTarget ? *renderTarget : nullptr;
+}
 
-	return m_surfaces[name];
-}
\ No newline at end of file
+RHI::RHISurfacePtr RHIFrameGraph::GetSurface(const SurfaceParam& param) const
+{
+	const RHI::RHISurfacePtr* surface = m_surfaces.Find(param.GetIndex());
+	return surface ? *surface : nullptr;
+}
@@ -18,6 +18,10 @@ namespace Sailor::RHI
 		const uint32_t MaxRecordedCommands = 350;
 		const uint32_t MaxGpuCost = 650;
 
+		// The per frame render targets that are set by the renderer
+		SAILOR_API static const RenderTargetParam BackBuffer;
+		SAILOR_API static const RenderTargetParam DepthBuffer;
+
 		SAILOR_API RHIFrameGraph() = default;
 		SAILOR_API virtual ~RHIFrameGraph() = default;
 
@@ -32,6 +36,12 @@ namespace Sailor::RHI
 		SAILOR_API RHI::RHIRenderTargetPtr GetRenderTarget(const std::string& name);
 		SAILOR_API RHI::RHISurfacePtr GetSurface(const std::string& name);
 
+		SAILOR_API void SetRenderTarget(const RenderTargetParam& param, RHI::RHIRenderTargetPtr renderTarget);
+
+		SAILOR_API RHI::RHITexturePtr GetSampler(const SamplerParam& param) const;
+		SAILOR_API RHI::RHIRenderTargetPtr GetRenderTarget(const RenderTargetParam& param) const;
+		SAILOR_API RHI::RHISurfacePtr GetSurface(const SurfaceParam& param) const;
+
 		SAILOR_API RHI::RHIMeshPtr GetFullscreenNdcQuad() { return m_postEffectPlane; }
 
 		template<typename T>
@@ -55,16 +65,27 @@ namespace Sailor::RHI
 
 		SAILOR_API void Clear();
 
+		// Resolves the node params to the slots, is called when the frame graph is built
+		SAILOR_API void Compile();
+
+		// The nodes are recorded in their own secondary command lists on the worker threads
+		SAILOR_API void SetParallelRecording(bool bEnabled) { m_bParallelRecording = bEnabled; }
+		SAILOR_API bool IsParallelRecording() const { return m_bParallelRecording; }
+
 	protected:
 
 		void FillFrameData(RHI::RHICommandListPtr transferCmdList, RHI::RHISceneViewSnapshot& snapshot, float deltaTime, float worldTime) const;
+		void BuildRecordingSchedule();
 
-		TMap<std::string, RHI::RHITexturePtr> m_samplers;
-		TMap<std::string, RHI::RHIRenderTargetPtr> m_renderTargets;
-		TMap<std::string, RHI::RHISurfacePtr> m_surfaces;
+		TFrameGraphParamSlots<RHI::RHITexturePtr> m_samplers;
+		TFrameGraphParamSlots<RHI::RHIRenderTargetPtr> m_renderTargets;
+		TFrameGraphParamSlots<RHI::RHISurfacePtr> m_surfaces;
 		TMap<std::string, glm::vec4> m_values;
 		TVector<Framegraph::FrameGraphNodePtr> m_graph;
 
+		bool m_bParallelRecording = false;
+		Framegraph::FrameGraphRecordingSchedule m_recordingSchedule;
+
 		RHI::RHIMeshPtr m_postEffectPlane;
 	};
 
@@ -18,6 +18,11 @@ using namespace Sailor::Framegraph;
 const char* RenderImGuiNode::m_name = "RenderImGui";
 #endif
 
+namespace
+{
+	const ResourceParam ColorParam("color");
+}
+
 void RenderImGuiNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -26,17 +31,9 @@ void RenderImGuiNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 	auto commands = App::GetSubmodule<RHI::Renderer>()->GetDriverCommands();
 	commands->BeginDebugRegion(commandList, GetName(), DebugContext::Color_CmdDebug);
 
-	RHI::RHITexturePtr colorAttachment = GetResolvedAttachment("color");
-	for (const auto& r : m_unresolvedResourceParams)
-	{
-		if (r.First() == "color")
-		{
-			colorAttachment = frameGraph->GetRenderTarget(*r.Second());
-			break;
-		}
-	}
-
-	RHI::RHITexturePtr depthAttachment = frameGraph->GetRenderTarget("DepthBuffer");
+	RHI::RHITexturePtr colorAttachment = GetResolvedAttachment(frameGraph, ColorParam);
+
+	RHI::RHITexturePtr depthAttachment = frameGraph->GetRenderTarget(RHIFrameGraph::DepthBuffer);
 
 	if (!colorAttachment || !depthAttachment)
 		return;
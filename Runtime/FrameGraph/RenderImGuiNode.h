@@ -15,6 +15,7 @@ namespace Sailor::Framegraph
 
 		SAILOR_API virtual void Process(RHI::RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView) override;		
 		SAILOR_API virtual void Clear() {}
+		SAILOR_API virtual bool CanRecordInSecondaryCommandList() const override { return false; }
 
 	protected:
 
@@ -18,9 +18,19 @@ using namespace Sailor::Framegraph;
 const char* RenderSceneNode::m_name = "RenderScene";
 #endif
 
+namespace
+{
+	const StringParam SortingParam("Sorting");
+	const StringParam TagParam("Tag");
+	const StringParam GPUCullingParam("GPUCulling");
+	const ResourceParam DepthHighZParam("depthHighZ");
+	const ResourceParam ColorParam("color");
+	const ResourceParam DepthStencilParam("depthStencil");
+}
+
 RHI::ESortingOrder RenderSceneNode::GetSortingOrder() const
 {
-	const std::string& sortOrder = GetString("Sorting");
+	const std::string& sortOrder = GetString(SortingParam);
 
 	if (!sortOrder.empty())
 	{
@@ -34,7 +44,7 @@ Tasks::TaskPtr<void, void> RenderSceneNode::Prepare(RHI::RHIFrameGraphPtr frameG
 {
 	SAILOR_PROFILE_FUNCTION();
 
-	const std::string QueueTag = GetString("Tag");
+	const std::string QueueTag = GetString(TagParam);
 	const size_t QueueTagHash = GetHash(QueueTag);
 
 	Tasks::TaskPtr res = Tasks::CreateTask("Prepare RenderSceneNode  " + std::to_string(sceneView.m_frame),
@@ -111,10 +121,10 @@ void RenderSceneNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 	m_syncSharedResources.Lock();
 
 	std::string temp;
-	TryGetString("GPUCulling", temp);
+	TryGetString(GPUCullingParam, temp);
 	const bool bGpuCullingEnabled = temp == "true";
 
-	const std::string QueueTag = GetString("Tag");
+	const std::string QueueTag = GetString(TagParam);
 
 	auto scheduler = App::GetSubmodule<Tasks::Scheduler>();
 	auto& driver = App::GetSubmodule<RHI::Renderer>()->GetDriver();
@@ -132,7 +142,7 @@ void RenderSceneNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 
 		if (!m_computeMeshCullingBindings.IsValid())
 		{
-			auto depthHighZ = GetResolvedAttachment("depthHighZ").StaticCast<RHI::RHITexture>();
+			auto depthHighZ = GetResolvedAttachment(DepthHighZParam).StaticCast<RHI::RHITexture>();
 			m_computeMeshCullingBindings = driver->CreateShaderBindings();
 			driver->AddSamplerToShaderBindings(m_computeMeshCullingBindings, "depthHighZ", depthHighZ, 0);
 		}
@@ -159,11 +169,11 @@ void RenderSceneNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPt
 	TVector<PerInstanceData> gpuMatricesData;
 	gpuMatricesData.AddDefault(m_numMeshes);
 
-	RHI::RHISurfacePtr colorAttachment = GetRHIResource("color").DynamicCast<RHI::RHISurface>();
-	RHI::RHITexturePtr depthAttachment = GetRHIResource("depthStencil").DynamicCast<RHI::RHITexture>();
+	RHI::RHISurfacePtr colorAttachment = GetRHIResource(ColorParam).DynamicCast<RHI::RHISurface>();
+	RHI::RHITexturePtr depthAttachment = GetRHIResource(DepthStencilParam).DynamicCast<RHI::RHITexture>();
 	if (!depthAttachment)
 	{
-		depthAttachment = frameGraph->GetRenderTarget("DepthBuffer");
+		depthAttachment = frameGraph->GetRenderTarget(RHIFrameGraph::DepthBuffer);
 	}
 
 	if (!colorAttachment)
@@ -37,6 +37,7 @@ namespace Sailor::Framegraph
 		SAILOR_API virtual Sailor::Tasks::TaskPtr<void, void> Prepare(RHI::RHIFrameGraphPtr frameGraph, const RHI::RHISceneViewSnapshot& sceneView);
 		SAILOR_API virtual void Process(RHI::RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandLists, const RHI::RHISceneViewSnapshot& sceneView) override;
 		SAILOR_API virtual void Clear() override;
+		SAILOR_API virtual bool CanRecordInSecondaryCommandList() const override { return false; }
 		SAILOR_API RHI::ESortingOrder GetSortingOrder() const;
 
 	protected:
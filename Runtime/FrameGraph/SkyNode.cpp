@@ -23,6 +23,14 @@ using namespace Sailor::Framegraph;
 const char* SkyNode::m_name = "Sky";
 #endif
 
+namespace
+{
+	const ResourceParam ColorParam("color");
+	const SamplerParam SkyCubemapParam("g_skyCubemap");
+	const SamplerParam DitherPatternSamplerParam("g_ditherPatternSampler");
+	const SamplerParam NoiseSamplerParam("g_noiseSampler");
+}
+
 glm::vec3 SkyNode::s_rgbTemperatures[s_maxRgbTemperatures];
 
 using TParseRes = TPair<TVector<VertexP3C4>, TVector<uint32_t>>;
@@ -210,6 +218,13 @@ void SkyNode::SetLocation(float latitudeDegrees, float longitudeDegrees)
 	m_starsModelView = glm::toMat4(precession);
 }
 
+void SkyNode::GetSamplerAccesses(TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const
+{
+	outAccesses.Add({ GetSamplerResourceId(DitherPatternSamplerParam), false });
+	outAccesses.Add({ GetSamplerResourceId(NoiseSamplerParam), false });
+	outAccesses.Add({ GetSamplerResourceId(SkyCubemapParam), true });
+}
+
 void SkyNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transferCommandList, RHI::RHICommandListPtr commandList, const RHI::RHISceneViewSnapshot& sceneView)
 {
 	auto& driver = App::GetSubmodule<RHI::Renderer>()->GetDriver();
@@ -432,10 +447,10 @@ void SkyNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transf
 		driver->AddSamplerToShaderBindings(m_pShaderBindings, "cloudsNoiseHighSampler", m_pCloudsNoiseHighTexture, 5);
 		driver->AddSamplerToShaderBindings(m_pShaderBindings, "cloudsSampler", m_pCloudsTexture, 6);
 
-		auto ditherPattern = frameGraph->GetSampler("g_ditherPatternSampler");
+		auto ditherPattern = frameGraph->GetSampler(DitherPatternSamplerParam);
 		driver->AddSamplerToShaderBindings(m_pShaderBindings, "g_ditherPatternSampler", ditherPattern, 7);
 
-		auto noise = frameGraph->GetSampler("g_noiseSampler");
+		auto noise = frameGraph->GetSampler(NoiseSamplerParam);
 		driver->AddSamplerToShaderBindings(m_pShaderBindings, "g_noiseSampler", noise, 8);
 
 		auto linearDepth = GetResolvedAttachment("linearDepth");
@@ -520,8 +535,8 @@ void SkyNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transf
 		m_pStarsMaterial = driver->CreateMaterial(vertexDescription, EPrimitiveTopology::PointList, renderState, m_pStarsShader);
 	}
 
-	RHI::RHITexturePtr target = GetResolvedAttachment("color");
-	RHI::RHIRenderTargetPtr depthAttachment = frameGraph->GetRenderTarget("DepthBuffer");
+	RHI::RHITexturePtr target = GetResolvedAttachment(ColorParam);
+	RHI::RHIRenderTargetPtr depthAttachment = frameGraph->GetRenderTarget(RHIFrameGraph::DepthBuffer);
 	const auto depthAttachmentLayout = RHI::IsDepthStencilFormat(depthAttachment->GetFormat()) ? EImageLayout::DepthStencilAttachmentOptimal : EImageLayout::DepthAttachmentOptimal;
 
 	auto mesh = frameGraph->GetFullscreenNdcQuad();
@@ -749,7 +764,7 @@ void SkyNode::Process(RHIFrameGraphPtr frameGraph, RHI::RHICommandListPtr transf
 
 	if (m_bIsDirty)
 	{
-		RHI::RHICubemapPtr cubemap = frameGraph->GetSampler("g_skyCubemap").DynamicCast<RHICubemap>();
+		RHI::RHICubemapPtr cubemap = frameGraph->GetSampler(SkyCubemapParam).DynamicCast<RHICubemap>();
 
 		if (!cubemap)
 		{
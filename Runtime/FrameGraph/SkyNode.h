@@ -98,6 +98,10 @@ namespace Sailor::Framegraph
 
 		SAILOR_API virtual void Clear() override;
 
+		// Sets g_skyCubemap and marks the Environment node dirty
+		SAILOR_API virtual bool ChangesFrameGraphState() const override { return true; }
+		SAILOR_API virtual void GetSamplerAccesses(TVector<FrameGraphRecordingSchedule::Access>& outAccesses) const override;
+
 		SAILOR_API RHI::RHIShaderBindingSetPtr GetShaderBindings() { return m_pShaderBindings; }
 		SAILOR_API void SetLocation(float latitudeDegrees, float longitudeDegrees);
 		SAILOR_API void MarkDirty() { m_bIsDirty = true;  m_updateEnvCubemapPattern = 0; }
@@ -0,0 +1,895 @@
+#include "NullGraphicsDriver.h"
+#include "RHI/Texture.h"
+#include "RHI/RenderTarget.h"
+#include "RHI/Cubemap.h"
+#include "RHI/Surface.h"
+#include "RHI/Fence.h"
+#include "RHI/Mesh.h"
+#include "RHI/Buffer.h"
+#include "RHI/Material.h"
+#include "RHI/Shader.h"
+#include "RHI/VertexDescription.h"
+#include "RHI/CommandList.h"
+#include "RHI/Types.h"
+#include "AssetRegistry/Shader/ShaderCompiler.h"
+
+#ifdef SAILOR_BUILD_WITH_NULL_RHI
+
+using namespace Sailor;
+using namespace Sailor::GraphicsDriver::Null;
+
+namespace
+{
+	template<typename TTexture>
+	TRefPtr<TTexture> CreateTextureHandle(glm::ivec2 extent,
+		uint32_t mipLevels,
+		RHI::ETextureFormat format,
+		RHI::ETextureFiltration filtration,
+		RHI::ETextureClamping clamping,
+		RHI::EImageLayout layout,
+		RHI::ESamplerReductionMode reduction = RHI::ESamplerReductionMode::Average)
+	{
+		TRefPtr<TTexture> res = TRefPtr<TTexture>::Make(filtration, clamping, mipLevels > 1, layout, reduction);
+
+		res->m_null.m_bIsNullResource = true;
+		res->m_null.m_format = format;
+		res->m_null.m_extent = extent;
+
+		for (uint32_t i = 0; i < mipLevels; i++)
+		{
+			const size_t width = std::max(1, extent.x >> i);
+			const size_t height = std::max(1, extent.y >> i);
+
+			res->m_null.m_size += (width * height * RHI::GetBitsPerPixel(format)) / 8;
+		}
+
+		return res;
+	}
+
+	RHI::EImageLayout GetRenderTargetLayout(RHI::ETextureUsageFlags usage)
+	{
+		if (usage & RHI::ETextureUsageBit::Storage_Bit)
+		{
+			return RHI::EImageLayout::General;
+		}
+		else if (usage & RHI::ETextureUsageBit::ColorAttachment_Bit)
+		{
+			return RHI::EImageLayout::ColorAttachmentOptimal;
+		}
+		else if (usage & RHI::ETextureUsageBit::DepthStencilAttachment_Bit)
+		{
+			return RHI::EImageLayout::DepthStencilAttachmentOptimal;
+		}
+
+		return RHI::EImageLayout::ShaderReadOnlyOptimal;
+	}
+
+	struct ImageBarrierArgs
+	{
+		RHI::RHITexture* m_pImage;
+		RHI::EImageLayout m_oldLayout;
+		RHI::EImageLayout m_newLayout;
+	};
+
+	struct RenderPassArgs
+	{
+		glm::ivec4 m_renderArea;
+		glm::ivec2 m_offset;
+		glm::vec4 m_clearColor;
+		float m_clearDepth;
+		uint32_t m_numColorAttachments;
+		bool m_bClearRenderTargets;
+		bool m_bStoreDepth;
+	};
+
+	struct DrawIndexedArgs
+	{
+		uint32_t m_indexCount;
+		uint32_t m_instanceCount;
+		uint32_t m_firstIndex;
+		uint32_t m_vertexOffset;
+		uint32_t m_firstInstance;
+	};
+
+	struct BlitImageArgs
+	{
+		glm::ivec4 m_srcRegionRect;
+		glm::ivec4 m_dstRegionRect;
+	};
+
+	struct UpdateBufferArgs
+	{
+		RHI::RHIBuffer* m_pBuffer;
+		size_t m_size;
+		size_t m_offset;
+	};
+}
+
+void NullGraphicsDriver::Initialize(Win32::Window* pViewport, RHI::EMsaaSamples msaaSamples, bool bIsDebug)
+{
+	// MSAA is not emulated, the surfaces are never resolved
+	const glm::ivec2 extent = pViewport ? glm::ivec2(pViewport->GetWidth(), pViewport->GetHeight()) : glm::ivec2(1920, 1080);
+
+	// There is no swapchain, the render area matches the back buffer
+	if (pViewport)
+	{
+		pViewport->SetRenderArea(extent);
+	}
+
+	m_backBuffer = CreateTextureHandle<RHI::RHIRenderTarget>(extent, 1, RHI::EFormat::B8G8R8A8_SRGB, RHI::ETextureFiltration::Linear, RHI::ETextureClamping::Repeat, RHI::EImageLayout::PresentSrc);
+
+	m_depthStencilBuffer = CreateTextureHandle<RHI::RHIRenderTarget>(extent, 1, RHI::EFormat::D32_SFLOAT_S8_UINT, RHI::ETextureFiltration::Linear, RHI::ETextureClamping::Repeat, RHI::EImageLayout::DepthStencilAttachmentOptimal);
+	m_depthStencilBuffer->m_depthAspect = CreateTextureHandle<RHI::RHITexture>(extent, 1, RHI::EFormat::D32_SFLOAT_S8_UINT, RHI::ETextureFiltration::Linear, RHI::ETextureClamping::Repeat, RHI::EImageLayout::DepthStencilAttachmentOptimal);
+	m_depthStencilBuffer->m_stencilAspect = CreateTextureHandle<RHI::RHITexture>(extent, 1, RHI::EFormat::D32_SFLOAT_S8_UINT, RHI::ETextureFiltration::Linear, RHI::ETextureClamping::Repeat, RHI::EImageLayout::DepthStencilAttachmentOptimal);
+
+	m_defaultTexture = CreateTextureHandle<RHI::RHITexture>(glm::ivec2(1, 1), 1, RHI::EFormat::R8G8B8A8_SRGB, RHI::ETextureFiltration::Linear, RHI::ETextureClamping::Repeat, RHI::EImageLayout::ShaderReadOnlyOptimal);
+}
+
+void NullGraphicsDriver::BeginConditionalDestroy()
+{
+	m_temporaryRenderTargets.Clear();
+	m_backBuffer.Clear();
+	m_depthStencilBuffer.Clear();
+	m_defaultTexture.Clear();
+
+	TrackResources_ThreadSafe();
+
+	m_trackedFences.Clear();
+}
+
+bool NullGraphicsDriver::PresentFrame(const class FrameState& state, const TVector<RHI::RHICommandListPtr>& primaryCommandBuffers, const TVector<RHI::RHISemaphorePtr>& waitSemaphores) const
+{
+	return true;
+}
+
+void NullGraphicsDriver::SubmitCommandList(RHI::RHICommandListPtr commandList, RHI::RHIFencePtr fence, RHI::RHISemaphorePtr signalSemaphore, RHI::RHISemaphorePtr waitSemaphore)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	m_numSubmittedCommandBuffers++;
+
+	if (fence)
+	{
+		// There is no device, so the command list is finished right after the submit
+		fence->m_null.m_bIsNullResource = true;
+		fence->m_null.m_bIsSignaled = true;
+		fence->AddDependency(commandList);
+
+		TrackPendingCommandList_ThreadSafe(fence);
+	}
+}
+
+RHI::RHISemaphorePtr NullGraphicsDriver::CreateWaitSemaphore()
+{
+	return RHI::RHISemaphorePtr::Make();
+}
+
+RHI::RHICommandListPtr NullGraphicsDriver::CreateCommandList(bool bIsSecondary, RHI::ECommandListQueue queue)
+{
+	RHI::RHICommandListPtr cmdList = RHI::RHICommandListPtr::Make(queue);
+	cmdList->m_null.m_bIsSecondary = bIsSecondary;
+
+	return cmdList;
+}
+
+RHI::RHIBufferPtr NullGraphicsDriver::CreateBuffer(size_t size, RHI::EBufferUsageFlags usage, RHI::EMemoryPropertyFlags properties)
+{
+	RHI::RHIBufferPtr res = RHI::RHIBufferPtr::Make(usage, properties);
+	res->m_null.m_bIsNullResource = true;
+	res->m_null.m_memory.Resize(size);
+
+	return res;
+}
+
+RHI::RHIBufferPtr NullGraphicsDriver::CreateBuffer(RHI::RHICommandListPtr& cmdList, const void* pData, size_t size, RHI::EBufferUsageFlags usage, RHI::EMemoryPropertyFlags properties)
+{
+	RHI::RHIBufferPtr res = CreateBuffer(size, usage, properties);
+	UpdateBuffer(cmdList, res, pData, size);
+
+	return res;
+}
+
+RHI::RHIBufferPtr NullGraphicsDriver::CreateIndirectBuffer(size_t size)
+{
+	const uint32_t usage = RHI::EBufferUsageBit::IndirectBuffer_Bit | RHI::EBufferUsageBit::StorageBuffer_Bit | RHI::EBufferUsageBit::BufferTransferDst_Bit | RHI::EBufferUsageBit::BufferTransferSrc_Bit;
+	const RHI::EMemoryPropertyFlags properties = RHI::EMemoryPropertyBit::HostCoherent | RHI::EMemoryPropertyBit::HostVisible;
+
+	return CreateBuffer(size, usage, properties);
+}
+
+RHI::RHIShaderPtr NullGraphicsDriver::CreateShader(RHI::EShaderStage shaderStage, const RHI::ShaderByteCode& shaderSpirv)
+{
+	return RHI::RHIShaderPtr::Make(shaderStage);
+}
+
+RHI::RHIBufferPtr NullGraphicsDriver::CreateBuffer_Immediate(const void* pData, size_t size, RHI::EBufferUsageFlags usage)
+{
+	RHI::RHIBufferPtr res = CreateBuffer(size, usage, RHI::EMemoryPropertyBit::DeviceLocal);
+
+	if (pData)
+	{
+		memcpy(res->m_null.m_memory.GetData(), pData, size);
+	}
+
+	return res;
+}
+
+void NullGraphicsDriver::CopyBuffer_Immediate(RHI::RHIBufferPtr src, RHI::RHIBufferPtr dst, size_t size)
+{
+	memcpy(dst->m_null.m_memory.GetData(), src->m_null.m_memory.GetData(), size);
+}
+
+RHI::RHITexturePtr NullGraphicsDriver::CreateImage_Immediate(
+	const void* pData,
+	size_t size,
+	glm::ivec3 extent,
+	uint32_t mipLevels,
+	RHI::ETextureType type,
+	RHI::ETextureFormat format,
+	RHI::ETextureFiltration filtration,
+	RHI::ETextureClamping clamping,
+	RHI::ETextureUsageFlags usage)
+{
+	return CreateTextureHandle<RHI::RHITexture>(glm::ivec2(extent.x, extent.y), mipLevels, format, filtration, clamping, RHI::EImageLayout::ShaderReadOnlyOptimal);
+}
+
+RHI::RHITexturePtr NullGraphicsDriver::CreateTexture(
+	const void* pData,
+	size_t size,
+	glm::ivec3 extent,
+	uint32_t mipLevels,
+	RHI::ETextureType type,
+	RHI::ETextureFormat format,
+	RHI::ETextureFiltration filtration,
+	RHI::ETextureClamping clamping,
+	RHI::ETextureUsageFlags usage,
+	RHI::ESamplerReductionMode reduction)
+{
+	const RHI::EImageLayout layout = (usage & RHI::ETextureUsageBit::Storage_Bit) ? RHI::EImageLayout::General : RHI::EImageLayout::ShaderReadOnlyOptimal;
+
+	return CreateTextureHandle<RHI::RHITexture>(glm::ivec2(extent.x, extent.y), mipLevels, format, filtration, clamping, layout, reduction);
+}
+
+RHI::RHICubemapPtr NullGraphicsDriver::CreateCubemap(
+	glm::ivec2 extent,
+	uint32_t mipLevels,
+	RHI::ETextureFormat format,
+	RHI::ETextureFiltration filtration,
+	RHI::ETextureClamping clamping,
+	RHI::ETextureUsageFlags usage,
+	RHI::ESamplerReductionMode reduction)
+{
+	const RHI::EImageLayout layout = (usage & RHI::ETextureUsageBit::Storage_Bit) ? RHI::EImageLayout::General : RHI::EImageLayout::ShaderReadOnlyOptimal;
+
+	RHI::RHICubemapPtr outCubemap = CreateTextureHandle<RHI::RHICubemap>(extent, mipLevels, format, filtration, clamping, layout, reduction);
+	outCubemap->m_null.m_size *= 6;
+
+	for (uint32_t i = 0; i < mipLevels; i++)
+	{
+		const glm::ivec2 mipExtent = glm::max(glm::ivec2(1, 1), glm::ivec2(extent.x >> i, extent.y >> i));
+
+		RHI::RHICubemapPtr res = outCubemap;
+		if (i > 0)
+		{
+			res = CreateTextureHandle<RHI::RHICubemap>(mipExtent, 1, format, filtration, clamping, layout, reduction);
+			outCubemap->m_mipLevels.Add(res);
+		}
+
+		for (uint32_t face = 0; face < 6; face++)
+		{
+			res->m_faces.Emplace(CreateTextureHandle<RHI::RHITexture>(mipExtent, 1, format, filtration, clamping, layout, reduction));
+		}
+	}
+
+	return outCubemap;
+}
+
+RHI::RHIRenderTargetPtr NullGraphicsDriver::CreateRenderTarget(
+	glm::ivec2 extent,
+	uint32_t mipLevels,
+	RHI::ETextureFormat format,
+	RHI::ETextureFiltration filtration,
+	RHI::ETextureClamping clamping,
+	RHI::ETextureUsageFlags usage,
+	RHI::ESamplerReductionMode reduction)
+{
+	RHI::RHICommandListPtr cmdList = CreateCommandList(false, RHI::ECommandListQueue::Graphics);
+	BeginCommandList(cmdList, true);
+
+	RHI::RHIRenderTargetPtr outTexture = CreateRenderTarget(cmdList, extent, mipLevels, format, filtration, clamping, usage, reduction);
+
+	EndCommandList(cmdList);
+	SubmitCommandList(cmdList);
+
+	return outTexture;
+}
+
+RHI::RHIRenderTargetPtr NullGraphicsDriver::CreateRenderTarget(
+	RHI::RHICommandListPtr cmdList,
+	glm::ivec2 extent,
+	uint32_t mipLevels,
+	RHI::ETextureFormat format,
+	RHI::ETextureFiltration filtration,
+	RHI::ETextureClamping clamping,
+	RHI::ETextureUsageFlags usage,
+	RHI::ESamplerReductionMode reduction)
+{
+	const RHI::EImageLayout layout = GetRenderTargetLayout(usage);
+
+	RHI::RHIRenderTargetPtr outTexture = CreateTextureHandle<RHI::RHIRenderTarget>(extent, mipLevels, format, filtration, clamping, layout, reduction);
+
+	if (RHI::IsDepthFormat(format))
+	{
+		outTexture->m_depthAspect = CreateTextureHandle<RHI::RHITexture>(extent, 1, format, filtration, clamping, layout, reduction);
+
+		if (RHI::IsDepthStencilFormat(format))
+		{
+			outTexture->m_stencilAspect = CreateTextureHandle<RHI::RHITexture>(extent, 1, format, filtration, clamping, layout, reduction);
+		}
+	}
+
+	for (uint32_t i = 0; i < mipLevels; i++)
+	{
+		const glm::ivec2 mipExtent = glm::max(glm::ivec2(1, 1), glm::ivec2(extent.x >> i, extent.y >> i));
+		outTexture->m_mipLayers.Emplace(CreateTextureHandle<RHI::RHITexture>(mipExtent, 1, format, filtration, clamping, layout, reduction));
+	}
+
+	ImageMemoryBarrier(cmdList, outTexture, format, RHI::EImageLayout::Undefined, layout);
+
+	return outTexture;
+}
+
+RHI::RHISurfacePtr NullGraphicsDriver::CreateSurface(
+	glm::ivec2 extent,
+	uint32_t mipLevels,
+	RHI::ETextureFormat format,
+	RHI::ETextureFiltration filtration,
+	RHI::ETextureClamping clamping,
+	RHI::ETextureUsageFlags usage)
+{
+	const RHI::RHIRenderTargetPtr resolved = CreateRenderTarget(extent, mipLevels, format, filtration, clamping, usage);
+
+	return RHI::RHISurfacePtr::Make(resolved, resolved, false);
+}
+
+RHI::RHIMaterialPtr NullGraphicsDriver::CreateMaterial(const RHI::RHIVertexDescriptionPtr& vertexDescription, RHI::EPrimitiveTopology topology, const RHI::RenderState& renderState, const Sailor::ShaderSetPtr& shader)
+{
+	return CreateMaterial(vertexDescription, topology, renderState, shader, CreateShaderBindings());
+}
+
+RHI::RHIMaterialPtr NullGraphicsDriver::CreateMaterial(const RHI::RHIVertexDescriptionPtr& vertexDescription, RHI::EPrimitiveTopology topology, const RHI::RenderState& renderState, const Sailor::ShaderSetPtr& shader, const RHI::RHIShaderBindingSetPtr& shaderBindigs)
+{
+#ifdef _DEBUG
+	const bool bIsDebug = true;
+#else
+	const bool bIsDebug = false;
+#endif
+
+	auto vertex = bIsDebug ? shader->GetDebugVertexShaderRHI() : shader->GetVertexShaderRHI();
+	auto fragment = bIsDebug ? shader->GetDebugFragmentShaderRHI() : shader->GetFragmentShaderRHI();
+
+	RHI::RHIMaterialPtr res = RHI::RHIMaterialPtr::Make(renderState, vertex, fragment);
+	res->SetBindings(shaderBindigs);
+
+	return res;
+}
+
+RHI::RHIShaderBindingSetPtr NullGraphicsDriver::CreateShaderBindings()
+{
+	return RHI::RHIShaderBindingSetPtr::Make();
+}
+
+bool NullGraphicsDriver::FillShadersLayout(RHI::RHIShaderBindingSetPtr& pShaderBindings, const TVector<RHI::RHIShaderPtr>& shaders, uint32_t setNum)
+{
+	// The shaders are not reflected, the layouts are filled only by the explicitly added bindings
+	return false;
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddShaderBinding(RHI::RHIShaderBindingSetPtr& pShaderBindings, const RHI::RHIShaderBindingPtr& binding, const std::string& name, uint32_t shaderBinding)
+{
+	auto& pBinding = pShaderBindings->GetOrAddShaderBinding(name);
+
+	pBinding->m_null = binding->m_null;
+	pBinding->SetTextureBindings(binding->GetTextureBindings());
+
+	RHI::ShaderLayoutBinding layout = binding->GetLayout();
+	layout.m_binding = shaderBinding;
+	layout.m_name = name;
+
+	pBinding->SetLayout(layout);
+	pShaderBindings->UpdateLayoutShaderBinding(layout);
+
+	return pBinding;
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddHostBufferToShaderBindings(RHI::RHIShaderBindingSetPtr& pShaderBindings, const std::string& name, size_t size, size_t paddedSize, uint32_t shaderBinding, RHI::EShaderBindingType bufferType)
+{
+	RHI::RHIShaderBindingPtr binding = pShaderBindings->GetOrAddShaderBinding(name);
+
+	const RHI::EBufferUsageFlags usage = bufferType == RHI::EShaderBindingType::StorageBuffer ? RHI::EBufferUsageBit::StorageBuffer_Bit : RHI::EBufferUsageBit::UniformBuffer_Bit;
+
+	binding->m_null.m_buffer = CreateBuffer(std::max(size, paddedSize), usage, RHI::EMemoryPropertyBit::HostVisible | RHI::EMemoryPropertyBit::HostCoherent);
+	binding->m_null.m_offset = 0;
+	binding->m_null.m_storageInstanceIndex = bufferType == RHI::EShaderBindingType::StorageBuffer ? m_numStorageInstances++ : 0;
+
+	const auto& layouts = pShaderBindings->GetLayoutBindings();
+	size_t index = layouts.FindIf([=](const auto& el) { return el.m_binding == shaderBinding; });
+
+	if (index == -1)
+	{
+		RHI::ShaderLayoutBinding layout;
+		layout.m_binding = shaderBinding;
+		layout.m_name = name;
+		layout.m_size = (uint32_t)size;
+		layout.m_type = bufferType;
+		layout.m_paddedSize = (uint32_t)paddedSize;
+
+		pShaderBindings->UpdateLayoutShaderBinding(layout);
+
+		binding->SetLayout(layout);
+	}
+	else
+	{
+		binding->SetLayout(layouts[index]);
+	}
+
+	return binding;
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddBufferToShaderBindings(RHI::RHIShaderBindingSetPtr& pShaderBindings, RHI::RHIBufferPtr buffer, const std::string& name, uint32_t shaderBinding)
+{
+	const auto bindingType = buffer->GetUsage() & RHI::EBufferUsageBit::StorageBuffer_Bit ? RHI::EShaderBindingType::StorageBuffer : RHI::EShaderBindingType::UniformBuffer;
+
+	RHI::RHIShaderBindingPtr binding = AddHostBufferToShaderBindings(pShaderBindings, name, buffer->GetSize(), buffer->GetSize(), shaderBinding, bindingType);
+
+	// The binding references the buffer instead of the own memory
+	binding->m_null.m_buffer = buffer;
+	binding->m_null.m_storageInstanceIndex = 0;
+
+	return binding;
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddSsboToShaderBindings(RHI::RHIShaderBindingSetPtr& pShaderBindings, const std::string& name, size_t elementSize, size_t numElements, uint32_t shaderBinding, bool bBindSsboWithOffset)
+{
+	const size_t p = 16 - elementSize % 16;
+	const size_t paddedSize = elementSize + p;
+
+	RHI::RHIShaderBindingPtr binding = AddHostBufferToShaderBindings(pShaderBindings, name, numElements * elementSize, paddedSize * numElements, shaderBinding, RHI::EShaderBindingType::StorageBuffer);
+	if (bBindSsboWithOffset)
+	{
+		binding->m_null.m_storageInstanceIndex = 0;
+	}
+
+	return binding;
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddBufferToShaderBindings(RHI::RHIShaderBindingSetPtr& pShaderBindings, const std::string& name, size_t size, uint32_t shaderBinding, RHI::EShaderBindingType bufferType)
+{
+	const size_t p = 16 - size % 16;
+	const size_t paddedSize = size + p;
+
+	return AddHostBufferToShaderBindings(pShaderBindings, name, size, paddedSize, shaderBinding, bufferType);
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddSamplerToShaderBindings(RHI::RHIShaderBindingSetPtr& pShaderBindings, const std::string& name, RHI::RHITexturePtr texture, uint32_t shaderBinding)
+{
+	return AddSamplerToShaderBindings(pShaderBindings, name, TVector<RHI::RHITexturePtr>{ texture }, shaderBinding);
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddSamplerToShaderBindings(RHI::RHIShaderBindingSetPtr& pShaderBindings, const std::string& name, const TVector<RHI::RHITexturePtr>& array, uint32_t shaderBinding)
+{
+	RHI::RHIShaderBindingPtr binding = pShaderBindings->GetOrAddShaderBinding(name);
+
+	RHI::ShaderLayoutBinding layout;
+	layout.m_binding = shaderBinding;
+	layout.m_name = name;
+	layout.m_type = RHI::EShaderBindingType::CombinedImageSampler;
+	layout.m_arrayCount = (uint32_t)array.Num();
+
+	binding->SetLayout(layout);
+	binding->SetTextureBindings(array);
+
+	pShaderBindings->UpdateLayoutShaderBinding(layout);
+
+	return binding;
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddStorageImageToShaderBindings(RHI::RHIShaderBindingSetPtr& pShaderBindings, const std::string& name, RHI::RHITexturePtr texture, uint32_t shaderBinding)
+{
+	return AddStorageImageToShaderBindings(pShaderBindings, name, TVector<RHI::RHITexturePtr>{ texture }, shaderBinding);
+}
+
+RHI::RHIShaderBindingPtr NullGraphicsDriver::AddStorageImageToShaderBindings(RHI::RHIShaderBindingSetPtr& pShaderBindings, const std::string& name, const TVector<RHI::RHITexturePtr>& array, uint32_t shaderBinding)
+{
+	RHI::RHIShaderBindingPtr binding = pShaderBindings->GetOrAddShaderBinding(name);
+
+	RHI::ShaderLayoutBinding layout;
+	layout.m_binding = shaderBinding;
+	layout.m_name = name;
+	layout.m_type = RHI::EShaderBindingType::StorageImage;
+	layout.m_arrayCount = (uint32_t)array.Num();
+
+	binding->SetLayout(layout);
+	binding->SetTextureBindings(array);
+
+	pShaderBindings->UpdateLayoutShaderBinding(layout);
+
+	return binding;
+}
+
+void NullGraphicsDriver::UpdateShaderBinding(RHI::RHIShaderBindingSetPtr bindings, const std::string& parameter, RHI::RHITexturePtr value, uint32_t dstArrayElement)
+{
+	if (!bindings->HasBinding(parameter))
+	{
+		return;
+	}
+
+	auto& binding = bindings->GetOrAddShaderBinding(parameter);
+
+	TVector<RHI::RHITexturePtr> textures = binding->GetTextureBindings();
+	if (dstArrayElement >= textures.Num())
+	{
+		textures.Resize(dstArrayElement + 1);
+	}
+
+	textures[dstArrayElement] = value;
+	binding->SetTextureBindings(textures);
+}
+
+void NullGraphicsDriver::UpdateShaderBinding_Immediate(RHI::RHIShaderBindingSetPtr bindings, const std::string& parameter, const void* value, size_t size)
+{
+	RHI::RHICommandListPtr commandList = CreateCommandList(true, RHI::ECommandListQueue::Transfer);
+
+	auto& shaderBinding = bindings->GetOrAddShaderBinding(parameter);
+	UpdateShaderBinding(commandList, shaderBinding, value, size);
+
+	SubmitCommandList_Immediate(commandList);
+}
+
+void NullGraphicsDriver::BeginDebugRegion(RHI::RHICommandListPtr cmdList, const std::string& title, const glm::vec4& color)
+{
+	Record(cmdList, ENullCommand::BeginDebugRegion, 0, color);
+}
+
+void NullGraphicsDriver::EndDebugRegion(RHI::RHICommandListPtr cmdList)
+{
+	Record(cmdList, ENullCommand::EndDebugRegion, 0);
+}
+
+void NullGraphicsDriver::RenderSecondaryCommandBuffers(RHI::RHICommandListPtr cmd,
+	TVector<RHI::RHICommandListPtr> secondaryCmds,
+	const TVector<RHI::RHITexturePtr>& colorAttachments,
+	RHI::RHITexturePtr depthStencilAttachment,
+	glm::ivec4 renderArea,
+	glm::ivec2 offset,
+	bool bClearRenderTargets,
+	glm::vec4 clearColor,
+	float clearDepth,
+	bool bSupportMultisampling,
+	bool bStoreDepth)
+{
+	BeginRenderPass(cmd, colorAttachments, depthStencilAttachment, renderArea, offset, bClearRenderTargets, clearColor, clearDepth, bSupportMultisampling, bStoreDepth);
+
+	for (auto& el : secondaryCmds)
+	{
+		ExecuteSecondaryCommandList(cmd, el);
+	}
+
+	EndRenderPass(cmd);
+}
+
+void NullGraphicsDriver::RenderSecondaryCommandBuffers(RHI::RHICommandListPtr cmd,
+	TVector<RHI::RHICommandListPtr> secondaryCmds,
+	const TVector<RHI::RHISurfacePtr>& colorAttachments,
+	RHI::RHITexturePtr depthStencilAttachment,
+	glm::ivec4 renderArea,
+	glm::ivec2 offset,
+	bool bClearRenderTargets,
+	glm::vec4 clearColor,
+	float clearDepth,
+	bool bStoreDepth)
+{
+	BeginRenderPass(cmd, colorAttachments, depthStencilAttachment, renderArea, offset, bClearRenderTargets, clearColor, clearDepth, bStoreDepth);
+
+	for (auto& el : secondaryCmds)
+	{
+		ExecuteSecondaryCommandList(cmd, el);
+	}
+
+	EndRenderPass(cmd);
+}
+
+void NullGraphicsDriver::BeginRenderPass(RHI::RHICommandListPtr cmd,
+	const TVector<RHI::RHISurfacePtr>& colorAttachments,
+	RHI::RHITexturePtr depthStencilAttachment,
+	glm::ivec4 renderArea,
+	glm::ivec2 offset,
+	bool bClearRenderTargets,
+	glm::vec4 clearColor,
+	float clearDepth,
+	bool bStoreDepth)
+{
+	const RenderPassArgs args{ renderArea, offset, clearColor, clearDepth, (uint32_t)colorAttachments.Num(), bClearRenderTargets, bStoreDepth };
+	Record(cmd, ENullCommand::BeginRenderPass, 1, args);
+}
+
+void NullGraphicsDriver::BeginRenderPass(RHI::RHICommandListPtr cmd,
+	const TVector<RHI::RHITexturePtr>& colorAttachments,
+	RHI::RHITexturePtr depthStencilAttachment,
+	glm::ivec4 renderArea,
+	glm::ivec2 offset,
+	bool bClearRenderTargets,
+	glm::vec4 clearColor,
+	float clearDepth,
+	bool bSupportMultisampling,
+	bool bStoreDepth)
+{
+	const RenderPassArgs args{ renderArea, offset, clearColor, clearDepth, (uint32_t)colorAttachments.Num(), bClearRenderTargets, bStoreDepth };
+	Record(cmd, ENullCommand::BeginRenderPass, 1, args);
+}
+
+void NullGraphicsDriver::EndRenderPass(RHI::RHICommandListPtr cmd)
+{
+	Record(cmd, ENullCommand::EndRenderPass, 0);
+}
+
+void NullGraphicsDriver::MemoryBarrier(RHI::RHICommandListPtr cmd, RHI::EAccessFlags srcBit, RHI::EAccessFlags dstBit)
+{
+	Record(cmd, ENullCommand::MemoryBarrier, 1, glm::uvec2(srcBit, dstBit));
+}
+
+void NullGraphicsDriver::ImageMemoryBarrier(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr image, RHI::EFormat format, RHI::EImageLayout layout, bool bAllowToWriteFromComputeShader)
+{
+	const ImageBarrierArgs args{ image.GetRawPtr(), image->GetDefaultLayout(), layout };
+	Record(cmd, ENullCommand::ImageMemoryBarrier, 1, args);
+}
+
+void NullGraphicsDriver::ImageMemoryBarrier(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr image, RHI::EFormat format, RHI::EImageLayout oldLayout, RHI::EImageLayout newLayout)
+{
+	const ImageBarrierArgs args{ image.GetRawPtr(), oldLayout, newLayout };
+	Record(cmd, ENullCommand::ImageMemoryBarrier, 1, args);
+}
+
+void NullGraphicsDriver::BeginSecondaryCommandList(RHI::RHICommandListPtr cmd, bool bOneTimeSubmit, bool bSupportMultisampling, RHI::EFormat colorAttachment)
+{
+	cmd->m_null.m_commands.Clear(false);
+	cmd->m_null.m_numRecordedCommands = 0;
+	cmd->m_null.m_gpuCost = 0;
+
+	Record(cmd, ENullCommand::BeginCommandList, 0, colorAttachment);
+}
+
+void NullGraphicsDriver::BeginCommandList(RHI::RHICommandListPtr cmd, bool bOneTimeSubmit)
+{
+	cmd->m_null.m_commands.Clear(false);
+	cmd->m_null.m_numRecordedCommands = 0;
+	cmd->m_null.m_gpuCost = 0;
+
+	Record(cmd, ENullCommand::BeginCommandList, 0);
+}
+
+void NullGraphicsDriver::EndCommandList(RHI::RHICommandListPtr cmd)
+{
+	Record(cmd, ENullCommand::EndCommandList, 0);
+}
+
+bool NullGraphicsDriver::BlitImage(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr src, RHI::RHITexturePtr dst, glm::ivec4 srcRegionRect, glm::ivec4 dstRegionRect, RHI::ETextureFiltration filtration)
+{
+	const BlitImageArgs args{ srcRegionRect, dstRegionRect };
+	Record(cmd, ENullCommand::BlitImage, 24, args);
+	return true;
+}
+
+void NullGraphicsDriver::ClearImage(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr dst, const glm::vec4& clearColor)
+{
+	Record(cmd, ENullCommand::ClearImage, 5, clearColor);
+}
+
+void NullGraphicsDriver::ClearDepthStencil(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr dst, float depth, uint32_t stencil)
+{
+	Record(cmd, ENullCommand::ClearDepthStencil, 5, glm::vec2(depth, (float)stencil));
+}
+
+void NullGraphicsDriver::UpdateShaderBindingVariable(RHI::RHICommandListPtr cmd, RHI::RHIShaderBindingPtr shaderBinding, const std::string& variable, const void* value, size_t size, uint32_t indexInArray)
+{
+	RHI::ShaderLayoutBindingMember bindingLayout;
+	if (shaderBinding->FindVariableInUniformBuffer(variable, bindingLayout))
+	{
+		UpdateShaderBinding(cmd, shaderBinding, value, size, bindingLayout.m_absoluteOffset + bindingLayout.m_arrayStride * indexInArray);
+	}
+}
+
+void NullGraphicsDriver::UpdateShaderBindingVariable(RHI::RHICommandListPtr cmd, RHI::RHIShaderBindingPtr shaderBinding, const std::string& variable, const void* value, size_t size)
+{
+	UpdateShaderBindingVariable(cmd, shaderBinding, variable, value, size, 0);
+}
+
+void NullGraphicsDriver::UpdateShaderBinding(RHI::RHICommandListPtr cmd, RHI::RHIShaderBindingPtr binding, const void* data, size_t size, size_t offset)
+{
+	if (binding->m_null.m_buffer)
+	{
+		UpdateBuffer(cmd, binding->m_null.m_buffer, data, size, binding->m_null.m_offset + offset);
+	}
+}
+
+void NullGraphicsDriver::UpdateBuffer(RHI::RHICommandListPtr cmd, RHI::RHIBufferPtr buffer, const void* data, size_t size, size_t offset)
+{
+	auto& memory = buffer->m_null.m_memory;
+
+	// The data is visible right away, the command only tracks the copy
+	if (data && offset + size <= memory.Num())
+	{
+		memcpy(memory.GetData() + offset, data, size);
+	}
+
+	const UpdateBufferArgs args{ buffer.GetRawPtr(), size, offset };
+	Record(cmd, ENullCommand::UpdateBuffer, 3, args);
+}
+
+void NullGraphicsDriver::SetMaterialParameter(RHI::RHICommandListPtr cmd, RHI::RHIShaderBindingSetPtr bindings, const std::string& binding, const std::string& variable, const void* value, size_t size)
+{
+	if (bindings->HasBinding(binding))
+	{
+		auto& shaderBinding = bindings->GetOrAddShaderBinding(binding);
+		UpdateShaderBindingVariable(cmd, shaderBinding, variable, value, size);
+	}
+}
+
+void NullGraphicsDriver::BindMaterial(RHI::RHICommandListPtr cmd, RHI::RHIMaterialPtr material)
+{
+	Record(cmd, ENullCommand::BindMaterial, 1, material.GetRawPtr());
+}
+
+void NullGraphicsDriver::Dispatch(RHI::RHICommandListPtr cmd, RHI::RHIShaderPtr computeShader,
+	uint32_t groupSizeX, uint32_t groupSizeY, uint32_t groupSizeZ,
+	const TVector<RHI::RHIShaderBindingSetPtr>& bindings,
+	const void* pPushConstantsData,
+	uint32_t sizePushConstantsData)
+{
+	// The pipeline, the descriptor sets and the push constants are bound as in the Vulkan driver
+	Record(cmd, ENullCommand::BindShaderBindings, 1 + (uint32_t)bindings.Num(), (uint32_t)bindings.Num());
+
+	if (sizePushConstantsData > 0)
+	{
+		Record(cmd, ENullCommand::PushConstants, 1, pPushConstantsData, sizePushConstantsData);
+	}
+
+	Record(cmd, ENullCommand::Dispatch, 20, glm::uvec3(groupSizeX, groupSizeY, groupSizeZ));
+}
+
+void NullGraphicsDriver::BindVertexBuffer(RHI::RHICommandListPtr cmd, RHI::RHIBufferPtr vertexBuffer, uint32_t offset)
+{
+	Record(cmd, ENullCommand::BindVertexBuffer, 1, offset);
+}
+
+void NullGraphicsDriver::BindIndexBuffer(RHI::RHICommandListPtr cmd, RHI::RHIBufferPtr indexBuffer, uint32_t offset, bool bUint16InsteadOfUint32)
+{
+	Record(cmd, ENullCommand::BindIndexBuffer, 1, offset);
+}
+
+void NullGraphicsDriver::SetViewport(RHI::RHICommandListPtr cmd, float x, float y, float width, float height, glm::vec2 scissorOffset, glm::vec2 scissorExtent, float minDepth, float maxDepth)
+{
+	// The viewport and the scissor
+	Record(cmd, ENullCommand::SetViewport, 2, glm::vec4(x, y, width, height));
+}
+
+void NullGraphicsDriver::SetDefaultViewport(RHI::RHICommandListPtr cmd)
+{
+	const glm::ivec2 extent = m_backBuffer->GetExtent();
+	SetViewport(cmd, 0.0f, 0.0f, (float)extent.x, (float)extent.y, glm::vec2(0.0f, 0.0f), glm::vec2(extent), 0.0f, 1.0f);
+}
+
+void NullGraphicsDriver::BindShaderBindings(RHI::RHICommandListPtr cmd, RHI::RHIMaterialPtr material, const TVector<RHI::RHIShaderBindingSetPtr>& bindings)
+{
+	Record(cmd, ENullCommand::BindShaderBindings, (uint32_t)bindings.Num(), (uint32_t)bindings.Num());
+}
+
+void NullGraphicsDriver::DrawIndexedIndirect(RHI::RHICommandListPtr cmd, RHI::RHIBufferPtr buffer, size_t offset, uint32_t drawCount, uint32_t stride)
+{
+	Record(cmd, ENullCommand::DrawIndexedIndirect, 20, glm::uvec3((uint32_t)offset, drawCount, stride));
+}
+
+void NullGraphicsDriver::DrawIndexed(RHI::RHICommandListPtr cmd, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
+{
+	const DrawIndexedArgs args{ indexCount, instanceCount, firstIndex, vertexOffset, firstInstance };
+	Record(cmd, ENullCommand::DrawIndexed, 2, args);
+}
+
+void NullGraphicsDriver::ExecuteSecondaryCommandList(RHI::RHICommandListPtr cmd, RHI::RHICommandListPtr cmdSecondary)
+{
+	Record(cmd, ENullCommand::ExecuteSecondaryCommandList, cmdSecondary->GetGPUCost(), cmdSecondary.GetRawPtr());
+}
+
+void NullGraphicsDriver::PushConstants(RHI::RHICommandListPtr cmd, RHI::RHIMaterialPtr material, size_t size, const void* ptr)
+{
+	Record(cmd, ENullCommand::PushConstants, 1, ptr, size);
+}
+
+void NullGraphicsDriver::GenerateMipMaps(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr target)
+{
+	uint32_t mipLevels = 1;
+	if (auto renderTarget = target.DynamicCast<RHI::RHIRenderTarget>())
+	{
+		mipLevels = renderTarget->GetMipLevels();
+	}
+
+	Record(cmd, ENullCommand::GenerateMipMaps, mipLevels * 20, mipLevels);
+}
+
+void NullGraphicsDriver::ConvertEquirect2Cubemap(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr equirect, RHI::RHICubemapPtr cubemap)
+{
+	const glm::ivec2 extent = cubemap->GetExtent();
+	Record(cmd, ENullCommand::Dispatch, 20, glm::uvec3(extent.x / 32, extent.y / 32, 6));
+}
+
+void NullGraphicsDriver::CopyBufferToImage(RHI::RHICommandListPtr cmd, RHI::RHIBufferPtr src, RHI::RHITexturePtr dst)
+{
+	Record(cmd, ENullCommand::CopyBufferToImage, 10, dst.GetRawPtr());
+}
+
+void NullGraphicsDriver::CopyImageToBuffer(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr src, RHI::RHIBufferPtr dst)
+{
+	Record(cmd, ENullCommand::CopyImageToBuffer, 10, src.GetRawPtr());
+}
+
+void NullGraphicsDriver::Record(RHI::RHICommandListPtr& cmd, ENullCommand command, uint32_t gpuCost, const void* pArgs, size_t size)
+{
+	auto& commands = cmd->m_null.m_commands;
+
+	const CommandHeader header{ command, (uint32_t)size };
+	commands.AddRange((const uint8_t*)&header, sizeof(header));
+
+	if (size > 0)
+	{
+		commands.AddRange((const uint8_t*)pArgs, size);
+	}
+
+	cmd->m_null.m_numRecordedCommands++;
+	cmd->m_null.m_gpuCost += gpuCost;
+}
+
+TVector<ENullCommand> NullGraphicsDriver::GetRecordedCommands(const RHI::RHICommandListPtr& cmd)
+{
+	TVector<ENullCommand> res;
+
+	const auto& commands = cmd->m_null.m_commands;
+	size_t offset = 0;
+
+	while (offset + sizeof(CommandHeader) <= commands.Num())
+	{
+		CommandHeader header;
+		memcpy(&header, commands.GetData() + offset, sizeof(header));
+
+		res.Add(header.m_command);
+		offset += sizeof(header) + header.m_size;
+	}
+
+	return res;
+}
+
+TVector<const RHI::RHICommandList*> NullGraphicsDriver::GetExecutedCommandLists(const RHI::RHICommandListPtr& cmd)
+{
+	TVector<const RHI::RHICommandList*> res;
+
+	const auto& commands = cmd->m_null.m_commands;
+	size_t offset = 0;
+
+	while (offset + sizeof(CommandHeader) <= commands.Num())
+	{
+		CommandHeader header;
+		memcpy(&header, commands.GetData() + offset, sizeof(header));
+
+		if (header.m_command == ENullCommand::ExecuteSecondaryCommandList)
+		{
+			const RHI::RHICommandList* pSecondary = nullptr;
+			memcpy(&pSecondary, commands.GetData() + offset + sizeof(header), sizeof(pSecondary));
+			res.Add(pSecondary);
+		}
+
+		offset += sizeof(header) + header.m_size;
+	}
+
+	return res;
+}
+
+#endif //SAILOR_BUILD_WITH_NULL_RHI
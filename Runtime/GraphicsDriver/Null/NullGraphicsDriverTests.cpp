@@ -0,0 +1,117 @@
+#include "GraphicsDriver/Null/NullGraphicsDriver.h"
+#include "RHI/Renderer.h"
+#include "RHI/CommandList.h"
+#include "RHI/Buffer.h"
+#include "RHI/Fence.h"
+
+#ifdef SAILOR_BUILD_WITH_NULL_RHI
+
+using namespace Sailor;
+using namespace Sailor::GraphicsDriver::Null;
+
+namespace
+{
+	// Records a draw and a secondary command list into the primary one, submits it and compares the command stream
+	bool RecordCheck(NullGraphicsDriver* pDriver)
+	{
+		const RHI::EBufferUsageFlags usage = RHI::EBufferUsageBit::VertexBuffer_Bit | RHI::EBufferUsageBit::IndexBuffer_Bit;
+		const RHI::EMemoryPropertyFlags properties = RHI::EMemoryPropertyBit::HostVisible | RHI::EMemoryPropertyBit::HostCoherent;
+
+		RHI::RHIBufferPtr buffer = pDriver->CreateBuffer(256, usage, properties);
+
+		const uint32_t constants = 42;
+		RHI::RHICommandListPtr secondary = pDriver->CreateCommandList(true);
+		pDriver->BeginSecondaryCommandList(secondary);
+		pDriver->PushConstants(secondary, nullptr, sizeof(constants), &constants);
+		pDriver->EndCommandList(secondary);
+
+		RHI::RHICommandListPtr cmd = pDriver->CreateCommandList(false);
+		pDriver->BeginCommandList(cmd, true);
+		pDriver->BeginDebugRegion(cmd, "RecordCheck", glm::vec4(1.0f));
+		pDriver->BindVertexBuffer(cmd, buffer, 0);
+		pDriver->BindIndexBuffer(cmd, buffer, 128);
+		pDriver->DrawIndexed(cmd, 36, 1, 0, 0, 0);
+		pDriver->MemoryBarrier(cmd, (RHI::EAccessFlags)RHI::EAccessBit::ShaderWrite_Bit, (RHI::EAccessFlags)RHI::EAccessBit::ShaderRead_Bit);
+		pDriver->ExecuteSecondaryCommandList(cmd, secondary);
+		pDriver->EndDebugRegion(cmd);
+		pDriver->EndCommandList(cmd);
+
+		const TVector<ENullCommand> expectedCommands =
+		{
+			ENullCommand::BeginCommandList,
+			ENullCommand::BeginDebugRegion,
+			ENullCommand::BindVertexBuffer,
+			ENullCommand::BindIndexBuffer,
+			ENullCommand::DrawIndexed,
+			ENullCommand::MemoryBarrier,
+			ENullCommand::ExecuteSecondaryCommandList,
+			ENullCommand::EndDebugRegion,
+			ENullCommand::EndCommandList
+		};
+
+		const TVector<ENullCommand> expectedSecondaryCommands = { ENullCommand::BeginCommandList, ENullCommand::PushConstants, ENullCommand::EndCommandList };
+		const TVector<const RHI::RHICommandList*> expectedSecondaries = { secondary.GetRawPtr() };
+
+		if (!(NullGraphicsDriver::GetRecordedCommands(cmd) == expectedCommands) ||
+			!(NullGraphicsDriver::GetRecordedCommands(secondary) == expectedSecondaryCommands) ||
+			!(NullGraphicsDriver::GetExecutedCommandLists(cmd) == expectedSecondaries))
+		{
+			return false;
+		}
+
+		// The command list is re-recorded from scratch
+		pDriver->BeginCommandList(cmd, true);
+		pDriver->EndCommandList(cmd);
+
+		if (!(NullGraphicsDriver::GetRecordedCommands(cmd) == TVector<ENullCommand>{ ENullCommand::BeginCommandList, ENullCommand::EndCommandList }))
+		{
+			return false;
+		}
+
+		RHI::RHIFencePtr fence = RHI::RHIFencePtr::Make();
+		pDriver->SubmitCommandList(cmd, fence);
+
+		if (!fence->IsFinished())
+		{
+			return false;
+		}
+
+		// The reset fence stays on the null path and is signaled by the next submit
+		fence->Reset();
+		fence->Wait();
+
+		if (fence->IsFinished())
+		{
+			return false;
+		}
+
+		pDriver->SubmitCommandList(cmd, fence);
+
+		return fence->IsFinished();
+	}
+
+	// The zero-size buffer doesn't fall through to the Vulkan handle
+	bool EmptyBufferCheck(NullGraphicsDriver* pDriver)
+	{
+		RHI::RHIBufferPtr buffer = pDriver->CreateBuffer(0, RHI::EBufferUsageBit::StorageBuffer_Bit, RHI::EMemoryPropertyBit::HostVisible);
+
+		return buffer->GetSize() == 0 && buffer->GetOffset() == 0;
+	}
+}
+
+void Sailor::GraphicsDriver::Null::RunNullGraphicsDriverTests()
+{
+	printf("\nStarting Null graphics driver tests...\n");
+
+	NullGraphicsDriver* pDriver = RHI::Renderer::GetDriver().DynamicCast<NullGraphicsDriver>();
+	if (!pDriver)
+	{
+		printf("Null graphics driver tests are skipped, they run with --nullrhi\n");
+		return;
+	}
+
+	printf("Record check passed: %d\n", RecordCheck(pDriver));
+	printf("Empty buffer check passed: %d\n", EmptyBufferCheck(pDriver));
+}
+
+#endif
@@ -77,10 +77,14 @@ VulkanCommandPoolPtr VulkanCommandBuffer::GetCommandPool() const
 
 void VulkanCommandBuffer::BeginCommandList(VkCommandBufferUsageFlags flags)
 {
+	// The secondary command buffer that is executed outside of the render pass inherits nothing
+	VkCommandBufferInheritanceInfo inheritanceInfo{};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	beginInfo.flags = flags;
-	beginInfo.pInheritanceInfo = nullptr;
+	beginInfo.pInheritanceInfo = m_level == VK_COMMAND_BUFFER_LEVEL_SECONDARY ? &inheritanceInfo : nullptr;
 
 	VK_CHECK(vkBeginCommandBuffer(m_commandBuffer, &beginInfo));
 
@@ -971,7 +975,8 @@ void VulkanCommandBuffer::MemoryBarrier(VkAccessFlags srcAccess, VkAccessFlags d
 	memoryBarrier.pNext = VK_NULL_HANDLE;
 	memoryBarrier.srcAccessMask = srcAccess;
 	memoryBarrier.dstAccessMask = dstAccess;
-	//vkCmdPipelineBarrier
+
+	vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
 
 	m_numRecordedCommands++;
 	m_gpuCost += 1;
@@ -234,7 +234,7 @@ VkFormat VulkanDevice::GetDepthFormat() const
 	);
 }
 
-TBlockAllocator<class GlobalVulkanMemoryAllocator, class VulkanMemoryPtr>& VulkanDevice::GetMemoryAllocator(VkMemoryPropertyFlags properties, VkMemoryRequirements requirements)
+VulkanDeviceMemoryAllocator& VulkanDevice::GetMemoryAllocator(VkMemoryPropertyFlags properties, VkMemoryRequirements requirements)
 {
 	uint64_t hash{};
 	HashCombine(hash, properties, requirements.memoryTypeBits);
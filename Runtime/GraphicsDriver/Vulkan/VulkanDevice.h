@@ -18,8 +18,8 @@ class Sailor::Win32::Window;
 
 namespace Sailor::GraphicsDriver::Vulkan
 {
-	using VulkanDeviceMemoryAllocator = TBlockAllocator<Sailor::Memory::GlobalVulkanMemoryAllocator, VulkanMemoryPtr>;
-	using VulkanBufferAllocator = TBlockAllocator<Sailor::Memory::GlobalVulkanBufferAllocator, VulkanBufferMemoryPtr>;
+	using VulkanDeviceMemoryAllocator = TBlockAllocator<Sailor::Memory::GlobalVulkanMemoryAllocator, VulkanMemoryPtr, Sailor::Memory::TlsfPolicy>;
+	using VulkanBufferAllocator = TBlockAllocator<Sailor::Memory::GlobalVulkanBufferAllocator, VulkanBufferMemoryPtr, Sailor::Memory::TlsfPolicy>;
 
 	// Thread independent resources
 	struct ThreadContext
@@ -2021,8 +2021,6 @@ void VulkanGraphicsDriver::BeginSecondaryCommandList(RHI::RHICommandListPtr cmd,
 
 void VulkanGraphicsDriver::BeginCommandList(RHI::RHICommandListPtr cmd, bool bOneTimeSubmit)
 {
-	check(cmd->m_vulkan.m_commandBuffer->GetLevel() != VK_COMMAND_BUFFER_LEVEL_SECONDARY);
-
 	uint32_t flags = bOneTimeSubmit ? VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT : 0;
 	cmd->m_vulkan.m_commandBuffer->BeginCommandList(flags);
 }
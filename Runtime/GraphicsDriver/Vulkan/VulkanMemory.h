@@ -4,7 +4,7 @@
 #include "Memory/RefPtr.hpp"
 #include "VulkanDeviceMemory.h"
 #include "Memory/Memory.h"
-#include "Memory/MemoryBlockAllocator.hpp"
+#include "Memory/MemoryTlsfAllocator.hpp"
 #include "Memory/MemoryPoolAllocator.hpp"
 #include "Memory/MemoryPtr.hpp"
 
@@ -166,6 +166,7 @@ namespace Sailor::Math
 		SAILOR_API __forceinline glm::mat4 CalculateOrthoMatrixByView(const glm::mat4& view, float zMult) const;
 
 		SAILOR_API __forceinline const TVector<glm::vec3>& GetCorners() const;
+		SAILOR_API __forceinline const Plane& GetPlane(uint32_t index) const { return m_planes[index]; }
 
 		SAILOR_API __forceinline void ExtractFrustumPlanes(const glm::mat4& projectionViewMatrix, bool bNormalizePlanes = true);
 		SAILOR_API __forceinline void ExtractFrustumPlanes(const glm::mat4& worldMatrix, float aspect, float fovY, float zNear, float zFar);
@@ -1,6 +1,7 @@
 #include "Math.h"
 #include "Transform.h"
 #include <glm/glm/gtx/quaternion.hpp>
+#include <immintrin.h>
 
 using namespace Sailor;
 using namespace Sailor::Math;
@@ -38,7 +39,61 @@ Transform& Transform::operator*= (const Transform& parent)
 
 mat4 Transform::Matrix() const
 {
-	return glm::translate(glm::mat4(1), vec3(m_position)) * glm::toMat4(m_rotation) * glm::scale(glm::mat4(1), vec3(m_scale));
+	mat4 res;
+	CalculateMatrix(*this, res);
+	return res;
+}
+
+void Sailor::Math::CalculateMatrix(const Transform& transform, mat4& outMatrix)
+{
+	const quat& r = transform.m_rotation;
+
+	const __m128 q = _mm_setr_ps(r.x, r.y, r.z, r.w);
+	const __m128 q2 = _mm_add_ps(q, q);
+
+	// The columns of the rotation matrix are 1 - 2(yy + zz), 2(xy + wz), ... each is the sum of two products
+	const __m128 col0 = _mm_add_ps(_mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f), _mm_add_ps(
+		_mm_mul_ps(_mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 0, 0, 1)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 2, 1, 1))), _mm_setr_ps(-1.0f, 1.0f, 1.0f, 0.0f)),
+		_mm_mul_ps(_mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 3, 3, 2)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 1, 2, 2))), _mm_setr_ps(-1.0f, 1.0f, -1.0f, 0.0f))));
+
+	const __m128 col1 = _mm_add_ps(_mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f), _mm_add_ps(
+		_mm_mul_ps(_mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 1, 0, 0)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 2, 0, 1))), _mm_setr_ps(1.0f, -1.0f, 1.0f, 0.0f)),
+		_mm_mul_ps(_mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 3, 2, 3)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 0, 2, 2))), _mm_setr_ps(-1.0f, -1.0f, 1.0f, 0.0f))));
+
+	const __m128 col2 = _mm_add_ps(_mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f), _mm_add_ps(
+		_mm_mul_ps(_mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 0, 1, 0)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 0, 2, 2))), _mm_setr_ps(1.0f, 1.0f, -1.0f, 0.0f)),
+		_mm_mul_ps(_mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(3, 1, 3, 3)), _mm_shuffle_ps(q2, q2, _MM_SHUFFLE(3, 1, 0, 1))), _mm_setr_ps(1.0f, -1.0f, -1.0f, 0.0f))));
+
+	const vec4& s = transform.m_scale;
+	const vec4& t = transform.m_position;
+
+	_mm_storeu_ps(&outMatrix[0][0], _mm_mul_ps(col0, _mm_set1_ps(s.x)));
+	_mm_storeu_ps(&outMatrix[1][0], _mm_mul_ps(col1, _mm_set1_ps(s.y)));
+	_mm_storeu_ps(&outMatrix[2][0], _mm_mul_ps(col2, _mm_set1_ps(s.z)));
+	_mm_storeu_ps(&outMatrix[3][0], _mm_setr_ps(t.x, t.y, t.z, 1.0f));
+}
+
+void Sailor::Math::MultiplyMatrices(const mat4& lhs, const mat4& rhs, mat4& outMatrix)
+{
+	const __m256 l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&lhs[0][0]));
+	const __m256 l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&lhs[1][0]));
+	const __m256 l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&lhs[2][0]));
+	const __m256 l3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&lhs[3][0]));
+
+	const auto multiply = [&](__m256 r)
+		{
+			__m256 res = _mm256_mul_ps(l0, _mm256_shuffle_ps(r, r, 0x00));
+			res = _mm256_add_ps(res, _mm256_mul_ps(l1, _mm256_shuffle_ps(r, r, 0x55)));
+			res = _mm256_add_ps(res, _mm256_mul_ps(l2, _mm256_shuffle_ps(r, r, 0xAA)));
+			return _mm256_add_ps(res, _mm256_mul_ps(l3, _mm256_shuffle_ps(r, r, 0xFF)));
+		};
+
+	// Both halves of rhs are loaded before the store, so outMatrix could be lhs or rhs
+	const __m256 res01 = multiply(_mm256_loadu_ps(&rhs[0][0]));
+	const __m256 res23 = multiply(_mm256_loadu_ps(&rhs[2][0]));
+
+	_mm256_storeu_ps(&outMatrix[0][0], res01);
+	_mm256_storeu_ps(&outMatrix[2][0], res23);
 }
 
 vec4 Transform::TransformPosition(const vec4& position) const
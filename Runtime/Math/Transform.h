@@ -46,4 +46,10 @@ namespace Sailor::Math
 	};
 
 	Transform SAILOR_API Lerp(const Transform& a, const Transform& b, float t);
+
+	// SSE translate * rotate * scale, the same as Transform::Matrix
+	SAILOR_API void CalculateMatrix(const Transform& transform, mat4& outMatrix);
+
+	// AVX lhs * rhs, two columns of the result per register
+	SAILOR_API void MultiplyMatrices(const mat4& lhs, const mat4& rhs, mat4& outMatrix);
 }
\ No newline at end of file
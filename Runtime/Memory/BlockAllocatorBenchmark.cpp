@@ -0,0 +1,149 @@
+#include <random>
+#include <cstring>
+#include "Memory.h"
+#include "MallocAllocator.hpp"
+#include "MemoryBlockAllocator.hpp"
+#include "MemoryTlsfAllocator.hpp"
+#include "Core/Utils.h"
+#include "Core/LogMacros.h"
+#include "Containers/Vector.h"
+
+using namespace Sailor;
+using namespace Sailor::Memory;
+using Timer = Utils::Timer;
+
+namespace
+{
+	using FirstFitAllocator = TBlockAllocator<MallocAllocator, void*, FirstFitPolicy>;
+	using TlsfAllocator = TBlockAllocator<MallocAllocator, void*, TlsfPolicy>;
+
+	// The streaming pattern: the live allocations of the random sizes are replaced one by one
+	template<typename TAllocator>
+	void RunStreaming(const char* name, size_t numLive, size_t numIterations, size_t maxSize)
+	{
+		TAllocator allocator(16 * 1024 * 1024, maxSize / 2, 32 * 1024 * 1024);
+		TVector<TMemoryPtr<void*>> ptrs(numLive);
+
+		std::mt19937 gen((uint32_t)numLive);
+
+		Timer timer;
+		timer.Start();
+
+		for (auto& ptr : ptrs)
+		{
+			ptr = allocator.Allocate(gen() % maxSize + 1, (size_t)1 << (gen() % 9));
+		}
+
+		for (size_t i = 0; i < numIterations; i++)
+		{
+			auto& ptr = ptrs[gen() % numLive];
+
+			allocator.Free(ptr);
+			ptr = allocator.Allocate(gen() % maxSize + 1, (size_t)1 << (gen() % 9));
+		}
+
+		timer.Stop();
+
+		SAILOR_LOG("%s streaming %zu live, %zu iterations, max size %zu:\n\t %llums, reserved %.2fmb",
+			name, numLive, numIterations, maxSize, timer.ResultMs(), allocator.GetOccupiedSpace() / (1024.0f * 1024.0f));
+
+		if constexpr (std::is_same_v<TAllocator, TlsfAllocator>)
+		{
+			const auto report = allocator.GetFragmentationReport();
+			SAILOR_LOG("\t blocks %zu, allocated %.2fmb, free %.2fmb in %zu chunks, largest free %.2fmb, fragmentation %.2f",
+				report.m_numBlocks, report.m_allocatedSpace / (1024.0f * 1024.0f), report.m_freeSpace / (1024.0f * 1024.0f),
+				report.m_numFreeChunks, report.m_largestFreeChunk / (1024.0f * 1024.0f), report.GetFragmentation());
+		}
+
+		for (auto& ptr : ptrs)
+		{
+			allocator.Free(ptr);
+		}
+	}
+
+	// The live allocations are aligned, don't overlap and keep the content,
+	// all free space is coalesced back into the blocks when everything is freed
+	bool SanityCheck()
+	{
+		const size_t NumAllocations = 20000;
+		const size_t MaxSize = 8192;
+
+		TlsfAllocator allocator(256 * 1024, 1024, 1024 * 1024 * 1024);
+		TVector<TMemoryPtr<void*>> ptrs(NumAllocations);
+		TVector<size_t> sizes(NumAllocations);
+		TVector<size_t> alignments(NumAllocations);
+
+		std::mt19937 gen(NumAllocations);
+
+		const auto allocate = [&](size_t i)
+			{
+				sizes[i] = gen() % MaxSize;
+				alignments[i] = (size_t)1 << (gen() % 9);
+				ptrs[i] = allocator.Allocate(sizes[i], alignments[i]);
+				memset(*ptrs[i], (int)(i % 251), sizes[i]);
+			};
+
+		const auto validate = [&](size_t i)
+			{
+				const uint8_t* pData = reinterpret_cast<const uint8_t*>(*ptrs[i]);
+				if ((size_t)pData % alignments[i] != 0)
+				{
+					return false;
+				}
+
+				for (size_t j = 0; j < sizes[i]; j++)
+				{
+					if (pData[j] != (uint8_t)(i % 251))
+					{
+						return false;
+					}
+				}
+
+				return true;
+			};
+
+		for (size_t i = 0; i < NumAllocations; i++)
+		{
+			allocate(i);
+		}
+
+		for (size_t i = 0; i < NumAllocations; i += 3)
+		{
+			allocator.Free(ptrs[i]);
+		}
+
+		for (size_t i = 0; i < NumAllocations; i += 3)
+		{
+			allocate(i);
+		}
+
+		for (size_t i = 0; i < NumAllocations; i++)
+		{
+			if (!validate(i))
+			{
+				return false;
+			}
+		}
+
+		for (auto& ptr : ptrs)
+		{
+			allocator.Free(ptr);
+		}
+
+		const auto report = allocator.GetFragmentationReport();
+		return report.m_allocatedSpace == 0 && report.m_numFreeChunks == report.m_numBlocks && report.m_freeSpace == report.m_reservedSpace;
+	}
+}
+
+void Sailor::Memory::RunBlockAllocatorBenchmark()
+{
+	printf("\nStarting Block allocator benchmark...\n");
+	printf("TLSF sanity check passed: %d\n", SanityCheck());
+
+	for (size_t numLive : { 1000, 4000, 16000 })
+	{
+		RunStreaming<FirstFitAllocator>("First fit", numLive, 200000, 32 * 1024);
+		RunStreaming<TlsfAllocator>("TLSF", numLive, 200000, 32 * 1024);
+		printf("\n");
+	}
+}
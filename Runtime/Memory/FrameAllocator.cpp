@@ -0,0 +1,259 @@
+#include "FrameAllocator.h"
+#include "Core/SpinLock.h"
+#include "Containers/Vector.h"
+#include "Memory/MallocAllocator.hpp"
+
+using namespace Sailor;
+using namespace Sailor::Memory;
+
+namespace
+{
+	struct FramePage
+	{
+		uint8_t* m_pData = nullptr;
+		size_t m_size = 0;
+	};
+
+	// The counters are written only by the owner thread and read while gathering the stats
+	struct FrameArenaCounters
+	{
+		std::atomic<size_t> m_numAllocations = 0;
+		std::atomic<size_t> m_numFrees = 0;
+		std::atomic<size_t> m_numReallocations = 0;
+		std::atomic<size_t> m_bytesUsed = 0;
+
+		static __forceinline void Increment(std::atomic<size_t>& counter, size_t value = 1)
+		{
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		void Reset()
+		{
+			m_numAllocations.store(0, std::memory_order_relaxed);
+			m_numFrees.store(0, std::memory_order_relaxed);
+			m_numReallocations.store(0, std::memory_order_relaxed);
+			m_bytesUsed.store(0, std::memory_order_relaxed);
+		}
+	};
+
+	struct FrameArena
+	{
+		TVector<FramePage, MallocAllocator> m_pages;
+		size_t m_currentPage = 0;
+		size_t m_offset = 0;
+		uint8_t* m_pLastAllocation = nullptr;
+
+		std::atomic<uint64_t> m_frame = (uint64_t)-1;
+		std::atomic<size_t> m_bytesReserved = 0;
+		FrameArenaCounters m_counters;
+
+		// Pages are kept, so the reset is O(1)
+		void Reset(uint64_t frame)
+		{
+			m_currentPage = 0;
+			m_offset = 0;
+			m_pLastAllocation = nullptr;
+			m_counters.Reset();
+			m_frame.store(frame, std::memory_order_relaxed);
+		}
+
+		void* Allocate(size_t size, size_t alignment)
+		{
+			while (m_currentPage < m_pages.Num())
+			{
+				FramePage& page = m_pages[m_currentPage];
+
+				const size_t alignedOffset = (m_offset + alignment - 1) & ~(alignment - 1);
+				if (alignedOffset + size <= page.m_size)
+				{
+					m_pLastAllocation = page.m_pData + alignedOffset;
+					m_offset = alignedOffset + size;
+					return m_pLastAllocation;
+				}
+
+				m_currentPage++;
+				m_offset = 0;
+			}
+
+			// The big allocations get their own pages, that are reused during the next frames as well
+			FramePage newPage;
+			newPage.m_size = (std::max)(FrameAllocator::PageSize, size + alignment);
+			newPage.m_pData = static_cast<uint8_t*>(MallocAllocator::allocate(newPage.m_size));
+
+			m_pages.Add(newPage);
+			FrameArenaCounters::Increment(m_bytesReserved, newPage.m_size);
+			m_currentPage = m_pages.Num() - 1;
+			m_offset = 0;
+
+			return Allocate(size, alignment);
+		}
+
+		bool Reallocate(void* ptr, size_t size)
+		{
+			// Only the last allocation could be extended in place
+			if (ptr == nullptr || ptr != m_pLastAllocation)
+			{
+				return false;
+			}
+
+			const FramePage& page = m_pages[m_currentPage];
+			const size_t offset = (uint8_t*)ptr - page.m_pData;
+
+			if (offset + size > page.m_size)
+			{
+				return false;
+			}
+
+			m_offset = (std::max)(m_offset, offset + size);
+			return true;
+		}
+
+		void Release()
+		{
+			for (auto& page : m_pages)
+			{
+				MallocAllocator::free(page.m_pData);
+			}
+			m_pages.Clear();
+		}
+	};
+
+	struct ThreadFrameAllocator;
+
+	std::atomic<uint64_t> g_currentFrame = 0;
+
+	SpinLock& GetRegistryLock()
+	{
+		static SpinLock s_lock;
+		return s_lock;
+	}
+
+	TVector<ThreadFrameAllocator*, MallocAllocator>& GetRegistry()
+	{
+		static TVector<ThreadFrameAllocator*, MallocAllocator> s_registry;
+		return s_registry;
+	}
+
+	FrameAllocatorStats& GetLastStats()
+	{
+		static FrameAllocatorStats s_stats;
+		return s_stats;
+	}
+
+	struct ThreadFrameAllocator
+	{
+		ThreadFrameAllocator()
+		{
+			GetRegistryLock().Lock();
+			GetRegistry().Add(this);
+			GetRegistryLock().Unlock();
+		}
+
+		~ThreadFrameAllocator()
+		{
+			GetRegistryLock().Lock();
+			GetRegistry().RemoveFirst(this);
+			GetRegistryLock().Unlock();
+
+			for (auto& arena : m_arenas)
+			{
+				arena.Release();
+			}
+		}
+
+		__forceinline FrameArena& GetArena()
+		{
+			const uint64_t frame = g_currentFrame.load(std::memory_order_relaxed);
+			FrameArena& arena = m_arenas[frame % FrameAllocator::NumFrames];
+
+			if (arena.m_frame.load(std::memory_order_relaxed) != frame)
+			{
+				arena.Reset(frame);
+			}
+
+			return arena;
+		}
+
+		FrameArena m_arenas[FrameAllocator::NumFrames];
+	};
+
+	thread_local ThreadFrameAllocator t_frameAllocator;
+}
+
+void* FrameAllocator::allocate(size_t size, size_t alignment)
+{
+	check(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	FrameArena& arena = t_frameAllocator.GetArena();
+
+	FrameArenaCounters::Increment(arena.m_counters.m_numAllocations);
+	FrameArenaCounters::Increment(arena.m_counters.m_bytesUsed, size);
+
+	return arena.Allocate(size, alignment);
+}
+
+bool FrameAllocator::reallocate(void* ptr, size_t size, size_t alignment)
+{
+	FrameArena& arena = t_frameAllocator.GetArena();
+
+	if (arena.Reallocate(ptr, size))
+	{
+		FrameArenaCounters::Increment(arena.m_counters.m_numReallocations);
+		return true;
+	}
+
+	return false;
+}
+
+void FrameAllocator::free(void* ptr, size_t size)
+{
+	if (ptr != nullptr)
+	{
+		// Nothing to free, we only count the frees that were removed
+		FrameArenaCounters::Increment(t_frameAllocator.GetArena().m_counters.m_numFrees);
+	}
+}
+
+void FrameAllocator::BeginFrame()
+{
+	const uint64_t finishedFrame = g_currentFrame.load(std::memory_order_relaxed);
+
+	FrameAllocatorStats stats{};
+
+	GetRegistryLock().Lock();
+	for (auto& pThreadAllocator : GetRegistry())
+	{
+		for (auto& arena : pThreadAllocator->m_arenas)
+		{
+			stats.m_bytesReserved += arena.m_bytesReserved.load(std::memory_order_relaxed);
+		}
+
+		// The values are approximate, the threads could still allocate within the finished frame
+		FrameArena& arena = pThreadAllocator->m_arenas[finishedFrame % NumFrames];
+		if (arena.m_frame.load(std::memory_order_relaxed) == finishedFrame)
+		{
+			stats.m_numAllocations += arena.m_counters.m_numAllocations.load(std::memory_order_relaxed);
+			stats.m_numFrees += arena.m_counters.m_numFrees.load(std::memory_order_relaxed);
+			stats.m_numReallocations += arena.m_counters.m_numReallocations.load(std::memory_order_relaxed);
+			stats.m_bytesUsed += arena.m_counters.m_bytesUsed.load(std::memory_order_relaxed);
+		}
+	}
+	GetLastStats() = stats;
+	GetRegistryLock().Unlock();
+
+	g_currentFrame.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t FrameAllocator::GetCurrentFrame()
+{
+	return g_currentFrame.load(std::memory_order_relaxed);
+}
+
+FrameAllocatorStats FrameAllocator::GetLastFrameStats()
+{
+	GetRegistryLock().Lock();
+	FrameAllocatorStats res = GetLastStats();
+	GetRegistryLock().Unlock();
+
+	return res;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cassert>
+#include <atomic>
+#include "Core/Defines.h"
+
+namespace Sailor::Memory
+{
+	struct FrameAllocatorStats
+	{
+		size_t m_numAllocations = 0;
+		size_t m_numFrees = 0;
+		size_t m_numReallocations = 0;
+		size_t m_bytesUsed = 0;
+		size_t m_bytesReserved = 0;
+	};
+
+	/* Per-thread linear allocator for the transient data that lives not longer than the frame.
+	*  Each thread owns NumFrames arenas, the arena is picked by the current frame index and
+	*  the whole arena is reset in O(1) the first time the thread allocates in the new frame.
+	*  Free does nothing, the memory is reused when the frame index wraps around.
+	*  Allocated memory stays valid for NumFrames - 1 frames after the current one to cover the frames in flight,
+	*  so the containers with FrameAllocator should never be stored longer than that.
+	*/
+	class SAILOR_API FrameAllocator
+	{
+	public:
+
+		// RHI::Renderer::MaxFramesInQueue plus the frame that is being recorded
+		static constexpr uint32_t NumFrames = 3;
+		static constexpr size_t PageSize = 256 * 1024;
+
+		__forceinline void* Allocate(size_t size, size_t alignment = 8) { return FrameAllocator::allocate(size, alignment); }
+		__forceinline bool Reallocate(void* ptr, size_t size, size_t alignment = 8) { return FrameAllocator::reallocate(ptr, size, alignment); }
+		__forceinline void Free(void* ptr, size_t size = 0) { FrameAllocator::free(ptr, size); }
+
+		// Used for smart ptrs
+		static void* allocate(size_t size, size_t alignment = 8);
+		static bool reallocate(void* ptr, size_t size, size_t alignment = 8);
+		static void free(void* ptr, size_t size = 0);
+
+		// Should be called once per frame before any allocation of the frame
+		static void BeginFrame();
+		static uint64_t GetCurrentFrame();
+
+		// The sum of the counters from all threads for the last finished frame
+		static FrameAllocatorStats GetLastFrameStats();
+	};
+}
@@ -1,76 +1,525 @@
-#pragma once
 #include "LockFreeHeapAllocator.h"
 #include <windows.h>
-#include <mutex>
+#include <malloc.h>
+#include <cstdlib>
+#include <atomic>
+#include <bit>
+#include <algorithm>
 
-#include "Memory/UniquePtr.hpp"
-#include "Containers/ConcurrentMap.h"
-#include "HeapAllocator.h"
+#include "Core/SpinLock.h"
+#include "Containers/Vector.h"
+#include "Memory/MallocAllocator.hpp"
 
 using namespace Sailor;
 using namespace Sailor::Memory;
 
-// For now TConcurrentMap doesn't have dll interface, so cannot 
-// handle that in class
-std::unique_ptr<TConcurrentMap<DWORD, TUniquePtr<HeapAllocator>, 8, ERehashPolicy::Never, Memory::MallocAllocator>>& GetAllocator()
+/* Each thread owns the heap, that is cached in the thread local pointer, so the common path takes no locks.
+*  The memory is requested in segments aligned by SegmentSize, the segment is split into pages and each page
+*  serves the blocks of one size class. The segment descriptor is placed at the beginning of the segment,
+*  so the owner and the size class are found by masking the pointer instead of storing the header before each block.
+*  The blocks that are freed by other threads are pushed onto the lock-free remote free list of the owner heap,
+*  the owner drains the list on its next allocation. The empty segments are returned, except the one spare per heap.
+*  The large blocks are allocated from the global heap with the header, the segment map tells them from the small ones.
+*/
+namespace
 {
-	static std::unique_ptr<TConcurrentMap<DWORD, TUniquePtr<HeapAllocator>, 8, ERehashPolicy::Never, Memory::MallocAllocator>> g_lockFreeAllocators =
-		std::make_unique<TConcurrentMap<DWORD, TUniquePtr<HeapAllocator>, 8, ERehashPolicy::Never, Memory::MallocAllocator>>();
+	constexpr size_t SegmentSize = 4 * 1024 * 1024;
+	constexpr size_t PageSize = 64 * 1024;
+	constexpr size_t NumPagesPerSegment = SegmentSize / PageSize;
 
-	return g_lockFreeAllocators;
-}
+	constexpr size_t MinBlockSize = 16;
+	constexpr size_t MaxSmallSize = 32 * 1024;
+	constexpr size_t NumSizeClasses = 40;
 
-void* LockFreeHeapAllocator::allocate(size_t size, size_t alignment)
-{
-	auto& allocator = GetAllocator();
-	const DWORD currentThreadId = GetCurrentThreadId();
-	void* res = nullptr;
+	// One bit per segment of the 47 bit user address space
+	constexpr size_t NumSegmentMapBits = ((size_t)1 << 47) / SegmentSize;
 
-	check(currentThreadId < 100000000);
+	struct BlockNode
+	{
+		BlockNode* m_pNext;
+	};
 
-	auto& pAllocator = allocator->At_Lock(currentThreadId);
+	class ThreadHeap;
 
-	if (!pAllocator)
+	struct PageMeta
 	{
-		pAllocator = TUniquePtr<HeapAllocator>::Make();
+		BlockNode* m_pFree = nullptr;
+		PageMeta* m_pNext = nullptr;
+		PageMeta* m_pPrev = nullptr;
+
+		uint32_t m_blockSize = 0;
+		uint16_t m_sizeClass = 0;
+		uint16_t m_numUsed = 0;
+		uint16_t m_numCommitted = 0;
+		uint16_t m_capacity = 0;
+		bool m_bInClassList = false;
+	};
+
+	struct Segment
+	{
+		ThreadHeap* m_pOwner = nullptr;
+		uint32_t m_numUsedPages = 0;
+
+		PageMeta m_pages[NumPagesPerSegment];
+
+		__forceinline uint8_t* GetPageData(size_t pageIndex) { return reinterpret_cast<uint8_t*>(this) + pageIndex * PageSize; }
+	};
+
+	// The first page is occupied by the segment descriptor
+	static_assert(sizeof(Segment) <= PageSize);
+
+	__forceinline Segment* GetSegment(const void* ptr)
+	{
+		return reinterpret_cast<Segment*>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t)(SegmentSize - 1));
 	}
 
-	res = pAllocator->Allocate(size + sizeof(DWORD), alignment);
-	((DWORD*)res)[0] = currentThreadId;
-	allocator->Unlock(currentThreadId);
+	__forceinline size_t GetPageIndex(const Segment* pSegment, const void* ptr)
+	{
+		return (reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(pSegment)) / PageSize;
+	}
 
-	if (!res)
+	__forceinline size_t GetSizeClass(size_t size)
 	{
-		return nullptr;
+		// 16 bytes steps up to 128 bytes, then 4 classes per power of 2
+		if (size <= 128)
+		{
+			return ((std::max)(size, (size_t)1) + MinBlockSize - 1) / MinBlockSize - 1;
+		}
+
+		const size_t log2 = std::bit_width(size - 1) - 1;
+		return 8 + (log2 - 7) * 4 + ((size - 1 - ((size_t)1 << log2)) >> (log2 - 2));
 	}
 
-	return &((DWORD*)res)[1];
+	__forceinline size_t GetClassBlockSize(size_t sizeClass)
+	{
+		if (sizeClass < 8)
+		{
+			return (sizeClass + 1) * MinBlockSize;
+		}
+
+		const size_t log2 = 7 + (sizeClass - 8) / 4;
+		return ((size_t)1 << log2) + ((sizeClass - 8) % 4 + 1) * ((size_t)1 << (log2 - 2));
+	}
+
+	struct LargeBlockHeader
+	{
+		void* m_pRaw;
+		size_t m_size;
+	};
+
+	std::atomic<uint64_t> g_segmentMap[NumSegmentMapBits / 64]{};
+
+	__forceinline bool IsSmallBlock(const void* ptr)
+	{
+		const size_t index = reinterpret_cast<uintptr_t>(ptr) / SegmentSize;
+		if (index >= NumSegmentMapBits)
+		{
+			return false;
+		}
+
+		return (g_segmentMap[index / 64].load(std::memory_order_acquire) >> (index % 64)) & 1;
+	}
+
+	void* AllocateSegment()
+	{
+		void* pRaw = _aligned_malloc(SegmentSize, SegmentSize);
+		if (pRaw)
+		{
+			const size_t index = reinterpret_cast<uintptr_t>(pRaw) / SegmentSize;
+			check(index < NumSegmentMapBits);
+
+			g_segmentMap[index / 64].fetch_or((uint64_t)1 << (index % 64), std::memory_order_release);
+		}
+
+		return pRaw;
+	}
+
+	void FreeSegment(void* ptr)
+	{
+		const size_t index = reinterpret_cast<uintptr_t>(ptr) / SegmentSize;
+		g_segmentMap[index / 64].fetch_and(~((uint64_t)1 << (index % 64)), std::memory_order_release);
+
+		_aligned_free(ptr);
+	}
+
+	__forceinline LargeBlockHeader* GetLargeBlockHeader(void* ptr)
+	{
+		return static_cast<LargeBlockHeader*>(ptr) - 1;
+	}
+
+	class ThreadHeap
+	{
+	public:
+
+		ThreadHeap() = default;
+
+		void* Allocate(size_t sizeClass)
+		{
+			DrainRemoteFrees();
+
+			PageMeta* pPage = m_classPages[sizeClass];
+			while (pPage)
+			{
+				if (void* pRes = AllocateFromPage(pPage))
+				{
+					return pRes;
+				}
+
+				// The page is full, it will be returned to the class list on the first free
+				RemoveFromClassList(pPage);
+				pPage = m_classPages[sizeClass];
+			}
+
+			pPage = AcquirePage(sizeClass);
+			if (!pPage)
+			{
+				return nullptr;
+			}
+
+			return AllocateFromPage(pPage);
+		}
+
+		void Free(Segment* pSegment, void* ptr)
+		{
+			PageMeta& page = pSegment->m_pages[GetPageIndex(pSegment, ptr)];
+
+			BlockNode* pNode = static_cast<BlockNode*>(ptr);
+			pNode->m_pNext = page.m_pFree;
+			page.m_pFree = pNode;
+
+			check(page.m_numUsed > 0);
+			page.m_numUsed--;
+
+			if (page.m_numUsed == 0 && m_classPages[page.m_sizeClass] != &page)
+			{
+				// Keep the head page of the class to avoid ping-pong on the boundary
+				if (page.m_bInClassList)
+				{
+					RemoveFromClassList(&page);
+				}
+
+				ReleasePage(&page);
+			}
+			else if (!page.m_bInClassList)
+			{
+				PushToClassList(&page);
+			}
+		}
+
+		void RemoteFree(void* ptr)
+		{
+			BlockNode* pNode = static_cast<BlockNode*>(ptr);
+			BlockNode* pHead = m_remoteFree.load(std::memory_order_relaxed);
+			do
+			{
+				pNode->m_pNext = pHead;
+			} while (!m_remoteFree.compare_exchange_weak(pHead, pNode, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		__forceinline void DrainRemoteFrees()
+		{
+			if (m_remoteFree.load(std::memory_order_relaxed) == nullptr)
+			{
+				return;
+			}
+
+			BlockNode* pNode = m_remoteFree.exchange(nullptr, std::memory_order_acquire);
+			while (pNode)
+			{
+				BlockNode* pNext = pNode->m_pNext;
+				Free(GetSegment(pNode), pNode);
+				pNode = pNext;
+			}
+		}
+
+	protected:
+
+		__forceinline void* AllocateFromPage(PageMeta* pPage)
+		{
+			if (BlockNode* pNode = pPage->m_pFree)
+			{
+				pPage->m_pFree = pNode->m_pNext;
+				pPage->m_numUsed++;
+				return pNode;
+			}
+
+			if (pPage->m_numCommitted < pPage->m_capacity)
+			{
+				Segment* pSegment = GetSegment(pPage);
+				const size_t pageIndex = pPage - &pSegment->m_pages[0];
+
+				void* pRes = pSegment->GetPageData(pageIndex) + (size_t)pPage->m_numCommitted * pPage->m_blockSize;
+				pPage->m_numCommitted++;
+				pPage->m_numUsed++;
+				return pRes;
+			}
+
+			return nullptr;
+		}
+
+		PageMeta* AcquirePage(size_t sizeClass)
+		{
+			if (m_emptyPages.IsEmpty())
+			{
+				void* pRaw = AllocateSegment();
+				if (!pRaw)
+				{
+					return nullptr;
+				}
+
+				Segment* pSegment = new (pRaw) Segment();
+
+				pSegment->m_pOwner = this;
+				m_segments.Add(pSegment);
+
+				for (size_t i = NumPagesPerSegment - 1; i > 0; i--)
+				{
+					m_emptyPages.Add(&pSegment->m_pages[i]);
+				}
+			}
+
+			PageMeta* pPage = m_emptyPages[m_emptyPages.Num() - 1];
+			m_emptyPages.RemoveLast();
+
+			Segment* pSegment = GetSegment(pPage);
+			pSegment->m_numUsedPages++;
+
+			if (pSegment == m_pSpareSegment)
+			{
+				m_pSpareSegment = nullptr;
+			}
+
+			pPage->m_pFree = nullptr;
+			pPage->m_sizeClass = (uint16_t)sizeClass;
+			pPage->m_blockSize = (uint32_t)GetClassBlockSize(sizeClass);
+			pPage->m_capacity = (uint16_t)(PageSize / pPage->m_blockSize);
+			pPage->m_numCommitted = 0;
+			pPage->m_numUsed = 0;
+
+			PushToClassList(pPage);
+
+			return pPage;
+		}
+
+		void ReleasePage(PageMeta* pPage)
+		{
+			pPage->m_pFree = nullptr;
+			pPage->m_numCommitted = 0;
+			m_emptyPages.Add(pPage);
+
+			Segment* pSegment = GetSegment(pPage);
+			check(pSegment->m_numUsedPages > 0);
+
+			if (--pSegment->m_numUsedPages > 0)
+			{
+				return;
+			}
+
+			// Keep one empty segment to avoid the allocation on the next page request
+			if (!m_pSpareSegment)
+			{
+				m_pSpareSegment = pSegment;
+				return;
+			}
+
+			for (size_t i = 0; i < m_emptyPages.Num(); i++)
+			{
+				if (GetSegment(m_emptyPages[i]) == pSegment)
+				{
+					m_emptyPages.RemoveAtSwap(i);
+					i--;
+				}
+			}
+
+			m_segments.RemoveFirst(pSegment);
+
+			pSegment->~Segment();
+			FreeSegment(pSegment);
+		}
+
+		void PushToClassList(PageMeta* pPage)
+		{
+			PageMeta*& pHead = m_classPages[pPage->m_sizeClass];
+
+			pPage->m_pPrev = nullptr;
+			pPage->m_pNext = pHead;
+			if (pHead)
+			{
+				pHead->m_pPrev = pPage;
+			}
+			pHead = pPage;
+			pPage->m_bInClassList = true;
+		}
+
+		void RemoveFromClassList(PageMeta* pPage)
+		{
+			if (pPage->m_pPrev)
+			{
+				pPage->m_pPrev->m_pNext = pPage->m_pNext;
+			}
+			else
+			{
+				m_classPages[pPage->m_sizeClass] = pPage->m_pNext;
+			}
+
+			if (pPage->m_pNext)
+			{
+				pPage->m_pNext->m_pPrev = pPage->m_pPrev;
+			}
+
+			pPage->m_pNext = pPage->m_pPrev = nullptr;
+			pPage->m_bInClassList = false;
+		}
+
+		PageMeta* m_classPages[NumSizeClasses]{};
+		TVector<PageMeta*, MallocAllocator> m_emptyPages;
+		TVector<Segment*, MallocAllocator> m_segments;
+		Segment* m_pSpareSegment = nullptr;
+
+		alignas(64) std::atomic<BlockNode*> m_remoteFree = nullptr;
+	};
+
+	// The heaps are never destroyed, since the blocks could be freed after the thread exit.
+	// The heap of the finished thread is adopted by the next new thread.
+	SpinLock& GetAbandonedHeapsLock()
+	{
+		static SpinLock s_lock;
+		return s_lock;
+	}
+
+	TVector<ThreadHeap*, MallocAllocator>& GetAbandonedHeaps()
+	{
+		static TVector<ThreadHeap*, MallocAllocator>* s_pHeaps = new TVector<ThreadHeap*, MallocAllocator>();
+		return *s_pHeaps;
+	}
+
+	thread_local ThreadHeap* t_pHeap = nullptr;
+	thread_local bool t_bHeapReleased = false;
+
+	struct ThreadHeapGuard
+	{
+		~ThreadHeapGuard()
+		{
+			GetAbandonedHeapsLock().Lock();
+			GetAbandonedHeaps().Add(t_pHeap);
+			GetAbandonedHeapsLock().Unlock();
+
+			t_pHeap = nullptr;
+			t_bHeapReleased = true;
+		}
+	};
+
+	ThreadHeap* AcquireThreadHeap()
+	{
+		ThreadHeap* pHeap = nullptr;
+
+		GetAbandonedHeapsLock().Lock();
+		if (GetAbandonedHeaps().Num() > 0)
+		{
+			pHeap = GetAbandonedHeaps()[GetAbandonedHeaps().Num() - 1];
+			GetAbandonedHeaps().RemoveLast();
+		}
+		GetAbandonedHeapsLock().Unlock();
+
+		if (!pHeap)
+		{
+			pHeap = new (MallocAllocator::allocate(sizeof(ThreadHeap))) ThreadHeap();
+		}
+
+		t_pHeap = pHeap;
+
+		// The allocations during the thread's destruction are not returned to the pool
+		if (!t_bHeapReleased)
+		{
+			static thread_local ThreadHeapGuard s_guard;
+		}
+
+		return pHeap;
+	}
+
+	__forceinline ThreadHeap* GetThreadHeap()
+	{
+		if (ThreadHeap* pHeap = t_pHeap)
+		{
+			return pHeap;
+		}
+
+		return AcquireThreadHeap();
+	}
+
+	// The header keeps the pointer to free and the usable size
+	void* AllocateLarge(size_t size, size_t alignment)
+	{
+		alignment = (std::max)(alignment, alignof(LargeBlockHeader));
+
+		const size_t rawSize = size + sizeof(LargeBlockHeader) + alignment - 1;
+		uint8_t* pRaw = static_cast<uint8_t*>(std::malloc(rawSize));
+		if (!pRaw)
+		{
+			return nullptr;
+		}
+
+		const uintptr_t res = (reinterpret_cast<uintptr_t>(pRaw) + sizeof(LargeBlockHeader) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+		LargeBlockHeader* pHeader = GetLargeBlockHeader(reinterpret_cast<void*>(res));
+		pHeader->m_pRaw = pRaw;
+		pHeader->m_size = reinterpret_cast<uintptr_t>(pRaw) + rawSize - res;
+
+		return reinterpret_cast<void*>(res);
+	}
+}
+
+void* LockFreeHeapAllocator::allocate(size_t size, size_t alignment)
+{
+	check(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	// The blocks of power of 2 classes are aligned by their size
+	const size_t alignedSize = alignment <= MinBlockSize ? size : (std::max)(std::bit_ceil(size), alignment);
+
+	if (alignedSize > MaxSmallSize)
+	{
+		return AllocateLarge(size, alignment);
+	}
+
+	return GetThreadHeap()->Allocate(GetSizeClass(alignedSize));
 }
 
 bool LockFreeHeapAllocator::reallocate(void* ptr, size_t size, size_t alignment)
 {
-	auto& allocator = GetAllocator();
-	void* pRaw = (((DWORD*)ptr) - 1);
-	const DWORD allocatedThreadId = *(DWORD*)pRaw;
+	check(ptr);
 
-	bool res = allocator->At_Lock(allocatedThreadId)->Reallocate(pRaw, size + sizeof(DWORD), alignment);
-	allocator->Unlock(allocatedThreadId);
+	if (!IsSmallBlock(ptr))
+	{
+		return size <= GetLargeBlockHeader(ptr)->m_size;
+	}
 
-	check(((DWORD*)pRaw)[0] == allocatedThreadId);
+	Segment* pSegment = GetSegment(ptr);
 
-	return res;
+	// We could only use the slack of the size class
+	return size <= pSegment->m_pages[GetPageIndex(pSegment, ptr)].m_blockSize;
 }
 
 void LockFreeHeapAllocator::free(void* ptr, size_t size)
 {
-	if (ptr != nullptr)
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	if (!IsSmallBlock(ptr))
 	{
-		auto& allocator = GetAllocator();
-		void* pRaw = (((DWORD*)ptr) - 1);
-		const DWORD allocatedThreadId = *((DWORD*)pRaw);
+		std::free(GetLargeBlockHeader(ptr)->m_pRaw);
+		return;
+	}
 
-		check(allocator->ContainsKey(allocatedThreadId));
-		allocator->At_Lock(allocatedThreadId)->Free(pRaw);
-		allocator->Unlock(allocatedThreadId);
+	Segment* pSegment = GetSegment(ptr);
+	ThreadHeap* pOwner = pSegment->m_pOwner;
+	if (pOwner == t_pHeap)
+	{
+		pOwner->Free(pSegment, ptr);
+	}
+	else
+	{
+		pOwner->RemoteFree(ptr);
 	}
 }
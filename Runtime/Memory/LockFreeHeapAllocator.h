@@ -4,7 +4,7 @@
 
 namespace Sailor::Memory
 {
-	// Global allocator
+	// Global allocator, each thread allocates from its own heap without locks
 	class SAILOR_API LockFreeHeapAllocator
 	{
 	public:
@@ -0,0 +1,281 @@
+#include <windows.h>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <cstring>
+#include "Core/Utils.h"
+#include "Containers/Vector.h"
+#include "Containers/ConcurrentMap.h"
+#include "Containers/ConcurrentQueue.h"
+#include "Memory/Memory.h"
+#include "Memory/UniquePtr.hpp"
+#include "Memory/MallocAllocator.hpp"
+#include "Memory/HeapAllocator.h"
+#include "Memory/LockFreeHeapAllocator.h"
+
+using namespace Sailor;
+using namespace Sailor::Memory;
+using Timer = Utils::Timer;
+
+namespace
+{
+	// The previous implementation of LockFreeHeapAllocator: the heap per thread is looked up in the map under the lock
+	// and the id of the owner thread is stored in front of each block.
+	class LockedThreadHeapAllocator
+	{
+	public:
+
+		using TAllocators = TConcurrentMap<DWORD, TUniquePtr<HeapAllocator>, 8, ERehashPolicy::Never, Memory::MallocAllocator>;
+
+		static TAllocators& GetAllocators()
+		{
+			static std::unique_ptr<TAllocators> s_allocators = std::make_unique<TAllocators>();
+			return *s_allocators;
+		}
+
+		static void* allocate(size_t size, size_t alignment = 8)
+		{
+			const DWORD currentThreadId = GetCurrentThreadId();
+
+			auto& pAllocator = GetAllocators().At_Lock(currentThreadId);
+			if (!pAllocator)
+			{
+				pAllocator = TUniquePtr<HeapAllocator>::Make();
+			}
+
+			void* res = pAllocator->Allocate(size + sizeof(DWORD), alignment);
+			((DWORD*)res)[0] = currentThreadId;
+			GetAllocators().Unlock(currentThreadId);
+
+			return &((DWORD*)res)[1];
+		}
+
+		static void free(void* ptr, size_t size = 0)
+		{
+			void* pRaw = (((DWORD*)ptr) - 1);
+			const DWORD allocatedThreadId = *((DWORD*)pRaw);
+
+			GetAllocators().At_Lock(allocatedThreadId)->Free(pRaw);
+			GetAllocators().Unlock(allocatedThreadId);
+		}
+	};
+
+	struct Result
+	{
+		std::string m_allocator;
+
+		Result() = default;
+		Result(std::string allocator) : m_allocator(allocator) {}
+
+		size_t m_threadLocal[3]{};
+		size_t m_crossThread[3]{};
+
+		bool m_bSanityPassed = false;
+
+		void PrintLog()
+		{
+			SAILOR_LOG("\nAllocator: %s", m_allocator.c_str());
+			SAILOR_LOG("Sanity check passed: %d", m_bSanityPassed);
+			SAILOR_LOG("Thread local alloc/free 1/4/8 threads: %llums %llums %llums", m_threadLocal[0], m_threadLocal[1], m_threadLocal[2]);
+			SAILOR_LOG("Cross thread free 1/2/4 producer-consumer pairs: %llums %llums %llums\n", m_crossThread[0], m_crossThread[1], m_crossThread[2]);
+		}
+	};
+
+	template<typename TAllocator>
+	class TestCase_MultiThreadedAllocator
+	{
+		static constexpr size_t NumOperations = 1 << 20;
+		static constexpr size_t NumLiveBlocks = 1024;
+		static constexpr size_t MaxBlockSize = 512;
+
+	public:
+
+		static Result RunTests(std::string allocator)
+		{
+			Result r(allocator);
+
+			const size_t numThreads[] = { 1, 4, 8 };
+			const size_t numPairs[] = { 1, 2, 4 };
+
+			for (size_t i = 0; i < 3; i++)
+			{
+				r.m_threadLocal[i] = Measure([&]() { return ThreadLocalTest(numThreads[i]); });
+				r.m_crossThread[i] = Measure([&]() { return CrossThreadTest(numPairs[i]); });
+			}
+
+			r.m_bSanityPassed = ThreadLocalTest(3) && CrossThreadTest(3);
+
+			return r;
+		}
+
+	protected:
+
+		template<typename TFunction>
+		static size_t Measure(TFunction test)
+		{
+			Timer timer;
+
+			timer.Start();
+			const bool bRes = test();
+			timer.Stop();
+
+			check(bRes);
+			return timer.ResultMs();
+		}
+
+		static __forceinline void Fill(void* ptr, size_t size, uint8_t value)
+		{
+			memset(ptr, value, size);
+		}
+
+		static __forceinline bool Validate(const void* ptr, size_t size, uint8_t value)
+		{
+			const uint8_t* pData = static_cast<const uint8_t*>(ptr);
+			return size == 0 || (pData[0] == value && pData[size - 1] == value);
+		}
+
+		// Each thread keeps a window of live blocks and replaces the random ones, typical for the containers
+		static bool ThreadLocalTest(size_t numThreads)
+		{
+			std::atomic<bool> bFailed = false;
+			TVector<std::thread> threads;
+
+			for (size_t t = 0; t < numThreads; t++)
+			{
+				threads.Emplace([&bFailed, t, numThreads]()
+					{
+						std::mt19937 random((uint32_t)t);
+
+						void* blocks[NumLiveBlocks]{};
+						size_t sizes[NumLiveBlocks]{};
+
+						for (size_t i = 0; i < NumOperations / numThreads; i++)
+						{
+							const size_t index = random() % NumLiveBlocks;
+
+							if (blocks[index])
+							{
+								if (!Validate(blocks[index], sizes[index], (uint8_t)index))
+								{
+									bFailed = true;
+								}
+
+								TAllocator::free(blocks[index]);
+							}
+
+							sizes[index] = 1 + random() % MaxBlockSize;
+							blocks[index] = TAllocator::allocate(sizes[index]);
+							Fill(blocks[index], sizes[index], (uint8_t)index);
+						}
+
+						for (size_t i = 0; i < NumLiveBlocks; i++)
+						{
+							if (blocks[i])
+							{
+								TAllocator::free(blocks[i]);
+							}
+						}
+					});
+			}
+
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			return !bFailed;
+		}
+
+		// The producers allocate the blocks and the consumers free them, the blocks are always released by the other thread
+		static bool CrossThreadTest(size_t numPairs)
+		{
+			struct Block
+			{
+				void* m_ptr = nullptr;
+				uint32_t m_size = 0;
+				uint8_t m_value = 0;
+			};
+
+			TConcurrentBoundedQueue<Block> queue(4096);
+
+			std::atomic<size_t> numConsumed = 0;
+			std::atomic<bool> bFailed = false;
+			TVector<std::thread> threads;
+
+			const size_t numBlocks = NumOperations / 2;
+
+			for (size_t p = 0; p < numPairs; p++)
+			{
+				threads.Emplace([&queue, p, numPairs, numBlocks]()
+					{
+						std::mt19937 random((uint32_t)p);
+
+						for (size_t i = p; i < numBlocks; i += numPairs)
+						{
+							Block block;
+							block.m_size = 1 + random() % MaxBlockSize;
+							block.m_value = (uint8_t)i;
+							block.m_ptr = TAllocator::allocate(block.m_size);
+							Fill(block.m_ptr, block.m_size, block.m_value);
+
+							while (!queue.TryEnqueue(block))
+							{
+								std::this_thread::yield();
+							}
+						}
+					});
+
+				threads.Emplace([&]()
+					{
+						Block block;
+						while (numConsumed.load(std::memory_order_relaxed) < numBlocks)
+						{
+							if (!queue.TryDequeue(block))
+							{
+								std::this_thread::yield();
+								continue;
+							}
+
+							if (!Validate(block.m_ptr, block.m_size, block.m_value))
+							{
+								bFailed = true;
+							}
+
+							// Mix the remote free with the local allocation and free of the consumer
+							void* ptr = TAllocator::allocate(block.m_size);
+							TAllocator::free(block.m_ptr);
+							TAllocator::free(ptr);
+
+							numConsumed++;
+						}
+					});
+			}
+
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			return !bFailed && numConsumed == numBlocks;
+		}
+	};
+}
+
+void Memory::RunMultiThreadedMemoryBenchmark()
+{
+	printf("\nStarting multithreaded memory benchmark...\n");
+
+	TVector<Result> res;
+
+	res.Add(TestCase_MultiThreadedAllocator<MallocAllocator>::RunTests("MallocAllocator"));
+	res.Add(TestCase_MultiThreadedAllocator<LockedThreadHeapAllocator>::RunTests("HeapAllocator per thread under lock (previous LockFreeHeapAllocator)"));
+	res.Add(TestCase_MultiThreadedAllocator<LockFreeHeapAllocator>::RunTests("LockFreeHeapAllocator"));
+
+	for (auto& r : res)
+	{
+		r.PrintLog();
+	}
+
+	printf("\n\n");
+}
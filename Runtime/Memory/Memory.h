@@ -122,7 +122,12 @@ namespace Sailor::Memory
 		}
 	};
 
-	template<typename TGlobalAllocator = Sailor::Memory::DefaultGlobalAllocator, typename TPtr = void*>
+	// The policies of TBlockAllocator: the first fit by the sorted free ranges of each block (MemoryBlockAllocator.hpp)
+	// or the two-level segregated fit over all blocks with O(1) allocate/free (MemoryTlsfAllocator.hpp)
+	struct FirstFitPolicy {};
+	struct TlsfPolicy {};
+
+	template<typename TGlobalAllocator = Sailor::Memory::DefaultGlobalAllocator, typename TPtr = void*, typename TPolicy = FirstFitPolicy>
 	class TBlockAllocator;
 
 	template<typename TGlobalAllocator = Sailor::Memory::DefaultGlobalAllocator, typename TPtr = void*>
@@ -194,4 +199,6 @@ namespace Sailor::Memory
 	}
 
 	void SAILOR_API RunMemoryBenchmark();
+	void SAILOR_API RunMultiThreadedMemoryBenchmark();
+	void SAILOR_API RunBlockAllocatorBenchmark();
 }
\ No newline at end of file
@@ -5,7 +5,7 @@
 
 namespace Sailor::Memory
 {
-	template<typename TGlobalAllocator, typename TPtr>
+	template<typename TGlobalAllocator, typename TPtr, typename TPolicy>
 	class TBlockAllocator
 	{
 	public:
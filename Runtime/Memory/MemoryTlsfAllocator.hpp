@@ -0,0 +1,476 @@
+#pragma once
+#include <bit>
+#include <algorithm>
+#include "Memory.h"
+#include "MemoryBlockAllocator.hpp"
+#include "Core/SpinLock.h"
+#include "Containers/Vector.h"
+#include "Containers/FlatMap.h"
+
+namespace Sailor::Memory
+{
+	/* Two-level segregated fit: the free chunks of all blocks are kept in the lists by the size class.
+	*  The first level is the power of 2 and the second level splits it into SecondLevelCount linear ranges,
+	*  the bitmaps of the non-empty lists give the suitable list with two bit scans, so Allocate and Free are O(1).
+	*  The freed chunk is coalesced with its free neighbours immediately.
+	*  TPtr could point to the device memory, so the headers of the chunks are not stored in the memory itself:
+	*  the chunks are kept in the pool and the allocated ones are found by the offset in the block.
+	*/
+	template<typename TGlobalAllocator, typename TPtr>
+	class TBlockAllocator<TGlobalAllocator, TPtr, TlsfPolicy>
+	{
+	public:
+
+		struct FragmentationReport
+		{
+			size_t m_numBlocks = 0;
+			size_t m_reservedSpace = 0;
+			size_t m_allocatedSpace = 0;
+			size_t m_freeSpace = 0;
+			size_t m_numFreeChunks = 0;
+			size_t m_largestFreeChunk = 0;
+
+			// 0 when the free space is the single chunk, close to 1 when it is scattered between the small chunks
+			float GetFragmentation() const { return m_freeSpace > 0 ? 1.0f - (float)m_largestFreeChunk / m_freeSpace : 0.0f; }
+		};
+
+		TBlockAllocator(size_t blockSize = 2 * 1024 * 1024, size_t averageElementSize = 2048, size_t reservedSize = 4 * 1024 * 1024) :
+			m_blockSize(blockSize),
+			m_reservedSize(reservedSize)
+		{
+			for (auto& lists : m_freeLists)
+			{
+				std::fill(std::begin(lists), std::end(lists), InvalidIndexUINT32);
+			}
+
+			m_chunks.Reserve(std::max(blockSize / std::max(averageElementSize, (size_t)1), (size_t)1));
+		}
+
+		TBlockAllocator(const TBlockAllocator&) = delete;
+		TBlockAllocator& operator= (const TBlockAllocator&) = delete;
+
+		template<typename TDataType>
+		TMemoryPtr<TPtr> Allocate(uint32_t count)
+		{
+			size_t size = count * sizeof(TDataType);
+			return Allocate(size, alignof(TDataType));
+		}
+
+		TMemoryPtr<TPtr> Allocate(size_t size, size_t alignment)
+		{
+			m_lock.Lock();
+
+			alignment = std::max(alignment, (size_t)1);
+
+			// The first chunk of the size class could be misaligned, then we take the chunk with the room for any alignment
+			uint32_t alignmentOffset = 0;
+			uint32_t chunkIndex = FindFreeChunk(size);
+
+			if (chunkIndex == InvalidIndexUINT32 || !Fits(chunkIndex, size, alignment, alignmentOffset))
+			{
+				chunkIndex = FindFreeChunk(size + alignment - 1);
+
+				if (chunkIndex == InvalidIndexUINT32)
+				{
+					chunkIndex = AddBlock(size + alignment - 1);
+				}
+
+				const bool bFits = Fits(chunkIndex, size, alignment, alignmentOffset);
+				check(bFits);
+			}
+
+			RemoveFree(chunkIndex);
+
+			// The empty allocations still occupy a byte to keep the offsets of the chunks unique
+			const size_t usedSize = std::max(size + alignmentOffset, (size_t)1);
+			if (m_chunks[chunkIndex].m_size > usedSize)
+			{
+				Split(chunkIndex, usedSize);
+			}
+
+			Chunk& chunk = m_chunks[chunkIndex];
+			Block& block = m_blocks[chunk.m_blockIndex];
+
+			chunk.m_bIsFree = false;
+			block.m_allocated.Insert(chunk.m_offset, chunkIndex);
+			m_allocatedSpace += chunk.m_size;
+
+			auto res = TMemoryPtr<TPtr>(chunk.m_offset, alignmentOffset, size, block.m_ptr.m_ptr, chunk.m_blockIndex);
+
+			m_lock.Unlock();
+
+			return res;
+		}
+
+		void Free(TMemoryPtr<TPtr>& data)
+		{
+			m_lock.Lock();
+
+			uint32_t* pChunkIndex = nullptr;
+			if (data.m_ptr && data.m_blockIndex < m_blocks.Num() && m_blocks[data.m_blockIndex].m_allocated.Find(data.m_offset, pChunkIndex))
+			{
+				uint32_t chunkIndex = *pChunkIndex;
+				Block& block = m_blocks[data.m_blockIndex];
+
+				block.m_allocated.Remove(data.m_offset);
+				m_allocatedSpace -= m_chunks[chunkIndex].m_size;
+				m_chunks[chunkIndex].m_bIsFree = true;
+
+				const uint32_t prev = m_chunks[chunkIndex].m_prevPhysical;
+				if (prev != InvalidIndexUINT32 && m_chunks[prev].m_bIsFree)
+				{
+					RemoveFree(prev);
+					Merge(prev, chunkIndex);
+					chunkIndex = prev;
+				}
+
+				const uint32_t next = m_chunks[chunkIndex].m_nextPhysical;
+				if (next != InvalidIndexUINT32 && m_chunks[next].m_bIsFree)
+				{
+					RemoveFree(next);
+					Merge(chunkIndex, next);
+				}
+
+				if (m_chunks[chunkIndex].m_size == block.m_size && HeuristicToFreeBlock(block.m_size))
+				{
+					FreeBlock(data.m_blockIndex, chunkIndex);
+				}
+				else
+				{
+					InsertFree(chunkIndex);
+				}
+			}
+
+			data.Clear();
+
+			m_lock.Unlock();
+		}
+
+		virtual ~TBlockAllocator()
+		{
+			m_lock.Lock();
+
+			for (auto& block : m_blocks)
+			{
+				if (block.m_size > 0)
+				{
+					Sailor::Memory::Free<TMemoryPtr<TPtr>, TPtr, TGlobalAllocator>(block.m_ptr, &m_dataAllocator);
+				}
+			}
+
+			m_blocks.Clear();
+			m_chunks.Clear();
+			m_emptyBlocks.Clear();
+			m_emptyChunks.Clear();
+
+			m_lock.Unlock();
+		}
+
+		size_t GetOccupiedSpace() const { return m_usedDataSpace; }
+
+		TGlobalAllocator& GetGlobalAllocator() { return m_dataAllocator; }
+
+		FragmentationReport GetFragmentationReport() const
+		{
+			m_lock.Lock();
+
+			FragmentationReport report{};
+			report.m_reservedSpace = m_usedDataSpace;
+			report.m_allocatedSpace = m_allocatedSpace;
+
+			for (const auto& block : m_blocks)
+			{
+				report.m_numBlocks += block.m_size > 0 ? 1 : 0;
+			}
+
+			for (const auto& chunk : m_chunks)
+			{
+				if (chunk.m_bIsFree)
+				{
+					report.m_numFreeChunks++;
+					report.m_freeSpace += chunk.m_size;
+					report.m_largestFreeChunk = std::max(report.m_largestFreeChunk, chunk.m_size);
+				}
+			}
+
+			m_lock.Unlock();
+
+			return report;
+		}
+
+	private:
+
+		static constexpr uint32_t InvalidIndexUINT32 = (uint32_t)-1;
+
+		static constexpr uint32_t SecondLevelLog2 = 5;
+		static constexpr uint32_t SecondLevelCount = 1u << SecondLevelLog2;
+		static constexpr uint32_t FirstLevelCount = 64 - SecondLevelLog2 + 1;
+
+		// The sizes less than SecondLevelCount are mapped linearly to the first level 0
+		static constexpr size_t SmallSize = SecondLevelCount;
+
+		struct Chunk
+		{
+			size_t m_offset = 0;
+			size_t m_size = 0;
+			uint32_t m_blockIndex = InvalidIndexUINT32;
+
+			// The neighbours in the block
+			uint32_t m_prevPhysical = InvalidIndexUINT32;
+			uint32_t m_nextPhysical = InvalidIndexUINT32;
+
+			// The neighbours in the list of the size class
+			uint32_t m_prevFree = InvalidIndexUINT32;
+			uint32_t m_nextFree = InvalidIndexUINT32;
+
+			bool m_bIsFree = false;
+		};
+
+		struct Block
+		{
+			TMemoryPtr<TPtr> m_ptr{};
+			size_t m_size = 0;
+
+			// The allocated chunks by the offset
+			TFlatMap<size_t, uint32_t> m_allocated;
+		};
+
+		static __forceinline void Mapping(size_t size, uint32_t& outFirstLevel, uint32_t& outSecondLevel)
+		{
+			if (size < SmallSize)
+			{
+				outFirstLevel = 0;
+				outSecondLevel = (uint32_t)size;
+				return;
+			}
+
+			const uint32_t log2 = (uint32_t)std::bit_width(size) - 1;
+			outFirstLevel = log2 - SecondLevelLog2 + 1;
+			outSecondLevel = (uint32_t)(size >> (log2 - SecondLevelLog2)) ^ SecondLevelCount;
+		}
+
+		// The first chunk of the list that fits any size of the class, so there is no search inside of the list
+		uint32_t FindFreeChunk(size_t size) const
+		{
+			if (size >= SmallSize)
+			{
+				const uint32_t log2 = (uint32_t)std::bit_width(size) - 1;
+				size += ((size_t)1 << (log2 - SecondLevelLog2)) - 1;
+			}
+
+			uint32_t firstLevel = 0;
+			uint32_t secondLevel = 0;
+			Mapping(size, firstLevel, secondLevel);
+
+			uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+			if (secondLevelMap == 0)
+			{
+				const uint64_t firstLevelMap = firstLevel + 1 < FirstLevelCount ? m_firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+				if (firstLevelMap == 0)
+				{
+					return InvalidIndexUINT32;
+				}
+
+				firstLevel = (uint32_t)std::countr_zero(firstLevelMap);
+				secondLevelMap = m_secondLevelBitmaps[firstLevel];
+			}
+
+			return m_freeLists[firstLevel][std::countr_zero(secondLevelMap)];
+		}
+
+		bool Fits(uint32_t chunkIndex, size_t size, size_t alignment, uint32_t& outAlignmentOffset) const
+		{
+			const Chunk& chunk = m_chunks[chunkIndex];
+			return Align(size, alignment, Memory::Shift(*m_blocks[chunk.m_blockIndex].m_ptr, chunk.m_offset), chunk.m_size, outAlignmentOffset);
+		}
+
+		void InsertFree(uint32_t chunkIndex)
+		{
+			Chunk& chunk = m_chunks[chunkIndex];
+
+			uint32_t firstLevel = 0;
+			uint32_t secondLevel = 0;
+			Mapping(chunk.m_size, firstLevel, secondLevel);
+
+			uint32_t& head = m_freeLists[firstLevel][secondLevel];
+
+			chunk.m_bIsFree = true;
+			chunk.m_prevFree = InvalidIndexUINT32;
+			chunk.m_nextFree = head;
+
+			if (head != InvalidIndexUINT32)
+			{
+				m_chunks[head].m_prevFree = chunkIndex;
+			}
+
+			head = chunkIndex;
+			m_firstLevelBitmap |= 1ull << firstLevel;
+			m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+		}
+
+		void RemoveFree(uint32_t chunkIndex)
+		{
+			Chunk& chunk = m_chunks[chunkIndex];
+
+			uint32_t firstLevel = 0;
+			uint32_t secondLevel = 0;
+			Mapping(chunk.m_size, firstLevel, secondLevel);
+
+			if (chunk.m_prevFree != InvalidIndexUINT32)
+			{
+				m_chunks[chunk.m_prevFree].m_nextFree = chunk.m_nextFree;
+			}
+			else
+			{
+				m_freeLists[firstLevel][secondLevel] = chunk.m_nextFree;
+
+				if (chunk.m_nextFree == InvalidIndexUINT32)
+				{
+					m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+					if (m_secondLevelBitmaps[firstLevel] == 0)
+					{
+						m_firstLevelBitmap &= ~(1ull << firstLevel);
+					}
+				}
+			}
+
+			if (chunk.m_nextFree != InvalidIndexUINT32)
+			{
+				m_chunks[chunk.m_nextFree].m_prevFree = chunk.m_prevFree;
+			}
+
+			chunk.m_prevFree = InvalidIndexUINT32;
+			chunk.m_nextFree = InvalidIndexUINT32;
+		}
+
+		// The tail of the chunk after the size becomes the new free chunk
+		void Split(uint32_t chunkIndex, size_t size)
+		{
+			const uint32_t tailIndex = AddChunk();
+
+			Chunk& chunk = m_chunks[chunkIndex];
+			Chunk& tail = m_chunks[tailIndex];
+
+			tail.m_offset = chunk.m_offset + size;
+			tail.m_size = chunk.m_size - size;
+			tail.m_blockIndex = chunk.m_blockIndex;
+			tail.m_prevPhysical = chunkIndex;
+			tail.m_nextPhysical = chunk.m_nextPhysical;
+
+			if (chunk.m_nextPhysical != InvalidIndexUINT32)
+			{
+				m_chunks[chunk.m_nextPhysical].m_prevPhysical = tailIndex;
+			}
+
+			chunk.m_size = size;
+			chunk.m_nextPhysical = tailIndex;
+
+			InsertFree(tailIndex);
+		}
+
+		// The right chunk is appended to the left one
+		void Merge(uint32_t leftIndex, uint32_t rightIndex)
+		{
+			Chunk& left = m_chunks[leftIndex];
+			const Chunk& right = m_chunks[rightIndex];
+
+			left.m_size += right.m_size;
+			left.m_nextPhysical = right.m_nextPhysical;
+
+			if (right.m_nextPhysical != InvalidIndexUINT32)
+			{
+				m_chunks[right.m_nextPhysical].m_prevPhysical = leftIndex;
+			}
+
+			RemoveChunk(rightIndex);
+		}
+
+		uint32_t AddChunk()
+		{
+			if (m_emptyChunks.Num() == 0)
+			{
+				m_chunks.AddDefault(1);
+				return (uint32_t)m_chunks.Num() - 1;
+			}
+
+			const uint32_t chunkIndex = m_emptyChunks[m_emptyChunks.Num() - 1];
+			m_emptyChunks.RemoveLast();
+			return chunkIndex;
+		}
+
+		void RemoveChunk(uint32_t chunkIndex)
+		{
+			m_chunks[chunkIndex] = Chunk();
+			m_emptyChunks.Add(chunkIndex);
+		}
+
+		// Returns the free chunk that covers the whole new block
+		uint32_t AddBlock(size_t size)
+		{
+			const size_t blockSize = std::max(size, m_blockSize);
+
+			uint32_t blockIndex = 0;
+			if (m_emptyBlocks.Num() == 0)
+			{
+				blockIndex = (uint32_t)m_blocks.Num();
+				m_blocks.AddDefault(1);
+			}
+			else
+			{
+				blockIndex = m_emptyBlocks[m_emptyBlocks.Num() - 1];
+				m_emptyBlocks.RemoveLast();
+			}
+
+			m_blocks[blockIndex].m_ptr = Sailor::Memory::Allocate<TMemoryPtr<TPtr>, TPtr, TGlobalAllocator>(blockSize, &m_dataAllocator);
+			m_blocks[blockIndex].m_size = blockSize;
+			m_usedDataSpace += blockSize;
+
+			const uint32_t chunkIndex = AddChunk();
+			m_chunks[chunkIndex].m_size = blockSize;
+			m_chunks[chunkIndex].m_blockIndex = blockIndex;
+
+			InsertFree(chunkIndex);
+
+			return chunkIndex;
+		}
+
+		void FreeBlock(uint32_t blockIndex, uint32_t chunkIndex)
+		{
+			Block& block = m_blocks[blockIndex];
+
+			Sailor::Memory::Free<TMemoryPtr<TPtr>, TPtr, TGlobalAllocator>(block.m_ptr, &m_dataAllocator);
+
+			m_usedDataSpace -= block.m_size;
+			block.m_size = 0;
+			block.m_allocated.Clear();
+
+			RemoveChunk(chunkIndex);
+			m_emptyBlocks.Add(blockIndex);
+		}
+
+		bool HeuristicToFreeBlock(size_t blockSize) const
+		{
+			// Keep the reserved space to not allocate the block again on the next allocation
+			return m_usedDataSpace - blockSize >= m_reservedSize;
+		}
+
+		mutable SpinLock m_lock;
+
+		TGlobalAllocator m_dataAllocator;
+
+		size_t m_usedDataSpace = 0;
+		size_t m_allocatedSpace = 0;
+		size_t m_blockSize = 1024;
+		size_t m_reservedSize = 2048;
+
+		TVector<Block> m_blocks;
+		TVector<uint32_t> m_emptyBlocks;
+
+		TVector<Chunk> m_chunks;
+		TVector<uint32_t> m_emptyChunks;
+
+		uint64_t m_firstLevelBitmap = 0;
+		uint32_t m_secondLevelBitmaps[FirstLevelCount]{};
+		uint32_t m_freeLists[FirstLevelCount][SecondLevelCount];
+	};
+}
@@ -330,7 +330,7 @@ void Window::Destroy()
 
 bool Window::IsIconic() const
 {
-	return ::IsIconic(m_hWnd);
+	return IsCreated() && ::IsIconic(m_hWnd);
 }
 
 LRESULT CALLBACK Sailor::Win32::WindowProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
@@ -41,6 +41,7 @@ namespace Sailor::Win32
 		SAILOR_API bool IsRunning() const { return m_bIsRunning; }
 		SAILOR_API bool IsFullscreen() const { return m_bIsFullscreen; }
 		SAILOR_API bool IsIconic() const;
+		SAILOR_API bool IsCreated() const { return m_hWnd != nullptr; }
 
 		SAILOR_API void SetActive(bool value) { m_bIsActive = value; }
 		SAILOR_API void SetRunning(bool value) { m_bIsRunning = value; }
@@ -1,5 +1,6 @@
 #pragma once
 #include "Containers/Map.h"
+#include "Memory/FrameAllocator.h"
 #include "RHI/Types.h"
 #include "RHI/VertexDescription.h"
 #include "RHI/SceneView.h"
@@ -134,7 +135,7 @@ namespace Sailor::RHI
 				prevIndexBuffer = mesh->m_indexBuffer;
 			}
 
-			TVector<RHI::DrawIndexedIndirectData> drawIndirect;
+			TVector<RHI::DrawIndexedIndirectData, Memory::FrameAllocator> drawIndirect;
 			drawIndirect.Reserve(drawCall.Num());
 
 			firstInstanceIndex = std::min(firstInstanceIndex, storageIndex[j]);
@@ -263,7 +264,7 @@ namespace Sailor::RHI
 				prevIndexBuffer = mesh->m_indexBuffer;
 			}
 
-			TVector<RHI::DrawIndexedIndirectData> drawIndirect;
+			TVector<RHI::DrawIndexedIndirectData, Memory::FrameAllocator> drawIndirect;
 			drawIndirect.Reserve(drawCall.Num());
 
 			uint32_t ssboOffset = 0;
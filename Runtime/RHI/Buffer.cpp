@@ -8,6 +8,13 @@ using namespace Sailor::GraphicsDriver::Vulkan;
 
 void* RHIBuffer::GetPointer()
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return m_null.m_memory.GetData();
+	}
+#endif
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 	check(m_memoryProperty & EMemoryPropertyBit::HostVisible);
 
@@ -20,6 +27,13 @@ void* RHIBuffer::GetPointer()
 
 size_t RHIBuffer::GetSize() const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return m_null.m_memory.Num();
+	}
+#endif
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 	return m_vulkan.m_buffer.m_size;
 #endif
@@ -28,6 +42,13 @@ size_t RHIBuffer::GetSize() const
 
 uint32_t RHIBuffer::GetOffset() const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return 0;
+	}
+#endif
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 	return (uint32_t)(*m_vulkan.m_buffer).m_offset;
 #endif
@@ -57,5 +78,12 @@ size_t RHIBuffer::GetCompatibilityHashCode() const
 	}
 #endif
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return (size_t)m_null.m_memory.GetData();
+	}
+#endif
+
 	return 0;
 }
\ No newline at end of file
@@ -13,7 +13,7 @@ namespace Sailor::RHI
 		virtual ~RHIBuffer();
 
 #if defined(SAILOR_BUILD_WITH_VULKAN)
-		using VulkanBufferAllocator = TBlockAllocator<Sailor::Memory::GlobalVulkanBufferAllocator, VulkanBufferMemoryPtr>;
+		using VulkanBufferAllocator = TBlockAllocator<Sailor::Memory::GlobalVulkanBufferAllocator, VulkanBufferMemoryPtr, Sailor::Memory::TlsfPolicy>;
 
 		// TODO: Refactoring move to TManagedMemoryPtr<VulkanBufferAllocator, VulkanBufferAllocator>
 		struct
@@ -23,6 +23,15 @@ namespace Sailor::RHI
 		} m_vulkan;
 #endif
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+		// The null driver keeps the contents in the host memory
+		struct
+		{
+			TVector<uint8_t> m_memory;
+			bool m_bIsNullResource = false;
+		} m_null;
+#endif
+
 		SAILOR_API EBufferUsageFlags GetUsage() const { return m_usage; }
 		SAILOR_API EMemoryPropertyFlags GetMemoryProperty() const { return m_memoryProperty; }
 
@@ -11,7 +11,14 @@ uint32_t RHICommandList::GetGPUCost() const
 	uint32_t res = 0;
 
 #if defined(SAILOR_BUILD_WITH_VULKAN)
-	res = m_vulkan.m_commandBuffer->GetGPUCost();
+	if (m_vulkan.m_commandBuffer)
+	{
+		res = m_vulkan.m_commandBuffer->GetGPUCost();
+	}
+#endif
+
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	res += m_null.m_gpuCost;
 #endif
 
 	return res;
@@ -21,7 +28,14 @@ uint32_t RHICommandList::GetNumRecordedCommands() const
 	uint32_t res = 0;
 
 #if defined(SAILOR_BUILD_WITH_VULKAN)
-	res = m_vulkan.m_commandBuffer->GetNumRecordedCommands();
+	if (m_vulkan.m_commandBuffer)
+	{
+		res = m_vulkan.m_commandBuffer->GetNumRecordedCommands();
+	}
+#endif
+
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	res += m_null.m_numRecordedCommands;
 #endif
 
 	return res;
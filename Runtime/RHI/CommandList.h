@@ -19,6 +19,17 @@ namespace Sailor::RHI
 		} m_vulkan;
 #endif
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+		// The commands are packed one by one, the header is followed by the arguments
+		struct
+		{
+			TVector<uint8_t> m_commands;
+			uint32_t m_numRecordedCommands = 0;
+			uint32_t m_gpuCost = 0;
+			bool m_bIsSecondary = false;
+		} m_null;
+#endif
+
 		bool IsTransferOnly() const { return m_queue == RHI::ECommandListQueue::Transfer; }
 		RHI::ECommandListQueue GetQueue() const { return m_queue; }
 		SAILOR_API uint32_t GetGPUCost() const;
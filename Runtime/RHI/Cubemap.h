@@ -5,6 +5,10 @@
 #include "GraphicsDriver/Vulkan/VulkanGraphicsDriver.h"
 #endif
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+#include "GraphicsDriver/Null/NullGraphicsDriver.h"
+#endif
+
 #include "Texture.h"
 #include "Types.h"
 
@@ -30,5 +34,9 @@ namespace Sailor::RHI
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 		friend class Sailor::GraphicsDriver::Vulkan::VulkanGraphicsDriver;
 #endif
+
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+		friend class Sailor::GraphicsDriver::Null::NullGraphicsDriver;
+#endif
 	};
 };
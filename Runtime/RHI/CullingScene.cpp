@@ -0,0 +1,184 @@
+#include "CullingScene.h"
+#include "Tasks/ParallelFor.h"
+#include "Core/LogMacros.h"
+#include <immintrin.h>
+#include <bit>
+
+using namespace Sailor;
+using namespace Sailor::RHI;
+
+void CullingScene::Update(uint32_t instance, const Math::AABB& worldBounds)
+{
+	if (instance >= m_numInstances)
+	{
+		const size_t numSlots = ((size_t)instance + LaneWidth) / LaneWidth * LaneWidth;
+		const size_t numAdded = numSlots - m_minX.Num();
+
+		if (numAdded > 0)
+		{
+			for (TVector<float>* pArray : { &m_minX, &m_minY, &m_minZ, &m_maxX, &m_maxY, &m_maxZ })
+			{
+				const size_t first = pArray->Num();
+				pArray->AddDefault(numAdded);
+
+				for (size_t i = first; i < numSlots; i++)
+				{
+					(*pArray)[i] = std::numeric_limits<float>::quiet_NaN();
+				}
+			}
+		}
+
+		m_numInstances = instance + 1;
+	}
+
+	m_minX[instance] = worldBounds.m_min.x;
+	m_minY[instance] = worldBounds.m_min.y;
+	m_minZ[instance] = worldBounds.m_min.z;
+	m_maxX[instance] = worldBounds.m_max.x;
+	m_maxY[instance] = worldBounds.m_max.y;
+	m_maxZ[instance] = worldBounds.m_max.z;
+}
+
+void CullingScene::Remove(uint32_t instance)
+{
+	if (instance >= m_numInstances)
+	{
+		return;
+	}
+
+	for (TVector<float>* pArray : { &m_minX, &m_minY, &m_minZ, &m_maxX, &m_maxY, &m_maxZ })
+	{
+		(*pArray)[instance] = std::numeric_limits<float>::quiet_NaN();
+	}
+
+	// The trailing empty slots are dropped, so the culled range follows the last live instance
+	while (m_numInstances > 0 && !Contains(m_numInstances - 1))
+	{
+		m_numInstances--;
+	}
+
+	const size_t numSlots = ((size_t)m_numInstances + LaneWidth - 1) / LaneWidth * LaneWidth;
+	if (numSlots < m_minX.Num())
+	{
+		for (TVector<float>* pArray : { &m_minX, &m_minY, &m_minZ, &m_maxX, &m_maxY, &m_maxZ })
+		{
+			pArray->RemoveAt(numSlots, pArray->Num() - numSlots);
+		}
+	}
+}
+
+Math::AABB CullingScene::GetBounds(uint32_t instance) const
+{
+	check(instance < m_numInstances);
+
+	Math::AABB res{};
+	res.m_min = vec3(m_minX[instance], m_minY[instance], m_minZ[instance]);
+	res.m_max = vec3(m_maxX[instance], m_maxY[instance], m_maxZ[instance]);
+	return res;
+}
+
+void CullingScene::Clear()
+{
+	for (TVector<float>* pArray : { &m_minX, &m_minY, &m_minZ, &m_maxX, &m_maxY, &m_maxZ })
+	{
+		pArray->Clear();
+	}
+
+	m_numInstances = 0;
+}
+
+void CullingScene::Cull(const Math::Frustum* frustums, uint32_t numFrustums, TVector<TVector<uint32_t>>& outVisible) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	outVisible.Clear(false);
+	outVisible.AddDefault(numFrustums);
+
+	if (numFrustums == 0 || m_numInstances == 0)
+	{
+		return;
+	}
+
+	// The planes are stored plane by plane: a, b, c, d
+	TVector<float> planes(numFrustums * 24);
+	for (uint32_t f = 0; f < numFrustums; f++)
+	{
+		for (uint32_t p = 0; p < 6; p++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				planes[f * 24 + p * 4 + c] = frustums[f].GetPlane(p)[c];
+			}
+		}
+	}
+
+	const uint32_t numBlocks = (uint32_t)(m_minX.Num() / LaneWidth);
+	const uint32_t numTasks = (numBlocks + NumBlocksPerTask - 1) / NumBlocksPerTask;
+
+	// The visible instances of the task per frustum, merged in the order of the tasks
+	TVector<TVector<uint32_t>> visibleInTasks(numTasks * numFrustums);
+
+	Tasks::ParallelFor("Frustum culling", 0, numTasks, 1,
+		[&](size_t task)
+		{
+			const uint32_t firstBlock = (uint32_t)task * NumBlocksPerTask;
+			const uint32_t lastBlock = std::min(numBlocks, firstBlock + NumBlocksPerTask);
+			const __m256 zero = _mm256_setzero_ps();
+
+			for (uint32_t f = 0; f < numFrustums; f++)
+			{
+				const float* pPlanes = &planes[f * 24];
+				TVector<uint32_t>& visible = visibleInTasks[task * numFrustums + f];
+
+				for (uint32_t block = firstBlock; block < lastBlock; block++)
+				{
+					const uint32_t first = block * LaneWidth;
+
+					const __m256 minX = _mm256_loadu_ps(&m_minX[first]);
+					const __m256 minY = _mm256_loadu_ps(&m_minY[first]);
+					const __m256 minZ = _mm256_loadu_ps(&m_minZ[first]);
+					const __m256 maxX = _mm256_loadu_ps(&m_maxX[first]);
+					const __m256 maxY = _mm256_loadu_ps(&m_maxY[first]);
+					const __m256 maxZ = _mm256_loadu_ps(&m_maxZ[first]);
+
+					// The farthest corner along the normal should be inside each plane, the same as Frustum::OverlapsAABB.
+					// The comparison with NaN is false, so the empty slots are culled.
+					__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+					for (uint32_t p = 0; p < 6; p++)
+					{
+						const __m256 a = _mm256_broadcast_ss(&pPlanes[p * 4 + 0]);
+						const __m256 b = _mm256_broadcast_ss(&pPlanes[p * 4 + 1]);
+						const __m256 c = _mm256_broadcast_ss(&pPlanes[p * 4 + 2]);
+						const __m256 d = _mm256_broadcast_ss(&pPlanes[p * 4 + 3]);
+
+						const __m256 x = _mm256_max_ps(_mm256_mul_ps(minX, a), _mm256_mul_ps(maxX, a));
+						const __m256 y = _mm256_max_ps(_mm256_mul_ps(minY, b), _mm256_mul_ps(maxY, b));
+						const __m256 z = _mm256_max_ps(_mm256_mul_ps(minZ, c), _mm256_mul_ps(maxZ, c));
+						const __m256 distance = _mm256_add_ps(_mm256_add_ps(x, y), _mm256_add_ps(z, d));
+
+						inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GT_OQ));
+					}
+
+					for (uint32_t mask = (uint32_t)_mm256_movemask_ps(inside); mask; mask &= mask - 1)
+					{
+						visible.Add(first + std::countr_zero(mask));
+					}
+				}
+			}
+		});
+
+	for (uint32_t f = 0; f < numFrustums; f++)
+	{
+		size_t numVisible = 0;
+		for (uint32_t task = 0; task < numTasks; task++)
+		{
+			numVisible += visibleInTasks[task * numFrustums + f].Num();
+		}
+
+		outVisible[f].Reserve(numVisible);
+		for (uint32_t task = 0; task < numTasks; task++)
+		{
+			outVisible[f].AddRange(visibleInTasks[task * numFrustums + f]);
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Containers/Vector.h"
+#include "Math/Bounds.h"
+
+namespace Sailor::RHI
+{
+	/* The world bounds of the scene instances for the frustum culling.
+	*  The bounds are stored as the structure of arrays, so 8 boxes are tested against the plane with one AVX2 op.
+	*  All views (the camera and the shadow cascades) are culled in one pass: the scene is split into the blocks
+	*  between the worker threads, each block is tested against every frustum while it is in the cache.
+	*  The empty slots and the padding are NaN and never pass the test.
+	*/
+	class CullingScene
+	{
+	public:
+
+		// The instance is the index chosen by the owner, the arrays grow to fit it and shrink after the last one is removed
+		void Update(uint32_t instance, const Math::AABB& worldBounds);
+		void Remove(uint32_t instance);
+
+		bool Contains(uint32_t instance) const { return instance < m_numInstances && m_minX[instance] == m_minX[instance]; }
+		Math::AABB GetBounds(uint32_t instance) const;
+
+		// The number of the slots including the empty ones
+		uint32_t GetNumInstances() const { return m_numInstances; }
+
+		// outVisible[i] receives the instances that overlap frustums[i] in the ascending order
+		void Cull(const Math::Frustum* frustums, uint32_t numFrustums, TVector<TVector<uint32_t>>& outVisible) const;
+
+		void Clear();
+
+	protected:
+
+		static constexpr uint32_t LaneWidth = 8;
+		static constexpr uint32_t NumBlocksPerTask = 256;
+
+		TVector<float> m_minX;
+		TVector<float> m_minY;
+		TVector<float> m_minZ;
+		TVector<float> m_maxX;
+		TVector<float> m_maxY;
+		TVector<float> m_maxZ;
+
+		uint32_t m_numInstances = 0;
+	};
+}
@@ -8,6 +8,13 @@ using namespace Sailor::GraphicsDriver::Vulkan;
 
 void RHIFence::Wait(uint64_t timeout) const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return;
+	}
+#endif
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 	VK_CHECK(m_vulkan.m_fence->Wait(timeout));
 #endif
@@ -15,6 +22,14 @@ void RHIFence::Wait(uint64_t timeout) const
 
 void RHIFence::Reset() const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		m_null.m_bIsSignaled = false;
+		return;
+	}
+#endif
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 	VK_CHECK(m_vulkan.m_fence->Reset());
 #endif
@@ -22,6 +37,13 @@ void RHIFence::Reset() const
 
 bool RHIFence::IsFinished() const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return m_null.m_bIsSignaled;
+	}
+#endif
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 	return m_vulkan.m_fence && m_vulkan.m_fence->Status() == VkResult::VK_SUCCESS;
 #endif
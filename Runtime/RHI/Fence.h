@@ -32,6 +32,15 @@ namespace Sailor::RHI
 		} m_vulkan;
 #endif
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+		// The null driver executes the command lists on submit, the fence stays null after the reset
+		struct
+		{
+			mutable bool m_bIsSignaled = false;
+			bool m_bIsNullResource = false;
+		} m_null;
+#endif
+
 		SAILOR_API void Wait(uint64_t timeout = UINT64_MAX) const;
 		SAILOR_API void Reset() const;
 		SAILOR_API bool IsFinished() const;
@@ -278,6 +278,8 @@ namespace Sailor::RHI
 		SAILOR_API virtual void ClearDepthStencil(RHI::RHICommandListPtr cmd, RHI::RHITexturePtr dst, float depth = 0.0f, uint32_t stencil = 0) = 0;
 
 		SAILOR_API virtual void BeginSecondaryCommandList(RHICommandListPtr cmd, bool bOneTimeSubmit = false, bool bSupportMultisampling = true, RHI::EFormat colorAttachment = RHI::EFormat::R16G16B16A16_SFLOAT) = 0;
+
+		// The secondary command list that is begun that way should be executed outside of the render pass
 		SAILOR_API virtual void BeginCommandList(RHICommandListPtr cmd, bool bOneTimeSubmit) = 0;
 		SAILOR_API virtual void EndCommandList(RHICommandListPtr cmd) = 0;
 
@@ -11,7 +11,9 @@
 #include "GraphicsDriver/Vulkan/VulkanDevice.h"
 #include "Tasks/Scheduler.h"
 #include "Memory/MemoryBlockAllocator.hpp"
+#include "Memory/FrameAllocator.h"
 #include "GraphicsDriver/Vulkan/VulkanGraphicsDriver.h"
+#include "GraphicsDriver/Null/NullGraphicsDriver.h"
 #include "Components/TestComponent.h"
 #include "Components/MeshRendererComponent.h"
 #include "Engine/World.h"
@@ -52,16 +54,28 @@ bool IDelayedInitialization::IsReady() const
 	return m_dependencies.Num() == 0;
 }
 
-Renderer::Renderer(Win32::Window* pViewport, RHI::EMsaaSamples msaaSamples, bool bIsDebug)
+Renderer::Renderer(Win32::Window* pViewport, RHI::EMsaaSamples msaaSamples, bool bIsDebug, bool bIsNullRhi)
 {
 	m_pViewport = pViewport;
 	m_msaaSamples = msaaSamples;
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (bIsNullRhi)
+	{
+		m_driverInstance = TUniquePtr<Sailor::GraphicsDriver::Null::NullGraphicsDriver>::Make();
+	}
+#endif
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
-	m_driverInstance = TUniquePtr<Sailor::GraphicsDriver::Vulkan::VulkanGraphicsDriver>::Make();
-	m_driverInstance->Initialize(pViewport, msaaSamples, bIsDebug);
+	if (!m_driverInstance)
+	{
+		m_driverInstance = TUniquePtr<Sailor::GraphicsDriver::Vulkan::VulkanGraphicsDriver>::Make();
+	}
 #endif
 
+	check(m_driverInstance);
+	m_driverInstance->Initialize(pViewport, msaaSamples, bIsDebug);
+
 	// Create default Vertices descriptions cache 
 	auto& vertexP3N3UV2C4 = m_driverInstance->GetOrAddVertexDescription<RHI::VertexP3N3UV2C4>();
 	vertexP3N3UV2C4->SetVertexStride(sizeof(RHI::VertexP3N3UV2C4));
@@ -97,35 +111,58 @@ Renderer::~Renderer()
 	m_driverInstance.Clear();
 }
 
+void Renderer::ToggleParallelFrameGraphRecording()
+{
+	auto renderer = App::GetSubmodule<Renderer>();
+	renderer->m_bParallelFrameGraphRecording = !renderer->m_bParallelFrameGraphRecording;
+
+	SAILOR_LOG("Parallel FrameGraph recording: %d", (bool)renderer->m_bParallelFrameGraphRecording);
+}
+
 void Renderer::MemoryStats()
 {
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 	auto driverInstance = App::GetSubmodule<Renderer>()->GetDriver().DynamicCast<Sailor::GraphicsDriver::Vulkan::VulkanGraphicsDriver>();
 
-	const auto& internalMemoryAllocators = VulkanApi::GetInstance()->GetMainDevice()->GetMemoryAllocators();
-
-	float texturesOccupiedSpace = 0.0f;
-	for (const auto& allocator : internalMemoryAllocators)
+	// The null driver has no device memory
+	if (driverInstance)
 	{
-		texturesOccupiedSpace += allocator.m_second->GetOccupiedSpace() / (1024.0f * 1024.0f);
-	}
+		const auto& internalMemoryAllocators = VulkanApi::GetInstance()->GetMainDevice()->GetMemoryAllocators();
+
+		float texturesOccupiedSpace = 0.0f;
+		float texturesFreeSpace = 0.0f;
+		float texturesLargestFreeChunk = 0.0f;
+		for (const auto& allocator : internalMemoryAllocators)
+		{
+			const auto report = allocator.m_second->GetFragmentationReport();
 
-	const auto& uniformBuffersMemoryAllocators = driverInstance->GetUniformBufferAllocators();
+			texturesOccupiedSpace += allocator.m_second->GetOccupiedSpace() / (1024.0f * 1024.0f);
+			texturesFreeSpace += report.m_freeSpace / (1024.0f * 1024.0f);
+			texturesLargestFreeChunk = std::max(texturesLargestFreeChunk, report.m_largestFreeChunk / (1024.0f * 1024.0f));
+		}
 
-	float uniformBuffersOccupiedSpace = 0.0f;
-	for (const auto& allocator : uniformBuffersMemoryAllocators)
-	{
-		uniformBuffersOccupiedSpace += allocator.m_second->GetOccupiedSpace() / (1024.0f * 1024.0f);
-	}
+		const auto& uniformBuffersMemoryAllocators = driverInstance->GetUniformBufferAllocators();
 
-	SAILOR_LOG("Memory consumption (GPU):");
-	SAILOR_LOG("Materials: % 2.fmb", driverInstance->GetMaterialSsboAllocator()->GetOccupiedSpace() / (1024.0f * 1024.0f));
-	SAILOR_LOG("General: % 2.fmb", driverInstance->GetGeneralSsboAllocator()->GetOccupiedSpace() / (1024.0f * 1024.0f));
-	SAILOR_LOG("Meshes: % 2.fmb", driverInstance->GetMeshSsboAllocator()->GetOccupiedSpace() / (1024.0f * 1024.0f));
-	SAILOR_LOG("Textures: % 2.fmb", texturesOccupiedSpace);
-	SAILOR_LOG("UniformBuffers: % 2.fmb", uniformBuffersOccupiedSpace);
+		float uniformBuffersOccupiedSpace = 0.0f;
+		for (const auto& allocator : uniformBuffersMemoryAllocators)
+		{
+			uniformBuffersOccupiedSpace += allocator.m_second->GetOccupiedSpace() / (1024.0f * 1024.0f);
+		}
 
+		SAILOR_LOG("Memory consumption (GPU):");
+		SAILOR_LOG("Materials: % 2.fmb", driverInstance->GetMaterialSsboAllocator()->GetOccupiedSpace() / (1024.0f * 1024.0f));
+		SAILOR_LOG("General: % 2.fmb", driverInstance->GetGeneralSsboAllocator()->GetOccupiedSpace() / (1024.0f * 1024.0f));
+		SAILOR_LOG("Meshes: % 2.fmb", driverInstance->GetMeshSsboAllocator()->GetOccupiedSpace() / (1024.0f * 1024.0f));
+		SAILOR_LOG("Textures: % 2.fmb, free: % 2.fmb, largest free chunk: % 2.fmb", texturesOccupiedSpace, texturesFreeSpace, texturesLargestFreeChunk);
+		SAILOR_LOG("UniformBuffers: % 2.fmb", uniformBuffersOccupiedSpace);
+	}
 #endif
+
+	const auto frameAllocatorStats = Memory::FrameAllocator::GetLastFrameStats();
+
+	SAILOR_LOG("Frame allocator (CPU, last frame):");
+	SAILOR_LOG("Allocations: %zu, Reallocations in place: %zu, Skipped frees: %zu", frameAllocatorStats.m_numAllocations, frameAllocatorStats.m_numReallocations, frameAllocatorStats.m_numFrees);
+	SAILOR_LOG("Used: % 2.fkb, Reserved: % 2.fkb", frameAllocatorStats.m_bytesUsed / 1024.0f, frameAllocatorStats.m_bytesReserved / 1024.0f);
 }
 
 RHI::EFormat Renderer::GetColorFormat() const
@@ -156,7 +193,7 @@ TUniquePtr<IGraphicsDriver>& Renderer::GetDriver()
 IGraphicsDriverCommands* Renderer::GetDriverCommands()
 {
 
-#if defined(SAILOR_BUILD_WITH_VULKAN)
+#if defined(SAILOR_BUILD_WITH_VULKAN) || defined(SAILOR_BUILD_WITH_NULL_RHI)
 	return dynamic_cast<IGraphicsDriverCommands*>(App::GetSubmodule<Renderer>()->m_driverInstance.GetRawPtr());
 #endif
 
@@ -279,9 +316,13 @@ bool Renderer::PushFrame(const Sailor::FrameState& frame)
 
 				if (!m_bFrameGraphOutdated && !m_pViewport->IsIconic())
 				{
-					rhiFrameGraph->SetRenderTarget("BackBuffer", m_driverInstance->GetBackBuffer());
-					rhiFrameGraph->SetRenderTarget("DepthBuffer", m_driverInstance->GetDepthBuffer());
+					rhiFrameGraph->SetRenderTarget(RHIFrameGraph::BackBuffer, m_driverInstance->GetBackBuffer());
+					rhiFrameGraph->SetRenderTarget(RHIFrameGraph::DepthBuffer, m_driverInstance->GetDepthBuffer());
+					rhiFrameGraph->SetParallelRecording(m_bParallelFrameGraphRecording);
+
+					m_frameGraphTimer.Start();
 					rhiFrameGraph->Process(rhiSceneView, transferCommandLists, primaryCommandLists, chainSemaphore);
+					m_frameGraphTimer.Stop();
 				}
 
 				SAILOR_PROFILE_BLOCK("Submit transfer command lists");
@@ -306,15 +347,19 @@ bool Renderer::PushFrame(const Sailor::FrameState& frame)
 						m_stats.m_gpuFps = totalFramesCount;
 						totalFramesCount = 0;
 						timer.Clear();
+						m_stats.m_numSubmittedCommandBuffers = m_driverInstance->GetNumSubmittedCommandBuffers();
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
-						size_t heapUsage = 0;
-						size_t heapBudget = 0;
+						if (m_driverInstance.DynamicCast<Sailor::GraphicsDriver::Vulkan::VulkanGraphicsDriver>())
+						{
+							size_t heapUsage = 0;
+							size_t heapBudget = 0;
 
-						VulkanApi::GetInstance()->GetMainDevice()->GetOccupiedVideoMemory(VkMemoryHeapFlagBits::VK_MEMORY_HEAP_DEVICE_LOCAL_BIT, heapBudget, heapUsage);
+							VulkanApi::GetInstance()->GetMainDevice()->GetOccupiedVideoMemory(VkMemoryHeapFlagBits::VK_MEMORY_HEAP_DEVICE_LOCAL_BIT, heapBudget, heapUsage);
 
-						m_stats.m_gpuHeapUsage = heapUsage;
-						m_stats.m_gpuHeapBudget = heapBudget;
-						m_stats.m_numSubmittedCommandBuffers = m_driverInstance->GetNumSubmittedCommandBuffers();
+							m_stats.m_gpuHeapUsage = heapUsage;
+							m_stats.m_gpuHeapBudget = heapBudget;
+						}
 #endif // SAILOR_BUILD_WITH_VULKAN
 					}
 				}
@@ -13,6 +13,7 @@
 #include "Memory/UniquePtr.hpp"
 #include "Memory/ObjectPtr.hpp"
 #include "Core/Submodule.h"
+#include "Core/Utils.h"
 #include "Tasks/Scheduler.h"
 #include "GraphicsDriver.h"
 #include "SceneView.h"
@@ -33,7 +34,7 @@ namespace Sailor::RHI
 
 		static constexpr uint32_t MaxFramesInQueue = 2;
 
-		SAILOR_API Renderer(class Win32::Window* pViewport, RHI::EMsaaSamples msaaSamples, bool bIsDebug);
+		SAILOR_API Renderer(class Win32::Window* pViewport, RHI::EMsaaSamples msaaSamples, bool bIsDebug, bool bIsNullRhi = false);
 		SAILOR_API ~Renderer() override;
 
 		SAILOR_API RHI::EMsaaSamples GetMsaaSamples() const { return m_msaaSamples; }
@@ -45,6 +46,9 @@ namespace Sailor::RHI
 
 		SAILOR_API const Stats& GetStats() const { return m_stats; }
 
+		// Accumulates the CPU time of RHIFrameGraph::Process on the render thread
+		SAILOR_API Utils::Timer& GetFrameGraphTimer() { return m_frameGraphTimer; }
+
 		SAILOR_API static TUniquePtr<IGraphicsDriver>& GetDriver();
 		SAILOR_API static IGraphicsDriverCommands* GetDriverCommands();
 
@@ -57,6 +61,7 @@ namespace Sailor::RHI
 		SAILOR_API FrameGraphPtr GetFrameGraph() { return m_frameGraph; }
 
 		SAILOR_API static void MemoryStats();
+		SAILOR_API static void ToggleParallelFrameGraphRecording();
 
 	protected:
 
@@ -64,8 +69,10 @@ namespace Sailor::RHI
 
 		std::atomic<bool> m_bFrameGraphOutdated = false;
 		std::atomic<bool> m_bForceStop = false;
+		std::atomic<bool> m_bParallelFrameGraphRecording = false;
 
 		RHI::Stats m_stats{};
+		Utils::Timer m_frameGraphTimer{};
 
 		class Win32::Window* m_pViewport;
 
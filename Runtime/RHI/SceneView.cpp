@@ -47,6 +47,7 @@ void RHISceneView::Clear()
 	m_cameras.Clear();
 	m_cameraTransforms.Clear();
 	m_shadowMapsToUpdate.Clear();
+	m_visibleInstances.Clear();
 
 	m_drawImGui.Clear();
 	m_debugDraw.Clear();
@@ -54,34 +55,44 @@ void RHISceneView::Clear()
 }
 
 TVector<RHISceneViewProxy> RHISceneView::TraceScene(const Math::Frustum& frustum, bool bSkipMaterials) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	TVector<TVector<uint32_t>> visible;
+	m_cullingScene.Cull(&frustum, 1, visible);
+
+	return GatherProxies(visible[0], bSkipMaterials);
+}
+
+TVector<RHISceneViewProxy> RHISceneView::GatherProxies(const TVector<uint32_t>& visibleInstances, bool bSkipMaterials) const
 {
 	const uint32_t NumProxiesPerTask = 1024;
 
 	SAILOR_PROFILE_FUNCTION();
 
 	TVector<RHISceneViewProxy> res;
+	res.Reserve(visibleInstances.Num());
 
-	// Stationary
-	TVector<RHIMeshProxy> meshProxies;
-	m_stationaryOctree.Trace(frustum, meshProxies);
 	TVector<Tasks::TaskPtr<TVector<RHISceneViewProxy>>> tasks;
-	for (uint32_t i = 0; i < meshProxies.Num() / NumProxiesPerTask + 1; i++)
+	for (uint32_t i = 0; i < visibleInstances.Num() / NumProxiesPerTask + 1; i++)
 	{
 		Tasks::TaskPtr<TVector<RHISceneViewProxy>> task = Tasks::CreateTaskWithResult<TVector<RHISceneViewProxy>>("Create list of scene view proxies",
-			[&res, NumProxiesPerTask, i, &meshProxies, &m_world = m_world, bSkipMaterials]()
+			[this, NumProxiesPerTask, i, &visibleInstances, bSkipMaterials]()
 			{
 				TVector<RHISceneViewProxy> temp;
 				temp.Reserve(NumProxiesPerTask);
 				for (uint32_t j = 0; j < NumProxiesPerTask; j++)
 				{
-					if (i * NumProxiesPerTask + j >= meshProxies.Num())
+					if (i * NumProxiesPerTask + j >= visibleInstances.Num())
 					{
 						break;
 					}
 
-					auto& meshProxy = meshProxies[i * NumProxiesPerTask + j];
+					const uint32_t instance = visibleInstances[i * NumProxiesPerTask + j];
+					auto& meshProxy = m_meshProxies[instance];
 					auto& ecsData = m_world->GetECS<StaticMeshRendererECS>()->GetComponentData(meshProxy.m_staticMeshEcs);
 
+					// The removed components are not in the culling scene, only the ones without the materials yet are skipped
 					if (ecsData.GetMaterials().Num() == 0)
 					{
 						continue;
@@ -94,8 +105,7 @@ TVector<RHISceneViewProxy> RHISceneView::TraceScene(const Math::Frustum& frustum
 					viewProxy.m_overrideMaterials.Clear();
 					viewProxy.m_frame = ecsData.GetFrameLastChange();
 					viewProxy.m_bCastShadows = ecsData.ShouldCastShadow();
-					viewProxy.m_worldAabb = ecsData.GetModel()->GetBoundsAABB();
-					viewProxy.m_worldAabb.Apply(viewProxy.m_worldMatrix);
+					viewProxy.m_worldAabb = m_cullingScene.GetBounds(instance);
 
 					viewProxy.m_overrideMaterials.Reserve(viewProxy.m_meshes.Num());
 					// TODO: Should we check AABB for each mesh in model?
@@ -117,7 +127,7 @@ TVector<RHISceneViewProxy> RHISceneView::TraceScene(const Math::Frustum& frustum
 				return temp;
 			});
 
-		if (meshProxies.Num() < NumProxiesPerTask)
+		if (visibleInstances.Num() < NumProxiesPerTask)
 		{
 			task->Execute();
 			res.AddRange(std::move(task->m_result));
@@ -135,12 +145,6 @@ TVector<RHISceneViewProxy> RHISceneView::TraceScene(const Math::Frustum& frustum
 		res.AddRange(std::move(t->m_result));
 	}
 
-	// Static
-	TVector<RHISceneViewProxy> proxies;
-	m_staticOctree.Trace(frustum, proxies);
-
-	res.AddRange(std::move(proxies));
-
 	return res;
 }
 
@@ -167,7 +171,10 @@ void RHISceneView::PrepareSnapshots()
 		res.m_rhiLightsData = m_rhiLightsData;
 		res.m_drawImGui = m_drawImGui;
 		res.m_shadowMapsToUpdate = std::move(m_shadowMapsToUpdate[i]);
-		res.m_proxies = std::move(TraceScene(frustum, false));
+		// The camera is culled together with the shadow cascades when the lighting is filled
+		res.m_proxies = i < m_visibleInstances.Num() ?
+			GatherProxies(m_visibleInstances[i], false) :
+			TraceScene(frustum, false);
 
 		res.m_debugDrawSecondaryCmdList = m_debugDraw[i];
 		m_snapshots.Emplace(std::move(res));
@@ -2,6 +2,7 @@
 #include "Core/Defines.h"
 #include "Memory/Memory.h"
 #include "Containers/Octree.h"
+#include "RHI/CullingScene.h"
 #include "Engine/Types.h"
 #include "RHI/Mesh.h"
 #include "RHI/Material.h"
@@ -88,8 +89,15 @@ namespace Sailor::RHI
 		SAILOR_API void PrepareSnapshots();
 		SAILOR_API void PrepareDebugDrawCommandLists(WorldPtr world);
 
-		TOctree<RHIMeshProxy> m_stationaryOctree{ glm::ivec3(0,0,0), 16536 * 16, 4 };
-		TOctree<RHISceneViewProxy> m_staticOctree{ glm::ivec3(0,0,0), 16536 * 16, 4 };
+		// Builds the proxies of the culled instances, the materials are resolved from the components
+		SAILOR_API TVector<RHISceneViewProxy> GatherProxies(const TVector<uint32_t>& visibleInstances, bool bSkipMaterials) const;
+
+		// The static meshes by the index of the component
+		CullingScene m_cullingScene{};
+		TVector<RHIMeshProxy> m_meshProxies{};
+
+		// The instances visible by each camera, culled together with the shadow cascades
+		TVector<TVector<uint32_t>> m_visibleInstances;
 
 		uint32_t m_totalNumLights = 0;
 		RHI::RHIShaderBindingSetPtr m_rhiLightsData{};
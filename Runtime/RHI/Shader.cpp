@@ -1,4 +1,5 @@
 #include "Shader.h"
+#include "Buffer.h"
 #include "Types.h"
 #include "GraphicsDriver/Vulkan/VulkanApi.h"
 #include "GraphicsDriver/Vulkan/VulkanGraphicsDriver.h"
@@ -10,6 +11,13 @@ using namespace Sailor::GraphicsDriver::Vulkan;
 
 bool RHIShaderBinding::IsBind() const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_buffer)
+	{
+		return true;
+	}
+#endif
+
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 	return m_textureBinding.Num() > 0 || (bool)(m_vulkan.m_valueBinding);
 #endif
@@ -40,6 +48,12 @@ size_t RHIShaderBinding::GetCompatibilityHash() const
 			HashCombine(hash, p(m_vulkan.m_valueBinding->Get().m_ptr.m_buffer), m_vulkan.m_valueBinding->Get().m_offset);
 		}
 	}
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	else if (m_null.m_buffer)
+	{
+		HashCombine(hash, p(m_null.m_buffer), m_null.m_offset);
+	}
+#endif
 
 	return hash;
 }
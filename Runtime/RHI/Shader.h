@@ -15,7 +15,7 @@ namespace Sailor::RHI
 	{
 	public:
 #if defined(SAILOR_BUILD_WITH_VULKAN)
-		using VulkanBufferAllocator = TBlockAllocator<Sailor::Memory::GlobalVulkanBufferAllocator, VulkanBufferMemoryPtr>;
+		using VulkanBufferAllocator = TBlockAllocator<Sailor::Memory::GlobalVulkanBufferAllocator, VulkanBufferMemoryPtr, Sailor::Memory::TlsfPolicy>;
 
 		struct
 		{
@@ -26,6 +26,15 @@ namespace Sailor::RHI
 		} m_vulkan;
 #endif
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+		struct
+		{
+			RHIBufferPtr m_buffer{};
+			size_t m_offset = 0;
+			uint32_t m_storageInstanceIndex = 0;
+		} m_null;
+#endif
+
 		SAILOR_API bool IsBind() const;
 
 		SAILOR_API size_t GetCompatibilityHash() const;
@@ -35,6 +44,12 @@ namespace Sailor::RHI
 
 		SAILOR_API uint32_t GetStorageInstanceIndex() const
 		{
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+			if (m_null.m_buffer)
+			{
+				return m_null.m_storageInstanceIndex;
+			}
+#endif
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 			return m_vulkan.m_storageInstanceIndex;
 #endif
@@ -43,6 +58,12 @@ namespace Sailor::RHI
 
 		SAILOR_API size_t GetBufferOffset() const
 		{
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+			if (m_null.m_buffer)
+			{
+				return m_null.m_offset;
+			}
+#endif
 #if defined(SAILOR_BUILD_WITH_VULKAN)
 			return (*m_vulkan.m_valueBinding->Get()).m_offset;
 #endif
@@ -10,6 +10,13 @@ using namespace Sailor::GraphicsDriver::Vulkan;
 
 glm::ivec2 RHITexture::GetExtent() const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return m_null.m_extent;
+	}
+#endif
+
 	uint32_t baseMipLevel = m_vulkan.m_imageView->m_subresourceRange.baseMipLevel;
 
 	return glm::vec2(m_vulkan.m_image->m_extent.width, m_vulkan.m_image->m_extent.height) / powf(2, (float)baseMipLevel);
@@ -17,10 +24,24 @@ glm::ivec2 RHITexture::GetExtent() const
 
 EFormat RHITexture::GetFormat() const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return m_null.m_format;
+	}
+#endif
+
 	return (EFormat)m_vulkan.m_image->m_format;
 }
 
 size_t RHITexture::GetSize() const
 {
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	if (m_null.m_bIsNullResource)
+	{
+		return m_null.m_size;
+	}
+#endif
+
 	return m_vulkan.m_image->GetMemoryRequirements().size;
 }
\ No newline at end of file
@@ -22,6 +22,16 @@ namespace Sailor::RHI
 		} m_vulkan;
 #endif
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+		struct
+		{
+			EFormat m_format = EFormat::UNDEFINED;
+			glm::ivec2 m_extent{};
+			size_t m_size = 0;
+			bool m_bIsNullResource = false;
+		} m_null;
+#endif
+
 		SAILOR_API RHITexture(ETextureFiltration filtration, ETextureClamping clamping, bool bShouldGenerateMips, EImageLayout defaultLayout = EImageLayout::ShaderReadOnlyOptimal, ESamplerReductionMode reduction = ESamplerReductionMode::Average) :
 			m_filtration(filtration),
 			m_clamping(clamping),
@@ -18,6 +18,75 @@ bool RHI::IsDepthStencilFormat(ETextureFormat textureFormat)
 		textureFormat == RHI::EFormat::D24_UNORM_S8_UINT;
 }
 
+uint32_t RHI::GetBitsPerPixel(ETextureFormat textureFormat)
+{
+	// The uncompressed color formats go in the ranges of the same texel size
+	static const std::pair<EFormat, uint32_t> ranges[] =
+	{
+		{ EFormat::UNDEFINED, 0 },
+		{ EFormat::R4G4_UNORM_PACK8, 8 },
+		{ EFormat::A1R5G5B5_UNORM_PACK16, 16 },
+		{ EFormat::R8_SRGB, 8 },
+		{ EFormat::R8G8_SRGB, 16 },
+		{ EFormat::B8G8R8_SRGB, 24 },
+		{ EFormat::A2B10G10R10_SINT_PACK32, 32 },
+		{ EFormat::R16_SFLOAT, 16 },
+		{ EFormat::R16G16_SFLOAT, 32 },
+		{ EFormat::R16G16B16_SFLOAT, 48 },
+		{ EFormat::R16G16B16A16_SFLOAT, 64 },
+		{ EFormat::R32_SFLOAT, 32 },
+		{ EFormat::R32G32_SFLOAT, 64 },
+		{ EFormat::R32G32B32_SFLOAT, 96 },
+		{ EFormat::R32G32B32A32_SFLOAT, 128 },
+		{ EFormat::R64_SFLOAT, 64 },
+		{ EFormat::R64G64_SFLOAT, 128 },
+		{ EFormat::R64G64B64_SFLOAT, 192 },
+		{ EFormat::R64G64B64A64_SFLOAT, 256 }
+	};
+
+	for (const auto& range : ranges)
+	{
+		if (textureFormat <= range.first)
+		{
+			return range.second;
+		}
+	}
+
+	switch (textureFormat)
+	{
+	case EFormat::B10G11R11_UFLOAT_PACK32:
+	case EFormat::E5B9G9R9_UFLOAT_PACK32:
+	case EFormat::X8_D24_UNORM_PACK32:
+	case EFormat::D32_SFLOAT:
+	case EFormat::D24_UNORM_S8_UINT:
+	// The most of the implementations pad the stencil
+	case EFormat::D16_UNORM_S8_UINT:
+		return 32;
+	case EFormat::D16_UNORM:
+		return 16;
+	case EFormat::S8_UINT:
+		return 8;
+	case EFormat::D32_SFLOAT_S8_UINT:
+		return 64;
+	case EFormat::BC1_RGB_UNORM_BLOCK:
+	case EFormat::BC1_RGB_SRGB_BLOCK:
+	case EFormat::BC1_RGBA_UNORM_BLOCK:
+	case EFormat::BC1_RGBA_SRGB_BLOCK:
+	case EFormat::BC4_UNORM_BLOCK:
+	case EFormat::BC4_SNORM_BLOCK:
+	case EFormat::ETC2_R8G8B8_UNORM_BLOCK:
+	case EFormat::ETC2_R8G8B8_SRGB_BLOCK:
+	case EFormat::ETC2_R8G8B8A1_UNORM_BLOCK:
+	case EFormat::ETC2_R8G8B8A1_SRGB_BLOCK:
+	case EFormat::EAC_R11_UNORM_BLOCK:
+	case EFormat::EAC_R11_SNORM_BLOCK:
+		return 4;
+	default:
+		// BC2, BC3, BC5-BC7, ETC2 RGBA, EAC RG and ASTC 4x4 as the upper bound
+		return 8;
+	}
+}
+
 uint64_t PackVertexAttributeFormat(EFormat format)
 {
 	switch (format)
@@ -364,6 +364,9 @@ namespace Sailor::RHI
 	SAILOR_API bool IsDepthFormat(ETextureFormat textureFormat);
 	SAILOR_API bool IsDepthStencilFormat(ETextureFormat textureFormat);
 
+	// The size of the texel in bits, the block compressed formats are averaged per texel
+	SAILOR_API uint32_t GetBitsPerPixel(ETextureFormat textureFormat);
+
 	enum ETextureUsageBit : uint8_t
 	{
 		TextureTransferSrc_Bit = 0x00000001,
@@ -1,54 +1,365 @@
 #include "BVH.h"
 #include "Tasks/Scheduler.h"
+#include "Tasks/ParallelFor.h"
 #include "Containers/Vector.h"
 #include "Core/LogMacros.h"
 #include "Core/Utils.h"
 #include "glm/glm/glm.hpp"
 #include "Math/Math.h"
 #include "Math/Bounds.h"
+#include <immintrin.h>
+#include <bit>
 
 using namespace Sailor;
 using namespace Sailor::Math;
 using namespace Sailor::Raytracing;
 
-float BVH::FindBestSplitPlane(const BVHNode& node, const TVector<Math::Triangle>& tris, int32_t& outAxis, float& outSplitPos) const
+namespace
+{
+	struct SimdSSE
+	{
+		using Float = __m128;
+		static constexpr uint32_t Width = 4;
+
+		static __forceinline Float Set1(float value) { return _mm_set1_ps(value); }
+		static __forceinline Float Load(const float* ptr) { return _mm_load_ps(ptr); }
+		static __forceinline Float LoadUnaligned(const float* ptr) { return _mm_loadu_ps(ptr); }
+		static __forceinline void Store(float* ptr, Float value) { _mm_store_ps(ptr, value); }
+
+		static __forceinline Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+		static __forceinline Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+		static __forceinline Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+		static __forceinline Float Min(Float a, Float b) { return _mm_min_ps(a, b); }
+		static __forceinline Float Max(Float a, Float b) { return _mm_max_ps(a, b); }
+
+		static __forceinline Float Less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+		static __forceinline Float LessEqual(Float a, Float b) { return _mm_cmple_ps(a, b); }
+		static __forceinline Float And(Float a, Float b) { return _mm_and_ps(a, b); }
+		static __forceinline Float Or(Float a, Float b) { return _mm_or_ps(a, b); }
+
+		static __forceinline uint32_t MoveMask(Float value) { return (uint32_t)_mm_movemask_ps(value); }
+	};
+
+	struct SimdAVX2
+	{
+		using Float = __m256;
+		static constexpr uint32_t Width = 8;
+
+		static __forceinline Float Set1(float value) { return _mm256_set1_ps(value); }
+		static __forceinline Float Load(const float* ptr) { return _mm256_load_ps(ptr); }
+		static __forceinline Float LoadUnaligned(const float* ptr) { return _mm256_loadu_ps(ptr); }
+		static __forceinline void Store(float* ptr, Float value) { _mm256_store_ps(ptr, value); }
+
+		static __forceinline Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+		static __forceinline Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+		static __forceinline Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+		static __forceinline Float Min(Float a, Float b) { return _mm256_min_ps(a, b); }
+		static __forceinline Float Max(Float a, Float b) { return _mm256_max_ps(a, b); }
+
+		static __forceinline Float Less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		static __forceinline Float LessEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		static __forceinline Float And(Float a, Float b) { return _mm256_and_ps(a, b); }
+		static __forceinline Float Or(Float a, Float b) { return _mm256_or_ps(a, b); }
+
+		static __forceinline uint32_t MoveMask(Float value) { return (uint32_t)_mm256_movemask_ps(value); }
+	};
+
+	// The rays of the packet in SoA layout
+	template<typename TSimd>
+	struct alignas(32) TRayPacket
+	{
+		float m_origin[3][TSimd::Width];
+		float m_direction[3][TSimd::Width];
+		float m_rDirection[3][TSimd::Width];
+		float m_maxLength[TSimd::Width];
+
+		__forceinline typename TSimd::Float Origin(uint32_t axis) const { return TSimd::Load(m_origin[axis]); }
+		__forceinline typename TSimd::Float Direction(uint32_t axis) const { return TSimd::Load(m_direction[axis]); }
+		__forceinline typename TSimd::Float ReciprocalDirection(uint32_t axis) const { return TSimd::Load(m_rDirection[axis]); }
+		__forceinline typename TSimd::Float MaxLength() const { return TSimd::Load(m_maxLength); }
+
+		// The same slab test as IntersectRayAABB for all lanes
+		__forceinline uint32_t IntersectAABB(const vec3& bmin, const vec3& bmax, typename TSimd::Float& outDistance) const
+		{
+			using Float = typename TSimd::Float;
+
+			Float tmin = TSimd::Set1(-std::numeric_limits<float>::max());
+			Float tmax = TSimd::Set1(std::numeric_limits<float>::max());
+
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				const Float t1 = TSimd::Mul(TSimd::Sub(TSimd::Set1(bmin[axis]), Origin(axis)), ReciprocalDirection(axis));
+				const Float t2 = TSimd::Mul(TSimd::Sub(TSimd::Set1(bmax[axis]), Origin(axis)), ReciprocalDirection(axis));
+
+				tmin = TSimd::Max(tmin, TSimd::Min(t1, t2));
+				tmax = TSimd::Min(tmax, TSimd::Max(t1, t2));
+			}
+
+			const Float hit = TSimd::And(TSimd::And(TSimd::LessEqual(tmin, tmax), TSimd::Less(tmin, MaxLength())), TSimd::Less(TSimd::Set1(0.0f), tmax));
+
+			outDistance = tmin;
+			return TSimd::MoveMask(hit);
+		}
+
+		// Möller–Trumbore for all lanes against one triangle, the same conditions as Math::IntersectRayTriangle
+		__forceinline uint32_t IntersectTriangle(const BVH::IntersectionTriangle& tri, float* outU, float* outV, float* outDistance) const
+		{
+			using Float = typename TSimd::Float;
+
+			const vec3& edge1 = tri.m_edge1;
+			const vec3& edge2 = tri.m_edge2;
+
+			const Float e1[3] = { TSimd::Set1(edge1.x), TSimd::Set1(edge1.y), TSimd::Set1(edge1.z) };
+			const Float e2[3] = { TSimd::Set1(edge2.x), TSimd::Set1(edge2.y), TSimd::Set1(edge2.z) };
+			const Float d[3] = { Direction(0), Direction(1), Direction(2) };
+
+			// p = cross(dir, edge2)
+			const Float p[3] =
+			{
+				TSimd::Sub(TSimd::Mul(d[1], e2[2]), TSimd::Mul(d[2], e2[1])),
+				TSimd::Sub(TSimd::Mul(d[2], e2[0]), TSimd::Mul(d[0], e2[2])),
+				TSimd::Sub(TSimd::Mul(d[0], e2[1]), TSimd::Mul(d[1], e2[0]))
+			};
+
+			const Float det = TSimd::Add(TSimd::Add(TSimd::Mul(e1[0], p[0]), TSimd::Mul(e1[1], p[1])), TSimd::Mul(e1[2], p[2]));
+
+			const Float dist[3] =
+			{
+				TSimd::Sub(Origin(0), TSimd::Set1(tri.m_v0.x)),
+				TSimd::Sub(Origin(1), TSimd::Set1(tri.m_v0.y)),
+				TSimd::Sub(Origin(2), TSimd::Set1(tri.m_v0.z))
+			};
+
+			const Float u = TSimd::Add(TSimd::Add(TSimd::Mul(dist[0], p[0]), TSimd::Mul(dist[1], p[1])), TSimd::Mul(dist[2], p[2]));
+
+			// q = cross(dist, edge1)
+			const Float q[3] =
+			{
+				TSimd::Sub(TSimd::Mul(dist[1], e1[2]), TSimd::Mul(dist[2], e1[1])),
+				TSimd::Sub(TSimd::Mul(dist[2], e1[0]), TSimd::Mul(dist[0], e1[2])),
+				TSimd::Sub(TSimd::Mul(dist[0], e1[1]), TSimd::Mul(dist[1], e1[0]))
+			};
+
+			const Float v = TSimd::Add(TSimd::Add(TSimd::Mul(d[0], q[0]), TSimd::Mul(d[1], q[1])), TSimd::Mul(d[2], q[2]));
+			const Float uv = TSimd::Add(u, v);
+			const Float zero = TSimd::Set1(0.0f);
+
+			const Float frontFace = TSimd::And(TSimd::And(TSimd::Less(zero, det), TSimd::LessEqual(zero, u)),
+				TSimd::And(TSimd::LessEqual(u, det), TSimd::And(TSimd::LessEqual(zero, v), TSimd::LessEqual(uv, det))));
+
+			const Float backFace = TSimd::And(TSimd::And(TSimd::Less(det, zero), TSimd::LessEqual(u, zero)),
+				TSimd::And(TSimd::LessEqual(det, u), TSimd::And(TSimd::LessEqual(v, zero), TSimd::LessEqual(det, uv))));
+
+			uint32_t mask = TSimd::MoveMask(TSimd::Or(frontFace, backFace));
+			if (mask == 0)
+			{
+				return 0;
+			}
+
+			const Float t = TSimd::Add(TSimd::Add(TSimd::Mul(e2[0], q[0]), TSimd::Mul(e2[1], q[1])), TSimd::Mul(e2[2], q[2]));
+
+			alignas(32) float detLanes[TSimd::Width];
+			alignas(32) float tLanes[TSimd::Width];
+
+			TSimd::Store(detLanes, det);
+			TSimd::Store(tLanes, t);
+			TSimd::Store(outU, u);
+			TSimd::Store(outV, v);
+
+			for (uint32_t lanes = mask; lanes; lanes &= lanes - 1)
+			{
+				const uint32_t lane = std::countr_zero(lanes);
+				const float invDet = 1.0f / detLanes[lane];
+
+				outU[lane] *= invDet;
+				outV[lane] *= invDet;
+				outDistance[lane] = tLanes[lane] * invDet;
+
+				if (!(outDistance[lane] < m_maxLength[lane] && outDistance[lane] > -0.0000001f))
+				{
+					mask &= ~(1u << lane);
+				}
+			}
+
+			return mask;
+		}
+	};
+
+	template<typename TSimd>
+	__forceinline float GetMinDistance(typename TSimd::Float distance, uint32_t mask)
+	{
+		alignas(32) float lanes[TSimd::Width];
+		TSimd::Store(lanes, distance);
+
+		float res = std::numeric_limits<float>::max();
+		for (; mask; mask &= mask - 1)
+		{
+			res = std::min(res, lanes[std::countr_zero(mask)]);
+		}
+
+		return res;
+	}
+}
+
+BVH::IntersectionTriangle::IntersectionTriangle(const Math::Triangle& tri, uint32_t triangleIndex) :
+	m_v0(tri.m_vertices[0]),
+	m_triangleIndex(triangleIndex),
+	m_edge1(tri.m_vertices[1] - tri.m_vertices[0]),
+	m_padding1(0.0f),
+	m_edge2(tri.m_vertices[2] - tri.m_vertices[0]),
+	m_padding2(0.0f)
+{
+}
+
+// GLM with zero epsilon as Math::IntersectRayTriangle, but the edges are precomputed
+bool BVH::IntersectionTriangle::Intersect(const Math::Ray& ray, float maxRayLength, vec2& outBarycentric, float& outDistance) const
+{
+	const vec3& dir = ray.GetDirection();
+	const vec3 p = glm::cross(dir, m_edge2);
+	const float det = glm::dot(m_edge1, p);
+
+	vec3 perpendicular(0);
+
+	if (det > 0.0f)
+	{
+		const vec3 dist = ray.GetOrigin() - m_v0;
+
+		outBarycentric.x = glm::dot(dist, p);
+		if (outBarycentric.x < 0.0f || outBarycentric.x > det)
+		{
+			return false;
+		}
+
+		perpendicular = glm::cross(dist, m_edge1);
+
+		outBarycentric.y = glm::dot(dir, perpendicular);
+		if (outBarycentric.y < 0.0f || (outBarycentric.x + outBarycentric.y) > det)
+		{
+			return false;
+		}
+	}
+	else if (det < 0.0f)
+	{
+		const vec3 dist = ray.GetOrigin() - m_v0;
+
+		outBarycentric.x = glm::dot(dist, p);
+		if (outBarycentric.x > 0.0f || outBarycentric.x < det)
+		{
+			return false;
+		}
+
+		perpendicular = glm::cross(dist, m_edge1);
+
+		outBarycentric.y = glm::dot(dir, perpendicular);
+		if (outBarycentric.y > 0.0f || (outBarycentric.x + outBarycentric.y) < det)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		return false;
+	}
+
+	const float invDet = 1.0f / det;
+
+	outDistance = glm::dot(m_edge2, perpendicular) * invDet;
+	outBarycentric *= invDet;
+
+	return outDistance < maxRayLength && outDistance > -0.0000001f;
+}
+
+float BVH::FindBestSplitPlane(const BVHNode& node, const TVector<Math::Triangle>& tris, int32_t& outAxis, float& outSplitPos, bool bMultithreaded) const
 {
 	SAILOR_PROFILE_FUNCTION();
 
 	struct Bin { Math::AABB m_bounds{}; int m_triCount = 0; };
+	struct Bins { Bin m_bins[3][NumBins]; };
 
-	const uint32_t NumBins = 8;
+	const bool bParallel = bMultithreaded && node.m_triCount >= ParallelBinningThreshold;
 
-	float bestCost = std::numeric_limits<float>::max();
+	// Centroid bounds for all axes at once
+	Math::AABB centroidBounds;
+	centroidBounds.m_min = vec3(std::numeric_limits<float>::max());
+	centroidBounds.m_max = vec3(-30000000.0f);
+
+	auto gatherCentroidBounds = [&](size_t first, size_t last, Math::AABB bounds)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				bounds.Extend(tris[m_triIdx[node.m_leftFirst + i]].m_centroid);
+			}
+			return bounds;
+		};
+
+	auto mergeBounds = [](Math::AABB lhs, const Math::AABB& rhs)
+		{
+			lhs.Extend(rhs);
+			return lhs;
+		};
+
+	centroidBounds = bParallel ?
+		Tasks::ParallelReduce<Math::AABB>("BVH centroid bounds", 0, node.m_triCount, ParallelGrainSize, centroidBounds, gatherCentroidBounds, mergeBounds) :
+		gatherCentroidBounds(0, node.m_triCount, centroidBounds);
+
+	vec3 scale{};
 	for (uint32_t a = 0; a < 3; a++)
 	{
-		float boundsMin = std::numeric_limits<float>::max();
-		float boundsMax = -30000000.0f;
+		const float extent = centroidBounds.m_max[a] - centroidBounds.m_min[a];
+		scale[a] = extent > 0.0f ? NumBins / extent : 0.0f;
+	}
 
-		for (uint32_t i = 0; i < node.m_triCount; i++)
+	// Each participant fills its own bins, the bins are merged after
+	auto fillBins = [&](size_t first, size_t last, Bins bins)
 		{
-			const Math::Triangle& triangle = tris[m_triIdx[node.m_leftFirst + i]];
-			boundsMin = std::min(boundsMin, triangle.m_centroid[a]);
-			boundsMax = std::max(boundsMax, triangle.m_centroid[a]);
-		}
+			for (size_t i = first; i < last; i++)
+			{
+				const Math::Triangle& triangle = tris[m_triIdx[node.m_leftFirst + i]];
+
+				for (uint32_t a = 0; a < 3; a++)
+				{
+					const int32_t binIdx = std::min((int32_t)NumBins - 1,
+						(int32_t)((triangle.m_centroid[a] - centroidBounds.m_min[a]) * scale[a]));
+
+					Bin& bin = bins.m_bins[a][binIdx];
+					bin.m_triCount++;
+					bin.m_bounds.Extend(triangle.m_vertices[0]);
+					bin.m_bounds.Extend(triangle.m_vertices[1]);
+					bin.m_bounds.Extend(triangle.m_vertices[2]);
+				}
+			}
+			return bins;
+		};
+
+	auto mergeBins = [](Bins lhs, const Bins& rhs)
+		{
+			for (uint32_t a = 0; a < 3; a++)
+			{
+				for (uint32_t i = 0; i < NumBins; i++)
+				{
+					lhs.m_bins[a][i].m_triCount += rhs.m_bins[a][i].m_triCount;
+					lhs.m_bins[a][i].m_bounds.Extend(rhs.m_bins[a][i].m_bounds);
+				}
+			}
+			return lhs;
+		};
+
+	const Bins bins = bParallel ?
+		Tasks::ParallelReduce<Bins>("BVH binning", 0, node.m_triCount, ParallelGrainSize, Bins{}, fillBins, mergeBins) :
+		fillBins(0, node.m_triCount, Bins{});
+
+	float bestCost = std::numeric_limits<float>::max();
+	for (uint32_t a = 0; a < 3; a++)
+	{
+		const float boundsMin = centroidBounds.m_min[a];
+		const float boundsMax = centroidBounds.m_max[a];
 
 		if (boundsMin == boundsMax)
 		{
 			continue;
 		}
 
-		Bin bin[NumBins];
-		float scale = NumBins / (boundsMax - boundsMin);
-		for (uint i = 0; i < node.m_triCount; i++)
-		{
-			const Math::Triangle& triangle = tris[m_triIdx[node.m_leftFirst + i]];
-			int32_t binIdx = std::min((int32_t)NumBins - 1,
-				(int32_t)((triangle.m_centroid[a] - boundsMin) * scale));
-			bin[binIdx].m_triCount++;
-			bin[binIdx].m_bounds.Extend(triangle.m_vertices[0]);
-			bin[binIdx].m_bounds.Extend(triangle.m_vertices[1]);
-			bin[binIdx].m_bounds.Extend(triangle.m_vertices[2]);
-		}
+		const Bin* bin = bins.m_bins[a];
 
 		float leftArea[NumBins - 1];
 		float rightArea[NumBins - 1];
@@ -71,14 +382,14 @@ float BVH::FindBestSplitPlane(const BVHNode& node, const TVector<Math::Triangle>
 			rightArea[NumBins - 2 - i] = rightBox.Area();
 		}
 
-		scale = (boundsMax - boundsMin) / NumBins;
+		const float planeScale = (boundsMax - boundsMin) / NumBins;
 		for (int32_t i = 0; i < NumBins - 1; i++)
 		{
 			float planeCost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
 			if (planeCost < bestCost)
 			{
 				outAxis = a;
-				outSplitPos = boundsMin + scale * (i + 1);
+				outSplitPos = boundsMin + planeScale * (i + 1);
 				bestCost = planeCost;
 			}
 		}
@@ -118,27 +429,28 @@ float BVH::EvaluateSAH(const BVHNode& node, const TVector<Math::Triangle>& tris,
 	return cost > 0 ? cost : 1e30f;
 }
 
-bool BVH::IntersectBVH(const Math::Ray& ray, Math::RaycastHit& outResult, const uint nodeIdx, float maxRayLength, uint32_t ignoreTriangle) const
+template<typename TIntersect>
+bool BVH::IntersectBinary(const Math::Ray& ray, Math::RaycastHit& outResult, float maxRayLength, TIntersect intersect) const
 {
-	SAILOR_PROFILE_FUNCTION();
-
 	const BVHNode* node = &m_nodes[m_rootNodeIdx], * stack[64];
 	uint stackPtr = 0;
-	Math::RaycastHit res{};
+
+	uint32_t closestTriangle = (uint32_t)(-1);
+	vec2 closestBarycentric{};
+	vec2 barycentric{};
+	float distance = 0.0f;
+
 	while (1)
 	{
 		if (node->IsLeaf())
 		{
 			for (uint i = 0; i < node->m_triCount; i++)
 			{
-				const uint32_t triangleIndex = m_triIdxMapping[node->m_leftFirst + i];
-
-				if (ignoreTriangle != triangleIndex && Math::IntersectRayTriangle(ray, m_triangles[node->m_leftFirst + i], res, maxRayLength))
+				if (intersect(node->m_leftFirst + i, maxRayLength, barycentric, distance))
 				{
-					outResult = res;
-					outResult.m_triangleIndex = triangleIndex;
-
-					maxRayLength = std::min(maxRayLength, res.m_rayLenght);
+					closestTriangle = node->m_leftFirst + i;
+					closestBarycentric = barycentric;
+					maxRayLength = distance;
 				}
 			}
 			if (stackPtr == 0)
@@ -186,32 +498,342 @@ bool BVH::IntersectBVH(const Math::Ray& ray, Math::RaycastHit& outResult, const
 		}
 	}
 
+	if (closestTriangle != (uint32_t)(-1))
+	{
+		FillRaycastHit(ray, closestTriangle, closestBarycentric, maxRayLength, outResult);
+	}
+
 	return outResult.HasIntersection();
 }
 
-void BVH::UpdateNodeBounds(uint32_t nodeIdx, const TVector<Math::Triangle>& tris)
+bool BVH::IntersectBVH(const Math::Ray& ray, Math::RaycastHit& outResult, const uint nodeIdx, float maxRayLength, uint32_t ignoreTriangle) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	if (m_width == 8)
+	{
+		return IntersectWide<SimdAVX2>(m_wideNodes8, ray, outResult, maxRayLength, ignoreTriangle);
+	}
+	else if (m_width == 4)
+	{
+		return IntersectWide<SimdSSE>(m_wideNodes4, ray, outResult, maxRayLength, ignoreTriangle);
+	}
+
+	return IntersectBinary(ray, outResult, maxRayLength,
+		[&](uint32_t triangle, float maxLength, vec2& outBarycentric, float& outDistance)
+		{
+			const IntersectionTriangle& tri = m_intersectionTriangles[triangle];
+			return ignoreTriangle != tri.m_triangleIndex && tri.Intersect(ray, maxLength, outBarycentric, outDistance);
+		});
+}
+
+bool BVH::IntersectBVHFullTriangles(const Math::Ray& ray, Math::RaycastHit& outResult, float maxRayLength) const
+{
+	return IntersectBinary(ray, outResult, maxRayLength,
+		[&](uint32_t triangle, float maxLength, vec2& outBarycentric, float& outDistance)
+		{
+			Math::RaycastHit hit{};
+			if (!Math::IntersectRayTriangle(ray, m_triangles[triangle], hit, maxLength))
+			{
+				return false;
+			}
+
+			outBarycentric = vec2(hit.m_barycentricCoordinate.y, hit.m_barycentricCoordinate.z);
+			outDistance = hit.m_rayLenght;
+			return true;
+		});
+}
+
+bool BVH::IntersectAnyBVH(const Math::Ray& ray, float maxRayLength) const
+{
+	if (m_nodes.Num() == 0)
+	{
+		return false;
+	}
+
+	// The binary tree is kept after the collapse, the order of the children doesn't matter for the any hit
+	const BVHNode* node = &m_nodes[m_rootNodeIdx], * stack[64];
+	uint stackPtr = 0;
+
+	vec2 barycentric{};
+	float distance = 0.0f;
+
+	if (IntersectRayAABB(ray, node->m_aabbMin, node->m_aabbMax, maxRayLength) == std::numeric_limits<float>::max())
+	{
+		return false;
+	}
+
+	while (1)
+	{
+		if (node->IsLeaf())
+		{
+			for (uint i = 0; i < node->m_triCount; i++)
+			{
+				if (m_intersectionTriangles[node->m_leftFirst + i].Intersect(ray, maxRayLength, barycentric, distance))
+				{
+					return true;
+				}
+			}
+
+			if (stackPtr == 0)
+			{
+				return false;
+			}
+
+			node = stack[--stackPtr];
+			continue;
+		}
+
+		const BVHNode* child1 = &m_nodes[node->m_leftFirst];
+		const BVHNode* child2 = &m_nodes[node->m_leftFirst + 1];
+
+		const bool bHit1 = IntersectRayAABB(ray, child1->m_aabbMin, child1->m_aabbMax, maxRayLength) != std::numeric_limits<float>::max();
+		const bool bHit2 = IntersectRayAABB(ray, child2->m_aabbMin, child2->m_aabbMax, maxRayLength) != std::numeric_limits<float>::max();
+
+		if (bHit1 && bHit2)
+		{
+			stack[stackPtr++] = child2;
+			node = child1;
+		}
+		else if (bHit1 || bHit2)
+		{
+			node = bHit1 ? child1 : child2;
+		}
+		else if (stackPtr == 0)
+		{
+			return false;
+		}
+		else
+		{
+			node = stack[--stackPtr];
+		}
+	}
+}
+
+Math::AABB BVH::GetBounds() const
+{
+	Math::AABB res{};
+	if (m_nodes.Num() > 0)
+	{
+		res.m_min = m_nodes[m_rootNodeIdx].m_aabbMin;
+		res.m_max = m_nodes[m_rootNodeIdx].m_aabbMax;
+	}
+
+	return res;
+}
+
+void BVH::FillRaycastHit(const Math::Ray& ray, uint32_t triangle, const vec2& barycentric, float distance, Math::RaycastHit& outResult) const
+{
+	const Math::Triangle& tri = m_triangles[triangle];
+
+	outResult = Math::RaycastHit();
+	outResult.m_barycentricCoordinate = vec3(1.0f - barycentric.x - barycentric.y, barycentric.x, barycentric.y);
+	outResult.m_point = ray.GetOrigin() + ray.GetDirection() * distance;
+	outResult.m_normal = outResult.m_barycentricCoordinate.x * tri.m_normals[0] +
+		outResult.m_barycentricCoordinate.y * tri.m_normals[1] +
+		outResult.m_barycentricCoordinate.z * tri.m_normals[2];
+	outResult.m_rayLenght = distance;
+	outResult.m_triangleIndex = m_intersectionTriangles[triangle].m_triangleIndex;
+}
+
+template<typename TSimd>
+uint32_t BVH::IntersectPacket(const Math::Ray* rays, Math::RaycastHit* outResults, uint32_t activeMask, float maxRayLength, uint32_t ignoreTriangle) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	using Float = typename TSimd::Float;
+
+	TRayPacket<TSimd> packet;
+
+	// The inactive lanes get the degenerate rays that never hit
+	for (uint32_t lane = 0; lane < TSimd::Width; lane++)
+	{
+		const bool bActive = (activeMask & (1u << lane)) != 0;
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			packet.m_origin[axis][lane] = bActive ? rays[lane].GetOrigin()[axis] : 0.0f;
+			packet.m_direction[axis][lane] = bActive ? rays[lane].GetDirection()[axis] : 1.0f;
+			packet.m_rDirection[axis][lane] = bActive ? rays[lane].GetReciprocalDirection()[axis] : 1.0f;
+		}
+
+		packet.m_maxLength[lane] = bActive ? maxRayLength : -1.0f;
+
+		if (bActive)
+		{
+			outResults[lane] = Math::RaycastHit();
+		}
+	}
+
+	// The closest hits, the results are filled after the traversal
+	uint32_t closestTriangle[TSimd::Width];
+	vec2 closestBarycentric[TSimd::Width];
+
+	struct StackEntry
+	{
+		const BVHNode* m_node;
+		uint32_t m_mask;
+	};
+
+	StackEntry stack[64];
+	uint32_t stackPtr = 0;
+	uint32_t hitMask = 0;
+
+	alignas(32) float u[TSimd::Width];
+	alignas(32) float v[TSimd::Width];
+	alignas(32) float distance[TSimd::Width];
+
+	Float rootDistance;
+	const BVHNode* node = &m_nodes[m_rootNodeIdx];
+	uint32_t mask = activeMask & packet.IntersectAABB(node->m_aabbMin, node->m_aabbMax, rootDistance);
+
+	while (1)
+	{
+		if (mask != 0 && node->IsLeaf())
+		{
+			for (uint i = 0; i < node->m_triCount; i++)
+			{
+				const IntersectionTriangle& tri = m_intersectionTriangles[node->m_leftFirst + i];
+				if (tri.m_triangleIndex == ignoreTriangle)
+				{
+					continue;
+				}
+
+				const uint32_t triMask = mask & packet.IntersectTriangle(tri, u, v, distance);
+
+				for (uint32_t lanes = triMask; lanes; lanes &= lanes - 1)
+				{
+					const uint32_t lane = std::countr_zero(lanes);
+
+					closestTriangle[lane] = node->m_leftFirst + i;
+					closestBarycentric[lane] = vec2(u[lane], v[lane]);
+					packet.m_maxLength[lane] = distance[lane];
+				}
+
+				hitMask |= triMask;
+			}
+		}
+		else if (mask != 0)
+		{
+			const BVHNode* child1 = &m_nodes[node->m_leftFirst];
+			const BVHNode* child2 = &m_nodes[node->m_leftFirst + 1];
+
+			Float distance1;
+			Float distance2;
+
+			uint32_t mask1 = mask & packet.IntersectAABB(child1->m_aabbMin, child1->m_aabbMax, distance1);
+			uint32_t mask2 = mask & packet.IntersectAABB(child2->m_aabbMin, child2->m_aabbMax, distance2);
+
+			if (mask1 && mask2)
+			{
+				// The child closer to the active lanes goes first
+				if (GetMinDistance<TSimd>(distance1, mask1) > GetMinDistance<TSimd>(distance2, mask2))
+				{
+					std::swap(child1, child2);
+					std::swap(mask1, mask2);
+				}
+
+				stack[stackPtr++] = { child2, mask2 };
+				node = child1;
+				mask = mask1;
+				continue;
+			}
+
+			if (mask1 || mask2)
+			{
+				node = mask1 ? child1 : child2;
+				mask = mask1 | mask2;
+				continue;
+			}
+		}
+
+		// All lanes are masked, pop the next node
+		if (stackPtr == 0)
+		{
+			break;
+		}
+
+		node = stack[--stackPtr].m_node;
+		mask = stack[stackPtr].m_mask;
+
+		// The lanes could already have closer hits
+		Float nodeDistance;
+		mask &= packet.IntersectAABB(node->m_aabbMin, node->m_aabbMax, nodeDistance);
+	}
+
+	for (uint32_t lanes = hitMask; lanes; lanes &= lanes - 1)
+	{
+		const uint32_t lane = std::countr_zero(lanes);
+		FillRaycastHit(rays[lane], closestTriangle[lane], closestBarycentric[lane], packet.m_maxLength[lane], outResults[lane]);
+	}
+
+	return hitMask;
+}
+
+uint32_t BVH::IntersectBVH4(const Math::Ray* rays, Math::RaycastHit* outResults, uint32_t activeMask, float maxRayLength, uint32_t ignoreTriangle) const
+{
+	return IntersectPacket<SimdSSE>(rays, outResults, activeMask & 0xF, maxRayLength, ignoreTriangle);
+}
+
+uint32_t BVH::IntersectBVH8(const Math::Ray* rays, Math::RaycastHit* outResults, uint32_t activeMask, float maxRayLength, uint32_t ignoreTriangle) const
+{
+	return IntersectPacket<SimdAVX2>(rays, outResults, activeMask & 0xFF, maxRayLength, ignoreTriangle);
+}
+
+void BVH::IntersectRays(const Math::Ray* rays, Math::RaycastHit* outResults, uint32_t numRays, float maxRayLength, uint32_t ignoreTriangle) const
+{
+	// The packets walk the binary tree, so the traversal doesn't depend on the collapsed width
+#if defined(__AVX2__)
+	for (uint32_t i = 0; i < numRays; i += 8)
+	{
+		const uint32_t activeMask = numRays - i >= 8 ? 0xFFu : ((1u << (numRays - i)) - 1);
+		IntersectBVH8(&rays[i], &outResults[i], activeMask, maxRayLength, ignoreTriangle);
+	}
+#else
+	for (uint32_t i = 0; i < numRays; i += 4)
+	{
+		const uint32_t activeMask = numRays - i >= 4 ? 0xFu : ((1u << (numRays - i)) - 1);
+		IntersectBVH4(&rays[i], &outResults[i], activeMask, maxRayLength, ignoreTriangle);
+	}
+#endif
+}
+
+void BVH::UpdateNodeBounds(uint32_t nodeIdx, const TVector<Math::Triangle>& tris, bool bMultithreaded)
 {
 	SAILOR_PROFILE_FUNCTION();
 
 	BVH::BVHNode& node = m_nodes[nodeIdx];
 
-	node.m_aabbMin = vec3(1e30f);
-	node.m_aabbMax = vec3(-1e30f);
+	Math::AABB bounds;
+	bounds.m_min = vec3(1e30f);
+	bounds.m_max = vec3(-1e30f);
 
-	for (uint first = node.m_leftFirst, i = 0; i < node.m_triCount; i++)
+	auto gatherBounds = [&](size_t first, size_t last, Math::AABB res)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				const Triangle& leafTri = tris[m_triIdx[node.m_leftFirst + i]];
+				res.Extend(leafTri.m_vertices[0]);
+				res.Extend(leafTri.m_vertices[1]);
+				res.Extend(leafTri.m_vertices[2]);
+			}
+			return res;
+		};
+
+	if (bMultithreaded && node.m_triCount >= ParallelBinningThreshold)
 	{
-		uint leafTriIdx = m_triIdx[first + i];
-		const Triangle& leafTri = tris[leafTriIdx];
-		node.m_aabbMin = glm::min(node.m_aabbMin, leafTri.m_vertices[0]);
-		node.m_aabbMin = glm::min(node.m_aabbMin, leafTri.m_vertices[1]);
-		node.m_aabbMin = glm::min(node.m_aabbMin, leafTri.m_vertices[2]);
-		node.m_aabbMax = glm::max(node.m_aabbMax, leafTri.m_vertices[0]);
-		node.m_aabbMax = glm::max(node.m_aabbMax, leafTri.m_vertices[1]);
-		node.m_aabbMax = glm::max(node.m_aabbMax, leafTri.m_vertices[2]);
+		bounds = Tasks::ParallelReduce<Math::AABB>("BVH node bounds", 0, node.m_triCount, ParallelGrainSize, bounds, gatherBounds,
+			[](Math::AABB lhs, const Math::AABB& rhs) { lhs.Extend(rhs); return lhs; });
 	}
+	else
+	{
+		bounds = gatherBounds(0, node.m_triCount, bounds);
+	}
+
+	node.m_aabbMin = bounds.m_min;
+	node.m_aabbMax = bounds.m_max;
 }
 
-void BVH::Subdivide(uint32_t nodeIdx, const TVector<Math::Triangle>& tris)
+void BVH::Subdivide(uint32_t nodeIdx, const TVector<Math::Triangle>& tris, bool bMultithreaded)
 {
 	SAILOR_PROFILE_FUNCTION();
 
@@ -225,7 +847,7 @@ void BVH::Subdivide(uint32_t nodeIdx, const TVector<Math::Triangle>& tris)
 
 	int32_t axis{};
 	float splitPos{};
-	float splitCost = FindBestSplitPlane(node, tris, axis, splitPos);
+	float splitCost = FindBestSplitPlane(node, tris, axis, splitPos, bMultithreaded);
 
 	float nosplitCost = node.CalculateCost();
 	if (splitCost >= nosplitCost)
@@ -257,9 +879,9 @@ void BVH::Subdivide(uint32_t nodeIdx, const TVector<Math::Triangle>& tris)
 		return;
 	}
 
-	// create child nodes
-	uint32_t leftChildIdx = m_nodesUsed++;
-	uint32_t rightChildIdx = m_nodesUsed++;
+	// create child nodes, the subtrees could be built concurrently so the children are allocated atomically
+	uint32_t leftChildIdx = m_nodesUsed.fetch_add(2, std::memory_order_relaxed);
+	uint32_t rightChildIdx = leftChildIdx + 1;
 
 	m_nodes[leftChildIdx].m_leftFirst = node.m_leftFirst;
 	m_nodes[leftChildIdx].m_triCount = leftCount;
@@ -269,45 +891,82 @@ void BVH::Subdivide(uint32_t nodeIdx, const TVector<Math::Triangle>& tris)
 	node.m_leftFirst = leftChildIdx;
 	node.m_triCount = 0;
 
-	UpdateNodeBounds(leftChildIdx, tris);
-	UpdateNodeBounds(rightChildIdx, tris);
+	// The subtrees share nothing except the node counter: the triangle ranges of the children don't overlap
+	if (bMultithreaded && std::min(leftCount, m_nodes[rightChildIdx].m_triCount) >= ParallelSubtreeThreshold)
+	{
+		Tasks::ParallelFor("BVH subtree", leftChildIdx, leftChildIdx + 2, 1,
+			[&](size_t childIdx)
+			{
+				UpdateNodeBounds((uint32_t)childIdx, tris, bMultithreaded);
+				Subdivide((uint32_t)childIdx, tris, bMultithreaded);
+			});
+
+		return;
+	}
 
-	Subdivide(leftChildIdx, tris);
-	Subdivide(rightChildIdx, tris);
+	UpdateNodeBounds(leftChildIdx, tris, bMultithreaded);
+	UpdateNodeBounds(rightChildIdx, tris, bMultithreaded);
+
+	Subdivide(leftChildIdx, tris, bMultithreaded);
+	Subdivide(rightChildIdx, tris, bMultithreaded);
 }
 
-void BVH::BuildBVH(const TVector<Math::Triangle>& tris)
+void BVH::BuildBVH(const TVector<Math::Triangle>& tris, bool bMultithreaded)
 {
 	SAILOR_PROFILE_FUNCTION();
 
-	check(tris.Num() * 2 - 1 == m_nodes.Num());
+	const uint32_t maxNodes = (uint32_t)tris.Num() * 2 - 1;
+	if (m_nodes.Num() != maxNodes)
+	{
+		m_nodes.Clear();
+		m_nodes.AddDefault(maxNodes);
+		m_triIdx.Clear();
+		m_triIdx.AddDefault(maxNodes);
+	}
 
 	for (uint32_t i = 0; i < m_nodes.Num(); i++)
 	{
 		m_triIdx[i] = i;
 	}
 
+	m_nodesUsed = 1;
+
 	BVHNode& root = m_nodes[m_rootNodeIdx];
 	root.m_leftFirst = 0;
 	root.m_triCount = (uint32_t)tris.Num();
 
-	UpdateNodeBounds(m_rootNodeIdx, tris);
-	Subdivide(m_rootNodeIdx, tris);
+	UpdateNodeBounds(m_rootNodeIdx, tris, bMultithreaded);
+	Subdivide(m_rootNodeIdx, tris, bMultithreaded);
 
 	SAILOR_PROFILE_BLOCK("Copy/Locality triangle data");
-	// Cache locality
-	m_triangles.Reserve(tris.Num());
-	m_triIdxMapping.AddDefault(tris.Num());
 
-	// TODO: Parallelize
-	for (uint32_t i = 0; i < m_nodes.Num(); i++)
+	const uint32_t numNodes = m_nodesUsed.load(std::memory_order_relaxed);
+
+	// Cache locality, the leaves are laid out in the order of the nodes
+	TVector<uint32_t> leafOffsets(numNodes);
+	uint32_t numTriangles = 0;
+	for (uint32_t i = 0; i < numNodes; i++)
 	{
-		if (m_nodes[i].IsLeaf())
+		leafOffsets[i] = numTriangles;
+		numTriangles += m_nodes[i].IsLeaf() ? m_nodes[i].m_triCount : 0;
+	}
+
+	m_triangles.Clear();
+	m_triangles.AddDefault(numTriangles);
+	m_intersectionTriangles.Clear();
+	m_intersectionTriangles.AddDefault(numTriangles);
+
+	auto copyLeaf = [&](size_t i)
 		{
+			if (!m_nodes[i].IsLeaf())
+			{
+				return;
+			}
+
 			const uint32_t triIndex = m_nodes[i].m_leftFirst;
-			m_nodes[i].m_leftFirst = (int32_t)m_triangles.Num();
+			const uint32_t offset = leafOffsets[i];
+			m_nodes[i].m_leftFirst = offset;
 
-			SAILOR_PROFILE_BLOCK("Sort Triangles by area");
 			TVector<uint32_t> sorted(m_nodes[i].m_triCount);
 			for (uint32_t j = 0; j < m_nodes[i].m_triCount; j++)
 			{
@@ -318,17 +977,292 @@ void BVH::BuildBVH(const TVector<Math::Triangle>& tris)
 				{
 					return tris[lhs].SquareArea() > tris[rhs].SquareArea();
 				});
-			SAILOR_PROFILE_END_BLOCK();
 
-			SAILOR_PROFILE_BLOCK("Copy data");
 			for (uint32_t j = 0; j < m_nodes[i].m_triCount; j++)
 			{
-				const uint32_t triId = sorted[j];// m_triIdx[triIndex + j];
-				m_triIdxMapping[m_triangles.Num()] = triId;
-				m_triangles.Add(tris[triId]);
+				const uint32_t triId = sorted[j];
+				const Math::Triangle& tri = tris[triId];
+
+				m_intersectionTriangles[offset + j] = IntersectionTriangle(tri, triId);
+				m_triangles[offset + j] = tri;
 			}
-			SAILOR_PROFILE_END_BLOCK();
+		};
+
+	if (bMultithreaded)
+	{
+		Tasks::ParallelFor("BVH copy leaves", 0, numNodes, ParallelGrainSize / 16, copyLeaf);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < numNodes; i++)
+		{
+			copyLeaf(i);
 		}
 	}
+
 	SAILOR_PROFILE_END_BLOCK();
-}
\ No newline at end of file
+}
+
+float BVH::CalculateSAHCost() const
+{
+	auto area = [](const BVHNode& node)
+		{
+			const vec3 e = node.m_aabbMax - node.m_aabbMin;
+			return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+		};
+
+	const float rootArea = area(m_nodes[m_rootNodeIdx]);
+	if (rootArea <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	// Traversal step is counted as 1, triangle test as 1 as well
+	double cost = 0.0;
+	const uint32_t numNodes = m_nodesUsed.load(std::memory_order_relaxed);
+	for (uint32_t i = 0; i < numNodes; i++)
+	{
+		const BVHNode& node = m_nodes[i];
+		cost += area(node) / rootArea * (node.IsLeaf() ? node.m_triCount : 1.0f);
+	}
+
+	return (float)cost;
+}
+
+void BVH::Serialize(SceneCache& cache) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	const uint32_t numNodes = m_nodesUsed.load(std::memory_order_relaxed);
+
+	cache.Write(m_rootNodeIdx);
+	cache.Write(m_nodes.GetData(), numNodes);
+	cache.Write(m_triIdx);
+	cache.Write(m_intersectionTriangles);
+	cache.Write(m_triangles);
+}
+
+bool BVH::Deserialize(SceneCache& cache)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	cache.Read(m_rootNodeIdx);
+	cache.Read(m_nodes);
+	cache.Read(m_triIdx);
+	cache.Read(m_intersectionTriangles);
+	cache.Read(m_triangles);
+
+	m_nodesUsed = (uint32_t)m_nodes.Num();
+	m_width = 2;
+	m_wideNodes4.Clear();
+	m_wideNodes8.Clear();
+
+	return cache.IsValid() && m_rootNodeIdx < m_nodes.Num();
+}
+
+template<uint32_t Width>
+uint32_t BVH::CollapseNode(uint32_t nodeIdx, TVector<TWideNode<Width>>& outNodes) const
+{
+	// Greedily open the child with the largest surface area until the node is full,
+	// that keeps the SAH ordering of the binary tree
+	uint32_t children[Width];
+	uint32_t numChildren = 0;
+
+	if (m_nodes[nodeIdx].IsLeaf())
+	{
+		children[numChildren++] = nodeIdx;
+	}
+	else
+	{
+		children[numChildren++] = m_nodes[nodeIdx].m_leftFirst;
+		children[numChildren++] = m_nodes[nodeIdx].m_leftFirst + 1;
+	}
+
+	while (numChildren < Width)
+	{
+		int32_t bestChild = -1;
+		float bestArea = -1.0f;
+
+		for (uint32_t i = 0; i < numChildren; i++)
+		{
+			const BVHNode& child = m_nodes[children[i]];
+			if (child.IsLeaf())
+			{
+				continue;
+			}
+
+			const vec3 e = child.m_aabbMax - child.m_aabbMin;
+			const float area = e.x * e.y + e.y * e.z + e.z * e.x;
+			if (area > bestArea)
+			{
+				bestArea = area;
+				bestChild = (int32_t)i;
+			}
+		}
+
+		if (bestChild == -1)
+		{
+			break;
+		}
+
+		const uint32_t leftFirst = m_nodes[children[bestChild]].m_leftFirst;
+		children[bestChild] = leftFirst;
+		children[numChildren++] = leftFirst + 1;
+	}
+
+	const uint32_t wideNodeIdx = (uint32_t)outNodes.Num();
+	outNodes.AddDefault(1);
+
+	TWideNode<Width> wideNode{};
+	wideNode.m_numChildren = numChildren;
+
+	for (uint32_t i = 0; i < Width; i++)
+	{
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			wideNode.m_aabbMin[axis][i] = i < numChildren ? m_nodes[children[i]].m_aabbMin[axis] : 1e30f;
+			wideNode.m_aabbMax[axis][i] = i < numChildren ? m_nodes[children[i]].m_aabbMax[axis] : -1e30f;
+		}
+	}
+
+	for (uint32_t i = 0; i < numChildren; i++)
+	{
+		const BVHNode& child = m_nodes[children[i]];
+
+		// The recursion adds the nodes, so the node is written after
+		wideNode.m_triCount[i] = child.m_triCount;
+		wideNode.m_child[i] = child.IsLeaf() ? child.m_leftFirst : CollapseNode<Width>(children[i], outNodes);
+	}
+
+	outNodes[wideNodeIdx] = wideNode;
+
+	return wideNodeIdx;
+}
+
+void BVH::CollapseBVH(uint32_t width)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	check(width == 2 || width == 4 || width == 8);
+
+	m_width = width;
+
+	m_wideNodes4.Clear();
+	m_wideNodes8.Clear();
+
+	if (width == 4)
+	{
+		m_wideNodes4.Reserve(m_nodesUsed.load() / 3 + 1);
+		CollapseNode<4>(m_rootNodeIdx, m_wideNodes4);
+	}
+	else if (width == 8)
+	{
+		m_wideNodes8.Reserve(m_nodesUsed.load() / 7 + 1);
+		CollapseNode<8>(m_rootNodeIdx, m_wideNodes8);
+	}
+}
+
+template<typename TSimd>
+bool BVH::IntersectWide(const TVector<TWideNode<TSimd::Width>>& nodes, const Math::Ray& ray, Math::RaycastHit& outResult, float maxRayLength, uint32_t ignoreTriangle) const
+{
+	using Float = typename TSimd::Float;
+
+	struct StackEntry
+	{
+		uint32_t m_child;
+		uint32_t m_triCount;
+		float m_distance;
+	};
+
+	// Each wide node pushes up to Width - 1 children
+	StackEntry stack[64 * (TSimd::Width - 1) + 1];
+	uint32_t stackPtr = 0;
+
+	const Float origin[3] = { TSimd::Set1(ray.GetOrigin().x), TSimd::Set1(ray.GetOrigin().y), TSimd::Set1(ray.GetOrigin().z) };
+	const Float rDirection[3] = { TSimd::Set1(ray.GetReciprocalDirection().x), TSimd::Set1(ray.GetReciprocalDirection().y), TSimd::Set1(ray.GetReciprocalDirection().z) };
+	const Float zero = TSimd::Set1(0.0f);
+
+	uint32_t closestTriangle = (uint32_t)(-1);
+	vec2 closestBarycentric{};
+	vec2 barycentric{};
+	float distance = 0.0f;
+
+	stack[stackPtr++] = { 0, 0, 0.0f };
+
+	while (stackPtr > 0)
+	{
+		const StackEntry entry = stack[--stackPtr];
+
+		// The closer hit was found after the entry had been pushed
+		if (entry.m_distance >= maxRayLength)
+		{
+			continue;
+		}
+
+		if (entry.m_triCount > 0)
+		{
+			for (uint32_t i = 0; i < entry.m_triCount; i++)
+			{
+				const IntersectionTriangle& tri = m_intersectionTriangles[entry.m_child + i];
+
+				if (ignoreTriangle != tri.m_triangleIndex && tri.Intersect(ray, maxRayLength, barycentric, distance))
+				{
+					closestTriangle = entry.m_child + i;
+					closestBarycentric = barycentric;
+					maxRayLength = distance;
+				}
+			}
+
+			continue;
+		}
+
+		const TWideNode<TSimd::Width>& node = nodes[entry.m_child];
+
+		// The same slab test as IntersectRayAABB for all children
+		Float tmin = TSimd::Set1(-std::numeric_limits<float>::max());
+		Float tmax = TSimd::Set1(std::numeric_limits<float>::max());
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			const Float t1 = TSimd::Mul(TSimd::Sub(TSimd::LoadUnaligned(node.m_aabbMin[axis]), origin[axis]), rDirection[axis]);
+			const Float t2 = TSimd::Mul(TSimd::Sub(TSimd::LoadUnaligned(node.m_aabbMax[axis]), origin[axis]), rDirection[axis]);
+
+			tmin = TSimd::Max(tmin, TSimd::Min(t1, t2));
+			tmax = TSimd::Min(tmax, TSimd::Max(t1, t2));
+		}
+
+		const Float hit = TSimd::And(TSimd::And(TSimd::LessEqual(tmin, tmax), TSimd::Less(tmin, TSimd::Set1(maxRayLength))), TSimd::Less(zero, tmax));
+		uint32_t hitMask = TSimd::MoveMask(hit) & ((1u << node.m_numChildren) - 1);
+
+		if (hitMask == 0)
+		{
+			continue;
+		}
+
+		alignas(32) float distances[TSimd::Width];
+		TSimd::Store(distances, tmin);
+
+		// Push the children in the descending order of the distance, so the closest one is popped first
+		const uint32_t first = stackPtr;
+		while (hitMask)
+		{
+			const uint32_t i = (uint32_t)std::countr_zero(hitMask);
+			hitMask &= hitMask - 1;
+
+			const StackEntry child{ node.m_child[i], node.m_triCount[i], distances[i] };
+
+			uint32_t j = stackPtr++;
+			for (; j > first && stack[j - 1].m_distance < child.m_distance; j--)
+			{
+				stack[j] = stack[j - 1];
+			}
+			stack[j] = child;
+		}
+	}
+
+	if (closestTriangle != (uint32_t)(-1))
+	{
+		FillRaycastHit(ray, closestTriangle, closestBarycentric, maxRayLength, outResult);
+	}
+
+	return outResult.HasIntersection();
+}
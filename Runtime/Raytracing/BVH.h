@@ -2,6 +2,8 @@
 #include "Core/Defines.h"
 #include "Math/Bounds.h"
 #include "Containers/Vector.h"
+#include "SceneCache.h"
+#include <atomic>
 
 using namespace Sailor;
 
@@ -33,8 +35,38 @@ namespace Sailor::Raytracing
 			}
 		};
 
+		// Node of the collapsed tree, the bounds of the children are stored as SoA to test all of them with one SIMD op.
+		// m_child is the index of the wide node or the first triangle when m_triCount > 0.
+		template<uint32_t Width>
+		struct TWideNode
+		{
+			float m_aabbMin[3][Width];
+			float m_aabbMax[3][Width];
+			uint32_t m_child[Width];
+			uint32_t m_triCount[Width];
+			uint32_t m_numChildren = 0;
+		};
+
 	public:
 
+		// Intersection-only triangle, 48 bytes: the edges are precomputed and the shading data is fetched for the closest hit only
+		struct IntersectionTriangle
+		{
+			vec3 m_v0;
+			uint32_t m_triangleIndex;
+			vec3 m_edge1;
+			float m_padding1;
+			vec3 m_edge2;
+			float m_padding2;
+
+			IntersectionTriangle() = default;
+			IntersectionTriangle(const Math::Triangle& tri, uint32_t triangleIndex);
+
+			// The same test as Math::IntersectRayTriangle, outBarycentric is (u, v)
+			bool Intersect(const Math::Ray& ray, float maxRayLength, vec2& outBarycentric, float& outDistance) const;
+		};
+
+		BVH() = default;
 		BVH(uint32_t numTriangles)
 		{
 			const uint32_t N = 2 * numTriangles - 1;
@@ -42,22 +74,82 @@ namespace Sailor::Raytracing
 			m_triIdx.AddDefault(N);
 		}
 
-		void BuildBVH(const TVector<Math::Triangle>& tris);
+		// The nodes are allocated by the constructor or by BuildBVH when the BVH is default constructed.
+		// The big subtrees are built by the scheduler tasks and the big nodes are binned in parallel,
+		// the resulting tree is the same as the single threaded one.
+		void BuildBVH(const TVector<Math::Triangle>& tris, bool bMultithreaded = true);
 		bool IntersectBVH(const Math::Ray& ray, Math::RaycastHit& outResult, const uint nodeIdx, float maxRayLength = std::numeric_limits<float>::max(), uint32_t ignoreTriangle = (uint32_t)(-1)) const;
 
+		// The binary traversal over the full Math::Triangle leaves instead of the compact stream, the reference for the layout benchmark
+		bool IntersectBVHFullTriangles(const Math::Ray& ray, Math::RaycastHit& outResult, float maxRayLength = std::numeric_limits<float>::max()) const;
+
+		// Occlusion query, stops at the first intersection closer than maxRayLength
+		bool IntersectAnyBVH(const Math::Ray& ray, float maxRayLength = std::numeric_limits<float>::max()) const;
+
+		Math::AABB GetBounds() const;
+
+		// Collapses the binary tree into the 4 or 8 wide one (width 2 keeps the binary tree),
+		// after that IntersectBVH traverses the wide tree. Should be called after BuildBVH.
+		void CollapseBVH(uint32_t width);
+		uint32_t GetWidth() const { return m_width; }
+
+		// Surface area heuristic cost of the binary tree to compare the tree quality
+		float CalculateSAHCost() const;
+
+		// The binary tree is cached, the wide one is collapsed after the load
+		void Serialize(SceneCache& cache) const;
+		bool Deserialize(SceneCache& cache);
+
+		// Packet traversal for the coherent rays (primary, shadow): the lanes share the traversal stack,
+		// each node is tested against all lanes with one SSE/AVX2 slab test and the node is skipped when no lane hits it.
+		// Returns the mask of the lanes with the intersection, only the lanes from activeMask are traced and written.
+		uint32_t IntersectBVH4(const Math::Ray* rays, Math::RaycastHit* outResults, uint32_t activeMask = 0xF, float maxRayLength = std::numeric_limits<float>::max(), uint32_t ignoreTriangle = (uint32_t)(-1)) const;
+		uint32_t IntersectBVH8(const Math::Ray* rays, Math::RaycastHit* outResults, uint32_t activeMask = 0xFF, float maxRayLength = std::numeric_limits<float>::max(), uint32_t ignoreTriangle = (uint32_t)(-1)) const;
+
+		// Traces the coherent rays in the 8 lanes packets (AVX2) or in the 4 lanes packets (SSE) when AVX2 is not available,
+		// the collapsed width only affects the single rays.
+		void IntersectRays(const Math::Ray* rays, Math::RaycastHit* outResults, uint32_t numRays, float maxRayLength = std::numeric_limits<float>::max(), uint32_t ignoreTriangle = (uint32_t)(-1)) const;
+
 	protected:
 
-		void UpdateNodeBounds(uint32_t nodeIdx, const TVector<Math::Triangle>& tris);
-		void Subdivide(uint32_t nodeIdx, const TVector<Math::Triangle>& tris);
+		static constexpr uint32_t NumBins = 8;
+		static constexpr uint32_t ParallelSubtreeThreshold = 4096;
+		static constexpr uint32_t ParallelBinningThreshold = 65536;
+		static constexpr uint32_t ParallelGrainSize = 16384;
+
+		void UpdateNodeBounds(uint32_t nodeIdx, const TVector<Math::Triangle>& tris, bool bMultithreaded);
+		void Subdivide(uint32_t nodeIdx, const TVector<Math::Triangle>& tris, bool bMultithreaded);
 		float EvaluateSAH(const BVHNode& node, const TVector<Math::Triangle>& tris, int32_t axis, float pos) const;
-		float FindBestSplitPlane(const BVHNode& node, const TVector<Math::Triangle>& tris, int32_t& outAxis, float& outSplitPos) const;
+		float FindBestSplitPlane(const BVHNode& node, const TVector<Math::Triangle>& tris, int32_t& outAxis, float& outSplitPos, bool bMultithreaded) const;
+
+		void FillRaycastHit(const Math::Ray& ray, uint32_t triangle, const vec2& barycentric, float distance, Math::RaycastHit& outResult) const;
+
+		template<uint32_t Width>
+		uint32_t CollapseNode(uint32_t nodeIdx, TVector<TWideNode<Width>>& outNodes) const;
+
+		// intersect(leafTriangle, maxRayLength, outBarycentric, outDistance) tests the triangle in the leaf order
+		template<typename TIntersect>
+		bool IntersectBinary(const Math::Ray& ray, Math::RaycastHit& outResult, float maxRayLength, TIntersect intersect) const;
+
+		template<typename TSimd>
+		bool IntersectWide(const TVector<TWideNode<TSimd::Width>>& nodes, const Math::Ray& ray, Math::RaycastHit& outResult, float maxRayLength, uint32_t ignoreTriangle) const;
+
+		template<typename TSimd>
+		uint32_t IntersectPacket(const Math::Ray* rays, Math::RaycastHit* outResults, uint32_t activeMask, float maxRayLength, uint32_t ignoreTriangle) const;
 
 		TVector<BVHNode> m_nodes;
 		TVector<uint32_t> m_triIdx;
+		// Both are ordered by the leaves, m_triangles is only read for the closest hit
+		TVector<IntersectionTriangle> m_intersectionTriangles;
 		TVector<Math::Triangle> m_triangles;
-		TVector<uint32_t> m_triIdxMapping;
 
 		uint32_t m_rootNodeIdx = 0;
-		uint32_t m_nodesUsed = 1;
+		std::atomic<uint32_t> m_nodesUsed = 1;
+
+		uint32_t m_width = 2;
+		TVector<TWideNode<4>> m_wideNodes4;
+		TVector<TWideNode<8>> m_wideNodes8;
 	};
-}
\ No newline at end of file
+
+	SAILOR_API void RunBVHBenchmark();
+}
@@ -0,0 +1,506 @@
+#include <random>
+#include <filesystem>
+#include "BVH.h"
+#include "MaterialUtils.h"
+#include "Core/Utils.h"
+#include "Core/LogMacros.h"
+#include "Containers/Vector.h"
+#include "Math/Bounds.h"
+#include "AssetRegistry/AssetRegistry.h"
+#include "glm/glm/glm.hpp"
+
+#include "assimp/scene.h"
+#include "assimp/postprocess.h"
+#include "assimp/Importer.hpp"
+
+using namespace Sailor;
+using namespace Sailor::Math;
+using namespace Sailor::Raytracing;
+using Timer = Utils::Timer;
+
+namespace
+{
+	struct Result
+	{
+		std::string m_traversal;
+		size_t m_ms = 0;
+		size_t m_numRays = 0;
+		size_t m_numHits = 0;
+		bool m_bSanityPassed = true;
+
+		Result() = default;
+		Result(std::string traversal) : m_traversal(traversal) {}
+
+		void PrintLog() const
+		{
+			const double mraysPerSecond = m_ms > 0 ? m_numRays / (m_ms * 1000.0) : 0.0;
+			SAILOR_LOG("%s: %llums, %.2f Mrays/s, hits: %llu, sanity check passed: %d", m_traversal.c_str(), m_ms, mraysPerSecond, m_numHits, m_bSanityPassed);
+		}
+	};
+
+	// Height field with the random debris above, close to the typical scene with the ground and the objects
+	TVector<Triangle> GenerateScene(uint32_t gridSize, uint32_t numDebris)
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> height(-0.5f, 0.5f);
+		std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+		std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+		TVector<Triangle> res;
+		res.Reserve(gridSize * gridSize * 2 + numDebris);
+
+		auto addTriangle = [&](const vec3& v0, const vec3& v1, const vec3& v2)
+			{
+				Triangle tri{};
+				tri.m_vertices[0] = v0;
+				tri.m_vertices[1] = v1;
+				tri.m_vertices[2] = v2;
+
+				const vec3 normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
+				tri.m_normals[0] = tri.m_normals[1] = tri.m_normals[2] = normal;
+				tri.m_centroid = (v0 + v1 + v2) * 0.333f;
+
+				res.Add(tri);
+			};
+
+		const float cellSize = 100.0f / gridSize;
+		for (uint32_t z = 0; z < gridSize; z++)
+		{
+			for (uint32_t x = 0; x < gridSize; x++)
+			{
+				const vec3 v00 = vec3(-50.0f + x * cellSize, height(random), -50.0f + z * cellSize);
+				const vec3 v10 = v00 + vec3(cellSize, height(random), 0);
+				const vec3 v01 = v00 + vec3(0, height(random), cellSize);
+				const vec3 v11 = v00 + vec3(cellSize, height(random), cellSize);
+
+				addTriangle(v00, v01, v10);
+				addTriangle(v10, v01, v11);
+			}
+		}
+
+		for (uint32_t i = 0; i < numDebris; i++)
+		{
+			const vec3 center = vec3(position(random), 5.0f + position(random) * 0.1f, position(random));
+			addTriangle(center + vec3(offset(random), offset(random), offset(random)),
+				center + vec3(offset(random), offset(random), offset(random)),
+				center + vec3(offset(random), offset(random), offset(random)));
+		}
+
+		return res;
+	}
+
+	// Primary rays of the pinhole camera, grouped by 8 pixels in the row as the PathTracer does
+	TVector<Ray> GenerateCameraRays(uint32_t width, uint32_t height, const vec3& cameraPos, const vec3& target)
+	{
+		const vec3 forward = glm::normalize(target - cameraPos);
+		const vec3 right = glm::normalize(glm::cross(vec3(0, 1, 0), forward));
+		const vec3 up = glm::cross(forward, right);
+
+		TVector<Ray> res;
+		res.Reserve(width * height);
+
+		for (uint32_t y = 0; y < height; y++)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				const float u = (x + 0.5f) / width - 0.5f;
+				const float v = (y + 0.5f) / height - 0.5f;
+
+				res.Add(Ray(cameraPos, glm::normalize(forward + right * u * 1.5f + up * v * 1.5f)));
+			}
+		}
+
+		return res;
+	}
+
+	// The rays from the random points in random directions, close to the diffuse bounces
+	TVector<Ray> GenerateIncoherentRays(const AABB& bounds, uint32_t count)
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+		TVector<Ray> res;
+		res.Reserve(count);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const vec3 t = vec3(unit(random), unit(random), unit(random));
+			const vec3 origin = bounds.m_min + (bounds.m_max - bounds.m_min) * t;
+
+			vec3 dir = vec3(direction(random), direction(random), direction(random));
+			if (glm::dot(dir, dir) < 0.0001f)
+			{
+				dir = vec3(0, 1, 0);
+			}
+
+			res.Add(Ray(origin, glm::normalize(dir)));
+		}
+
+		return res;
+	}
+
+	AABB CalculateBounds(const TVector<Triangle>& triangles)
+	{
+		AABB res;
+		for (const auto& tri : triangles)
+		{
+			res.Extend(tri.m_vertices[0]);
+			res.Extend(tri.m_vertices[1]);
+			res.Extend(tri.m_vertices[2]);
+		}
+		return res;
+	}
+
+	bool ImportTriangles(const std::filesystem::path& path, TVector<Triangle>& outTriangles)
+	{
+		Assimp::Importer importer;
+
+		const auto scene = importer.ReadFile(path.string().c_str(), aiProcess_GenNormals | aiProcess_GenUVCoords);
+		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+		{
+			SAILOR_LOG("%s", importer.GetErrorString());
+			return false;
+		}
+
+		ProcessNode_Assimp(outTriangles, scene->mRootNode, scene, glm::mat4(1.0f));
+		return outTriangles.Num() > 0;
+	}
+
+	bool IsSameHit(const RaycastHit& lhs, const RaycastHit& rhs)
+	{
+		if (lhs.HasIntersection() != rhs.HasIntersection())
+		{
+			return false;
+		}
+
+		return !lhs.HasIntersection() ||
+			(lhs.m_triangleIndex == rhs.m_triangleIndex && std::abs(lhs.m_rayLenght - rhs.m_rayLenght) < 0.001f);
+	}
+
+	template<uint32_t PacketSize, typename TIntersect>
+	Result RunPacketTest(std::string traversal, const TVector<Ray>& rays, const TVector<RaycastHit>& reference, TIntersect intersect)
+	{
+		Result r(traversal);
+		r.m_numRays = rays.Num();
+
+		TVector<RaycastHit> hits(rays.Num());
+
+		Timer timer;
+		timer.Start();
+
+		for (size_t i = 0; i < rays.Num(); i += PacketSize)
+		{
+			const size_t numActive = std::min((size_t)PacketSize, rays.Num() - i);
+			intersect(&rays[i], &hits[i], (1u << numActive) - 1);
+		}
+
+		timer.Stop();
+		r.m_ms = timer.ResultMs();
+
+		for (size_t i = 0; i < rays.Num(); i++)
+		{
+			r.m_numHits += hits[i].HasIntersection() ? 1 : 0;
+			r.m_bSanityPassed &= IsSameHit(hits[i], reference[i]);
+		}
+
+		return r;
+	}
+
+	Result RunScalarTest(std::string traversal, const BVH& bvh, const TVector<Ray>& rays, TVector<RaycastHit>& hits, const TVector<RaycastHit>* reference)
+	{
+		Result r(traversal);
+		r.m_numRays = rays.Num();
+
+		Timer timer;
+		timer.Start();
+
+		for (size_t i = 0; i < rays.Num(); i++)
+		{
+			hits[i] = RaycastHit();
+			bvh.IntersectBVH(rays[i], hits[i], 0);
+		}
+
+		timer.Stop();
+		r.m_ms = timer.ResultMs();
+
+		for (size_t i = 0; i < rays.Num(); i++)
+		{
+			r.m_numHits += hits[i].HasIntersection() ? 1 : 0;
+			r.m_bSanityPassed &= reference == nullptr || IsSameHit(hits[i], (*reference)[i]);
+		}
+
+		return r;
+	}
+
+	// The single threaded build vs the multithreaded one, the trees should have the same SAH cost
+	void RunBuildTest(const std::string& sceneName, const TVector<Triangle>& triangles)
+	{
+		float sahCost[2]{};
+		size_t buildMs[2]{};
+
+		for (uint32_t i = 0; i < 2; i++)
+		{
+			const bool bMultithreaded = i == 1;
+
+			BVH bvh((uint32_t)triangles.Num());
+
+			Timer timer;
+			timer.Start();
+			bvh.BuildBVH(triangles, bMultithreaded);
+			timer.Stop();
+
+			buildMs[i] = timer.ResultMs();
+			sahCost[i] = bvh.CalculateSAHCost();
+		}
+
+		SAILOR_LOG("\nScene: %s, triangles: %llu", sceneName.c_str(), triangles.Num());
+		SAILOR_LOG("Single threaded build: %llums, SAH cost: %.3f", buildMs[0], sahCost[0]);
+		SAILOR_LOG("Multithreaded build: %llums, SAH cost: %.3f, sanity check passed: %d", buildMs[1], sahCost[1],
+			std::abs(sahCost[0] - sahCost[1]) <= 0.001f * sahCost[0]);
+	}
+
+	// The binary traversal over the full Math::Triangle leaves vs the compact intersection-only stream on the same rays,
+	// every ray should hit the same triangle at the same distance
+	void RunTriangleLayoutTest(const std::string& sceneName, const TVector<Triangle>& triangles)
+	{
+		if (triangles.Num() == 0)
+		{
+			return;
+		}
+
+		const AABB bounds = CalculateBounds(triangles);
+		const TVector<Ray> rays = GenerateIncoherentRays(bounds, 1 << 20);
+
+		BVH bvh((uint32_t)triangles.Num());
+		bvh.BuildBVH(triangles);
+
+		TVector<RaycastHit> reference(rays.Num());
+
+		Result fat("Math::Triangle leaves");
+		fat.m_numRays = rays.Num();
+
+		Timer timer;
+		timer.Start();
+		for (size_t i = 0; i < rays.Num(); i++)
+		{
+			bvh.IntersectBVHFullTriangles(rays[i], reference[i]);
+		}
+		timer.Stop();
+		fat.m_ms = timer.ResultMs();
+
+		for (const auto& hit : reference)
+		{
+			fat.m_numHits += hit.HasIntersection() ? 1 : 0;
+		}
+
+		TVector<RaycastHit> hits(rays.Num());
+		const Result compact = RunScalarTest("BVH::IntersectionTriangle leaves", bvh, rays, hits, &reference);
+
+		SAILOR_LOG("\nTriangle layout, scene: %s, bytes per triangle: %llu -> %llu", sceneName.c_str(), sizeof(Triangle), sizeof(BVH::IntersectionTriangle));
+		fat.PrintLog();
+		compact.PrintLog();
+	}
+
+	// Textured ground plane seen at the glancing angle: the float row-major textures against the mipmapped 8-bit tiled ones
+	void RunTextureSamplingTest()
+	{
+		const int32_t TextureSize = 4096;
+		const uint32_t Width = 1280;
+		const uint32_t Height = 720;
+		const float UVScale = 0.1f;
+
+		std::mt19937 random(3);
+		TVector<u8vec4> texels(TextureSize * TextureSize);
+		for (auto& texel : texels)
+		{
+			texel = u8vec4(random() & 0xFF, random() & 0xFF, random() & 0xFF, 0xFF);
+		}
+
+		// Base color, normal map and ORM as PathTracer loads them
+		const bool bConvertToLinear[3] = { true, false, false };
+		const bool bNormalMap[3] = { false, true, false };
+
+		TVector<TSharedPtr<CombinedSampler2D>> floatTextures;
+		TVector<TSharedPtr<CombinedSampler2D>> tiledTextures;
+		size_t floatBytes = 0;
+		size_t tiledBytes = 0;
+
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			auto& tiled = tiledTextures[tiledTextures.Emplace(TSharedPtr<CombinedSampler2D>::Make())];
+			tiled->m_width = tiled->m_height = TextureSize;
+			tiled->m_channels = i == 0 ? 4 : 3;
+			tiled->m_clamping = SamplerClamping::Repeat;
+			tiled->Initialize<vec4, u8vec4>(texels.GetData(), bConvertToLinear[i], bNormalMap[i]);
+
+			auto& flat = floatTextures[floatTextures.Emplace(TSharedPtr<CombinedSampler2D>::Make())];
+			if (i == 0)
+			{
+				flat->Initialize<vec4>(TextureSize, TextureSize, 4, SamplerClamping::Repeat);
+			}
+			else
+			{
+				flat->Initialize<vec3>(TextureSize, TextureSize, 3, SamplerClamping::Repeat);
+			}
+
+			for (int32_t j = 0; j < TextureSize * TextureSize; j++)
+			{
+				const vec4 texel = vec4(texels[j]);
+				const vec4 value = bNormalMap[i] ? texel * (1.0f / 127.5f) - 1.0f :
+					(bConvertToLinear[i] ? Utils::SRGBToLinear(texel * (1.0f / 255.0f)) : texel * (1.0f / 255.0f));
+
+				if (i == 0)
+				{
+					flat->SetPixel(j % TextureSize, j / TextureSize, value);
+				}
+				else
+				{
+					flat->SetPixel(j % TextureSize, j / TextureSize, vec3(value));
+				}
+			}
+
+			floatBytes += flat->m_data.Num();
+			tiledBytes += tiled->m_data.Num();
+		}
+
+		// The uv and the ray cone footprint of the camera rays on the plane y = 0
+		const vec3 cameraPos = vec3(0.0f, 2.0f, 0.0f);
+		const TVector<Ray> rays = GenerateCameraRays(Width, Height, cameraPos, vec3(0.0f, 0.0f, 100.0f));
+		const float pixelSpreadAngle = atan(1.5f / Height);
+
+		TVector<vec2> uvs;
+		TVector<float> footprints;
+		for (const auto& ray : rays)
+		{
+			if (ray.GetDirection().y >= 0.0f)
+			{
+				continue;
+			}
+
+			const float distance = -cameraPos.y / ray.GetDirection().y;
+			const vec3 point = cameraPos + ray.GetDirection() * distance;
+
+			uvs.Add(vec2(point.x, point.z) * UVScale);
+			footprints.Add(std::log2(UVScale) + std::log2(pixelSpreadAngle * distance / -ray.GetDirection().y));
+		}
+
+		auto run = [&](const char* name, const TVector<TSharedPtr<CombinedSampler2D>>& textures, bool bUseFootprint)
+			{
+				Timer timer;
+				timer.Start();
+
+				vec4 checksum{};
+				for (size_t i = 0; i < uvs.Num(); i++)
+				{
+					const float footprint = bUseFootprint ? footprints[i] : -std::numeric_limits<float>::infinity();
+
+					checksum += textures[0]->Sample<vec4>(uvs[i], footprint);
+					checksum += vec4(textures[1]->Sample<vec3>(uvs[i], footprint), 0.0f);
+					checksum += vec4(textures[2]->Sample<vec3>(uvs[i], footprint), 0.0f);
+				}
+
+				timer.Stop();
+
+				SAILOR_LOG("%s: %llums, %.2f Msamples/s, checksum: %.2f", name, timer.ResultMs(),
+					timer.ResultMs() > 0 ? uvs.Num() * 3 / (timer.ResultMs() * 1000.0) : 0.0, checksum.x + checksum.y + checksum.z);
+			};
+
+		SAILOR_LOG("\nTexture sampling, 3 textures %dx%d, hits: %llu, memory: float %lluMB -> RGBA8 with mips %lluMB", TextureSize, TextureSize,
+			uvs.Num(), floatBytes >> 20, tiledBytes >> 20);
+
+		run("Float row-major", floatTextures, false);
+		run("RGBA8 tiled, the most detailed mip", tiledTextures, false);
+		run("RGBA8 tiled, mips by the ray cone", tiledTextures, true);
+	}
+
+	// Binary BVH vs the collapsed BVH4/BVH8 for the primary and the incoherent rays
+	void RunWideBVHTest(const std::string& sceneName, const TVector<Triangle>& triangles)
+	{
+		const AABB bounds = CalculateBounds(triangles);
+		const vec3 center = (bounds.m_min + bounds.m_max) * 0.5f;
+		const vec3 extents = bounds.m_max - bounds.m_min;
+
+		const TVector<Ray> primaryRays = GenerateCameraRays(1280, 720, center + vec3(0.0f, extents.y * 0.25f, -glm::length(extents)), center);
+		const TVector<Ray> incoherentRays = GenerateIncoherentRays(bounds, 1 << 20);
+
+		BVH bvh((uint32_t)triangles.Num());
+		bvh.BuildBVH(triangles);
+
+		TVector<RaycastHit> primaryReference(primaryRays.Num());
+		TVector<RaycastHit> incoherentReference(incoherentRays.Num());
+		TVector<RaycastHit> hits(std::max(primaryRays.Num(), incoherentRays.Num()));
+
+		TVector<Result> res;
+		res.Add(RunScalarTest("BVH2 primary", bvh, primaryRays, primaryReference, nullptr));
+		res.Add(RunScalarTest("BVH2 incoherent", bvh, incoherentRays, incoherentReference, nullptr));
+
+		for (uint32_t width : { 4u, 8u })
+		{
+			bvh.CollapseBVH(width);
+
+			res.Add(RunScalarTest("BVH" + std::to_string(width) + " primary", bvh, primaryRays, hits, &primaryReference));
+			res.Add(RunScalarTest("BVH" + std::to_string(width) + " incoherent", bvh, incoherentRays, hits, &incoherentReference));
+		}
+
+		for (const auto& r : res)
+		{
+			r.PrintLog();
+		}
+	}
+}
+
+void Sailor::Raytracing::RunBVHBenchmark()
+{
+	printf("\nStarting BVH benchmark...\n");
+
+	const TVector<Triangle> triangles = GenerateScene(256, 50000);
+	const TVector<Ray> rays = GenerateCameraRays(1920, 1080, vec3(0, 30.0f, -70.0f), vec3(0, 0, 0));
+
+	BVH bvh((uint32_t)triangles.Num());
+	bvh.BuildBVH(triangles);
+
+	TVector<Result> res;
+	TVector<RaycastHit> reference(rays.Num());
+
+	res.Add(RunScalarTest("Scalar IntersectBVH", bvh, rays, reference, nullptr));
+
+	res.Add(RunPacketTest<4>("IntersectBVH4 (SSE)", rays, reference,
+		[&](const Ray* pRays, RaycastHit* pHits, uint32_t mask) { bvh.IntersectBVH4(pRays, pHits, mask); }));
+
+	res.Add(RunPacketTest<8>("IntersectBVH8 (AVX2)", rays, reference,
+		[&](const Ray* pRays, RaycastHit* pHits, uint32_t mask) { bvh.IntersectBVH8(pRays, pHits, mask); }));
+
+	SAILOR_LOG("\nPacket traversal, triangles: %llu, rays: %llu", triangles.Num(), rays.Num());
+	for (const auto& r : res)
+	{
+		r.PrintLog();
+	}
+
+	RunBuildTest("Procedural", triangles);
+	RunTriangleLayoutTest("Procedural", triangles);
+	RunWideBVHTest("Procedural", triangles);
+	RunTextureSamplingTest();
+
+	const std::filesystem::path modelsFolder = std::filesystem::path(AssetRegistry::ContentRootFolder) / "Models";
+	if (std::filesystem::exists(modelsFolder))
+	{
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(modelsFolder))
+		{
+			if (entry.path().extension() != ".gltf")
+			{
+				continue;
+			}
+
+			TVector<Triangle> sceneTriangles;
+			if (ImportTriangles(entry.path(), sceneTriangles))
+			{
+				RunBuildTest(entry.path().filename().string(), sceneTriangles);
+				RunTriangleLayoutTest(entry.path().filename().string(), sceneTriangles);
+				RunWideBVHTest(entry.path().filename().string(), sceneTriangles);
+			}
+		}
+	}
+
+	printf("\n\n");
+}
@@ -0,0 +1,267 @@
+#include "Denoiser.h"
+#include "MaterialUtils.h"
+#include "Tasks/ParallelFor.h"
+#include "Containers/Vector.h"
+#include "Core/LogMacros.h"
+#include "glm/glm/glm.hpp"
+#include <immintrin.h>
+
+using namespace Sailor;
+using namespace Sailor::Raytracing;
+
+namespace
+{
+	constexpr uint32_t Lanes = 8;
+	constexpr uint32_t RowGrainSize = 4;
+
+	// The albedo is clamped, so the black surfaces are not divided by zero and the demodulation is reversible
+	constexpr float MinAlbedo = 0.001f;
+
+	constexpr float Kernel[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+	// The weights below exp(MinExponent) are zeroed, so the sums never get denormal and slow
+	constexpr float MinExponent = -60.0f;
+
+	// exp(x) as 2^i * 2^f, the polynomial of 2^f on [0, 1) has the relative error below 1e-5
+	__forceinline __m256 Exp(__m256 x)
+	{
+		const __m256 t = _mm256_mul_ps(x, _mm256_set1_ps(1.44269504f));
+		const __m256 i = _mm256_floor_ps(t);
+		const __m256 f = _mm256_sub_ps(t, i);
+
+		__m256 p = _mm256_set1_ps(1.3333558e-3f);
+		p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(9.6181291e-3f));
+		p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(5.5504109e-2f));
+		p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(2.4022651e-1f));
+		p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(6.9314718e-1f));
+		p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.0f));
+
+		const __m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(i), _mm256_set1_epi32(127)), 23);
+		return _mm256_mul_ps(p, _mm256_castsi256_ps(exponent));
+	}
+
+	// The image in SoA layout, the rows are padded by the margin of the widest kernel,
+	// so the taps outside of the image are loaded from the padding and masked out.
+	struct Planes
+	{
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+		uint32_t m_stride = 0;
+		uint32_t m_margin = 0;
+
+		TVector<float> m_data;
+
+		void Initialize(uint32_t width, uint32_t height, uint32_t margin, uint32_t numPlanes)
+		{
+			m_width = width;
+			m_height = height;
+			m_margin = margin;
+			m_stride = ((width + Lanes - 1) / Lanes) * Lanes + 2 * margin;
+
+			m_data.Clear(false);
+			m_data.AddDefault(m_stride * height * numPlanes);
+		}
+
+		__forceinline float* Get(uint32_t plane) { return m_data.GetData() + (size_t)plane * m_stride * m_height + m_margin; }
+		__forceinline const float* Get(uint32_t plane) const { return m_data.GetData() + (size_t)plane * m_stride * m_height + m_margin; }
+	};
+
+	enum GuidePlane : uint32_t
+	{
+		NormalX = 0,
+		NormalY,
+		NormalZ,
+		Depth,
+		NumGuidePlanes
+	};
+
+	void FilterRows(const Planes& src, Planes& dst, const Planes& guide, uint32_t firstRow, uint32_t lastRow, int32_t step, const DenoiserParams& params, float invColorSigma2)
+	{
+		const float* srcR = src.Get(0);
+		const float* srcG = src.Get(1);
+		const float* srcB = src.Get(2);
+
+		float* dstR = dst.Get(0);
+		float* dstG = dst.Get(1);
+		float* dstB = dst.Get(2);
+
+		const float* nX = guide.Get(NormalX);
+		const float* nY = guide.Get(NormalY);
+		const float* nZ = guide.Get(NormalZ);
+		const float* depth = guide.Get(Depth);
+
+		const int32_t width = (int32_t)src.m_width;
+		const int32_t height = (int32_t)src.m_height;
+		const uint32_t stride = src.m_stride;
+
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 imageWidth = _mm256_set1_ps((float)width);
+		const __m256 laneOffsets = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256 minusInvColorSigma2 = _mm256_set1_ps(-invColorSigma2);
+		const __m256 depthSigma = _mm256_set1_ps(params.m_depthPhi * (float)step);
+		const __m256 epsilon = _mm256_set1_ps(1e-6f);
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 normalPhi = _mm256_set1_ps(params.m_normalPhi);
+		const __m256 minExponent = _mm256_set1_ps(MinExponent);
+
+		for (int32_t y = (int32_t)firstRow; y < (int32_t)lastRow; y++)
+		{
+			for (int32_t x = 0; x < width; x += Lanes)
+			{
+				const size_t center = (size_t)y * stride + x;
+
+				const __m256 cR = _mm256_loadu_ps(srcR + center);
+				const __m256 cG = _mm256_loadu_ps(srcG + center);
+				const __m256 cB = _mm256_loadu_ps(srcB + center);
+				const __m256 cNX = _mm256_loadu_ps(nX + center);
+				const __m256 cNY = _mm256_loadu_ps(nY + center);
+				const __m256 cNZ = _mm256_loadu_ps(nZ + center);
+				const __m256 cDepth = _mm256_loadu_ps(depth + center);
+
+				const __m256 minusInvDepthSigma = _mm256_div_ps(_mm256_set1_ps(-1.0f), _mm256_add_ps(_mm256_mul_ps(depthSigma, cDepth), epsilon));
+				const __m256 pixelX = _mm256_add_ps(_mm256_set1_ps((float)x), laneOffsets);
+
+				__m256 sumR = zero, sumG = zero, sumB = zero, sumW = zero;
+
+				for (int32_t ky = -2; ky <= 2; ky++)
+				{
+					const int32_t tapY = y + ky * step;
+					if (tapY < 0 || tapY >= height)
+					{
+						continue;
+					}
+
+					for (int32_t kx = -2; kx <= 2; kx++)
+					{
+						const int32_t offsetX = kx * step;
+						const size_t tap = (size_t)tapY * stride + x + offsetX;
+
+						// The lanes outside of the image read the padding
+						const __m256 tapX = _mm256_add_ps(pixelX, _mm256_set1_ps((float)offsetX));
+						const __m256 inside = _mm256_and_ps(_mm256_cmp_ps(tapX, zero, _CMP_GE_OQ), _mm256_cmp_ps(tapX, imageWidth, _CMP_LT_OQ));
+
+						const __m256 tR = _mm256_loadu_ps(srcR + tap);
+						const __m256 tG = _mm256_loadu_ps(srcG + tap);
+						const __m256 tB = _mm256_loadu_ps(srcB + tap);
+
+						const __m256 dR = _mm256_sub_ps(tR, cR);
+						const __m256 dG = _mm256_sub_ps(tG, cG);
+						const __m256 dB = _mm256_sub_ps(tB, cB);
+						const __m256 colorDist2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dR, dR), _mm256_mul_ps(dG, dG)), _mm256_mul_ps(dB, dB));
+
+						const __m256 nDot = _mm256_add_ps(_mm256_add_ps(
+							_mm256_mul_ps(cNX, _mm256_loadu_ps(nX + tap)),
+							_mm256_mul_ps(cNY, _mm256_loadu_ps(nY + tap))),
+							_mm256_mul_ps(cNZ, _mm256_loadu_ps(nZ + tap)));
+
+						const __m256 depthDist = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(_mm256_loadu_ps(depth + tap), cDepth));
+
+						// All weights share one exp, the normal weight is exp(phi * (dot - 1)) that is close to dot^phi near 1
+						const __m256 exponent = _mm256_add_ps(_mm256_add_ps(
+							_mm256_mul_ps(colorDist2, minusInvColorSigma2),
+							_mm256_mul_ps(depthDist, minusInvDepthSigma)),
+							_mm256_mul_ps(_mm256_sub_ps(nDot, one), normalPhi));
+
+						const __m256 bIsSignificant = _mm256_and_ps(_mm256_cmp_ps(exponent, minExponent, _CMP_GT_OQ), inside);
+						const __m256 w = _mm256_and_ps(_mm256_mul_ps(Exp(exponent), _mm256_set1_ps(Kernel[ky + 2] * Kernel[kx + 2])), bIsSignificant);
+
+						sumR = _mm256_add_ps(sumR, _mm256_mul_ps(w, tR));
+						sumG = _mm256_add_ps(sumG, _mm256_mul_ps(w, tG));
+						sumB = _mm256_add_ps(sumB, _mm256_mul_ps(w, tB));
+						sumW = _mm256_add_ps(sumW, w);
+					}
+				}
+
+				// The missed rays have no normal and keep the color
+				const __m256 bHasWeight = _mm256_cmp_ps(sumW, zero, _CMP_GT_OQ);
+				const __m256 invSumW = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_max_ps(sumW, epsilon));
+
+				_mm256_storeu_ps(dstR + center, _mm256_blendv_ps(cR, _mm256_mul_ps(sumR, invSumW), bHasWeight));
+				_mm256_storeu_ps(dstG + center, _mm256_blendv_ps(cG, _mm256_mul_ps(sumG, invSumW), bHasWeight));
+				_mm256_storeu_ps(dstB + center, _mm256_blendv_ps(cB, _mm256_mul_ps(sumB, invSumW), bHasWeight));
+			}
+		}
+	}
+}
+
+void Sailor::Raytracing::Denoise(CombinedSampler2D& inOutColor, const DenoiserAOVs& aovs, const DenoiserParams& params)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	check(inOutColor.m_format == TextureFormat::Float && inOutColor.m_channels == 3);
+	check(aovs.m_width == (uint32_t)inOutColor.m_width && aovs.m_height == (uint32_t)inOutColor.m_height);
+
+	if (params.m_numIterations == 0)
+	{
+		return;
+	}
+
+	const uint32_t width = aovs.m_width;
+	const uint32_t height = aovs.m_height;
+	const uint32_t margin = ((2u << (params.m_numIterations - 1)) + Lanes - 1) / Lanes * Lanes;
+
+	vec3* color = reinterpret_cast<vec3*>(inOutColor.m_data.GetData());
+
+	Planes guide;
+	Planes planes[2];
+
+	guide.Initialize(width, height, margin, NumGuidePlanes);
+	planes[0].Initialize(width, height, margin, 3);
+	planes[1].Initialize(width, height, margin, 3);
+
+	// The normals are scattered to the planes and the color is demodulated by the albedo
+	Tasks::ParallelFor("Denoiser: Demodulate", 0, height, RowGrainSize,
+		[&](size_t y)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				const size_t pixel = y * width + x;
+				const size_t dst = y * guide.m_stride + x;
+				const vec3 albedo = glm::max(aovs.m_albedo[pixel], vec3(MinAlbedo));
+
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					planes[0].Get(c)[dst] = color[pixel][c] / albedo[c];
+					guide.Get(NormalX + c)[dst] = aovs.m_normal[pixel][c];
+				}
+
+				guide.Get(Depth)[dst] = aovs.m_depth[pixel];
+			}
+		});
+
+	uint32_t src = 0;
+	for (uint32_t i = 0; i < params.m_numIterations; i++)
+	{
+		SAILOR_PROFILE_BLOCK("Denoiser: A-trous iteration");
+
+		const int32_t step = 1 << i;
+		const float colorSigma = params.m_colorPhi / (float)step;
+		const float invColorSigma2 = 1.0f / (colorSigma * colorSigma);
+
+		Tasks::ParallelFor("Denoiser: A-trous iteration", 0, height, RowGrainSize,
+			[&](size_t first, size_t last)
+			{
+				FilterRows(planes[src], planes[src ^ 1], guide, (uint32_t)first, (uint32_t)last, step, params, invColorSigma2);
+			});
+
+		src ^= 1;
+
+		SAILOR_PROFILE_END_BLOCK();
+	}
+
+	Tasks::ParallelFor("Denoiser: Remodulate", 0, height, RowGrainSize,
+		[&](size_t y)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				const size_t pixel = y * width + x;
+				const size_t srcPixel = y * guide.m_stride + x;
+				const vec3 albedo = glm::max(aovs.m_albedo[pixel], vec3(MinAlbedo));
+
+				for (uint32_t c = 0; c < 3; c++)
+				{
+					color[pixel][c] = planes[src].Get(c)[srcPixel] * albedo[c];
+				}
+			}
+		});
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Containers/Vector.h"
+#include "glm/glm/glm.hpp"
+
+using namespace Sailor;
+using namespace glm;
+
+namespace Sailor::Raytracing
+{
+	struct CombinedSampler2D;
+
+	// The guide buffers of the first hits, row-major with the same layout as the denoised image
+	struct DenoiserAOVs
+	{
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+
+		TVector<vec3> m_albedo;
+		TVector<vec3> m_normal; // zero for the missed rays
+		TVector<float> m_depth;
+
+		void Initialize(uint32_t width, uint32_t height)
+		{
+			m_width = width;
+			m_height = height;
+
+			m_albedo.Clear(false);
+			m_normal.Clear(false);
+			m_depth.Clear(false);
+
+			m_albedo.AddDefault(width * height);
+			m_normal.AddDefault(width * height);
+			m_depth.AddDefault(width * height);
+		}
+	};
+
+	struct DenoiserParams
+	{
+		// The step between the taps is doubled each iteration, 5 iterations cover 61x61 pixels
+		uint32_t m_numIterations = 5;
+
+		// The sigma of the color weight in the demodulated color, it is halved each iteration
+		float m_colorPhi = 4.0f;
+		// The sharpness of the normal weight exp(phi * (dot - 1)), close to dot^phi
+		float m_normalPhi = 128.0f;
+		// The sigma of the depth weight relative to the depth and the step
+		float m_depthPhi = 0.05f;
+	};
+
+	/* Edge-avoiding a-trous wavelet filter (Dammertz et al. 2010).
+	*  The color is divided by the albedo, so only the lighting is filtered and the textures stay sharp.
+	*  Each iteration is the 5x5 B3-spline kernel with the holes between the taps, the taps are weighted
+	*  by the difference of the color, the normal and the depth to the center pixel.
+	*  The passes are split by the row tiles between the worker threads, 8 pixels of the row are filtered with one AVX2 op.
+	*/
+	SAILOR_API void Denoise(CombinedSampler2D& inOutColor, const DenoiserAOVs& aovs, const DenoiserParams& params = DenoiserParams());
+}
@@ -0,0 +1,344 @@
+#include "LightBVH.h"
+#include "Containers/Vector.h"
+#include "Core/LogMacros.h"
+#include "glm/glm/glm.hpp"
+#include "Math/Math.h"
+#include "Math/Bounds.h"
+#include <algorithm>
+
+using namespace Sailor;
+using namespace Sailor::Math;
+using namespace Sailor::Raytracing;
+
+namespace
+{
+	__forceinline float Luminance(const vec3& color)
+	{
+		return dot(color, vec3(0.2126f, 0.7152f, 0.0722f));
+	}
+}
+
+LightBVH::EmissiveTriangle::EmissiveTriangle(const Math::Triangle& tri, uint32_t triangleIndex, float luminance)
+{
+	m_v0 = tri.m_vertices[0];
+	m_edge1 = tri.m_vertices[1] - tri.m_vertices[0];
+	m_edge2 = tri.m_vertices[2] - tri.m_vertices[0];
+	m_triangleIndex = triangleIndex;
+
+	const vec3 n = cross(m_edge1, m_edge2);
+	const float length = glm::length(n);
+
+	m_area = 0.5f * length;
+	m_normal = length > 0.0f ? n / length : vec3(0.0f);
+	m_power = luminance * m_area;
+}
+
+void LightBVH::Build(TVector<EmissiveTriangle> lights, const TVector<DirectionalLight>& directionalLights, uint32_t numTriangles)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	m_lights = std::move(lights);
+	m_directionalLights = directionalLights;
+
+	m_nodes.Clear();
+	m_parents.Clear();
+	m_lightNodes.Clear();
+	m_triangleToLight.Clear();
+
+	if (m_lights.Num() == 0)
+	{
+		return;
+	}
+
+	const uint32_t numLights = (uint32_t)m_lights.Num();
+
+	m_nodes.Reserve(2 * numLights - 1);
+	m_parents.Reserve(2 * numLights - 1);
+
+	m_nodes.AddDefault(1);
+	m_nodes[0].m_leftFirst = 0;
+	m_nodes[0].m_count = numLights;
+	m_parents.Add(InvalidLight);
+
+	Subdivide(0);
+
+	m_lightNodes.AddDefault(numLights);
+	for (uint32_t i = 0; i < m_nodes.Num(); i++)
+	{
+		if (m_nodes[i].IsLeaf())
+		{
+			m_lightNodes[m_nodes[i].m_leftFirst] = i;
+		}
+	}
+
+	m_triangleToLight.Resize(numTriangles);
+	for (auto& light : m_triangleToLight)
+	{
+		light = InvalidLight;
+	}
+
+	for (uint32_t i = 0; i < numLights; i++)
+	{
+		m_triangleToLight[m_lights[i].m_triangleIndex] = i;
+	}
+}
+
+void LightBVH::Subdivide(uint32_t nodeIdx)
+{
+	const uint32_t first = m_nodes[nodeIdx].m_leftFirst;
+	const uint32_t count = m_nodes[nodeIdx].m_count;
+
+	AABB bounds;
+	AABB centroidBounds;
+	float power = 0.0f;
+
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		const EmissiveTriangle& light = m_lights[i];
+
+		bounds.Extend(light.m_v0);
+		bounds.Extend(light.m_v0 + light.m_edge1);
+		bounds.Extend(light.m_v0 + light.m_edge2);
+		centroidBounds.Extend(light.GetCentroid());
+
+		power += light.m_power;
+	}
+
+	m_nodes[nodeIdx].m_aabbMin = bounds.m_min;
+	m_nodes[nodeIdx].m_aabbMax = bounds.m_max;
+	m_nodes[nodeIdx].m_power = power;
+
+	if (count == 1)
+	{
+		return;
+	}
+
+	// The median split by the longest axis of the centroids, both children are never empty
+	const vec3 extent = centroidBounds.m_max - centroidBounds.m_min;
+	const int32_t axis = extent.y > extent.x ? (extent.z > extent.y ? 2 : 1) : (extent.z > extent.x ? 2 : 0);
+	const uint32_t leftCount = count / 2;
+
+	EmissiveTriangle* begin = m_lights.GetData() + first;
+	std::nth_element(begin, begin + leftCount, begin + count,
+		[axis](const EmissiveTriangle& a, const EmissiveTriangle& b) { return a.GetCentroid()[axis] < b.GetCentroid()[axis]; });
+
+	const uint32_t leftChildIdx = (uint32_t)m_nodes.Num();
+
+	m_nodes.AddDefault(2);
+	m_parents.Add(nodeIdx);
+	m_parents.Add(nodeIdx);
+
+	m_nodes[leftChildIdx].m_leftFirst = first;
+	m_nodes[leftChildIdx].m_count = leftCount;
+	m_nodes[leftChildIdx + 1].m_leftFirst = first + leftCount;
+	m_nodes[leftChildIdx + 1].m_count = count - leftCount;
+
+	m_nodes[nodeIdx].m_leftFirst = leftChildIdx;
+	m_nodes[nodeIdx].m_count = 0;
+
+	Subdivide(leftChildIdx);
+	Subdivide(leftChildIdx + 1);
+}
+
+float LightBVH::CalculateImportance(uint32_t nodeIdx, const vec3& point, const vec3& normal) const
+{
+	const Node& node = m_nodes[nodeIdx];
+
+	const vec3 center = (node.m_aabbMin + node.m_aabbMax) * 0.5f;
+	const vec3 halfExtent = node.m_aabbMax - center;
+	const vec3 toCenter = center - point;
+
+	const float distance2 = dot(toCenter, toCenter);
+	const float radius2 = dot(halfExtent, halfExtent);
+
+	// The node is behind the receiver when all corners of the box are
+	if (normal != vec3(0.0f) && dot(normal, toCenter) + dot(glm::abs(normal), halfExtent) <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	// The max cosine to the receiver over the bounding sphere of the node
+	float cosBound = 1.0f;
+	if (normal != vec3(0.0f) && distance2 > radius2)
+	{
+		const float distance = sqrt(distance2);
+		const float cosTheta = dot(normal, toCenter) / distance;
+		const float sinBound2 = radius2 / distance2;
+		const float cosBoundAngle = sqrt(1.0f - sinBound2);
+
+		if (cosTheta < cosBoundAngle)
+		{
+			const float sinTheta = sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+			cosBound = cosTheta * cosBoundAngle + sinTheta * sqrt(sinBound2);
+		}
+	}
+
+	if (cosBound <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return node.m_power * cosBound / std::max(distance2, radius2);
+}
+
+float LightBVH::CalculateImportance(const DirectionalLight& light, const vec3& normal) const
+{
+	const float cosTheta = normal != vec3(0.0f) ? dot(normal, -light.m_direction) : 1.0f;
+	return cosTheta > 0.0f ? Luminance(light.m_intensity) * cosTheta : 0.0f;
+}
+
+float LightBVH::CalculateTopLevelImportance(const vec3& point, const vec3& normal, float& outTotal) const
+{
+	const float treeImportance = m_nodes.Num() > 0 ? CalculateImportance(0, point, normal) : 0.0f;
+
+	outTotal = treeImportance;
+	for (const auto& light : m_directionalLights)
+	{
+		outTotal += CalculateImportance(light, normal);
+	}
+
+	return treeImportance;
+}
+
+bool LightBVH::Sample(const vec3& point, const vec3& normal, const vec3& randomSample, LightSample& outSample) const
+{
+	float total = 0.0f;
+	const float treeImportance = CalculateTopLevelImportance(point, normal, total);
+
+	if (total <= 0.0f)
+	{
+		return false;
+	}
+
+	float u = randomSample.x * total;
+
+	for (uint32_t i = 0; i < m_directionalLights.Num(); i++)
+	{
+		const float importance = CalculateImportance(m_directionalLights[i], normal);
+		if (u < importance || (treeImportance <= 0.0f && i == m_directionalLights.Num() - 1))
+		{
+			outSample.m_direction = -m_directionalLights[i].m_direction;
+			outSample.m_distance = std::numeric_limits<float>::max();
+			outSample.m_pdf = importance / total;
+			outSample.m_directionalLight = i;
+			outSample.m_triangleIndex = InvalidLight;
+
+			return importance > 0.0f;
+		}
+
+		u -= importance;
+	}
+
+	// The random number is rescaled at each level to choose the child
+	float pdf = treeImportance / total;
+	u = std::clamp(u / treeImportance, 0.0f, 0.99999994f);
+
+	uint32_t nodeIdx = 0;
+	while (!m_nodes[nodeIdx].IsLeaf())
+	{
+		const uint32_t leftChildIdx = m_nodes[nodeIdx].m_leftFirst;
+
+		const float left = CalculateImportance(leftChildIdx, point, normal);
+		const float right = CalculateImportance(leftChildIdx + 1, point, normal);
+
+		if (left + right <= 0.0f)
+		{
+			return false;
+		}
+
+		const float probabilityLeft = left / (left + right);
+		if (u < probabilityLeft)
+		{
+			u /= probabilityLeft;
+			pdf *= probabilityLeft;
+			nodeIdx = leftChildIdx;
+		}
+		else
+		{
+			u = (u - probabilityLeft) / (1.0f - probabilityLeft);
+			pdf *= 1.0f - probabilityLeft;
+			nodeIdx = leftChildIdx + 1;
+		}
+	}
+
+	const EmissiveTriangle& light = m_lights[m_nodes[nodeIdx].m_leftFirst];
+
+	// Uniform point on the triangle
+	const float su = sqrt(randomSample.y);
+	const float b1 = su * (1.0f - randomSample.z);
+	const float b2 = su * randomSample.z;
+
+	const vec3 toLight = light.m_v0 + light.m_edge1 * b1 + light.m_edge2 * b2 - point;
+	const float distance2 = dot(toLight, toLight);
+
+	if (distance2 <= 0.0f)
+	{
+		return false;
+	}
+
+	const float distance = sqrt(distance2);
+	const vec3 direction = toLight / distance;
+	const float cosLight = std::abs(dot(light.m_normal, direction));
+
+	if (cosLight <= 1e-6f || light.m_area <= 0.0f)
+	{
+		return false;
+	}
+
+	outSample.m_direction = direction;
+	outSample.m_distance = distance;
+	outSample.m_pdf = pdf * distance2 / (light.m_area * cosLight);
+	outSample.m_directionalLight = InvalidLight;
+	outSample.m_triangleIndex = light.m_triangleIndex;
+	outSample.m_barycentric = vec3(1.0f - b1 - b2, b1, b2);
+
+	return true;
+}
+
+float LightBVH::Pdf(const vec3& point, const vec3& normal, uint32_t triangleIndex, const vec3& lightPoint) const
+{
+	if (!IsLight(triangleIndex))
+	{
+		return 0.0f;
+	}
+
+	const uint32_t lightIdx = m_triangleToLight[triangleIndex];
+	const EmissiveTriangle& light = m_lights[lightIdx];
+
+	float total = 0.0f;
+	const float treeImportance = CalculateTopLevelImportance(point, normal, total);
+
+	if (treeImportance <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	// The probabilities of the choices from the leaf to the root
+	float pdf = treeImportance / total;
+	for (uint32_t nodeIdx = m_lightNodes[lightIdx]; m_parents[nodeIdx] != InvalidLight; nodeIdx = m_parents[nodeIdx])
+	{
+		const uint32_t leftChildIdx = m_nodes[m_parents[nodeIdx]].m_leftFirst;
+		const uint32_t siblingIdx = nodeIdx == leftChildIdx ? leftChildIdx + 1 : leftChildIdx;
+
+		const float importance = CalculateImportance(nodeIdx, point, normal);
+		const float sibling = CalculateImportance(siblingIdx, point, normal);
+
+		if (importance <= 0.0f)
+		{
+			return 0.0f;
+		}
+
+		pdf *= importance / (importance + sibling);
+	}
+
+	const vec3 toLight = lightPoint - point;
+	const float distance2 = dot(toLight, toLight);
+	const float cosLight = std::abs(dot(light.m_normal, toLight)) / sqrt(distance2);
+
+	if (cosLight <= 1e-6f || light.m_area <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return pdf * distance2 / (light.m_area * cosLight);
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Math/Bounds.h"
+#include "Containers/Vector.h"
+#include "LightingModel.h"
+
+using namespace Sailor;
+
+namespace Sailor::Raytracing
+{
+	/* Importance sampling of the lights for the next event estimation.
+	*  The emissive triangles are the leaves of the light BVH, the nodes store the bounds and the power of the subtree.
+	*  The tree is descended by the importance of the children for the shaded point (the power over the squared distance
+	*  bounded by the cosine to the receiver), so one shadow ray is traced per sample regardless of the number of the lights.
+	*  The directional lights are chosen against the root of the tree by their irradiance.
+	*/
+	class LightBVH
+	{
+		struct Node // 36 bytes
+		{
+			vec3 m_aabbMin;
+			uint32_t m_leftFirst;
+			vec3 m_aabbMax;
+			uint32_t m_count;
+			float m_power;
+
+			bool IsLeaf() const { return m_count > 0; }
+		};
+
+	public:
+
+		static constexpr uint32_t InvalidLight = (uint32_t)(-1);
+
+		struct EmissiveTriangle
+		{
+			vec3 m_v0;
+			uint32_t m_triangleIndex;
+			vec3 m_edge1;
+			float m_area;
+			vec3 m_edge2;
+			// The average emitted luminance by the area, the emission itself is sampled from the material
+			float m_power;
+			vec3 m_normal;
+
+			EmissiveTriangle() = default;
+			EmissiveTriangle(const Math::Triangle& tri, uint32_t triangleIndex, float luminance);
+
+			vec3 GetCentroid() const { return m_v0 + (m_edge1 + m_edge2) * (1.0f / 3.0f); }
+		};
+
+		struct LightSample
+		{
+			// Normalized direction to the light
+			vec3 m_direction{};
+			float m_distance = std::numeric_limits<float>::max();
+
+			// Solid angle pdf of the emissive triangles, the probability of the choice for the directional lights
+			float m_pdf = 0.0f;
+
+			uint32_t m_directionalLight = InvalidLight;
+			uint32_t m_triangleIndex = InvalidLight;
+			vec3 m_barycentric{};
+
+			bool IsDirectional() const { return m_directionalLight != InvalidLight; }
+		};
+
+		void Build(TVector<EmissiveTriangle> lights, const TVector<DirectionalLight>& directionalLights, uint32_t numTriangles);
+
+		// The zero normal disables the cosine bound of the receiver
+		bool Sample(const vec3& point, const vec3& normal, const vec3& randomSample, LightSample& outSample) const;
+
+		// The solid angle pdf of the light sample that hits the point of the triangle, 0 for the triangles that are not the lights
+		float Pdf(const vec3& point, const vec3& normal, uint32_t triangleIndex, const vec3& lightPoint) const;
+
+		bool IsEmpty() const { return m_lights.Num() == 0 && m_directionalLights.Num() == 0; }
+		bool IsLight(uint32_t triangleIndex) const { return triangleIndex < m_triangleToLight.Num() && m_triangleToLight[triangleIndex] != InvalidLight; }
+
+		size_t GetNumEmissiveTriangles() const { return m_lights.Num(); }
+		const DirectionalLight& GetDirectionalLight(uint32_t index) const { return m_directionalLights[index]; }
+
+	protected:
+
+		void Subdivide(uint32_t nodeIdx);
+
+		float CalculateImportance(uint32_t nodeIdx, const vec3& point, const vec3& normal) const;
+		float CalculateImportance(const DirectionalLight& light, const vec3& normal) const;
+
+		// Returns the importance of the tree, outTotal is the sum with the directional lights
+		float CalculateTopLevelImportance(const vec3& point, const vec3& normal, float& outTotal) const;
+
+		TVector<EmissiveTriangle> m_lights;
+		TVector<DirectionalLight> m_directionalLights;
+
+		TVector<Node> m_nodes;
+		TVector<uint32_t> m_parents;
+		TVector<uint32_t> m_lightNodes;
+		TVector<uint32_t> m_triangleToLight;
+	};
+}
@@ -0,0 +1,203 @@
+#include <random>
+#include "PathTracer.h"
+#include "BVH.h"
+#include "Core/Utils.h"
+#include "Core/LogMacros.h"
+#include "Containers/Vector.h"
+#include "Math/Bounds.h"
+#include "Tasks/ParallelFor.h"
+#include "glm/glm/glm.hpp"
+#include "glm/glm/gtc/random.hpp"
+
+using namespace Sailor;
+using namespace Sailor::Math;
+using namespace Sailor::Raytracing;
+using Timer = Utils::Timer;
+
+namespace
+{
+	void AddQuad(TVector<Triangle>& outTriangles, const vec3& corner, const vec3& edgeU, const vec3& edgeV, u8 materialIndex)
+	{
+		const vec3 normal = normalize(cross(edgeU, edgeV));
+		const vec3 vertices[4] = { corner, corner + edgeU, corner + edgeU + edgeV, corner + edgeV };
+		const vec2 uvs[4] = { vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1) };
+		const uint32_t indices[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+
+		for (const auto& face : indices)
+		{
+			Triangle tri{};
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				tri.m_vertices[i] = vertices[face[i]];
+				tri.m_normals[i] = normal;
+				tri.m_tangent[i] = normalize(edgeU);
+				tri.m_bitangent[i] = normalize(edgeV);
+				tri.m_uvs[i] = uvs[face[i]];
+			}
+
+			tri.m_centroid = (tri.m_vertices[0] + tri.m_vertices[1] + tri.m_vertices[2]) * (1.0f / 3.0f);
+			tri.m_materialIndex = materialIndex;
+			outTriangles.Add(tri);
+		}
+	}
+
+	void AddBox(TVector<Triangle>& outTriangles, const vec3& boxMin, const vec3& boxMax, u8 materialIndex)
+	{
+		const vec3 e = boxMax - boxMin;
+		const vec3 x = vec3(e.x, 0, 0), y = vec3(0, e.y, 0), z = vec3(0, 0, e.z);
+
+		AddQuad(outTriangles, boxMin, z, x, materialIndex);
+		AddQuad(outTriangles, boxMin + y, x, z, materialIndex);
+		AddQuad(outTriangles, boxMin, x, y, materialIndex);
+		AddQuad(outTriangles, boxMin + z, y, x, materialIndex);
+		AddQuad(outTriangles, boxMin, y, z, materialIndex);
+		AddQuad(outTriangles, boxMin + x, z, y, materialIndex);
+	}
+}
+
+void Sailor::Raytracing::RunLightSamplingBenchmark()
+{
+	printf("\nStarting light sampling benchmark...\n");
+
+	const uint32_t NumLightsPerRow = 24;
+	const uint32_t NumEmissiveMaterials = 8;
+	const uint32_t Width = 160;
+	const uint32_t Height = 120;
+	const uint32_t ReferencePasses = 256;
+	const uint32_t MaxPasses = 32;
+
+	std::mt19937 gen(1234);
+	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+
+	PathTracer pathTracer;
+
+	// The rough floor, the boxes and the grid of the small ceiling lights of the different power
+	Material diffuse{};
+	diffuse.m_baseColorFactor = vec4(0.8f, 0.8f, 0.8f, 1.0f);
+	diffuse.m_metallicFactor = 0.0f;
+	diffuse.m_roughnessFactor = 0.7f;
+	pathTracer.m_materials.Add(diffuse);
+
+	for (uint32_t i = 0; i < NumEmissiveMaterials; i++)
+	{
+		Material emissive = diffuse;
+		emissive.m_emissiveFactor = vec3(dist(gen), dist(gen), dist(gen)) * (i == 0 ? 400.0f : 20.0f);
+		pathTracer.m_materials.Add(emissive);
+	}
+
+	AddQuad(pathTracer.m_triangles, vec3(-12, 0, -12), vec3(0, 0, 24), vec3(24, 0, 0), 0);
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		const vec3 boxMin = vec3(dist(gen) * 16.0f - 8.0f, 0.0f, dist(gen) * 16.0f - 8.0f);
+		AddBox(pathTracer.m_triangles, boxMin, boxMin + vec3(1.0f, 0.5f + dist(gen) * 2.0f, 1.0f), 0);
+	}
+
+	for (uint32_t i = 0; i < NumLightsPerRow * NumLightsPerRow; i++)
+	{
+		const vec3 corner = vec3((i % NumLightsPerRow) - NumLightsPerRow * 0.5f, 4.0f, (i / NumLightsPerRow) - NumLightsPerRow * 0.5f);
+		const u8 materialIndex = (u8)(1 + (i * 7) % NumEmissiveMaterials);
+		AddQuad(pathTracer.m_triangles, corner, vec3(0.2f, 0, 0), vec3(0, 0, 0.2f), materialIndex);
+	}
+
+	DirectionalLight moon{};
+	moon.m_direction = normalize(vec3(0.3f, -1.0f, 0.2f));
+	moon.m_intensity = vec3(0.05f, 0.05f, 0.08f);
+	pathTracer.m_directionalLights.Add(moon);
+
+	pathTracer.BuildLightBVH();
+
+	BVH bvh((uint32_t)pathTracer.m_triangles.Num());
+	bvh.BuildBVH(pathTracer.m_triangles);
+
+	const vec3 cameraPos = vec3(0.0f, 6.0f, 14.0f);
+	const vec3 cameraForward = normalize(vec3(0.0f, 1.0f, 0.0f) - cameraPos);
+	const vec3 u = normalize(cross(vec3(0, 1, 0), -cameraForward));
+	const vec3 v = cross(-cameraForward, u);
+	const float viewportHeight = 2.0f * tan(glm::radians(25.0f));
+	const vec3 viewportU = viewportHeight * Width / (float)Height * u;
+	const vec3 viewportV = viewportHeight * v;
+	const vec3 pixelDeltaU = viewportU / (float)Width;
+	const vec3 pixelDeltaV = viewportV / (float)Height;
+	const vec3 pixel00Dir = cameraForward - (viewportU + viewportV) * 0.5f + 0.5f * (pixelDeltaU + pixelDeltaV);
+
+	pathTracer.m_pixelSpreadAngle = atan(length(pixelDeltaV));
+
+	PathTracer::Params params{};
+	params.m_height = Height;
+	params.m_numSamples = 1;
+	params.m_numAmbientSamples = 1;
+	params.m_maxBounces = 2;
+	params.m_msaa = 1;
+	// The material samples are traced with the ambient only
+	params.m_ambient = vec3(0.01f);
+
+	// One sample per pixel is added by the pass
+	auto renderPass = [&](const PathTracer::Params& passParams, TVector<vec3>& accumulation)
+		{
+			Tasks::ParallelFor("Light sampling benchmark", 0, Height, 1,
+				[&](size_t y)
+				{
+					for (uint32_t x = 0; x < Width; x++)
+					{
+						const vec2 offset = glm::linearRand(vec2(-0.5f), vec2(0.5f));
+						const vec3 pixelDir = pixel00Dir + ((float)x + offset.x) * pixelDeltaU + ((float)y + offset.y) * pixelDeltaV;
+						const Ray ray(cameraPos, normalize(pixelDir));
+
+						RaycastHit hit{};
+						bvh.IntersectBVH(ray, hit, 0);
+
+						accumulation[y * Width + x] += pathTracer.Shade(ray, hit, bvh, passParams.m_maxBounces, passParams, 1.0f, 1.0f);
+					}
+				});
+		};
+
+	TVector<vec3> reference(Width * Height);
+	for (uint32_t pass = 0; pass < ReferencePasses; pass++)
+	{
+		renderPass(params, reference);
+	}
+
+	for (auto& pixel : reference)
+	{
+		pixel /= (float)ReferencePasses;
+	}
+
+	SAILOR_LOG("\nLight sampling, %llu emissive triangles, %ux%u, reference %u spp", pathTracer.m_lightBvh.GetNumEmissiveTriangles(), Width, Height, ReferencePasses);
+	SAILOR_LOG("%-36s %6s %10s %12s", "Method", "spp", "time (ms)", "RMSE");
+
+	for (uint32_t numLightSamples : { 0u, 1u, 4u })
+	{
+		PathTracer::Params methodParams = params;
+		methodParams.m_numLightSamples = numLightSamples;
+
+		const std::string name = numLightSamples == 0 ? "Loop over directional lights" :
+			("Light BVH, " + std::to_string(numLightSamples) + " shadow ray(s)");
+
+		TVector<vec3> accumulation(Width * Height);
+		Timer timer;
+
+		for (uint32_t pass = 1; pass <= MaxPasses; pass++)
+		{
+			timer.Start();
+			renderPass(methodParams, accumulation);
+			timer.Stop();
+
+			if ((pass & (pass - 1)) != 0)
+			{
+				continue;
+			}
+
+			double error = 0.0;
+			for (uint32_t i = 0; i < Width * Height; i++)
+			{
+				const vec3 diff = accumulation[i] / (float)pass - reference[i];
+				error += dot(diff, diff) / 3.0;
+			}
+
+			SAILOR_LOG("%-36s %6u %10.2f %12.5f", name.c_str(), pass, (float)timer.ResultAccumulatedMs(), sqrt(error / (Width * Height)));
+		}
+	}
+
+	printf("\n\n");
+}
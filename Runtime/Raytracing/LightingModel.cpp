@@ -385,6 +385,29 @@ bool LightingModel::Sample(const SampledData& sample, const vec3& worldNormal, c
 	return false;
 }
 
+float LightingModel::Pdf(const SampledData& sample, const vec3& worldNormal, const vec3& viewDirection, const vec3& direction)
+{
+	const bool bFullMetallic = sample.m_orm.z == 1.0f;
+	const bool bMirror = bFullMetallic && sample.m_orm.y <= 0.001f;
+	const bool bHasTransmission = !bFullMetallic && sample.m_transmission > 0.0f;
+
+	const vec3 H = normalize(viewDirection + direction);
+
+	const float pdfSpec = sample.m_orm.y < 0.2f ?
+		LightingModel::Beckmann_PDF(worldNormal, H, viewDirection, sample.m_orm.y) :
+		LightingModel::GGX_PDF(worldNormal, H, viewDirection, sample.m_orm.y);
+
+	const float pdfLambert = abs(dot(direction, worldNormal)) / Math::Pi;
+	float pdf = bMirror ? pdfSpec : ((pdfSpec + pdfLambert) * 0.5f);
+
+	if (bHasTransmission)
+	{
+		pdf *= 0.5f;
+	}
+
+	return isnan(pdf) ? 0.0f : pdf;
+}
+
 float LightingModel::IsotropicPhaseFunctionPDF()
 {
 	return 1.0f / (4.0f * Math::Pi);
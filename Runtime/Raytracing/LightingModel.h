@@ -32,6 +32,9 @@ namespace Sailor::Raytracing
 		static bool Sample(const SampledData& sample, const vec3& worldNormal, const vec3& viewDirection,
 			float fromIor, float toIor, vec3& outTerm, float& outPdf, bool& bOutTransmissionRay, vec3& inOutDirection, vec2 randomSample);
 
+		// The pdf of Sample to reflect the view direction into the direction, weights the light samples against the material samples
+		static float Pdf(const SampledData& sample, const vec3& worldNormal, const vec3& viewDirection, const vec3& direction);
+
 		static vec3 CalculateBRDF(const vec3& viewDirection, const vec3& worldNormal, const vec3& lightDirection, const SampledData& sample);
 		static vec3 CalculateBTDF(const vec3& viewDirection, const vec3& worldNormal, const vec3& lightDirection, const SampledData& sample);
 		static vec3 CalculateVolumetricBTDF(const vec3& viewDirection, const vec3& worldNormal, const vec3& lightDirection, const SampledData& sample, float envIor);
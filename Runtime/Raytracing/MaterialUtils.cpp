@@ -11,10 +11,155 @@
 
 #include "nlohmann_json/include/nlohmann/json.hpp"
 
+#include <array>
+
 using namespace Sailor;
 using namespace Sailor::Math;
 using namespace Sailor::Raytracing;
 
+size_t CombinedSampler2D::UpdateMipLayout()
+{
+	m_mips.Clear();
+
+	size_t offset = 0;
+	int32_t width = m_width;
+	int32_t height = m_height;
+
+	while (width > 0 && height > 0)
+	{
+		MipLevel mip{};
+		mip.m_offset = offset;
+		mip.m_width = width;
+		mip.m_height = height;
+		mip.m_tilesPerRow = (width + TileSize - 1) / TileSize;
+
+		const size_t numTiles = (size_t)mip.m_tilesPerRow * ((height + TileSize - 1) / TileSize);
+		offset += numTiles * TileSize * TileSize * GetTexelSize();
+
+		m_mips.Add(mip);
+
+		if (width == 1 && height == 1)
+		{
+			break;
+		}
+
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+
+	m_lodBias = m_mips.Num() > 0 ? 0.5f * std::log2((float)m_width * (float)m_height) : 0.0f;
+
+	return offset;
+}
+
+void CombinedSampler2D::BuildMips(const vec4* level0, const u8vec4* source)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	m_data.Clear();
+	if (m_width <= 0 || m_height <= 0 || (!level0 && !source))
+	{
+		m_mips.Clear();
+		return;
+	}
+
+	m_data.AddDefault(UpdateMipLayout());
+
+	TVector<vec4> current(m_width * m_height);
+	for (int32_t y = 0; y < m_height; y++)
+	{
+		for (int32_t x = 0; x < m_width; x++)
+		{
+			const int32_t i = x + y * m_width;
+			u8* texel = m_data.GetData() + GetTexelOffset(m_mips[0], x, y);
+
+			if (source)
+			{
+				// The most detailed mip keeps the source texels untouched
+				memcpy(texel, &source[i], sizeof(u8vec4));
+				current[i] = DecodeTexel(texel);
+			}
+			else
+			{
+				current[i] = level0[i];
+				EncodeTexel(current[i], texel);
+			}
+		}
+	}
+
+	// The box filter in the linear space
+	TVector<vec4> next;
+	for (uint32_t level = 1; level < m_mips.Num(); level++)
+	{
+		const MipLevel& src = m_mips[level - 1];
+		const MipLevel& dst = m_mips[level];
+
+		next.Clear(false);
+		next.Resize(dst.m_width * dst.m_height);
+
+		for (int32_t y = 0; y < dst.m_height; y++)
+		{
+			const int32_t y0 = std::min(y * 2, src.m_height - 1);
+			const int32_t y1 = std::min(y * 2 + 1, src.m_height - 1);
+
+			for (int32_t x = 0; x < dst.m_width; x++)
+			{
+				const int32_t x0 = std::min(x * 2, src.m_width - 1);
+				const int32_t x1 = std::min(x * 2 + 1, src.m_width - 1);
+
+				const vec4 value = 0.25f * (current[x0 + y0 * src.m_width] + current[x1 + y0 * src.m_width] +
+					current[x0 + y1 * src.m_width] + current[x1 + y1 * src.m_width]);
+
+				next[x + y * dst.m_width] = value;
+				EncodeTexel(value, m_data.GetData() + GetTexelOffset(dst, x, y));
+			}
+		}
+
+		std::swap(current, next);
+	}
+}
+
+void CombinedSampler2D::EncodeTexel(const vec4& value, u8* outTexel) const
+{
+	switch (m_format)
+	{
+	case TextureFormat::RGBA8:
+		*(u8vec4*)outTexel = u8vec4(glm::round(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
+		break;
+
+	case TextureFormat::RGBA8_SRGB:
+	{
+		const vec3 srgb = Utils::LinearToSRGB(glm::clamp(vec3(value), 0.0f, 1.0f));
+		*(u8vec4*)outTexel = u8vec4(glm::round(glm::clamp(vec4(srgb, value.a), 0.0f, 1.0f) * 255.0f));
+		break;
+	}
+
+	case TextureFormat::RGBA8_SNORM:
+		*(u8vec4*)outTexel = u8vec4(glm::round((glm::clamp(value, -1.0f, 1.0f) + 1.0f) * 127.5f));
+		break;
+
+	case TextureFormat::Float:
+	default:
+		memcpy(outTexel, &value, m_channels * sizeof(float));
+		break;
+	}
+}
+
+const float* CombinedSampler2D::GetSRGBToLinearTable()
+{
+	static const std::array<float, 256> table = []()
+		{
+			std::array<float, 256> res{};
+			for (uint32_t i = 0; i < res.size(); i++)
+			{
+				res[i] = Utils::SRGBToLinear(vec3(i * (1.0f / 255.0f))).x;
+			}
+			return res;
+		}();
+
+	return table.data();
+}
+
 uint Raytracing::PackVec3ToByte(vec3 v)
 {
 	vec3 clamped = clamp(v, 0.0f, 1.0f);
@@ -21,15 +21,54 @@ namespace Sailor::Raytracing
 		Repeat
 	};
 
+	enum class TextureFormat : uint8_t
+	{
+		// vec3 or vec4 by the channels, the render targets and the HDR textures
+		Float = 0,
+
+		// The source 8-bit texels, decoded on sample
+		RGBA8,
+		RGBA8_SRGB,
+		RGBA8_SNORM // Normal maps
+	};
+
 	struct CombinedSampler2D
 	{
+		// The mipmapped textures are stored level by level, each level is split into 8x8 tiles
+		// and the texels of the tile are in the Morton order, so the bilinear footprint rarely leaves the tile.
+		static constexpr int32_t TileSize = 8;
+
+		struct MipLevel
+		{
+			size_t m_offset = 0;
+			int32_t m_width = 0;
+			int32_t m_height = 0;
+			int32_t m_tilesPerRow = 0;
+		};
+
 		uint8_t m_channels = 3;
 		SamplerClamping m_clamping = SamplerClamping::Clamp;
+		TextureFormat m_format = TextureFormat::Float;
 
 		int32_t m_width{};
 		int32_t m_height{};
 		TVector<u8> m_data;
 
+		// Empty for the row-major render targets
+		TVector<MipLevel> m_mips;
+		float m_lodBias = 0.0f;
+
+		// Points into the mapped scene cache, m_data is empty in that case
+		const u8* m_pMappedData = nullptr;
+
+		__forceinline const u8* GetData() const { return m_pMappedData ? m_pMappedData : m_data.GetData(); }
+		__forceinline bool IsMipmapped() const { return m_mips.Num() > 0; }
+		__forceinline uint32_t GetTexelSize() const { return m_format == TextureFormat::Float ? m_channels * (uint32_t)sizeof(float) : (uint32_t)sizeof(u8vec4); }
+
+		// Calculates the offsets of the mips by the size and the format, returns the size of the data
+		size_t UpdateMipLayout();
+
+		// Row-major render target
 		template<typename TOutputData>
 		void Initialize(uint32_t width, uint32_t height, uint8_t channels = 3, SamplerClamping clamping = SamplerClamping::Clamp)
 		{
@@ -38,30 +77,51 @@ namespace Sailor::Raytracing
 			m_data.Resize(width * height * sizeof(TOutputData));
 			m_channels = channels;
 			m_clamping = clamping;
+			m_format = TextureFormat::Float;
+			m_mips.Clear();
 		}
 
+		// Mipmapped texture, the 8-bit data is kept in 8 bits and the HDR data is stored as TOutputData
 		template<typename TOutputData, typename TInputData>
 		void Initialize(TInputData* data, bool bConvertToLinear, bool bNormalMap = false)
 		{
 			SAILOR_PROFILE_FUNCTION();
 
-			m_data.Resize(m_width * m_height * sizeof(TOutputData));
-
-			for (uint32_t i = 0; i < (uint32_t)m_width * m_height; i++)
+			if constexpr (IsSame<u8vec4, TInputData>)
+			{
+				m_format = bNormalMap ? TextureFormat::RGBA8_SNORM : (bConvertToLinear ? TextureFormat::RGBA8_SRGB : TextureFormat::RGBA8);
+				BuildMips(nullptr, data);
+			}
+			else
 			{
-				TOutputData* dst = (TOutputData*)(m_data.GetData() + sizeof(TOutputData) * i);
-				TInputData* src = data + i;
+				m_format = TextureFormat::Float;
 
-				if (bNormalMap)
-				{
-					*dst = (TOutputData(*src) * (1.0f / 127.5f)) - 1.0f;
-				}
-				else
+				TVector<vec4> texels(m_width * m_height);
+				for (uint32_t i = 0; i < (uint32_t)m_width * m_height; i++)
 				{
-					*dst = bConvertToLinear ?
-						(TOutputData)Utils::SRGBToLinear(TOutputData(*src) * (1.0f / 255.0f)) :
-						(TOutputData(*src) * (1.0f / 255.0f));
+					const TOutputData src = TOutputData(data[i]);
+					TOutputData dst{};
+
+					if (bNormalMap)
+					{
+						dst = (src * (1.0f / 127.5f)) - 1.0f;
+					}
+					else
+					{
+						dst = bConvertToLinear ? (TOutputData)Utils::SRGBToLinear(src * (1.0f / 255.0f)) : (src * (1.0f / 255.0f));
+					}
+
+					if constexpr (IsSame<vec3, TOutputData>)
+					{
+						texels[i] = vec4(dst, 1.0f);
+					}
+					else
+					{
+						texels[i] = dst;
+					}
 				}
+
+				BuildMips(texels.GetData(), nullptr);
 			}
 		}
 
@@ -73,26 +133,178 @@ namespace Sailor::Raytracing
 			ptr[x + y * m_width] = value;
 		}
 
+		// Samples the most detailed mip
 		template<typename T>
 		const T Sample(const vec2& uv) const
+		{
+			return Sample<T>(uv, -std::numeric_limits<float>::infinity());
+		}
+
+		// footprintLog2 is log2 of the width of the ray footprint in the uv space,
+		// the mips are blended by the footprint in texels
+		template<typename T>
+		const T Sample(const vec2& uv, float footprintLog2) const
 		{
 			SAILOR_PROFILE_FUNCTION();
 
-			vec2 wrappedUV{};
+			const vec2 wrappedUV = WrapUV(uv);
 
-			switch (m_clamping)
+			if (!IsMipmapped())
 			{
-			case SamplerClamping::Clamp:
-				wrappedUV.x = std::clamp(uv.x, 0.0f, 1.0f);
-				wrappedUV.y = std::clamp(uv.y, 0.0f, 1.0f);
+				return SampleRowMajor<T>(wrappedUV);
+			}
+
+			const float lod = std::clamp(footprintLog2 + m_lodBias, 0.0f, (float)(m_mips.Num() - 1));
+			const uint32_t level = (uint32_t)lod;
+			const float fracLod = lod - level;
+
+			vec4 res{};
+			switch (m_format)
+			{
+			case TextureFormat::RGBA8:
+				res = SampleTrilinear<TextureFormat::RGBA8>(level, fracLod, wrappedUV);
+				break;
+			case TextureFormat::RGBA8_SRGB:
+				res = SampleTrilinear<TextureFormat::RGBA8_SRGB>(level, fracLod, wrappedUV);
+				break;
+			case TextureFormat::RGBA8_SNORM:
+				res = SampleTrilinear<TextureFormat::RGBA8_SNORM>(level, fracLod, wrappedUV);
 				break;
+			case TextureFormat::Float:
+			default:
+				res = SampleTrilinear<TextureFormat::Float>(level, fracLod, wrappedUV);
+				break;
+			}
+
+			if constexpr (IsSame<vec3, T>)
+			{
+				return vec3(res);
+			}
+			else
+			{
+				return res;
+			}
+		}
 
+		CombinedSampler2D() = default;
+		CombinedSampler2D(CombinedSampler2D&) = delete;
+		CombinedSampler2D& operator=(CombinedSampler2D&) = delete;
+
+	protected:
+
+		// level0 is the decoded texels, source is the 8-bit data that is copied as is into the most detailed mip
+		void BuildMips(const vec4* level0, const u8vec4* source);
+
+		void EncodeTexel(const vec4& value, u8* outTexel) const;
+		static const float* GetSRGBToLinearTable();
+
+		__forceinline vec2 WrapUV(const vec2& uv) const
+		{
+			switch (m_clamping)
+			{
 			case SamplerClamping::Repeat:
-				wrappedUV.x = uv.x - std::floor(uv.x);
-				wrappedUV.y = uv.y - std::floor(uv.y);
-				break;
+				return uv - glm::floor(uv);
+
+			case SamplerClamping::Clamp:
+			default:
+				return glm::clamp(uv, 0.0f, 1.0f);
+			}
+		}
+
+		__forceinline size_t GetTexelOffset(const MipLevel& mip, uint32_t x, uint32_t y) const
+		{
+			// The bits of 0..7 spread to the even bits
+			static constexpr uint8_t Morton[TileSize] = { 0, 1, 4, 5, 16, 17, 20, 21 };
+
+			const size_t tile = (size_t)(y / TileSize) * mip.m_tilesPerRow + (x / TileSize);
+			const uint32_t texel = Morton[x % TileSize] | (Morton[y % TileSize] << 1);
+
+			return mip.m_offset + (tile * TileSize * TileSize + texel) * GetTexelSize();
+		}
+
+		template<TextureFormat Format>
+		__forceinline vec4 DecodeTexel(const u8* texel, const float* srgbTable) const
+		{
+			if constexpr (Format == TextureFormat::RGBA8)
+			{
+				return vec4(*(const u8vec4*)texel) * (1.0f / 255.0f);
+			}
+			else if constexpr (Format == TextureFormat::RGBA8_SRGB)
+			{
+				return vec4(srgbTable[texel[0]], srgbTable[texel[1]], srgbTable[texel[2]], texel[3] * (1.0f / 255.0f));
+			}
+			else if constexpr (Format == TextureFormat::RGBA8_SNORM)
+			{
+				return vec4(*(const u8vec4*)texel) * (1.0f / 127.5f) - 1.0f;
+			}
+			else
+			{
+				return m_channels == 4 ? *(const vec4*)texel : vec4(*(const vec3*)texel, 1.0f);
+			}
+		}
+
+		__forceinline vec4 DecodeTexel(const u8* texel) const
+		{
+			const float* srgbTable = GetSRGBToLinearTable();
+
+			switch (m_format)
+			{
+			case TextureFormat::RGBA8:
+				return DecodeTexel<TextureFormat::RGBA8>(texel, srgbTable);
+			case TextureFormat::RGBA8_SRGB:
+				return DecodeTexel<TextureFormat::RGBA8_SRGB>(texel, srgbTable);
+			case TextureFormat::RGBA8_SNORM:
+				return DecodeTexel<TextureFormat::RGBA8_SNORM>(texel, srgbTable);
+			case TextureFormat::Float:
+			default:
+				return DecodeTexel<TextureFormat::Float>(texel, srgbTable);
+			}
+		}
+
+		template<TextureFormat Format>
+		__forceinline vec4 SampleLevel(const MipLevel& mip, const vec2& uv, const float* srgbTable) const
+		{
+			const float fx = uv.x * (mip.m_width - 1);
+			const float fy = uv.y * (mip.m_height - 1);
+
+			const uint32_t tX0 = static_cast<uint32_t>(fx);
+			const uint32_t tY0 = static_cast<uint32_t>(fy);
+			const uint32_t tX1 = std::min(tX0 + 1, (uint32_t)mip.m_width - 1);
+			const uint32_t tY1 = std::min(tY0 + 1, (uint32_t)mip.m_height - 1);
+
+			const float fracX = fx - tX0;
+			const float fracY = fy - tY0;
+
+			const u8* data = GetData();
+
+			const vec4 topLeft = DecodeTexel<Format>(data + GetTexelOffset(mip, tX0, tY0), srgbTable);
+			const vec4 topRight = DecodeTexel<Format>(data + GetTexelOffset(mip, tX1, tY0), srgbTable);
+			const vec4 bottomLeft = DecodeTexel<Format>(data + GetTexelOffset(mip, tX0, tY1), srgbTable);
+			const vec4 bottomRight = DecodeTexel<Format>(data + GetTexelOffset(mip, tX1, tY1), srgbTable);
+
+			const vec4 topMix = topLeft + fracX * (topRight - topLeft);
+			const vec4 bottomMix = bottomLeft + fracX * (bottomRight - bottomLeft);
+
+			return topMix + fracY * (bottomMix - topMix);
+		}
+
+		template<TextureFormat Format>
+		__forceinline vec4 SampleTrilinear(uint32_t level, float fracLod, const vec2& uv) const
+		{
+			const float* srgbTable = Format == TextureFormat::RGBA8_SRGB ? GetSRGBToLinearTable() : nullptr;
+
+			const vec4 res = SampleLevel<Format>(m_mips[level], uv, srgbTable);
+			if (fracLod > 0.0f)
+			{
+				return glm::mix(res, SampleLevel<Format>(m_mips[level + 1], uv, srgbTable), fracLod);
 			}
 
+			return res;
+		}
+
+		template<typename T>
+		__forceinline T SampleRowMajor(const vec2& wrappedUV) const
+		{
 			// Convert UV to pixel space once, and compute the required values.
 			const float fx = wrappedUV.x * (m_width - 1);
 			const float fy = wrappedUV.y * (m_height - 1);
@@ -106,15 +318,15 @@ namespace Sailor::Raytracing
 			const float fracX = fx - tX0;
 			const float fracY = fy - tY0;
 
-			T* topLeft;
-			T* topRight;
-			T* bottomLeft;
-			T* bottomRight;
+			const T* topLeft;
+			const T* topRight;
+			const T* bottomLeft;
+			const T* bottomRight;
 
-			topLeft = (T*)m_data.GetData() + tX0 + tY0 * m_width;
-			topRight = (T*)m_data.GetData() + tX1 + tY0 * m_width;
-			bottomLeft = (T*)m_data.GetData() + tX0 + tY1 * m_width;
-			bottomRight = (T*)m_data.GetData() + tX1 + tY1 * m_width;
+			topLeft = (const T*)GetData() + tX0 + tY0 * m_width;
+			topRight = (const T*)GetData() + tX1 + tY0 * m_width;
+			bottomLeft = (const T*)GetData() + tX0 + tY1 * m_width;
+			bottomRight = (const T*)GetData() + tX1 + tY1 * m_width;
 
 			// Bilinear interpolation using direct memory access
 			const T topMix = *topLeft + fracX * (*topRight - *topLeft);
@@ -123,10 +335,6 @@ namespace Sailor::Raytracing
 
 			return finalSample;
 		}
-
-		CombinedSampler2D() = default;
-		CombinedSampler2D(CombinedSampler2D&) = delete;
-		CombinedSampler2D& operator=(CombinedSampler2D&) = delete;
 	};
 
 	enum BlendMode : uint8_t
@@ -1,5 +1,6 @@
 ﻿#include "PathTracer.h"
 #include "Tasks/Scheduler.h"
+#include "Tasks/ParallelFor.h"
 #include "Core/LogMacros.h"
 #include "Core/Utils.h"
 #include "glm/glm/glm.hpp"
@@ -26,6 +27,68 @@ using namespace Sailor;
 using namespace Sailor::Math;
 using namespace Sailor::Raytracing;
 
+namespace
+{
+	// The rays traced by the current thread, to compare the integrators
+	thread_local uint64_t t_numTracedRays = 0;
+
+	__forceinline uint32_t ExpandBits(uint32_t v)
+	{
+		v = (v * 0x00010001u) & 0xFF0000FFu;
+		v = (v * 0x00000101u) & 0x0F00F00Fu;
+		v = (v * 0x00000011u) & 0xC30C30C3u;
+		v = (v * 0x00000005u) & 0x49249249u;
+		return v;
+	}
+
+	// The direction octant in the high 3 bits and the Morton code of the origin in the low 29 bits
+	__forceinline uint32_t CalculateRayKey(const Ray& ray, const vec3& boundsMin, const vec3& invBoundsExtent)
+	{
+		const vec3& direction = ray.GetDirection();
+		const uint32_t octant = (direction.x < 0.0f ? 1u : 0u) | (direction.y < 0.0f ? 2u : 0u) | (direction.z < 0.0f ? 4u : 0u);
+
+		const vec3 p = glm::clamp((ray.GetOrigin() - boundsMin) * invBoundsExtent, 0.0f, 1.0f) * 1023.0f;
+		const uint32_t morton = (ExpandBits((uint32_t)p.x) << 2) | (ExpandBits((uint32_t)p.y) << 1) | ExpandBits((uint32_t)p.z);
+
+		return (octant << 29) | (morton >> 1);
+	}
+
+	// LSD radix sort of the (key << 32 | value) pairs by the key
+	void RadixSortByKey(TVector<uint64_t>& pairs, TVector<uint64_t>& temp)
+	{
+		SAILOR_PROFILE_FUNCTION();
+
+		temp.Resize(pairs.Num());
+
+		uint64_t* src = pairs.GetData();
+		uint64_t* dst = temp.GetData();
+
+		for (uint32_t shift = 32; shift < 64; shift += 8)
+		{
+			size_t offsets[256]{};
+			for (size_t i = 0; i < pairs.Num(); i++)
+			{
+				offsets[(src[i] >> shift) & 0xFF]++;
+			}
+
+			size_t sum = 0;
+			for (auto& offset : offsets)
+			{
+				const size_t count = offset;
+				offset = sum;
+				sum += count;
+			}
+
+			for (size_t i = 0; i < pairs.Num(); i++)
+			{
+				dst[offsets[(src[i] >> shift) & 0xFF]++] = src[i];
+			}
+
+			std::swap(src, dst);
+		}
+	}
+}
+
 void PathTracer::ParseCommandLineArgs(PathTracer::Params& res, const char** args, int32_t num)
 {
 	for (int32_t i = 1; i < num; i++)
@@ -55,6 +118,47 @@ void PathTracer::ParseCommandLineArgs(PathTracer::Params& res, const char** args
 		{
 			res.m_maxBounces = atoi(Utils::GetArgValue(args, i, num).c_str());
 		}
+		else if (arg == "--progressive")
+		{
+			res.m_bProgressive = true;
+		}
+		else if (arg == "--max-samples")
+		{
+			res.m_maxSamples = atoi(Utils::GetArgValue(args, i, num).c_str());
+		}
+		else if (arg == "--time-budget")
+		{
+			res.m_timeBudget = (float)atof(Utils::GetArgValue(args, i, num).c_str());
+		}
+		else if (arg == "--variance")
+		{
+			res.m_varianceThreshold = (float)atof(Utils::GetArgValue(args, i, num).c_str());
+		}
+		else if (arg == "--checkpoint")
+		{
+			res.m_checkpointInterval = (float)atof(Utils::GetArgValue(args, i, num).c_str());
+		}
+		else if (arg == "--bvh-width")
+		{
+			const uint32_t width = atoi(Utils::GetArgValue(args, i, num).c_str());
+			res.m_bvhWidth = (width == 4 || width == 8) ? width : 2u;
+		}
+		else if (arg == "--wavefront")
+		{
+			res.m_bWavefront = true;
+		}
+		else if (arg == "--scene-cache")
+		{
+			res.m_bUseSceneCache = true;
+		}
+		else if (arg == "--light-samples")
+		{
+			res.m_numLightSamples = atoi(Utils::GetArgValue(args, i, num).c_str());
+		}
+		else if (arg == "--denoise")
+		{
+			res.m_bDenoise = true;
+		}
 		else if (arg == "--camera")
 		{
 			res.m_camera = Utils::GetArgValue(args, i, num);
@@ -82,6 +186,291 @@ void PathTracer::Run(const PathTracer::Params& params)
 
 	const uint32_t GroupSize = 32;
 
+	TVector<Camera> cameras;
+	BVH bvh;
+
+	if (!params.m_bUseSceneCache || !LoadSceneCache(params, cameras, bvh))
+	{
+		TVector<std::filesystem::path> dependencies;
+		if (!ImportScene(params, cameras, dependencies))
+		{
+			return;
+		}
+
+		bvh.BuildBVH(m_triangles);
+
+		if (params.m_bUseSceneCache)
+		{
+			SaveSceneCache(params, cameras, bvh, dependencies);
+		}
+	}
+
+	BuildLightBVH();
+
+	SAILOR_LOG("PathTracer scene is ready in sec: %.2f", (float)raytracingTimer.ResultMs() * 0.001f);
+
+	bvh.CollapseBVH(params.m_bvhWidth);
+
+	// Camera
+	auto cameraPos = vec3(0, 0.75f, 5.0f);
+	//auto cameraPos = vec3(-1.0f, 0.7f, -1.0f) * 0.5f;
+	//auto cameraPos = glm::vec3(-2.8f, 2.7f, 5.5f) * 100.0f;
+
+	auto cameraUp = normalize(vec3(0, 1, 0));
+	auto cameraForward = normalize(-cameraPos);
+	//auto cameraForward = glm::normalize(glm::vec3(0.0f, -0.0f, -1.0f));
+
+	auto axis = normalize(cross(cameraForward, cameraUp));
+	cameraUp = normalize(cross(axis, cameraForward));
+
+	float aspectRatio = 4.0f / 3.0f;
+	float hFov = glm::radians(60.0f);
+
+	// View
+	if (cameras.Num() > 0)
+	{
+		uint32_t cameraIndex = 0;
+		for (uint32_t i = 0; i < cameras.Num(); i++)
+		{
+			if (std::strcmp(params.m_camera.c_str(), cameras[i].m_name) == 0)
+			{
+				cameraIndex = i;
+				break;
+			}
+		}
+
+		const Camera& camera = cameras[cameraIndex];
+
+		cameraPos = camera.m_position;
+		cameraUp = camera.m_up;
+		cameraForward = camera.m_forward;
+		aspectRatio = camera.m_aspectRatio > 0.0f ? camera.m_aspectRatio : aspectRatio;
+		hFov = camera.m_hFov > 0.0f ? camera.m_hFov : hFov;
+	}
+
+	const uint32_t height = params.m_height;
+	const uint32_t width = static_cast<uint32_t>(height * aspectRatio);
+
+	const float vFov = 2.0f * atan(tan(hFov * 0.5f) * (1.0f / aspectRatio));
+
+	SAILOR_PROFILE_BLOCK("Viewport Calcs");
+
+	CombinedSampler2D outputTex;
+	outputTex.Initialize<vec3>(width, height);
+
+	float h = tan(vFov / 2);
+	const float ViewportHeight = 2.0f * h;
+	const float ViewportWidth = aspectRatio * ViewportHeight;
+
+	vec3 _u = normalize(cross(cameraUp, -cameraForward));
+	vec3 _v = cross(-cameraForward, _u);
+
+	const vec3 ViewportU = ViewportWidth * _u;
+	const vec3 ViewportV = ViewportHeight * _v;
+	const vec3 ViewportPivot = cameraPos - (ViewportU + ViewportV) * 0.5f + cameraForward;
+
+	const vec3 _pixelDeltaU = ViewportU / (float)width;
+	const vec3 _pixelDeltaV = ViewportV / (float)height;
+	const vec3 _pixel00Dir = ViewportPivot + 0.5f * (_pixelDeltaU + _pixelDeltaV) - cameraPos;
+
+	// The viewport is at the distance 1
+	m_pixelSpreadAngle = atan(length(_pixelDeltaV));
+
+	SAILOR_PROFILE_END_BLOCK();
+
+	Utils::Timer renderTimer;
+	renderTimer.Start();
+
+	std::atomic<uint64_t> numTracedRays = 0;
+
+	const Viewport viewport{ cameraPos, _pixel00Dir, _pixelDeltaU, _pixelDeltaV, width, height };
+
+	// The guide buffers are filled by the primary hits of the render, there is no separate pass
+	DenoiserAOVs aovs;
+	DenoiserAOVs* pAovs = nullptr;
+
+	if (params.m_bDenoise)
+	{
+		aovs.Initialize(width, height);
+		pAovs = &aovs;
+	}
+
+	// Raytracing
+	if (params.m_bProgressive)
+	{
+		RenderProgressive(params, bvh, viewport, outputTex, pAovs);
+	}
+	else if (params.m_bWavefront)
+	{
+		numTracedRays = RenderWavefront(params, bvh, viewport, outputTex, pAovs);
+	}
+	else
+	{
+		SAILOR_PROFILE_BLOCK("Calculate raytracing");
+
+		const uint32_t numTilesX = (width + GroupSize - 1) / GroupSize;
+		const uint32_t numTilesY = (height + GroupSize - 1) / GroupSize;
+		const uint32_t numTasks = numTilesX * numTilesY;
+
+		std::atomic<uint32_t> finishedTasks = 0;
+		float lastPrg = 0.0f;
+		float eta = 0.0f;
+
+		const auto callerThreadId = std::this_thread::get_id();
+
+		// The tiles are processed by the worker threads and the current thread
+		Tasks::ParallelFor("Calculate raytracing", 0, numTasks, 1,
+			[&](size_t tileIndex)
+			{
+				const uint32_t x = (uint32_t)(tileIndex % numTilesX) * GroupSize;
+				const uint32_t y = (uint32_t)(tileIndex / numTilesX) * GroupSize;
+
+				const uint64_t numTracedRaysBefore = t_numTracedRays;
+
+				// The primary rays of the row are coherent, so they are traced in the packets
+				TVector<Ray> primaryRays(GroupSize * params.m_msaa);
+				TVector<RaycastHit> primaryHits(GroupSize * params.m_msaa);
+
+				for (auto& ray : primaryRays)
+				{
+					ray.SetOrigin(cameraPos);
+				}
+
+#ifdef _DEBUG
+				uint32_t debugX = 975u;
+				uint32_t debugY = height - 355u - 1;
+
+				if (!(x < debugX && (x + GroupSize) > debugX &&
+					y < debugY && (y + GroupSize) > debugY))
+				{
+					finishedTasks++;
+					return;
+				}
+#endif
+				for (uint32_t v = 0; (v < GroupSize) && (y + v) < height; v++)
+				{
+					const uint32_t numPixels = std::min(GroupSize, width - x);
+					const uint32_t numRays = numPixels * params.m_msaa;
+
+					for (uint32_t u = 0; u < numPixels; u++)
+					{
+						for (uint32_t sample = 0; sample < params.m_msaa; sample++)
+						{
+							const vec2 offset = sample == 0 ? vec2(0.5f, 0.5f) : glm::linearRand(vec2(0, 0), vec2(1.0f, 1.0f));
+							const vec3 pixelDir = _pixel00Dir + ((float)(u + x) + offset.x) * _pixelDeltaU + ((float)(y + v) - offset.y) * _pixelDeltaV;
+
+							primaryRays[u * params.m_msaa + sample].SetDirection(glm::normalize(pixelDir));
+						}
+					}
+
+					{
+						SAILOR_PROFILE_BLOCK("Trace primary rays");
+
+						bvh.IntersectRays(&primaryRays[0], &primaryHits[0], numRays);
+
+						t_numTracedRays += numRays;
+
+						SAILOR_PROFILE_END_BLOCK();
+					}
+
+					for (uint32_t u = 0; u < numPixels; u++)
+					{
+						SAILOR_PROFILE_BLOCK("Raycasting");
+#ifdef _DEBUG
+						if (((x + u) == debugX) && ((y + v) == debugY))
+						{
+							volatile uint8_t a = 0;
+						}
+#endif
+						vec3 accumulator = vec3(0);
+						for (uint32_t sample = 0; sample < params.m_msaa; sample++)
+						{
+							const uint32_t rayIndex = u * params.m_msaa + sample;
+							accumulator += Shade(primaryRays[rayIndex], primaryHits[rayIndex], bvh, params.m_maxBounces, params, 1.0f, 1.0f);
+						}
+
+						vec3 res = accumulator / (float)params.m_msaa;
+						outputTex.SetPixel(x + u, height - (y + v) - 1, res);
+
+						if (pAovs)
+						{
+							const size_t pixel = (height - (y + v) - 1) * width + x + u;
+							WriteAOVs(&primaryRays[u * params.m_msaa], &primaryHits[u * params.m_msaa], params.m_msaa, pixel, *pAovs);
+						}
+
+						SAILOR_PROFILE_END_BLOCK();
+					}
+				}
+
+				numTracedRays += t_numTracedRays - numTracedRaysBefore;
+
+				const float progress = ++finishedTasks / (float)numTasks;
+
+				// Only the calling thread reports the progress
+				if (std::this_thread::get_id() == callerThreadId && progress - lastPrg > 0.05f)
+				{
+					if (eta == 0.0f)
+					{
+						eta = raytracingTimer.ResultAccumulatedMs() * 20.0f * 0.001f * 1.5f;
+						SAILOR_LOG("PathTracer ETA: ~%.2fsec (%.2fmin)", eta, round(eta / 60.0f));
+					}
+
+					SAILOR_LOG("PathTracer Progress: %.2f", progress);
+					lastPrg = progress;
+				}
+			});
+
+		SAILOR_PROFILE_END_BLOCK();
+	}
+
+	renderTimer.Stop();
+	raytracingTimer.Stop();
+	//profiler::dumpBlocksToFile("test_profile.prof");
+
+	if (numTracedRays > 0)
+	{
+		SAILOR_LOG("PathTracer %s: %llu rays in %.2fsec, %.2f Mrays/s", params.m_bWavefront ? "wavefront" : "recursive",
+			numTracedRays.load(), renderTimer.ResultMs() * 0.001f, numTracedRays.load() / (std::max<int64_t>(1, renderTimer.ResultMs()) * 1000.0));
+	}
+
+	if (params.m_bDenoise)
+	{
+		SAILOR_PROFILE_BLOCK("Denoise");
+
+		Utils::Timer denoiseTimer;
+		denoiseTimer.Start();
+
+		Denoise(outputTex, aovs);
+
+		denoiseTimer.Stop();
+		SAILOR_LOG("PathTracer denoised in sec: %.2f", (float)denoiseTimer.ResultMs() * 0.001f);
+
+		SAILOR_PROFILE_END_BLOCK();
+	}
+
+	WriteImage(params, outputTex);
+
+	// The progressive mode is used by the farm jobs, so nothing is shown
+	if (params.m_bProgressive)
+	{
+		SAILOR_LOG("PathTracer time in sec: %.2f", (float)raytracingTimer.ResultMs() * 0.001f);
+		return;
+	}
+
+	char msg[2048];
+	if (raytracingTimer.ResultMs() > 10000.0f)
+	{
+		sprintf_s(msg, "Time in sec: %.2f", (float)raytracingTimer.ResultMs() * 0.001f);
+		MessageBoxA(0, msg, msg, 0);
+	}
+
+	::system(params.m_output.string().c_str());
+}
+
+bool PathTracer::ImportScene(const PathTracer::Params& params, TVector<Camera>& outCameras, TVector<std::filesystem::path>& outDependencies)
+{
+	SAILOR_PROFILE_FUNCTION();
+
 	Assimp::Importer importer;
 
 	const unsigned int DefaultImportFlags_Assimp =
@@ -114,67 +503,31 @@ void PathTracer::Run(const PathTracer::Params& params)
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 	{
 		SAILOR_LOG("%s", importer.GetErrorString());
-		return;
+		return false;
 	}
 
 	ensure(scene->HasCameras(), "Scene %s has no Cameras!", params.m_pathToModel.string().c_str());
 
-	// Camera
-	auto cameraPos = vec3(0, 0.75f, 5.0f);
-	//auto cameraPos = vec3(-1.0f, 0.7f, -1.0f) * 0.5f;
-	//auto cameraPos = glm::vec3(-2.8f, 2.7f, 5.5f) * 100.0f;
-
-	auto cameraUp = normalize(vec3(0, 1, 0));
-	auto cameraForward = normalize(-cameraPos);
-	//auto cameraForward = glm::normalize(glm::vec3(0.0f, -0.0f, -1.0f));
-
-	auto axis = normalize(cross(cameraForward, cameraUp));
-	cameraUp = normalize(cross(axis, cameraForward));
-
-	// View
-	int32_t cameraIndex = 0;
-	if (scene->HasCameras())
+	for (uint32_t i = 0; i < scene->mNumCameras; i++)
 	{
-		for (uint32_t i = 0; i < scene->mNumCameras; i++)
-		{
-			if (std::strcmp(params.m_camera.c_str(), scene->mCameras[i]->mName.C_Str()) == 0)
-			{
-				cameraIndex = i;
-				break;
-			}
-		}
+		const auto& aiCamera = scene->mCameras[i];
 
-		const auto& aiCamera = scene->mCameras[cameraIndex];
+		Camera& camera = outCameras[outCameras.Emplace()];
+		strncpy_s(camera.m_name, aiCamera->mName.C_Str(), _TRUNCATE);
 
-		mat4 matrix = GetWorldTransformMatrix(scene, scene->mCameras[cameraIndex]->mName.C_Str());
-		::memcpy(&cameraUp, &aiCamera->mUp, sizeof(float) * 3);
-		::memcpy(&cameraForward, &aiCamera->mLookAt, sizeof(float) * 3);
-		::memcpy(&cameraPos, &aiCamera->mPosition, sizeof(float) * 3);
+		mat4 matrix = GetWorldTransformMatrix(scene, aiCamera->mName.C_Str());
+		::memcpy(&camera.m_up, &aiCamera->mUp, sizeof(float) * 3);
+		::memcpy(&camera.m_forward, &aiCamera->mLookAt, sizeof(float) * 3);
+		::memcpy(&camera.m_position, &aiCamera->mPosition, sizeof(float) * 3);
 
 		const vec4 translation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f) * matrix;
-		cameraPos = vec3(translation.xyz) / translation.w;
-		cameraUp = glm::normalize(glm::vec3(glm::vec4(cameraUp, 0.0f) * matrix));
-		cameraForward = glm::normalize(glm::vec3(glm::vec4(cameraForward, 0.0f) * matrix));
+		camera.m_position = vec3(translation.xyz) / translation.w;
+		camera.m_up = glm::normalize(glm::vec3(glm::vec4(camera.m_up, 0.0f) * matrix));
+		camera.m_forward = glm::normalize(glm::vec3(glm::vec4(camera.m_forward, 0.0f) * matrix));
+		camera.m_aspectRatio = aiCamera->mAspect;
+		camera.m_hFov = aiCamera->mHorizontalFOV;
 	}
 
-	const float aspectRatio = (scene->HasCameras() && scene->mCameras[cameraIndex]->mAspect > 0.0f)
-		? scene->mCameras[cameraIndex]->mAspect
-		: (4.0f / 3.0f);
-
-	const uint32_t height = params.m_height;
-	const uint32_t width = static_cast<uint32_t>(height * aspectRatio);
-
-	const float hFov = (scene->HasCameras() && scene->mCameras[cameraIndex]->mHorizontalFOV > 0.0f)
-		? scene->mCameras[cameraIndex]->mHorizontalFOV
-		: glm::radians(60.0f);
-
-	const float vFov = 2.0f * atan(tan(hFov * 0.5f) * (1.0f / aspectRatio));
-
-	const float zMin = scene->HasCameras() ? scene->mCameras[cameraIndex]->mClipPlaneNear : 0.01f;
-	const float zMax = scene->HasCameras() ? scene->mCameras[cameraIndex]->mClipPlaneFar : 1000.0f;
-
-	const auto cameraRight = normalize(cross(cameraForward, cameraUp));
-
 	uint32_t expectedNumFaces = 0;
 	for (uint32_t i = 0; i < scene->mNumMeshes; i++)
 	{
@@ -412,201 +765,737 @@ void PathTracer::Run(const PathTracer::Params& params)
 		m_directionalLights.Add(defaultLight);
 	}*/
 
-	BVH bvh((uint32_t)m_triangles.Num());
-	bvh.BuildBVH(m_triangles);
-
-	SAILOR_PROFILE_BLOCK("Viewport Calcs");
+	// The external textures and the buffers invalidate the scene cache
+	for (const auto& texture : m_textureMapping)
+	{
+		if (texture.m_first[0] != '*')
+		{
+			std::filesystem::path filepath = params.m_pathToModel;
+			filepath.replace_filename(texture.m_first);
+			outDependencies.Add(filepath);
+		}
+	}
 
-	CombinedSampler2D outputTex;
-	outputTex.Initialize<vec3>(width, height);
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(params.m_pathToModel.parent_path(), error))
+	{
+		if (entry.path().extension() == ".bin")
+		{
+			outDependencies.Add(entry.path());
+		}
+	}
 
-	float h = tan(vFov / 2);
-	const float ViewportHeight = 2.0f * h;
-	const float ViewportWidth = aspectRatio * ViewportHeight;
+	return true;
+}
 
-	vec3 _u = normalize(cross(cameraUp, -cameraForward));
-	vec3 _v = cross(-cameraForward, _u);
+uint64_t PathTracer::GetSceneCacheLayoutHash()
+{
+	size_t hash = 0;
+	HashCombine(hash, sizeof(Math::Triangle), sizeof(Material), sizeof(DirectionalLight), sizeof(Camera), sizeof(TextureHeader), sizeof(BVH::IntersectionTriangle));
+	return hash;
+}
 
-	const vec3 ViewportU = ViewportWidth * _u;
-	const vec3 ViewportV = ViewportHeight * _v;
-	const vec3 ViewportPivot = cameraPos - (ViewportU + ViewportV) * 0.5f + cameraForward;
+bool PathTracer::LoadSceneCache(const PathTracer::Params& params, TVector<Camera>& outCameras, BVH& outBvh)
+{
+	SAILOR_PROFILE_FUNCTION();
 
-	const vec3 _pixelDeltaU = ViewportU / (float)width;
-	const vec3 _pixelDeltaV = ViewportV / (float)height;
-	const vec3 _pixel00Dir = ViewportPivot + 0.5f * (_pixelDeltaU + _pixelDeltaV) - cameraPos;
+	if (!m_sceneCache.Open(params.m_pathToModel, GetSceneCacheLayoutHash()))
+	{
+		return false;
+	}
 
-	SAILOR_PROFILE_END_BLOCK();
-	// Raytracing
+	m_sceneCache.Read(outCameras);
+	m_sceneCache.Read(m_directionalLights);
+	m_sceneCache.Read(m_materials);
+	m_sceneCache.Read(m_triangles);
+
+	TVector<TextureHeader> textureHeaders;
+	m_sceneCache.Read(textureHeaders);
+
+	m_textures.Clear();
+	m_textures.Resize(textureHeaders.Num());
+
+	bool bCorruptedTextures = false;
+
+	for (uint32_t i = 0; i < textureHeaders.Num() && m_sceneCache.IsValid(); i++)
 	{
-		SAILOR_PROFILE_BLOCK("Prepare raytracing tasks");
+		size_t size = 0;
+		const u8* data = m_sceneCache.Map<u8>(size);
 
-		TVector<Tasks::ITaskPtr> tasks;
-		TVector<Tasks::ITaskPtr> tasksThisThread;
+		if (!textureHeaders[i].m_bValid)
+		{
+			continue;
+		}
 
-		std::atomic<uint32_t> finishedTasks = 0;
-		const uint32_t numTasks = (height * width) / (GroupSize * GroupSize);
+		// No copy, the texels are sampled right from the mapped file
+		auto& texture = m_textures[i] = TSharedPtr<CombinedSampler2D>::Make();
+		texture->m_channels = textureHeaders[i].m_channels;
+		texture->m_clamping = textureHeaders[i].m_clamping;
+		texture->m_width = textureHeaders[i].m_width;
+		texture->m_height = textureHeaders[i].m_height;
+		texture->m_format = textureHeaders[i].m_format;
+		texture->m_pMappedData = data;
+
+		if (textureHeaders[i].m_bMipmapped && texture->UpdateMipLayout() != size)
+		{
+			bCorruptedTextures = true;
+			break;
+		}
+	}
 
-		tasks.Reserve(numTasks);
-		tasksThisThread.Reserve(numTasks / 32);
+	if (bCorruptedTextures || !outBvh.Deserialize(m_sceneCache))
+	{
+		SAILOR_LOG("Scene cache for %s is corrupted", params.m_pathToModel.string().c_str());
 
-		for (uint32_t y = 0; y < height; y += GroupSize)
+		outCameras.Clear();
+		m_directionalLights.Clear();
+		m_materials.Clear();
+		m_triangles.Clear();
+		m_textures.Clear();
+		m_sceneCache.Close();
+
+		return false;
+	}
+
+	SAILOR_LOG("Scene %s is loaded from the cache", params.m_pathToModel.string().c_str());
+	return true;
+}
+
+void PathTracer::SaveSceneCache(const PathTracer::Params& params, const TVector<Camera>& cameras, const BVH& bvh, const TVector<std::filesystem::path>& dependencies)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	SceneCache cache;
+
+	cache.Write(cameras);
+	cache.Write(m_directionalLights);
+	cache.Write(m_materials);
+	cache.Write(m_triangles);
+
+	TVector<TextureHeader> textureHeaders(m_textures.Num());
+	for (uint32_t i = 0; i < m_textures.Num(); i++)
+	{
+		if (const auto& texture = m_textures[i])
 		{
-			for (uint32_t x = 0; x < width; x += GroupSize)
-			{
-				auto task = Tasks::CreateTask("Calculate raytracing",
-					[=,
-					&finishedTasks,
-					&outputTex,
-					&bvh,
-					this]() mutable
-					{
-						Ray ray;
-						ray.SetOrigin(cameraPos);
+			textureHeaders[i].m_bValid = true;
+			textureHeaders[i].m_channels = texture->m_channels;
+			textureHeaders[i].m_clamping = texture->m_clamping;
+			textureHeaders[i].m_format = texture->m_format;
+			textureHeaders[i].m_bMipmapped = texture->IsMipmapped();
+			textureHeaders[i].m_width = texture->m_width;
+			textureHeaders[i].m_height = texture->m_height;
+		}
+	}
 
-#ifdef _DEBUG
-						uint32_t debugX = 975u;
-						uint32_t debugY = height - 355u - 1;
+	cache.Write(textureHeaders);
 
-						if (!(x < debugX && (x + GroupSize) > debugX &&
-							y < debugY && (y + GroupSize) > debugY))
-						{
-							return;
-						}
-#endif
-						for (uint32_t v = 0; (v < GroupSize) && (y + v) < height; v++)
-						{
-							const float tv = (y + v) / (float)height;
-							for (uint32_t u = 0; u < GroupSize && (u + x) < width; u++)
-							{
-								SAILOR_PROFILE_BLOCK("Raycasting");
+	for (const auto& texture : m_textures)
+	{
+		if (texture)
+		{
+			cache.Write(texture->m_data);
+		}
+		else
+		{
+			cache.Write((const u8*)nullptr, 0);
+		}
+	}
 
-								const uint32_t index = (height - (y + v) - 1) * width + (x + u);
-								const float tu = (x + u) / (float)width;
-#ifdef _DEBUG
-								if (((x + u) == debugX) && ((y + v) == debugY))
-								{
-									volatile uint8_t a = 0;
-								}
-#endif
-								vec3 accumulator = vec3(0);
-								for (uint32_t sample = 0; sample < params.m_msaa; sample++)
-								{
-									const vec2 offset = sample == 0 ? vec2(0.5f, 0.5f) : glm::linearRand(vec2(0, 0), vec2(1.0f, 1.0f));
-									const vec3 pixelDir = _pixel00Dir + ((float)(u + x) + offset.x) * _pixelDeltaU + ((float)(y + v) - offset.y) * _pixelDeltaV;
+	bvh.Serialize(cache);
 
-									ray.SetDirection(glm::normalize(pixelDir));
+	if (!cache.Save(params.m_pathToModel, dependencies, GetSceneCacheLayoutHash()))
+	{
+		SAILOR_LOG("Cannot write the scene cache for %s", params.m_pathToModel.string().c_str());
+	}
+}
 
-									accumulator += Raytrace(ray, bvh, params.m_maxBounces, (uint32_t)(-1), params, 1.0f, 1.0f);
-								}
+void PathTracer::WriteImage(const PathTracer::Params& params, const CombinedSampler2D& outputTex)
+{
+	SAILOR_PROFILE_FUNCTION();
 
-								vec3 res = accumulator / (float)params.m_msaa;
-								outputTex.SetPixel(x + u, height - (y + v) - 1, res);
+	const uint32_t width = outputTex.m_width;
+	const uint32_t height = outputTex.m_height;
 
-								SAILOR_PROFILE_END_BLOCK();
-							}
-						}
+	TVector<u8vec3> outSrgb(width * height);
+	const float aberrationAmount = (0.5f / width);
 
-						finishedTasks++;
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			vec2 uv = vec2((float)x / width, (float)y / height);
 
-			}, Tasks::EThreadType::Worker);
+			// Fetch the color values from the offset positions
+			vec3 greenColor = outputTex.Sample<vec3>(uv + vec2(aberrationAmount, 0));
+			vec3 blueColor = outputTex.Sample<vec3>(uv + vec2(aberrationAmount, aberrationAmount));
+			vec3 redColor = outputTex.Sample<vec3>(uv + vec2(-aberrationAmount, -aberrationAmount));
 
-				if (((x + y) / GroupSize) % 32 == 0)
-				{
-					tasksThisThread.Emplace(task);
-				}
-				else
-				{
-					task->Run();
-					tasks.Emplace(std::move(task));
-				}
+			// Combine the shifted channels
+			vec3 chromaAberratedColor = vec3(redColor.r, greenColor.g, blueColor.b);
+
+			// Write the result back to the output array
+			outSrgb[x + y * width] = glm::clamp(Utils::LinearToSRGB(chromaAberratedColor) * 255.0f, 0.0f, 255.0f);
 		}
 	}
-		SAILOR_PROFILE_END_BLOCK();
 
-		SAILOR_PROFILE_BLOCK("Calcs on Main thread");
-		float lastPrg = 0.0f;
-		float eta = 0.0f;
-		for (auto& task : tasksThisThread)
+	const uint32_t Channels = 3;
+	if (!stbi_write_png(params.m_output.string().c_str(), width, height, Channels, outSrgb.GetData(), width * Channels))
+	{
+		SAILOR_LOG("Raytracing WriteImage error");
+	}
+}
+
+void PathTracer::WriteAOVs(const Math::Ray* rays, const Math::RaycastHit* hits, uint32_t numSamples, size_t pixel, DenoiserAOVs& outAovs) const
+{
+	vec3 albedo = vec3(0);
+	vec3 normal = vec3(0);
+	float depth = 0.0f;
+	uint32_t numHits = 0;
+
+	for (uint32_t sample = 0; sample < numSamples; sample++)
+	{
+		if (!hits[sample].HasIntersection())
 		{
-			task->Execute();
+			// The sky is not filtered, it has no normal
+			albedo += vec3(1.0f);
+			continue;
+		}
+
+		const SurfacePoint surface = GetSurfacePoint(rays[sample], hits[sample]);
+
+		albedo += vec3(surface.m_sample.m_baseColor);
+		normal += surface.m_worldNormal;
+		depth += hits[sample].m_rayLenght;
+		numHits++;
+	}
+
+	outAovs.m_albedo[pixel] = albedo / (float)numSamples;
+	outAovs.m_normal[pixel] = glm::length(normal) > 0.0f ? glm::normalize(normal) : vec3(0);
+	outAovs.m_depth[pixel] = numHits > 0 ? depth / numHits : 0.0f;
+}
+
+void PathTracer::RenderProgressive(const PathTracer::Params& params, const BVH& bvh, const Viewport& viewport, CombinedSampler2D& outputTex, DenoiserAOVs* outAovs) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	// The tiles with less samples are not tested for the convergence, the variance estimation is too noisy
+	const uint32_t MinSamples = 4;
+	const uint32_t TileSize = 16;
+
+	const uint32_t width = viewport.m_width;
+	const uint32_t height = viewport.m_height;
+	const uint32_t maxSamples = params.m_maxSamples > 0 ? params.m_maxSamples : params.m_msaa;
+
+	const uint32_t numTilesX = (width + TileSize - 1) / TileSize;
+	const uint32_t numTilesY = (height + TileSize - 1) / TileSize;
+	const uint32_t numTiles = numTilesX * numTilesY;
+
+	struct Tile
+	{
+		uint32_t m_numSamples = 0;
+		bool m_bConverged = false;
+	};
+
+	// Accumulation buffer: the sum of the samples and the sum of the squared luminance to estimate the variance
+	TVector<vec3> accumulation(width * height);
+	TVector<float> luminanceSqSum(width * height);
+	TVector<Tile> tiles(numTiles);
+
+	Utils::Timer timer;
+	timer.Start();
 
-			const float progress = finishedTasks.load() / (float)numTasks;
+	float lastCheckpoint = 0.0f;
 
-			if (progress - lastPrg > 0.05f)
+	std::atomic<bool> bIsOutOfTime = false;
+	uint32_t pass = 0;
+
+	for (; pass < maxSamples; pass++)
+	{
+		std::atomic<uint32_t> numActiveTiles = 0;
+
+		Tasks::ParallelFor("Progressive raytracing pass", 0, numTiles, 1,
+			[&](size_t tileIndex)
 			{
-				if (eta == 0.0f)
+				Tile& tile = tiles[tileIndex];
+				if (tile.m_bConverged || bIsOutOfTime.load(std::memory_order_relaxed))
 				{
-					eta = raytracingTimer.ResultAccumulatedMs() * 20.0f * 0.001f * 1.5f;
-					SAILOR_LOG("PathTracer ETA: ~%.2fsec (%.2fmin)", eta, round(eta / 60.0f));
+					return;
 				}
 
-				SAILOR_LOG("PathTracer Progress: %.2f", progress);
-				lastPrg = progress;
-			}
-		}
-		SAILOR_PROFILE_END_BLOCK();
+				// The pass is interrupted by the deadline, the skipped tiles just keep less samples
+				if (params.m_timeBudget > 0.0f && tileIndex % numTilesX == 0)
+				{
+					if (timer.ResultMs() * 0.001f >= params.m_timeBudget)
+					{
+						bIsOutOfTime = true;
+						return;
+					}
+				}
 
-		SAILOR_PROFILE_BLOCK("Wait all calcs");
-		for (auto& task : tasks)
-		{
-			if (!task->IsFinished())
-			{
-				task->Wait();
+				const uint32_t x = (uint32_t)(tileIndex % numTilesX) * TileSize;
+				const uint32_t y = (uint32_t)(tileIndex / numTilesX) * TileSize;
+				const uint32_t numPixels = std::min(TileSize, width - x);
 
-				const float progress = finishedTasks.load() / (float)numTasks;
-				if (progress - lastPrg > 0.05f)
+				Ray primaryRays[TileSize];
+				RaycastHit primaryHits[TileSize];
+
+				const float invNumSamples = 1.0f / (tile.m_numSamples + 1);
+				float maxError = 0.0f;
+
+				for (uint32_t v = 0; (v < TileSize) && (y + v) < height; v++)
 				{
-					SAILOR_LOG("PathTracer Progress: %.2f", progress);
-					lastPrg = progress;
+					for (uint32_t u = 0; u < numPixels; u++)
+					{
+						const vec2 offset = tile.m_numSamples == 0 ? vec2(0.5f, 0.5f) : glm::linearRand(vec2(0, 0), vec2(1.0f, 1.0f));
+						const vec3 pixelDir = viewport.m_pixel00Dir + ((float)(u + x) + offset.x) * viewport.m_pixelDeltaU + ((float)(y + v) - offset.y) * viewport.m_pixelDeltaV;
+
+						primaryRays[u].SetOrigin(viewport.m_cameraPos);
+						primaryRays[u].SetDirection(glm::normalize(pixelDir));
+					}
+
+					bvh.IntersectRays(&primaryRays[0], &primaryHits[0], numPixels);
+
+					for (uint32_t u = 0; u < numPixels; u++)
+					{
+						const vec3 sample = Shade(primaryRays[u], primaryHits[u], bvh, params.m_maxBounces, params, 1.0f, 1.0f);
+						const float luminance = glm::dot(sample, vec3(0.2126f, 0.7152f, 0.0722f));
+
+						const uint32_t index = (y + v) * width + x + u;
+						accumulation[index] += sample;
+						luminanceSqSum[index] += luminance * luminance;
+
+						const vec3 mean = accumulation[index] * invNumSamples;
+						outputTex.SetPixel(x + u, height - (y + v) - 1, mean);
+
+						// The first pass traces the pixel centers
+						if (outAovs && tile.m_numSamples == 0)
+						{
+							WriteAOVs(&primaryRays[u], &primaryHits[u], 1, (height - (y + v) - 1) * width + x + u, *outAovs);
+						}
+
+						// Relative standard error of the mean
+						const float meanLuminance = glm::dot(mean, vec3(0.2126f, 0.7152f, 0.0722f));
+						const float variance = std::max(0.0f, luminanceSqSum[index] * invNumSamples - meanLuminance * meanLuminance);
+						const float error = sqrtf(variance * invNumSamples) / (meanLuminance + 0.01f);
+
+						maxError = std::max(maxError, error);
+					}
 				}
-			}
+
+				tile.m_numSamples++;
+				tile.m_bConverged = params.m_varianceThreshold > 0.0f &&
+					tile.m_numSamples >= MinSamples &&
+					maxError < params.m_varianceThreshold;
+
+				if (!tile.m_bConverged)
+				{
+					numActiveTiles++;
+				}
+			});
+
+		const float elapsed = timer.ResultMs() * 0.001f;
+
+		SAILOR_LOG("PathTracer pass %u, active tiles: %u/%u, elapsed: %.2fsec", pass + 1, numActiveTiles.load(), numTiles, elapsed);
+
+		if (numActiveTiles == 0 || bIsOutOfTime || (params.m_timeBudget > 0.0f && elapsed >= params.m_timeBudget))
+		{
+			pass++;
+			break;
 		}
-		SAILOR_PROFILE_END_BLOCK();
+
+		if (params.m_checkpointInterval > 0.0f && elapsed - lastCheckpoint >= params.m_checkpointInterval)
+		{
+			WriteImage(params, outputTex);
+			lastCheckpoint = elapsed;
+		}
+	}
+
+	size_t numSamples = 0;
+	for (const auto& tile : tiles)
+	{
+		numSamples += tile.m_numSamples;
+	}
+
+	SAILOR_LOG("PathTracer progressive: %u passes, %.2f%% of the sample budget is used", pass, 100.0f * numSamples / ((float)numTiles * maxSamples));
 }
 
-	raytracingTimer.Stop();
-	//profiler::dumpBlocksToFile("test_profile.prof");
+uint64_t PathTracer::RenderWavefront(const PathTracer::Params& params, const BVH& bvh, const Viewport& viewport, CombinedSampler2D& outputTex, DenoiserAOVs* outAovs) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	// The image is split into the bands of rows, so the state of the wave stays in the memory budget
+	const uint32_t MaxWaveSize = 1u << 20;
+	const size_t GrainSize = 256;
 
-	SAILOR_PROFILE_BLOCK("Write Image");
+	const uint32_t width = viewport.m_width;
+	const uint32_t height = viewport.m_height;
+	const uint32_t numSamples = std::max(1u, params.m_msaa * params.m_numSamples);
+	const uint32_t rowsPerWave = std::max(1u, MaxWaveSize / width);
+	const uint32_t numLights = (uint32_t)m_directionalLights.Num();
+	const uint32_t numShadowRays = params.m_numLightSamples > 0 ? params.m_numLightSamples : numLights;
+
+	struct Path
+	{
+		Ray m_ray;
+		vec3 m_throughput;
+		vec3 m_radiance;
+		// Inside the thick volume, the throughput is attenuated by the distance to the next hit
+		vec3 m_extinction;
+		// The last vertex sampled by the material, weights the emission of the next hit against the light samples
+		BsdfVertex m_bsdfVertex;
+		float m_environmentIor;
+		uint32_t m_ignoreTriangle;
+		uint32_t m_pixel;
+		bool m_bHasBsdfVertex;
+		bool m_bActive;
+	};
+
+	struct ShadowRay
+	{
+		Ray m_ray;
+		vec3 m_contribution;
+		float m_maxDistance;
+		uint32_t m_path;
+		uint32_t m_ignoreTriangle;
+	};
+
+	Math::AABB bounds;
+	for (const auto& tri : m_triangles)
 	{
-		TVector<u8vec3> outSrgb(width * height);
-		const float aberrationAmount = (0.5f / width);
+		bounds.Extend(tri.m_vertices[0]);
+		bounds.Extend(tri.m_vertices[1]);
+		bounds.Extend(tri.m_vertices[2]);
+	}
+
+	const vec3 invBoundsExtent = 1.0f / glm::max(bounds.m_max - bounds.m_min, vec3(0.0001f));
+
+	TVector<vec3> accumulation(width * height);
 
-		for (uint32_t y = 0; y < height; y++)
+	TVector<Path> paths;
+	TVector<uint32_t> activePaths;
+	TVector<uint32_t> slotPaths;
+	TVector<uint64_t> sortKeys;
+	TVector<uint64_t> sortTemp;
+	TVector<Ray> rays;
+	TVector<RaycastHit> hits;
+	TVector<ShadowRay> shadowRays;
+	TVector<uint64_t> shadowKeys;
+	TVector<uint8_t> shadowVisibility;
+
+	uint64_t numTracedRays = 0;
+
+	for (uint32_t sampleIndex = 0; sampleIndex < numSamples; sampleIndex++)
+	{
+		for (uint32_t firstRow = 0; firstRow < height; firstRow += rowsPerWave)
 		{
-			for (uint32_t x = 0; x < width; x++)
+			const uint32_t numPaths = std::min(rowsPerWave, height - firstRow) * width;
+
+			paths.Resize(numPaths);
+			activePaths.Resize(numPaths);
+
+			Tasks::ParallelFor("Wavefront camera rays", 0, numPaths, GrainSize,
+				[&](size_t i)
+				{
+					const uint32_t x = (uint32_t)(i % width);
+					const uint32_t y = firstRow + (uint32_t)(i / width);
+
+					const vec2 offset = sampleIndex == 0 ? vec2(0.5f, 0.5f) : glm::linearRand(vec2(0, 0), vec2(1.0f, 1.0f));
+					const vec3 pixelDir = viewport.m_pixel00Dir + ((float)x + offset.x) * viewport.m_pixelDeltaU + ((float)y - offset.y) * viewport.m_pixelDeltaV;
+
+					Path& path = paths[i];
+					path.m_ray = Ray(viewport.m_cameraPos, glm::normalize(pixelDir));
+					path.m_throughput = vec3(1.0f);
+					path.m_radiance = vec3(0.0f);
+					path.m_extinction = vec3(0.0f);
+					path.m_environmentIor = 1.0f;
+					path.m_ignoreTriangle = (uint32_t)(-1);
+					path.m_pixel = (height - y - 1) * width + x;
+					path.m_bHasBsdfVertex = false;
+					path.m_bActive = true;
+
+					activePaths[i] = (uint32_t)i;
+				});
+
+			for (uint32_t bounce = 0; bounce <= params.m_maxBounces && activePaths.Num() > 0; bounce++)
 			{
-				vec2 uv = vec2((float)x / width, (float)y / height);
+				const size_t numRays = activePaths.Num();
+				const bool bCanContinue = bounce < params.m_maxBounces;
+
+				// Sort the rays by the direction octant and the origin, the neighbours in the batch traverse the same nodes
+				SAILOR_PROFILE_BLOCK("Sort rays");
+
+				sortKeys.Resize(numRays);
+				for (size_t i = 0; i < numRays; i++)
+				{
+					sortKeys[i] = ((uint64_t)CalculateRayKey(paths[activePaths[i]].m_ray, bounds.m_min, invBoundsExtent) << 32) | activePaths[i];
+				}
 
-				// Fetch the color values from the offset positions
-				vec3 greenColor = outputTex.Sample<vec3>(uv + vec2(aberrationAmount, 0));
-				vec3 blueColor = outputTex.Sample<vec3>(uv + vec2(aberrationAmount, aberrationAmount));
-				vec3 redColor = outputTex.Sample<vec3>(uv + vec2(-aberrationAmount, -aberrationAmount));
+				RadixSortByKey(sortKeys, sortTemp);
 
-				// Combine the shifted channels
-				vec3 chromaAberratedColor = vec3(redColor.r, greenColor.g, blueColor.b);
+				slotPaths.Resize(numRays);
+				rays.Resize(numRays);
+				hits.Resize(numRays);
 
-				// Write the result back to the output array
-				outSrgb[x + y * width] = glm::clamp(Utils::LinearToSRGB(chromaAberratedColor) * 255.0f, 0.0f, 255.0f);
+				for (size_t i = 0; i < numRays; i++)
+				{
+					slotPaths[i] = (uint32_t)sortKeys[i];
+					rays[i] = paths[slotPaths[i]].m_ray;
+					hits[i] = RaycastHit();
+				}
+
+				SAILOR_PROFILE_END_BLOCK();
+
+				// The primary rays share the origin and are traced by the packets of the BVH width,
+				// the secondary rays skip the triangle they start from, so they are traced one by one in the sorted order
+				Tasks::ParallelFor("Wavefront traversal", 0, (numRays + 7) / 8, GrainSize / 8,
+					[&](size_t packetIndex)
+					{
+						const size_t first = packetIndex * 8;
+						const uint32_t numLanes = (uint32_t)std::min<size_t>(8, numRays - first);
+
+						if (bounce == 0)
+						{
+							bvh.IntersectRays(&rays[first], &hits[first], numLanes);
+							return;
+						}
+
+						for (size_t i = first; i < first + numLanes; i++)
+						{
+							bvh.IntersectBVH(rays[i], hits[i], 0, std::numeric_limits<float>().max(), paths[slotPaths[i]].m_ignoreTriangle);
+						}
+					});
+
+				numTracedRays += numRays;
+
+				// Sort the hits by the material, so the shading reads the same textures in a row. The misses go last.
+				SAILOR_PROFILE_BLOCK("Sort hits");
+
+				for (size_t i = 0; i < numRays; i++)
+				{
+					const uint64_t materialIndex = hits[i].HasIntersection() ? m_triangles[hits[i].m_triangleIndex].m_materialIndex : 0xFFFFFFFFu;
+					sortKeys[i] = (materialIndex << 32) | i;
+				}
+
+				RadixSortByKey(sortKeys, sortTemp);
+
+				SAILOR_PROFILE_END_BLOCK();
+
+				shadowRays.Resize(numRays * numShadowRays);
+
+				Tasks::ParallelFor("Wavefront shading", 0, numRays, GrainSize,
+					[&](size_t orderIndex)
+					{
+						const uint32_t slot = (uint32_t)sortKeys[orderIndex];
+						const RaycastHit& hit = hits[slot];
+						const Ray& ray = rays[slot];
+
+						Path& path = paths[slotPaths[slot]];
+						path.m_bActive = false;
+
+						const bool bHasBsdfVertex = path.m_bHasBsdfVertex;
+						path.m_bHasBsdfVertex = false;
+
+						for (uint32_t i = 0; i < numShadowRays; i++)
+						{
+							shadowRays[slot * numShadowRays + i].m_contribution = vec3(0.0f);
+						}
+
+						// The first sample traces the pixel centers
+						if (outAovs && bounce == 0 && sampleIndex == 0)
+						{
+							WriteAOVs(&ray, &hit, 1, path.m_pixel, *outAovs);
+						}
+
+						if (!hit.HasIntersection())
+						{
+							path.m_radiance += glm::clamp(path.m_throughput * params.m_ambient, vec3(0, 0, 0), vec3(10, 10, 10));
+							return;
+						}
+
+						if (path.m_extinction != vec3(0.0f))
+						{
+							path.m_throughput *= glm::exp(-path.m_extinction * hit.m_rayLenght);
+							path.m_extinction = vec3(0.0f);
+						}
+
+						const Material& material = m_materials[m_triangles[hit.m_triangleIndex].m_materialIndex];
+						const SurfacePoint surface = GetSurfacePoint(ray, hit);
+						const LightingModel::SampledData& sample = surface.m_sample;
+
+						const vec3 offset = 0.000001f * surface.m_faceNormal;
+						const bool bFullMetallic = sample.m_orm.z == 1.0f;
+						const bool bHasTransmission = !bFullMetallic && sample.m_transmission > 0.0f;
+						const bool bThickVolume = bHasTransmission && material.m_thicknessFactor > 0.0f;
+						const bool bHasAlphaBlending = !sample.m_bIsOpaque && sample.m_baseColor.a < 1.0f;
+
+						// Alpha blending is stochastic, the path passes through with the probability of the transparency
+						if (bHasAlphaBlending && glm::linearRand(0.0f, 1.0f) > sample.m_baseColor.a)
+						{
+							path.m_ray.SetOrigin(hit.m_point + ray.GetDirection() * 0.0001f);
+							path.m_ignoreTriangle = hit.m_triangleIndex;
+							path.m_bActive = bCanContinue;
+							return;
+						}
+
+						// Leaving the thick volume
+						if (!surface.m_bIsOppositeRay && bThickVolume)
+						{
+							const vec3 newDirection = LightingModel::CalculateRefraction(ray.GetDirection(), surface.m_worldNormal, path.m_environmentIor, 1.0f);
+
+							path.m_ray = Ray(hit.m_point, newDirection - offset);
+							path.m_environmentIor = 1.0f;
+							path.m_ignoreTriangle = hit.m_triangleIndex;
+							path.m_bActive = bCanContinue && newDirection != vec3(0, 0, 0);
+							return;
+						}
+
+						path.m_radiance += path.m_throughput * sample.m_emissive * CalculateEmissionWeight(hit, bHasBsdfVertex ? &path.m_bsdfVertex : nullptr, params);
+
+						// Direct lighting, the shadow rays are traced in the separate stage
+						if (params.m_numLightSamples > 0)
+						{
+							// The next segment of the path is the only material sample that could hit the light
+							const uint32_t numBsdfSamples = bCanContinue ? 1u : 0u;
+
+							for (uint32_t i = 0; i < numShadowRays; i++)
+							{
+								ShadowRay& shadowRay = shadowRays[slot * numShadowRays + i];
+								shadowRay.m_path = slotPaths[slot];
+								shadowRay.m_ignoreTriangle = hit.m_triangleIndex;
+
+								vec3 contribution{};
+								if (SampleLight(hit.m_point, offset, surface, numBsdfSamples, params, shadowRay.m_ray, shadowRay.m_maxDistance, contribution))
+								{
+									shadowRay.m_contribution = path.m_throughput * contribution;
+								}
+							}
+						}
+						else
+						{
+							for (uint32_t i = 0; i < numLights; i++)
+							{
+								const vec3 toLight = -m_directionalLights[i].m_direction;
+								const float angle = max(0.0f, glm::dot(toLight, surface.m_worldNormal));
+
+								ShadowRay& shadowRay = shadowRays[slot * numShadowRays + i];
+								shadowRay.m_ray = Ray(hit.m_point + offset, toLight);
+								shadowRay.m_maxDistance = std::numeric_limits<float>::max();
+								shadowRay.m_path = slotPaths[slot];
+								shadowRay.m_ignoreTriangle = hit.m_triangleIndex;
+								shadowRay.m_contribution = angle > 0.0f ?
+									path.m_throughput * LightingModel::CalculateBRDF(surface.m_viewDirection, surface.m_worldNormal, toLight, sample) * m_directionalLights[i].m_intensity * angle :
+									vec3(0.0f);
+							}
+						}
+
+						if (!bCanContinue)
+						{
+							return;
+						}
+
+						// The next segment of the path is sampled by the material
+						const float toIor = bThickVolume ? (surface.m_bIsOppositeRay ? sample.m_ior : 1.0f) : path.m_environmentIor;
+
+						vec3 term{};
+						vec3 direction{};
+						float pdf = 0.0f;
+						bool bTransmissionRay = false;
+						bool bSample = false;
+
+						for (uint32_t attempt = 0; attempt < 4 && !bSample; attempt++)
+						{
+							direction = vec3(0);
+							bSample = LightingModel::Sample(sample, surface.m_worldNormal, surface.m_viewDirection, path.m_environmentIor, toIor, term, pdf, bTransmissionRay, direction, NextVec2_Linear());
+						}
+
+						if (!bSample)
+						{
+							return;
+						}
+
+						if (surface.m_bIsOppositeRay && bTransmissionRay && bThickVolume)
+						{
+							path.m_environmentIor = sample.m_ior;
+							path.m_extinction = -log(material.m_attenuationColor) / material.m_attenuationDistance;
+						}
+
+						// The light samples cover the reflected directions only
+						if (!bTransmissionRay && params.m_numLightSamples > 0)
+						{
+							path.m_bsdfVertex = BsdfVertex{ hit.m_point, surface.m_worldNormal, LightingModel::Pdf(sample, surface.m_worldNormal, surface.m_viewDirection, direction), 1u };
+							path.m_bHasBsdfVertex = true;
+						}
+
+						path.m_throughput *= term;
+						path.m_ray = Ray(hit.m_point + (bTransmissionRay ? -offset : offset), direction);
+						path.m_ignoreTriangle = hit.m_triangleIndex;
+						path.m_bActive = glm::length(path.m_throughput) > 0.01f;
+					});
+
+				// Shadow rays
+				SAILOR_PROFILE_BLOCK("Sort shadow rays");
+
+				shadowKeys.Clear(false);
+				for (uint32_t i = 0; i < shadowRays.Num(); i++)
+				{
+					if (shadowRays[i].m_contribution != vec3(0.0f))
+					{
+						shadowKeys.Add(((uint64_t)CalculateRayKey(shadowRays[i].m_ray, bounds.m_min, invBoundsExtent) << 32) | i);
+					}
+				}
+
+				RadixSortByKey(shadowKeys, sortTemp);
+				shadowVisibility.Resize(shadowKeys.Num());
+
+				SAILOR_PROFILE_END_BLOCK();
+
+				Tasks::ParallelFor("Wavefront shadow rays", 0, shadowKeys.Num(), GrainSize,
+					[&](size_t i)
+					{
+						const ShadowRay& shadowRay = shadowRays[(uint32_t)shadowKeys[i]];
+
+						RaycastHit hitLight{};
+						shadowVisibility[i] = !bvh.IntersectBVH(shadowRay.m_ray, hitLight, 0, shadowRay.m_maxDistance, shadowRay.m_ignoreTriangle);
+					});
+
+				numTracedRays += shadowKeys.Num();
+
+				for (size_t i = 0; i < shadowKeys.Num(); i++)
+				{
+					if (shadowVisibility[i])
+					{
+						const ShadowRay& shadowRay = shadowRays[(uint32_t)shadowKeys[i]];
+						paths[shadowRay.m_path].m_radiance += shadowRay.m_contribution;
+					}
+				}
+
+				// Compaction, the terminated paths leave the wave
+				activePaths.Clear(false);
+				for (size_t i = 0; i < numRays; i++)
+				{
+					if (paths[slotPaths[i]].m_bActive)
+					{
+						activePaths.Add(slotPaths[i]);
+					}
+				}
 			}
-		}
 
-		const uint32_t Channels = 3;
-		if (!stbi_write_png(params.m_output.string().c_str(), width, height, Channels, outSrgb.GetData(), width * Channels))
-		{
-			SAILOR_LOG("Raytracing WriteImage error");
+			for (const auto& path : paths)
+			{
+				accumulation[path.m_pixel] += path.m_radiance;
+			}
 		}
+
+		SAILOR_LOG("PathTracer wavefront: sample %u/%u", sampleIndex + 1, numSamples);
 	}
-	SAILOR_PROFILE_END_BLOCK();
 
-	char msg[2048];
-	if (raytracingTimer.ResultMs() > 10000.0f)
+	const float invNumSamples = 1.0f / numSamples;
+	for (uint32_t i = 0; i < width * height; i++)
 	{
-		sprintf_s(msg, "Time in sec: %.2f", (float)raytracingTimer.ResultMs() * 0.001f);
-		MessageBoxA(0, msg, msg, 0);
+		outputTex.SetPixel(i % width, i / width, accumulation[i] * invNumSamples);
 	}
 
-	::system(params.m_output.string().c_str());
+	return numTracedRays;
 }
 
 vec3 PathTracer::TraceSky(vec3 startPoint, vec3 toLight, const BVH& bvh, const PathTracer::Params& params, float currentIor, uint32_t ignoreTriangle) const
@@ -618,6 +1507,7 @@ vec3 PathTracer::TraceSky(vec3 startPoint, vec3 toLight, const BVH& bvh, const P
 		RaycastHit hitLight{};
 		Ray rayToLight(startPoint, toLight);
 
+		t_numTracedRays++;
 		if (!bvh.IntersectBVH(rayToLight, hitLight, 0, std::numeric_limits<float>().max(), ignoreTriangle))
 		{
 			return att;
@@ -654,47 +1544,187 @@ vec3 PathTracer::TraceSky(vec3 startPoint, vec3 toLight, const BVH& bvh, const P
 	return vec3(0, 0, 0);
 }
 
-vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceLimit, uint32_t ignoreTriangle, const PathTracer::Params& params, float inAcc, float environmentIor) const
+vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceLimit, uint32_t ignoreTriangle, const PathTracer::Params& params, float inAcc, float environmentIor, const BsdfVertex* pBsdfVertex) const
 {
 	SAILOR_PROFILE_FUNCTION();
 
-	uint32_t randSeedX = glm::linearRand(0, 680);
-	uint32_t randSeedY = glm::linearRand(0, 680);
-
-	vec3 res = vec3(0);
 	RaycastHit hit;
+	t_numTracedRays++;
+	bvh.IntersectBVH(ray, hit, 0, std::numeric_limits<float>().max(), ignoreTriangle);
 
-	if (bvh.IntersectBVH(ray, hit, 0, std::numeric_limits<float>().max(), ignoreTriangle))
+	return Shade(ray, hit, bvh, bounceLimit, params, inAcc, environmentIor, pBsdfVertex);
+}
+
+void PathTracer::BuildLightBVH()
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	// The power of the light is estimated by the average emission of the material, the top mip of the emissive texture
+	TVector<float> luminance(m_materials.Num());
+	for (uint32_t i = 0; i < m_materials.Num(); i++)
 	{
-		SAILOR_PROFILE_BLOCK("Sampling");
+		const vec3 emissive = GetMaterialData(i, vec2(0.5f, 0.5f), std::numeric_limits<float>::max()).m_emissive;
+		luminance[i] = glm::dot(emissive, vec3(0.2126f, 0.7152f, 0.0722f));
+	}
 
-		const bool bIsFirstIntersection = bounceLimit == params.m_maxBounces;
-		const bool bIsFirstOrSecondIntersection = (params.m_maxBounces - bounceLimit) <= 1;
+	TVector<LightBVH::EmissiveTriangle> lights;
+	for (uint32_t i = 0; i < m_triangles.Num(); i++)
+	{
+		const float triangleLuminance = luminance[m_triangles[i].m_materialIndex];
+		if (triangleLuminance > 0.0f)
+		{
+			lights.Emplace(m_triangles[i], i, triangleLuminance);
+		}
+	}
 
-		const Math::Triangle& tri = m_triangles[hit.m_triangleIndex];
+	const size_t numEmissiveTriangles = lights.Num();
+	m_lightBvh.Build(std::move(lights), m_directionalLights, (uint32_t)m_triangles.Num());
+
+	SAILOR_LOG("PathTracer lights: %zu emissive triangles, %zu directional lights", numEmissiveTriangles, m_directionalLights.Num());
+}
+
+bool PathTracer::SampleLight(const vec3& point, const vec3& offset, const SurfacePoint& surface, uint32_t numBsdfSamples, const PathTracer::Params& params,
+	Math::Ray& outShadowRay, float& outMaxDistance, vec3& outContribution) const
+{
+	LightBVH::LightSample lightSample{};
+
+	const vec3 randomSample = vec3(NextVec2_Linear(), glm::linearRand(0.0f, 1.0f));
+	if (!m_lightBvh.Sample(point, surface.m_worldNormal, randomSample, lightSample) || lightSample.m_pdf <= 0.0f)
+	{
+		return false;
+	}
 
-		vec3 faceNormal = vec3(hit.m_barycentricCoordinate.x * tri.m_normals[0] + hit.m_barycentricCoordinate.y * tri.m_normals[1] + hit.m_barycentricCoordinate.z * tri.m_normals[2]);
-		const vec3 tangent = vec3(hit.m_barycentricCoordinate.x * tri.m_tangent[0] + hit.m_barycentricCoordinate.y * tri.m_tangent[1] + hit.m_barycentricCoordinate.z * tri.m_tangent[2]);
-		const vec3 bitangent = vec3(hit.m_barycentricCoordinate.x * tri.m_bitangent[0] + hit.m_barycentricCoordinate.y * tri.m_bitangent[1] + hit.m_barycentricCoordinate.z * tri.m_bitangent[2]);
+	const float angle = glm::dot(lightSample.m_direction, surface.m_worldNormal);
+	if (angle <= 0.0f)
+	{
+		return false;
+	}
 
-		const bool bIsOppositeRay = dot(faceNormal, ray.GetDirection()) < 0.0f;
-		if (!bIsOppositeRay)
+	vec3 radiance{};
+	float weight = 1.0f;
+
+	if (lightSample.IsDirectional())
+	{
+		radiance = m_lightBvh.GetDirectionalLight(lightSample.m_directionalLight).m_intensity;
+		outMaxDistance = std::numeric_limits<float>::max();
+	}
+	else
+	{
+		const Math::Triangle& tri = m_triangles[lightSample.m_triangleIndex];
+		const vec3& barycentric = lightSample.m_barycentric;
+
+		const vec2 uv = barycentric.x * tri.m_uvs[0] + barycentric.y * tri.m_uvs[1] + barycentric.z * tri.m_uvs[2];
+		const vec2 uvTransformed = m_materials[tri.m_materialIndex].m_uvTransform * vec3(uv, 1);
+
+		radiance = GetMaterialData(tri.m_materialIndex, uvTransformed).m_emissive;
+
+		// The light itself is not the occluder
+		outMaxDistance = lightSample.m_distance * 0.999f;
+
+		if (numBsdfSamples > 0)
 		{
-			faceNormal *= -1.0f;
+			const float bsdfPdf = LightingModel::Pdf(surface.m_sample, surface.m_worldNormal, surface.m_viewDirection, lightSample.m_direction);
+			weight = LightingModel::PowerHeuristic(params.m_numLightSamples, lightSample.m_pdf, numBsdfSamples, bsdfPdf);
 		}
+	}
 
-		const mat3 tbn(tangent, bitangent, faceNormal);
+	outContribution = LightingModel::CalculateBRDF(surface.m_viewDirection, surface.m_worldNormal, lightSample.m_direction, surface.m_sample) *
+		radiance * angle * (weight / (lightSample.m_pdf * params.m_numLightSamples));
 
-		const vec2 uv = hit.m_barycentricCoordinate.x * tri.m_uvs[0] +
-			hit.m_barycentricCoordinate.y * tri.m_uvs[1] +
-			hit.m_barycentricCoordinate.z * tri.m_uvs[2];
+	outShadowRay = Ray(point + offset, lightSample.m_direction);
 
-		const auto material = m_materials[tri.m_materialIndex];
-		const vec2 uvTransformed = (material.m_uvTransform * vec3(uv, 1));
+	return outContribution != vec3(0.0f);
+}
 
-		const LightingModel::SampledData sample = GetMaterialData(tri.m_materialIndex, uvTransformed);
-		const vec3 viewDirection = -normalize(ray.GetDirection());
-		const vec3 worldNormal = normalize(tbn * sample.m_normal);
+float PathTracer::CalculateEmissionWeight(const Math::RaycastHit& hit, const BsdfVertex* pBsdfVertex, const PathTracer::Params& params) const
+{
+	if (pBsdfVertex == nullptr || params.m_numLightSamples == 0 || !m_lightBvh.IsLight(hit.m_triangleIndex))
+	{
+		return 1.0f;
+	}
+
+	const float lightPdf = m_lightBvh.Pdf(pBsdfVertex->m_point, pBsdfVertex->m_normal, hit.m_triangleIndex, hit.m_point);
+	return LightingModel::PowerHeuristic(pBsdfVertex->m_numSamples, pBsdfVertex->m_pdf, params.m_numLightSamples, lightPdf);
+}
+
+PathTracer::SurfacePoint PathTracer::GetSurfacePoint(const Math::Ray& ray, const Math::RaycastHit& hit) const
+{
+	const Math::Triangle& tri = m_triangles[hit.m_triangleIndex];
+
+	SurfacePoint res{};
+
+	vec3 faceNormal = vec3(hit.m_barycentricCoordinate.x * tri.m_normals[0] + hit.m_barycentricCoordinate.y * tri.m_normals[1] + hit.m_barycentricCoordinate.z * tri.m_normals[2]);
+	const vec3 tangent = vec3(hit.m_barycentricCoordinate.x * tri.m_tangent[0] + hit.m_barycentricCoordinate.y * tri.m_tangent[1] + hit.m_barycentricCoordinate.z * tri.m_tangent[2]);
+	const vec3 bitangent = vec3(hit.m_barycentricCoordinate.x * tri.m_bitangent[0] + hit.m_barycentricCoordinate.y * tri.m_bitangent[1] + hit.m_barycentricCoordinate.z * tri.m_bitangent[2]);
+
+	res.m_bIsOppositeRay = dot(faceNormal, ray.GetDirection()) < 0.0f;
+	if (!res.m_bIsOppositeRay)
+	{
+		faceNormal *= -1.0f;
+	}
+
+	const mat3 tbn(tangent, bitangent, faceNormal);
+
+	const vec2 uv = hit.m_barycentricCoordinate.x * tri.m_uvs[0] +
+		hit.m_barycentricCoordinate.y * tri.m_uvs[1] +
+		hit.m_barycentricCoordinate.z * tri.m_uvs[2];
+
+	const mat3& uvTransform = m_materials[tri.m_materialIndex].m_uvTransform;
+	const vec2 uvTransformed = (uvTransform * vec3(uv, 1));
+
+	// Ray cone: the width of the cone at the hit over the texel density of the triangle.
+	// The cone starts from the pixel spread at every bounce, so the secondary hits are sampled sharper than the true footprint.
+	float footprintLog2 = -std::numeric_limits<float>::infinity();
+
+	const vec3 worldCross = cross(tri.m_vertices[1] - tri.m_vertices[0], tri.m_vertices[2] - tri.m_vertices[0]);
+	const vec2 uv1 = tri.m_uvs[1] - tri.m_uvs[0];
+	const vec2 uv2 = tri.m_uvs[2] - tri.m_uvs[0];
+
+	const float worldArea = length(worldCross);
+	const float uvArea = std::abs((uv1.x * uv2.y - uv1.y * uv2.x) * (uvTransform[0][0] * uvTransform[1][1] - uvTransform[0][1] * uvTransform[1][0]));
+	const float rayLength = length(ray.GetDirection());
+
+	if (worldArea > 0.0f && uvArea > 0.0f && rayLength > 0.0f)
+	{
+		const float cosTheta = std::max(std::abs(dot(worldCross, ray.GetDirection())) / (worldArea * rayLength), 0.001f);
+		const float coneWidth = m_pixelSpreadAngle * hit.m_rayLenght * rayLength;
+
+		footprintLog2 = 0.5f * std::log2(uvArea / worldArea) + std::log2(coneWidth / cosTheta);
+	}
+
+	res.m_sample = GetMaterialData(tri.m_materialIndex, uvTransformed, footprintLog2);
+	res.m_faceNormal = faceNormal;
+	res.m_viewDirection = -normalize(ray.GetDirection());
+	res.m_worldNormal = normalize(tbn * res.m_sample.m_normal);
+
+	return res;
+}
+
+vec3 PathTracer::Shade(const Math::Ray& ray, const Math::RaycastHit& hit, const BVH& bvh, uint32_t bounceLimit, const PathTracer::Params& params, float inAcc, float environmentIor, const BsdfVertex* pBsdfVertex) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	uint32_t randSeedX = glm::linearRand(0, 680);
+	uint32_t randSeedY = glm::linearRand(0, 680);
+
+	vec3 res = vec3(0);
+
+	if (hit.HasIntersection())
+	{
+		SAILOR_PROFILE_BLOCK("Sampling");
+
+		const bool bIsFirstIntersection = bounceLimit == params.m_maxBounces;
+		const bool bIsFirstOrSecondIntersection = (params.m_maxBounces - bounceLimit) <= 1;
+
+		const Math::Triangle& tri = m_triangles[hit.m_triangleIndex];
+		const auto& material = m_materials[tri.m_materialIndex];
+
+		const SurfacePoint surface = GetSurfacePoint(ray, hit);
+		const LightingModel::SampledData& sample = surface.m_sample;
+		const vec3& faceNormal = surface.m_faceNormal;
+		const vec3& viewDirection = surface.m_viewDirection;
+		const vec3& worldNormal = surface.m_worldNormal;
+		const bool bIsOppositeRay = surface.m_bIsOppositeRay;
 
 		const bool bHasAlphaBlending = !sample.m_bIsOpaque && sample.m_baseColor.a < 1.0f;
 		const uint32_t numSamples = bHasAlphaBlending ? std::max(1u, (uint32_t)round(sample.m_baseColor.a * (float)params.m_numSamples)) : params.m_numSamples;
@@ -725,7 +1755,37 @@ vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceL
 			return Raytrace(rayToLight, bvh, bounceLimit - 1, hit.m_triangleIndex, params, inAcc, 1.0f);
 		}
 
+		const bool bHasAmbient = params.m_ambient.x + params.m_ambient.y + params.m_ambient.z > 0.0f;
+		const uint32_t numExtraSamples = bIsFirstIntersection ? numSamples : 1;
+
 		// Direct lighting
+		if (params.m_numLightSamples > 0)
+		{
+			SAILOR_PROFILE_BLOCK("Direct lighting");
+
+			// The material samples are traced with the indirect lighting only
+			const uint32_t numBsdfSamples = bHasAmbient && bounceLimit > 0 ? numExtraSamples : 0u;
+
+			RaycastHit hitLight{};
+			for (uint32_t i = 0; i < params.m_numLightSamples; i++)
+			{
+				Ray rayToLight{};
+				float maxDistance = 0.0f;
+				vec3 contribution{};
+
+				if (SampleLight(hit.m_point, offset, surface, numBsdfSamples, params, rayToLight, maxDistance, contribution))
+				{
+					t_numTracedRays++;
+					if (!bvh.IntersectBVH(rayToLight, hitLight, 0, maxDistance, hit.m_triangleIndex))
+					{
+						res += contribution;
+					}
+				}
+			}
+
+			SAILOR_PROFILE_END_BLOCK();
+		}
+		else
 		{
 			RaycastHit hitLight{};
 			for (uint32_t i = 0; i < m_directionalLights.Num(); i++)
@@ -733,6 +1793,8 @@ vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceL
 				SAILOR_PROFILE_BLOCK("Direct lighting");
 				const vec3 toLight = -m_directionalLights[i].m_direction;
 				Ray rayToLight(hit.m_point + offset, toLight);
+
+				t_numTracedRays++;
 				if (!bvh.IntersectBVH(rayToLight, hitLight, 0, std::numeric_limits<float>().max(), hit.m_triangleIndex))
 				{
 					const float angle = max(0.0f, glm::dot(toLight, worldNormal));
@@ -743,14 +1805,13 @@ vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceL
 		}
 
 		// Ambient lighting
-		if (params.m_ambient.x + params.m_ambient.y + params.m_ambient.z > 0.0f)
+		if (bHasAmbient)
 		{
 			// Random ray
 			vec3 ambient1 = vec3(0, 0, 0);
 			const float pdfHemisphere = 1.0f / (Pi * 2.0f);
 
 			const uint32_t ambientNumSamples = bIsFirstIntersection ? numAmbientSamples : 1u;
-			const uint32_t numExtraSamples = bIsFirstIntersection ? numSamples : 1;
 
 			// Hemisphere sampling loop
 			if (!bThickVolume)
@@ -819,6 +1880,7 @@ vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceL
 				//vec3 att = TraceSky(rayToLight.GetOrigin(), rayToLight.GetDirection(), bvh, params, environmentIor, hit.m_triangleIndex);
 				//const bool bSkyTraced = length(att) > 0.0f;
 
+				t_numTracedRays++;
 				if (!bvh.IntersectBVH(rayToLight, hitLight, 0, std::numeric_limits<float>().max(), hit.m_triangleIndex))
 				{
 					vec3 value = glm::clamp(term * params.m_ambient, vec3(0, 0, 0), vec3(10, 10, 10));
@@ -846,7 +1908,15 @@ vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceL
 					const float newAcc = inAcc * length(term * lightAttenuation) * sample.m_baseColor.a;
 					if (newAcc > 0.01f)
 					{
-						raytraced = Raytrace(rayToLight, bvh, bounceLimit - 1, hit.m_triangleIndex, params, newAcc, newEnvironmentIor);
+						// The light samples cover the reflected directions only
+						BsdfVertex bsdfVertex{ hit.m_point, worldNormal, 0.0f, numExtraSamples };
+						if (!bTransmissionRay && params.m_numLightSamples > 0)
+						{
+							bsdfVertex.m_pdf = LightingModel::Pdf(sample, worldNormal, viewDirection, direction);
+						}
+
+						raytraced = Raytrace(rayToLight, bvh, bounceLimit - 1, hit.m_triangleIndex, params, newAcc, newEnvironmentIor,
+							bTransmissionRay ? nullptr : &bsdfVertex);
 					}
 
 					vec3 value = glm::clamp(term * lightAttenuation * raytraced, vec3(0, 0, 0), vec3(10, 10, 10));
@@ -888,7 +1958,7 @@ vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceL
 			}
 		}
 
-		res += sample.m_emissive;
+		res += sample.m_emissive * CalculateEmissionWeight(hit, pBsdfVertex, params);
 
 		// Alpha Blending
 		if (bounceLimit > 0 && bHasAlphaBlending)
@@ -914,7 +1984,7 @@ vec3 PathTracer::Raytrace(const Math::Ray& ray, const BVH& bvh, uint32_t bounceL
 	return res;
 }
 
-LightingModel::SampledData PathTracer::GetMaterialData(const size_t& materialIndex, glm::vec2 uv) const
+LightingModel::SampledData PathTracer::GetMaterialData(const size_t& materialIndex, glm::vec2 uv, float footprintLog2) const
 {
 	const auto& material = m_materials[materialIndex];
 
@@ -930,28 +2000,28 @@ LightingModel::SampledData PathTracer::GetMaterialData(const size_t& materialInd
 
 	if (material.HasBaseTexture())
 	{
-		res.m_baseColor *= m_textures[material.m_baseColorIndex]->Sample<vec4>(uv);
+		res.m_baseColor *= m_textures[material.m_baseColorIndex]->Sample<vec4>(uv, footprintLog2);
 	}
 
 	if (material.HasEmissiveTexture())
 	{
-		res.m_emissive *= m_textures[material.m_emissiveIndex]->Sample<vec3>(uv);
+		res.m_emissive *= m_textures[material.m_emissiveIndex]->Sample<vec3>(uv, footprintLog2);
 	}
 
 	if (material.HasMetallicRoughnessTexture())
 	{
-		const vec3 ormSample = m_textures[material.m_metallicRoughnessIndex]->Sample<vec3>(uv);
+		const vec3 ormSample = m_textures[material.m_metallicRoughnessIndex]->Sample<vec3>(uv, footprintLog2);
 		res.m_orm = vec3(ormSample.r, res.m_orm.g * ormSample.g, res.m_orm.b * ormSample.b);
 	}
 
 	if (material.HasNormalTexture())
 	{
-		res.m_normal = m_textures[material.m_normalIndex]->Sample<vec3>(uv);
+		res.m_normal = m_textures[material.m_normalIndex]->Sample<vec3>(uv, footprintLog2);
 	}
 
 	if (material.HasTransmissionTexture())
 	{
-		res.m_transmission *= m_textures[material.m_transmissionIndex]->Sample<vec3>(uv).r;
+		res.m_transmission *= m_textures[material.m_transmissionIndex]->Sample<vec3>(uv, footprintLog2).r;
 	}
 
 	if (material.m_blendMode == BlendMode::Mask)
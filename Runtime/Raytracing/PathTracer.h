@@ -5,8 +5,11 @@
 #include "Containers/Map.h"
 
 #include "BVH.h"
+#include "SceneCache.h"
 #include "MaterialUtils.h"
 #include "LightingModel.h"
+#include "Denoiser.h"
+#include "LightBVH.h"
 
 #include <filesystem>
 
@@ -14,6 +17,9 @@ using namespace Sailor;
 
 namespace Sailor::Raytracing
 {
+	// Error over the time of the light BVH sampling against the loop over the directional lights
+	SAILOR_API void RunLightSamplingBenchmark();
+
 	class PathTracer
 	{
 	public:
@@ -29,6 +35,35 @@ namespace Sailor::Raytracing
 			uint32_t m_maxBounces;
 			uint32_t m_msaa;
 			vec3 m_ambient;
+
+			// 4 or 8 collapses the BVH into the wide one for the secondary rays, 2 keeps the binary BVH,
+			// the primary ray packets walk the binary BVH with any width
+			uint32_t m_bvhWidth = 2;
+
+			// Progressive mode: the passes add one sample per pixel to the accumulation buffer until
+			// the tile converges, m_maxSamples per pixel are taken or the time budget is over.
+			bool m_bProgressive = false;
+			uint32_t m_maxSamples = 0; // 0 means m_msaa
+			float m_timeBudget = 0.0f; // in seconds, 0 means no limit
+			float m_varianceThreshold = 0.01f; // relative standard error of the pixel, 0 disables the adaptive sampling
+			float m_checkpointInterval = 0.0f; // in seconds, 0 means no checkpoints
+
+			// Wavefront mode: the paths of the whole image band are traced bounce by bounce in the bulk stages,
+			// the rays are sorted by the direction octant and the origin and the hits are sorted by the material.
+			// Each sample is the single path, m_msaa * m_numSamples paths per pixel are traced.
+			bool m_bWavefront = false;
+
+			// The imported scene and the BVH are cached under ../Cache/PathTracer/ and mapped by the next runs, opted in by --scene-cache
+			bool m_bUseSceneCache = false;
+
+			// Next event estimation: the directional lights and the emissive triangles are sampled by the light BVH,
+			// m_numLightSamples shadow rays are traced per hit regardless of the number of the lights.
+			// 0 traces one shadow ray per directional light and the emissive surfaces are only hit by the material samples,
+			// as before the light BVH, the sampling is opted in by --light-samples.
+			uint32_t m_numLightSamples = 0;
+
+			// The image is filtered by the a-trous denoiser guided by the albedo, the normal and the depth of the first hits
+			bool m_bDenoise = false;
 		};
 
 		static void ParseCommandLineArgs(Params& params, const char** args, int32_t num);
@@ -37,20 +72,109 @@ namespace Sailor::Raytracing
 
 	protected:
 
+		friend void RunLightSamplingBenchmark();
+
+		// The camera in the world space, so the cached scene needs no Assimp
+		struct Camera
+		{
+			char m_name[128]{};
+			vec3 m_position{};
+			vec3 m_up{};
+			vec3 m_forward{};
+			float m_aspectRatio = 0.0f;
+			float m_hFov = 0.0f;
+		};
+
+		struct TextureHeader
+		{
+			bool m_bValid = false;
+			uint8_t m_channels = 0;
+			SamplerClamping m_clamping = SamplerClamping::Clamp;
+			TextureFormat m_format = TextureFormat::Float;
+			bool m_bMipmapped = false;
+			int32_t m_width = 0;
+			int32_t m_height = 0;
+		};
+
+		// The shading frame and the material at the hit point
+		struct SurfacePoint
+		{
+			LightingModel::SampledData m_sample;
+			vec3 m_faceNormal;
+			vec3 m_worldNormal;
+			vec3 m_viewDirection;
+			bool m_bIsOppositeRay;
+		};
+
+		// The vertex that sampled the ray by the material, the emission of the hit is weighted against the light samples of the vertex
+		struct BsdfVertex
+		{
+			vec3 m_point;
+			vec3 m_normal;
+			float m_pdf;
+			uint32_t m_numSamples;
+		};
+
+		struct Viewport
+		{
+			vec3 m_cameraPos;
+			vec3 m_pixel00Dir;
+			vec3 m_pixelDeltaU;
+			vec3 m_pixelDeltaV;
+			uint32_t m_width;
+			uint32_t m_height;
+		};
+
+		bool ImportScene(const Params& params, TVector<Camera>& outCameras, TVector<std::filesystem::path>& outDependencies);
+		bool LoadSceneCache(const Params& params, TVector<Camera>& outCameras, BVH& outBvh);
+		void SaveSceneCache(const Params& params, const TVector<Camera>& cameras, const BVH& bvh, const TVector<std::filesystem::path>& dependencies);
+		static uint64_t GetSceneCacheLayoutHash();
+
+		// outAovs receives the first hits of the first pass, if not null
+		void RenderProgressive(const Params& params, const BVH& bvh, const Viewport& viewport, CombinedSampler2D& outputTex, DenoiserAOVs* outAovs = nullptr) const;
+		// Returns the number of the traced rays, outAovs receives the first hits of the first sample, if not null
+		uint64_t RenderWavefront(const Params& params, const BVH& bvh, const Viewport& viewport, CombinedSampler2D& outputTex, DenoiserAOVs* outAovs = nullptr) const;
+		static void WriteImage(const Params& params, const CombinedSampler2D& outputTex);
+
+		// The guide buffers of the denoiser are written from the primary hits of the pixel samples,
+		// so the albedo, the normal and the depth match the subpixel samples of the color
+		void WriteAOVs(const Math::Ray* rays, const Math::RaycastHit* hits, uint32_t numSamples, size_t pixel, DenoiserAOVs& outAovs) const;
+
 		static vec2 NextVec2_BlueNoise(uint32_t& randSeedX, uint32_t& randSeedY);
 		__forceinline static vec2 NextVec2_Linear();
 
-		__forceinline LightingModel::SampledData GetMaterialData(const size_t& materialIndex, glm::vec2 uv) const;
+		// footprintLog2 is the ray cone footprint in the uv space, selects the texture mips
+		__forceinline LightingModel::SampledData GetMaterialData(const size_t& materialIndex, glm::vec2 uv, float footprintLog2 = -std::numeric_limits<float>::infinity()) const;
+
+
+		SurfacePoint GetSurfacePoint(const Math::Ray& ray, const Math::RaycastHit& hit) const;
 
+		void BuildLightBVH();
+
+		// Chooses the light for the next event estimation, the shadow ray is traced by the caller.
+		// numBsdfSamples is the number of the material samples from the point that could hit the emissive triangles.
+		bool SampleLight(const vec3& point, const vec3& offset, const SurfacePoint& surface, uint32_t numBsdfSamples, const Params& params,
+			Math::Ray& outShadowRay, float& outMaxDistance, vec3& outContribution) const;
+
+		// The multiple importance sampling weight of the emission hit by the material sample
+		float CalculateEmissionWeight(const Math::RaycastHit& hit, const BsdfVertex* pBsdfVertex, const Params& params) const;
 
 		vec3 TraceSky(vec3 startPoint, vec3 toLight, const BVH& bvh, const PathTracer::Params& params, float currentIor, uint32_t ignoreTriangle) const;
-		vec3 Raytrace(const Math::Ray& r, const BVH& bvh, uint32_t bounceLimit, uint32_t ignoreTriangle, const Params& params, float inAcc, float environmentIor = 1.0f) const;
+		vec3 Raytrace(const Math::Ray& r, const BVH& bvh, uint32_t bounceLimit, uint32_t ignoreTriangle, const Params& params, float inAcc, float environmentIor = 1.0f, const BsdfVertex* pBsdfVertex = nullptr) const;
+		vec3 Shade(const Math::Ray& r, const Math::RaycastHit& hit, const BVH& bvh, uint32_t bounceLimit, const Params& params, float inAcc, float environmentIor = 1.0f, const BsdfVertex* pBsdfVertex = nullptr) const;
 
 
 		TVector<DirectionalLight> m_directionalLights{};
+		LightBVH m_lightBvh{};
 		TVector<Math::Triangle> m_triangles{};
 		TVector<Material> m_materials{};
 		TVector<TSharedPtr<CombinedSampler2D>> m_textures{};
 		TMap<std::string, uint32_t> m_textureMapping{};
+
+		// The angle between the primary rays of the neighbour pixels, the spread of the ray cones
+		float m_pixelSpreadAngle = 0.0f;
+
+		// The textures loaded from the cache point into the mapped memory
+		SceneCache m_sceneCache{};
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,276 @@
+#include "SceneCache.h"
+#include "Core/Utils.h"
+#include "Core/LogMacros.h"
+#include "AssetRegistry/AssetRegistry.h"
+
+#include <windows.h>
+
+using namespace Sailor;
+using namespace Sailor::Raytracing;
+
+SceneCache::~SceneCache()
+{
+	Close();
+}
+
+std::filesystem::path SceneCache::GetCacheFilepath(const std::filesystem::path& model)
+{
+	const size_t pathHash = std::hash<std::string>{}(std::filesystem::absolute(model).string());
+
+	char filename[512];
+	sprintf_s(filename, "%s_%016llx.scene", model.stem().string().c_str(), (unsigned long long)pathHash);
+
+	return std::filesystem::path(AssetRegistry::CacheRootFolder) / "PathTracer" / filename;
+}
+
+bool SceneCache::CalculateFileHash(const std::filesystem::path& filepath, uint64_t& outHash)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	TVector<char> content;
+	if (!AssetRegistry::ReadBinaryFile(filepath, content))
+	{
+		return false;
+	}
+
+	outHash = std::hash<std::string_view>{}(std::string_view(content.GetData(), content.Num()));
+	return true;
+}
+
+bool SceneCache::Open(const std::filesystem::path& model, uint64_t layoutHash)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	Close();
+
+	const std::filesystem::path cacheFilepath = GetCacheFilepath(model);
+	if (!std::filesystem::exists(cacheFilepath))
+	{
+		return false;
+	}
+
+	HANDLE hFile = ::CreateFileW(cacheFilepath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	m_hFile = hFile;
+
+	LARGE_INTEGER fileSize{};
+	if (!::GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(Header))
+	{
+		Close();
+		return false;
+	}
+
+	m_hMapping = ::CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_hMapping)
+	{
+		Close();
+		return false;
+	}
+
+	m_pMapped = reinterpret_cast<const uint8_t*>(::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (!m_pMapped)
+	{
+		Close();
+		return false;
+	}
+
+	m_mappedSize = (size_t)fileSize.QuadPart;
+	m_readOffset = sizeof(Header);
+	m_bFailed = false;
+
+	const Header& header = *reinterpret_cast<const Header*>(m_pMapped);
+	if (header.m_magic != Magic ||
+		header.m_version != Version ||
+		header.m_layoutHash != layoutHash ||
+		header.m_fileSize != m_mappedSize)
+	{
+		SAILOR_LOG("Scene cache %s is outdated", cacheFilepath.string().c_str());
+		Close();
+		return false;
+	}
+
+	size_t numDependencies = 0;
+	const Dependency* dependencies = Map<Dependency>(numDependencies);
+	if (!dependencies || numDependencies != header.m_numDependencies)
+	{
+		Close();
+		return false;
+	}
+
+	for (size_t i = 0; i < numDependencies; i++)
+	{
+		const Dependency& dependency = dependencies[i];
+		const std::filesystem::path filepath(dependency.m_path);
+
+		if (!std::filesystem::exists(filepath))
+		{
+			SAILOR_LOG("Scene cache %s is outdated, %s is missing", cacheFilepath.string().c_str(), dependency.m_path);
+			Close();
+			return false;
+		}
+
+		if (Utils::GetFileModificationTime(filepath.string()) == dependency.m_timestamp)
+		{
+			continue;
+		}
+
+		// The file is touched, but the content could be the same
+		uint64_t hash = 0;
+		if (!CalculateFileHash(filepath, hash) || hash != dependency.m_hash)
+		{
+			SAILOR_LOG("Scene cache %s is outdated, %s is changed", cacheFilepath.string().c_str(), dependency.m_path);
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SceneCache::Close()
+{
+	if (m_pMapped)
+	{
+		::UnmapViewOfFile(m_pMapped);
+		m_pMapped = nullptr;
+	}
+
+	if (m_hMapping)
+	{
+		::CloseHandle(m_hMapping);
+		m_hMapping = nullptr;
+	}
+
+	if (m_hFile)
+	{
+		::CloseHandle(m_hFile);
+		m_hFile = nullptr;
+	}
+
+	m_mappedSize = 0;
+	m_readOffset = 0;
+	m_bFailed = false;
+}
+
+const uint8_t* SceneCache::ReadChunk(size_t& outSize)
+{
+	outSize = 0;
+
+	if (!IsValid() || m_readOffset + ChunkAlignment > m_mappedSize)
+	{
+		m_bFailed = true;
+		return nullptr;
+	}
+
+	const uint64_t size = *reinterpret_cast<const uint64_t*>(m_pMapped + m_readOffset);
+	const size_t dataOffset = m_readOffset + ChunkAlignment;
+
+	if (size > m_mappedSize - dataOffset)
+	{
+		m_bFailed = true;
+		return nullptr;
+	}
+
+	m_readOffset = dataOffset + ((size + ChunkAlignment - 1) & ~(ChunkAlignment - 1));
+	outSize = (size_t)size;
+
+	return m_pMapped + dataOffset;
+}
+
+void SceneCache::WriteChunk(const uint8_t* data, size_t size)
+{
+	// The size is followed by the padding, so the data is aligned
+	const size_t offset = m_writeBuffer.Num();
+	const size_t alignedSize = (size + ChunkAlignment - 1) & ~(ChunkAlignment - 1);
+
+	m_writeBuffer.AddDefault(ChunkAlignment + alignedSize);
+	memset(m_writeBuffer.GetData() + offset, 0, ChunkAlignment + alignedSize);
+
+	const uint64_t size64 = size;
+	memcpy(m_writeBuffer.GetData() + offset, &size64, sizeof(size64));
+
+	if (size > 0)
+	{
+		memcpy(m_writeBuffer.GetData() + offset + ChunkAlignment, data, size);
+	}
+}
+
+bool SceneCache::Save(const std::filesystem::path& model, const TVector<std::filesystem::path>& dependencies, uint64_t layoutHash)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	TVector<uint8_t> chunks = std::move(m_writeBuffer);
+	m_writeBuffer.Clear();
+
+	TVector<Dependency> records;
+	records.Reserve(dependencies.Num() + 1);
+
+	auto addDependency = [&](const std::filesystem::path& filepath)
+		{
+			const std::string absolutePath = std::filesystem::absolute(filepath).string();
+
+			Dependency record{};
+			if (absolutePath.size() >= sizeof(record.m_path) || !CalculateFileHash(absolutePath, record.m_hash))
+			{
+				return false;
+			}
+
+			memcpy(record.m_path, absolutePath.c_str(), absolutePath.size());
+			record.m_timestamp = Utils::GetFileModificationTime(absolutePath);
+
+			records.Add(record);
+			return true;
+		};
+
+	if (!addDependency(model))
+	{
+		return false;
+	}
+
+	for (const auto& dependency : dependencies)
+	{
+		if (!addDependency(dependency))
+		{
+			return false;
+		}
+	}
+
+	Write(records);
+
+	Header header{};
+	header.m_layoutHash = layoutHash;
+	header.m_numDependencies = (uint32_t)records.Num();
+	header.m_fileSize = sizeof(Header) + m_writeBuffer.Num() + chunks.Num();
+
+	TVector<uint8_t> file;
+	file.AddDefault(header.m_fileSize);
+
+	memcpy(file.GetData(), &header, sizeof(Header));
+	memcpy(file.GetData() + sizeof(Header), m_writeBuffer.GetData(), m_writeBuffer.Num());
+	memcpy(file.GetData() + sizeof(Header) + m_writeBuffer.Num(), chunks.GetData(), chunks.Num());
+
+	m_writeBuffer.Clear();
+
+	// The renders of the same scene could run in parallel, so the cache is written aside and then renamed
+	const std::filesystem::path cacheFilepath = GetCacheFilepath(model);
+	std::filesystem::path tempFilepath = cacheFilepath;
+	tempFilepath += "." + std::to_string(::GetCurrentProcessId()) + ".tmp";
+
+	std::error_code error;
+	std::filesystem::create_directories(cacheFilepath.parent_path(), error);
+
+	AssetRegistry::WriteBinaryFile(tempFilepath, file);
+	std::filesystem::rename(tempFilepath, cacheFilepath, error);
+
+	if (error)
+	{
+		std::filesystem::remove(tempFilepath, error);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Containers/Vector.h"
+
+#include <filesystem>
+
+using namespace Sailor;
+
+namespace Sailor::Raytracing
+{
+	/* Versioned binary cache of the imported scene for the PathTracer.
+	*  The file is the header, the list of the source files with their timestamps and hashes and the chunks of POD data.
+	*  The chunks are 16-byte aligned, so the file is mapped into the memory and read in place without any parsing.
+	*  The cache is invalidated when the version or the data layout changes, or when any source file is changed:
+	*  the timestamps are checked first and the content hashes decide when the timestamps differ.
+	*/
+	class SceneCache
+	{
+	public:
+
+		static constexpr uint32_t Version = 2;
+
+		SceneCache() = default;
+		~SceneCache();
+
+		SceneCache(const SceneCache&) = delete;
+		SceneCache& operator=(const SceneCache&) = delete;
+
+		// ../Cache/PathTracer/<model name>_<path hash>.scene
+		static std::filesystem::path GetCacheFilepath(const std::filesystem::path& model);
+
+		// Maps the cache of the model, returns false if it is missing or outdated
+		bool Open(const std::filesystem::path& model, uint64_t layoutHash);
+		void Close();
+
+		// Reading is sequential, the read fails without touching the memory when the chunk is missing or the size mismatches
+		bool IsValid() const { return m_pMapped != nullptr && !m_bFailed; }
+
+		// The view into the mapped memory, valid while the cache is opened
+		template<typename T>
+		const T* Map(size_t& outNum)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+
+			size_t size = 0;
+			const uint8_t* data = ReadChunk(size);
+
+			if (!data || size % sizeof(T) != 0)
+			{
+				m_bFailed = true;
+				outNum = 0;
+				return nullptr;
+			}
+
+			outNum = size / sizeof(T);
+			return reinterpret_cast<const T*>(data);
+		}
+
+		template<typename T>
+		bool Read(TVector<T>& outData)
+		{
+			size_t num = 0;
+			const T* data = Map<T>(num);
+
+			outData.Clear();
+			if (data)
+			{
+				outData.AddDefault(num);
+				memcpy(outData.GetData(), data, num * sizeof(T));
+			}
+
+			return IsValid();
+		}
+
+		template<typename T>
+		bool Read(T& outValue)
+		{
+			size_t num = 0;
+			const T* data = Map<T>(num);
+
+			if (!data || num != 1)
+			{
+				m_bFailed = true;
+				return false;
+			}
+
+			outValue = *data;
+			return true;
+		}
+
+		// Writing collects the chunks in memory, Save writes the file
+		template<typename T>
+		void Write(const T* data, size_t num)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			WriteChunk(reinterpret_cast<const uint8_t*>(data), num * sizeof(T));
+		}
+
+		template<typename T>
+		void Write(const TVector<T>& data) { Write(data.GetData(), data.Num()); }
+
+		template<typename T>
+		void Write(const T& value) { Write(&value, 1); }
+
+		// The model is always the dependency, the textures and the buffers are passed in dependencies
+		bool Save(const std::filesystem::path& model, const TVector<std::filesystem::path>& dependencies, uint64_t layoutHash);
+
+	protected:
+
+		static constexpr uint32_t Magic = 0x43535053; // 'SPSC'
+		static constexpr size_t ChunkAlignment = 16;
+
+		struct Header
+		{
+			uint32_t m_magic = Magic;
+			uint32_t m_version = Version;
+			uint64_t m_layoutHash = 0;
+			uint64_t m_fileSize = 0;
+			uint32_t m_numDependencies = 0;
+			uint32_t m_padding = 0;
+		};
+
+		struct Dependency
+		{
+			char m_path[260]{};
+			int64_t m_timestamp = 0;
+			uint64_t m_hash = 0;
+		};
+
+		const uint8_t* ReadChunk(size_t& outSize);
+		void WriteChunk(const uint8_t* data, size_t size);
+
+		static bool CalculateFileHash(const std::filesystem::path& filepath, uint64_t& outHash);
+
+		// The mapping
+		void* m_hFile = nullptr;
+		void* m_hMapping = nullptr;
+		const uint8_t* m_pMapped = nullptr;
+		size_t m_mappedSize = 0;
+		size_t m_readOffset = 0;
+		bool m_bFailed = false;
+
+		TVector<uint8_t> m_writeBuffer;
+	};
+}
@@ -0,0 +1,507 @@
+#include "TLAS.h"
+#include "Tasks/ParallelFor.h"
+#include "Core/LogMacros.h"
+#include "glm/glm/glm.hpp"
+#include "Math/Math.h"
+
+using namespace Sailor;
+using namespace Sailor::Math;
+using namespace Sailor::Raytracing;
+
+namespace
+{
+	// Arvo's transform of the box, no temporary points
+	Math::AABB TransformAABB(const Math::AABB& aabb, const glm::mat4& matrix)
+	{
+		const vec3 center = vec3(matrix * vec4(aabb.GetCenter(), 1.0f));
+		const vec3 extents = aabb.GetExtents();
+
+		vec3 worldExtents{};
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			worldExtents[i] = glm::abs(matrix[0][i]) * extents.x + glm::abs(matrix[1][i]) * extents.y + glm::abs(matrix[2][i]) * extents.z;
+		}
+
+		Math::AABB res{};
+		res.m_min = center - worldExtents;
+		res.m_max = center + worldExtents;
+		return res;
+	}
+
+	float HalfArea(const vec3& aabbMin, const vec3& aabbMax)
+	{
+		const vec3 e = glm::max(aabbMax - aabbMin, vec3(0.0f));
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+}
+
+uint32_t TLAS::AddInstance(TSharedPtr<BVH> blas, const glm::mat4& worldMatrix, uint32_t userData)
+{
+	uint32_t instance = 0;
+	if (m_freeInstances.Num() > 0)
+	{
+		instance = m_freeInstances[m_freeInstances.Num() - 1];
+		m_freeInstances.RemoveLast();
+	}
+	else
+	{
+		instance = (uint32_t)m_instances.Emplace();
+	}
+
+	m_instances[instance].m_userData = userData;
+	UpdateInstance(instance, std::move(blas), worldMatrix);
+
+	m_bShouldRebuild = true;
+
+	return instance;
+}
+
+void TLAS::UpdateInstance(uint32_t instance, const glm::mat4& worldMatrix)
+{
+	Instance& inst = m_instances[instance];
+
+	inst.m_worldMatrix = worldMatrix;
+	inst.m_invWorldMatrix = glm::inverse(worldMatrix);
+	inst.m_worldBounds = inst.m_blas ? TransformAABB(inst.m_blas->GetBounds(), worldMatrix) : Math::AABB();
+
+	m_bIsDirty = true;
+}
+
+void TLAS::UpdateInstance(uint32_t instance, TSharedPtr<BVH> blas, const glm::mat4& worldMatrix)
+{
+	// The instances without the BLAS are excluded from the tree
+	if (m_instances[instance].m_blas.IsValid() != blas.IsValid())
+	{
+		m_bShouldRebuild = true;
+	}
+
+	m_instances[instance].m_blas = std::move(blas);
+	UpdateInstance(instance, worldMatrix);
+}
+
+void TLAS::RemoveInstance(uint32_t instance)
+{
+	m_instances[instance] = Instance();
+	m_freeInstances.Add(instance);
+
+	m_bShouldRebuild = true;
+}
+
+void TLAS::Update()
+{
+	if (m_bShouldRebuild)
+	{
+		Build();
+	}
+	else if (m_bIsDirty)
+	{
+		Refit();
+	}
+}
+
+void TLAS::Build()
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	m_instanceIdx.Clear(false);
+	for (uint32_t i = 0; i < m_instances.Num(); i++)
+	{
+		if (m_instances[i].m_blas)
+		{
+			m_instanceIdx.Add(i);
+		}
+	}
+
+	m_bShouldRebuild = false;
+	m_bIsDirty = false;
+
+	const uint32_t numInstances = (uint32_t)m_instanceIdx.Num();
+	if (numInstances == 0)
+	{
+		m_nodesUsed = 0;
+		m_builtCost = 0.0f;
+		return;
+	}
+
+	m_nodes.Clear(false);
+	m_nodes.AddDefault(2 * numInstances - 1);
+
+	Node& root = m_nodes[0];
+	root.m_leftFirst = 0;
+	root.m_count = numInstances;
+	m_nodesUsed = 1;
+
+	UpdateNodeBounds(0);
+	Subdivide(0);
+
+	m_builtCost = CalculateSAHCost();
+}
+
+void TLAS::Refit()
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	m_bIsDirty = false;
+
+	// The children are always allocated after the parent
+	for (int32_t i = (int32_t)m_nodesUsed - 1; i >= 0; i--)
+	{
+		Node& node = m_nodes[i];
+		if (node.IsLeaf())
+		{
+			UpdateNodeBounds(i);
+			continue;
+		}
+
+		const Node& left = m_nodes[node.m_leftFirst];
+		const Node& right = m_nodes[node.m_leftFirst + 1];
+
+		node.m_aabbMin = glm::min(left.m_aabbMin, right.m_aabbMin);
+		node.m_aabbMax = glm::max(left.m_aabbMax, right.m_aabbMax);
+	}
+
+	// The instances moved too far from the initial positions
+	if (CalculateSAHCost() > m_builtCost * RebuildCostFactor)
+	{
+		Build();
+	}
+}
+
+void TLAS::UpdateNodeBounds(uint32_t nodeIdx)
+{
+	Node& node = m_nodes[nodeIdx];
+	node.m_aabbMin = vec3(std::numeric_limits<float>::max());
+	node.m_aabbMax = vec3(-std::numeric_limits<float>::max());
+
+	for (uint32_t i = 0; i < node.m_count; i++)
+	{
+		const Instance& instance = m_instances[m_instanceIdx[node.m_leftFirst + i]];
+
+		node.m_aabbMin = glm::min(node.m_aabbMin, instance.m_worldBounds.m_min);
+		node.m_aabbMax = glm::max(node.m_aabbMax, instance.m_worldBounds.m_max);
+	}
+}
+
+void TLAS::Subdivide(uint32_t nodeIdx)
+{
+	Node& node = m_nodes[nodeIdx];
+	if (node.m_count <= MaxInstancesInLeaf)
+	{
+		return;
+	}
+
+	vec3 centroidMin = vec3(std::numeric_limits<float>::max());
+	vec3 centroidMax = vec3(-std::numeric_limits<float>::max());
+	for (uint32_t i = 0; i < node.m_count; i++)
+	{
+		const vec3 centroid = m_instances[m_instanceIdx[node.m_leftFirst + i]].m_worldBounds.GetCenter();
+		centroidMin = glm::min(centroidMin, centroid);
+		centroidMax = glm::max(centroidMax, centroid);
+	}
+
+	// Binned SAH over the centroids of the instances
+	int32_t bestAxis = -1;
+	float bestPos = 0.0f;
+	float bestCost = std::numeric_limits<float>::max();
+
+	for (int32_t axis = 0; axis < 3; axis++)
+	{
+		const float extent = centroidMax[axis] - centroidMin[axis];
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		struct Bin
+		{
+			vec3 m_aabbMin = vec3(std::numeric_limits<float>::max());
+			vec3 m_aabbMax = vec3(-std::numeric_limits<float>::max());
+			uint32_t m_count = 0;
+		} bins[NumBins];
+
+		const float scale = NumBins / extent;
+		for (uint32_t i = 0; i < node.m_count; i++)
+		{
+			const Math::AABB& bounds = m_instances[m_instanceIdx[node.m_leftFirst + i]].m_worldBounds;
+			const uint32_t binIdx = (std::min)(NumBins - 1, (uint32_t)((bounds.GetCenter()[axis] - centroidMin[axis]) * scale));
+
+			bins[binIdx].m_count++;
+			bins[binIdx].m_aabbMin = glm::min(bins[binIdx].m_aabbMin, bounds.m_min);
+			bins[binIdx].m_aabbMax = glm::max(bins[binIdx].m_aabbMax, bounds.m_max);
+		}
+
+		float leftArea[NumBins - 1], rightArea[NumBins - 1];
+		uint32_t leftCount[NumBins - 1], rightCount[NumBins - 1];
+
+		Bin left, right;
+		for (uint32_t i = 0; i < NumBins - 1; i++)
+		{
+			left.m_count += bins[i].m_count;
+			left.m_aabbMin = glm::min(left.m_aabbMin, bins[i].m_aabbMin);
+			left.m_aabbMax = glm::max(left.m_aabbMax, bins[i].m_aabbMax);
+			leftCount[i] = left.m_count;
+			leftArea[i] = HalfArea(left.m_aabbMin, left.m_aabbMax);
+
+			const uint32_t j = NumBins - 1 - i;
+			right.m_count += bins[j].m_count;
+			right.m_aabbMin = glm::min(right.m_aabbMin, bins[j].m_aabbMin);
+			right.m_aabbMax = glm::max(right.m_aabbMax, bins[j].m_aabbMax);
+			rightCount[j - 1] = right.m_count;
+			rightArea[j - 1] = HalfArea(right.m_aabbMin, right.m_aabbMax);
+		}
+
+		for (uint32_t i = 0; i < NumBins - 1; i++)
+		{
+			const float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+			if (leftCount[i] > 0 && rightCount[i] > 0 && cost < bestCost)
+			{
+				bestAxis = axis;
+				bestPos = centroidMin[axis] + extent * (i + 1) / NumBins;
+				bestCost = cost;
+			}
+		}
+	}
+
+	// All centroids are in the same point or the split is not profitable
+	if (bestAxis == -1 || bestCost >= node.m_count * HalfArea(node.m_aabbMin, node.m_aabbMax))
+	{
+		return;
+	}
+
+	int32_t i = node.m_leftFirst;
+	int32_t j = i + node.m_count - 1;
+	while (i <= j)
+	{
+		if (m_instances[m_instanceIdx[i]].m_worldBounds.GetCenter()[bestAxis] < bestPos)
+		{
+			i++;
+		}
+		else
+		{
+			std::swap(m_instanceIdx[i], m_instanceIdx[j--]);
+		}
+	}
+
+	const uint32_t leftCount = i - node.m_leftFirst;
+	if (leftCount == 0 || leftCount == node.m_count)
+	{
+		return;
+	}
+
+	const uint32_t leftChildIdx = m_nodesUsed;
+	m_nodesUsed += 2;
+
+	m_nodes[leftChildIdx].m_leftFirst = node.m_leftFirst;
+	m_nodes[leftChildIdx].m_count = leftCount;
+	m_nodes[leftChildIdx + 1].m_leftFirst = i;
+	m_nodes[leftChildIdx + 1].m_count = node.m_count - leftCount;
+
+	node.m_leftFirst = leftChildIdx;
+	node.m_count = 0;
+
+	UpdateNodeBounds(leftChildIdx);
+	UpdateNodeBounds(leftChildIdx + 1);
+
+	Subdivide(leftChildIdx);
+	Subdivide(leftChildIdx + 1);
+}
+
+float TLAS::CalculateSAHCost() const
+{
+	if (m_nodesUsed == 0)
+	{
+		return 0.0f;
+	}
+
+	const float rootArea = HalfArea(m_nodes[0].m_aabbMin, m_nodes[0].m_aabbMax);
+	if (rootArea <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	float cost = 0.0f;
+	for (uint32_t i = 0; i < m_nodesUsed; i++)
+	{
+		const Node& node = m_nodes[i];
+		cost += HalfArea(node.m_aabbMin, node.m_aabbMax) / rootArea * (node.IsLeaf() ? node.m_count : 1.0f);
+	}
+
+	return cost;
+}
+
+Math::Ray TLAS::TransformRay(const Math::Ray& ray, const glm::mat4& matrix)
+{
+	// The direction is not normalized, so the distance along the ray is the same in both spaces
+	return Math::Ray(vec3(matrix * vec4(ray.GetOrigin(), 1.0f)), glm::mat3(matrix) * ray.GetDirection());
+}
+
+bool TLAS::Raycast(const Math::Ray& ray, Math::RaycastHit& outResult, uint32_t& outInstance, float maxRayLength) const
+{
+	outResult = Math::RaycastHit();
+	outInstance = InvalidInstance;
+
+	if (m_nodesUsed == 0 || IntersectRayAABB(ray, m_nodes[0].m_aabbMin, m_nodes[0].m_aabbMax, maxRayLength) == std::numeric_limits<float>::max())
+	{
+		return false;
+	}
+
+	const Node* node = &m_nodes[0], * stack[64];
+	uint32_t stackPtr = 0;
+
+	uint32_t closestInstance = InvalidInstance;
+
+	while (1)
+	{
+		if (node->IsLeaf())
+		{
+			for (uint32_t i = 0; i < node->m_count; i++)
+			{
+				const uint32_t instanceIdx = m_instanceIdx[node->m_leftFirst + i];
+				const Instance& instance = m_instances[instanceIdx];
+
+				Math::RaycastHit hit;
+				if (instance.m_blas->IntersectBVH(TransformRay(ray, instance.m_invWorldMatrix), hit, 0, maxRayLength))
+				{
+					outResult = hit;
+					maxRayLength = hit.m_rayLenght;
+					closestInstance = instanceIdx;
+				}
+			}
+
+			if (stackPtr == 0)
+			{
+				break;
+			}
+
+			node = stack[--stackPtr];
+			continue;
+		}
+
+		const Node* child1 = &m_nodes[node->m_leftFirst];
+		const Node* child2 = &m_nodes[node->m_leftFirst + 1];
+
+		float dist1 = IntersectRayAABB(ray, child1->m_aabbMin, child1->m_aabbMax, maxRayLength);
+		float dist2 = IntersectRayAABB(ray, child2->m_aabbMin, child2->m_aabbMax, maxRayLength);
+
+		if (dist1 > dist2)
+		{
+			std::swap(dist1, dist2);
+			std::swap(child1, child2);
+		}
+
+		if (dist1 == std::numeric_limits<float>::max())
+		{
+			if (stackPtr == 0)
+			{
+				break;
+			}
+
+			node = stack[--stackPtr];
+		}
+		else
+		{
+			node = child1;
+			if (dist2 != std::numeric_limits<float>::max())
+			{
+				stack[stackPtr++] = child2;
+			}
+		}
+	}
+
+	if (closestInstance == InvalidInstance)
+	{
+		return false;
+	}
+
+	// Back to the world space
+	const Instance& instance = m_instances[closestInstance];
+	outResult.m_point = ray.GetOrigin() + ray.GetDirection() * outResult.m_rayLenght;
+	outResult.m_normal = glm::normalize(glm::transpose(glm::mat3(instance.m_invWorldMatrix)) * outResult.m_normal);
+	outInstance = instance.m_userData;
+
+	return true;
+}
+
+bool TLAS::RaycastAny(const Math::Ray& ray, float maxRayLength) const
+{
+	if (m_nodesUsed == 0 || IntersectRayAABB(ray, m_nodes[0].m_aabbMin, m_nodes[0].m_aabbMax, maxRayLength) == std::numeric_limits<float>::max())
+	{
+		return false;
+	}
+
+	const Node* node = &m_nodes[0], * stack[64];
+	uint32_t stackPtr = 0;
+
+	while (1)
+	{
+		if (node->IsLeaf())
+		{
+			for (uint32_t i = 0; i < node->m_count; i++)
+			{
+				const Instance& instance = m_instances[m_instanceIdx[node->m_leftFirst + i]];
+				if (instance.m_blas->IntersectAnyBVH(TransformRay(ray, instance.m_invWorldMatrix), maxRayLength))
+				{
+					return true;
+				}
+			}
+
+			if (stackPtr == 0)
+			{
+				return false;
+			}
+
+			node = stack[--stackPtr];
+			continue;
+		}
+
+		const Node* child1 = &m_nodes[node->m_leftFirst];
+		const Node* child2 = &m_nodes[node->m_leftFirst + 1];
+
+		const bool bHit1 = IntersectRayAABB(ray, child1->m_aabbMin, child1->m_aabbMax, maxRayLength) != std::numeric_limits<float>::max();
+		const bool bHit2 = IntersectRayAABB(ray, child2->m_aabbMin, child2->m_aabbMax, maxRayLength) != std::numeric_limits<float>::max();
+
+		if (bHit1 && bHit2)
+		{
+			stack[stackPtr++] = child2;
+			node = child1;
+		}
+		else if (bHit1 || bHit2)
+		{
+			node = bHit1 ? child1 : child2;
+		}
+		else if (stackPtr == 0)
+		{
+			return false;
+		}
+		else
+		{
+			node = stack[--stackPtr];
+		}
+	}
+}
+
+void TLAS::Raycast(const Math::Ray* rays, size_t numRays, Math::RaycastHit* outResults, uint32_t* outInstances, float maxRayLength) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	Tasks::ParallelFor("TLAS Raycast", 0, numRays, RaycastGrainSize, [&](size_t i)
+		{
+			uint32_t instance = InvalidInstance;
+			Raycast(rays[i], outResults[i], instance, maxRayLength);
+
+			if (outInstances)
+			{
+				outInstances[i] = instance;
+			}
+		});
+}
+
+void TLAS::RaycastAny(const Math::Ray* rays, size_t numRays, bool* outOccluded, float maxRayLength) const
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	Tasks::ParallelFor("TLAS RaycastAny", 0, numRays, RaycastGrainSize, [&](size_t i)
+		{
+			outOccluded[i] = RaycastAny(rays[i], maxRayLength);
+		});
+}
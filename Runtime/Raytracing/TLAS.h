@@ -0,0 +1,95 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Math/Bounds.h"
+#include "Containers/Vector.h"
+#include "Memory/SharedPtr.hpp"
+#include "BVH.h"
+
+using namespace Sailor;
+
+namespace Sailor::Raytracing
+{
+	/* Two-level acceleration structure for the runtime raycast queries.
+	*  The bottom level is the BVH of the model built once in the model space and shared between the instances,
+	*  the top level is the BVH over the world bounds of the instances.
+	*  The moved instances only refit the bounds of the top level nodes, the tree is rebuilt
+	*  when the instances are added/removed or when the refitted tree is much worse than the built one.
+	*  The owner adds and removes the instances, StaticMeshRendererECS keeps only the Static and Stationary
+	*  objects with the BLAS, the Dynamic objects are not in the tree.
+	*/
+	class TLAS
+	{
+		struct Node // 32 bytes
+		{
+			vec3 m_aabbMin;
+			uint32_t m_leftFirst;
+			vec3 m_aabbMax;
+			uint32_t m_count;
+
+			bool IsLeaf() const { return m_count > 0; }
+		};
+
+	public:
+
+		static constexpr uint32_t InvalidInstance = (uint32_t)(-1);
+
+		struct Instance
+		{
+			TSharedPtr<BVH> m_blas;
+			glm::mat4 m_worldMatrix{ 1.0f };
+			glm::mat4 m_invWorldMatrix{ 1.0f };
+			Math::AABB m_worldBounds{};
+			uint32_t m_userData = 0;
+		};
+
+		uint32_t AddInstance(TSharedPtr<BVH> blas, const glm::mat4& worldMatrix, uint32_t userData);
+		void UpdateInstance(uint32_t instance, const glm::mat4& worldMatrix);
+		void UpdateInstance(uint32_t instance, TSharedPtr<BVH> blas, const glm::mat4& worldMatrix);
+		void RemoveInstance(uint32_t instance);
+
+		const Instance& GetInstance(uint32_t instance) const { return m_instances[instance]; }
+		size_t GetNumInstances() const { return m_instances.Num() - m_freeInstances.Num(); }
+
+		// Should be called after the instances are changed and before the queries,
+		// the queries are read only and could run from any number of threads in between.
+		void Update();
+
+		void Build();
+		void Refit();
+
+		// outInstances receives the user data of the hit instances, the hits are in the world space.
+		// The direction of the ray is not normalized, so the distance is measured in the lengths of the direction.
+		bool Raycast(const Math::Ray& ray, Math::RaycastHit& outResult, uint32_t& outInstance, float maxRayLength = std::numeric_limits<float>::max()) const;
+		bool RaycastAny(const Math::Ray& ray, float maxRayLength = std::numeric_limits<float>::max()) const;
+
+		// The batches are split between the worker threads
+		void Raycast(const Math::Ray* rays, size_t numRays, Math::RaycastHit* outResults, uint32_t* outInstances = nullptr, float maxRayLength = std::numeric_limits<float>::max()) const;
+		void RaycastAny(const Math::Ray* rays, size_t numRays, bool* outOccluded, float maxRayLength = std::numeric_limits<float>::max()) const;
+
+	protected:
+
+		static constexpr uint32_t NumBins = 8;
+		static constexpr uint32_t MaxInstancesInLeaf = 2;
+		static constexpr uint32_t RaycastGrainSize = 256;
+
+		// The refitted tree is rebuilt when its cost grows by the factor
+		static constexpr float RebuildCostFactor = 1.5f;
+
+		void Subdivide(uint32_t nodeIdx);
+		void UpdateNodeBounds(uint32_t nodeIdx);
+		float CalculateSAHCost() const;
+
+		static Math::Ray TransformRay(const Math::Ray& ray, const glm::mat4& matrix);
+
+		TVector<Instance> m_instances;
+		TVector<uint32_t> m_freeInstances;
+
+		TVector<Node> m_nodes;
+		TVector<uint32_t> m_instanceIdx;
+		uint32_t m_nodesUsed = 0;
+
+		float m_builtCost = 0.0f;
+		bool m_bIsDirty = false;
+		bool m_bShouldRebuild = false;
+	};
+}
@@ -5,9 +5,11 @@
 #include "AssetRegistry/Model/ModelImporter.h"
 #include "AssetRegistry/Material/MaterialImporter.h"
 #include "AssetRegistry/FrameGraph/FrameGraphImporter.h"
+#include "AssetRegistry/FrameGraph/TransientResourcePlanner.h"
 #include "Platform/Win32/ConsoleWindow.h"
 #include "Platform/Win32/Input.h"
 #include "GraphicsDriver/Vulkan/VulkanApi.h"
+#include "GraphicsDriver/Null/NullGraphicsDriver.h"
 #include "Tasks/Scheduler.h"
 #include "RHI/Renderer.h"
 #include "Core/Submodule.h"
@@ -16,6 +18,7 @@
 #include "Containers/Map.h"
 #include "Containers/List.h"
 #include "Containers/Octree.h"
+#include "Containers/ConcurrentQueue.h"
 #include "Engine/EngineLoop.h"
 #include "Memory/MemoryBlockAllocator.hpp"
 #include "ECS/ECS.h"
@@ -57,6 +60,10 @@ AppArgs ParseCommandLineArgs(const char** args, int32_t num)
 		{
 			params.m_bWaitForDebugger = true;
 		}
+		else if (arg == "--nullrhi")
+		{
+			params.m_bIsNullRhi = true;
+		}
 	}
 
 	return params;
@@ -103,7 +110,12 @@ void App::Initialize(const char** commandLineArgs, int32_t num)
 #endif
 
 	s_pInstance->m_pMainWindow = TUniquePtr<Win32::Window>::Make();
-	s_pInstance->m_pMainWindow->Create("Sailor Viewport", "SailorViewport", 1024, 768, false, false, params.m_editorHwnd);
+
+	// The null graphics driver never presents, so the app runs without a display
+	if (!params.m_bIsNullRhi)
+	{
+		s_pInstance->m_pMainWindow->Create("Sailor Viewport", "SailorViewport", 1024, 768, false, false, params.m_editorHwnd);
+	}
 
 #ifdef SAILOR_VULKAN_ENABLE_VALIDATION_LAYER
 	const bool bIsEnabledVulkanValidationLayers = true;
@@ -118,7 +130,7 @@ void App::Initialize(const char** commandLineArgs, int32_t num)
 	EASY_MAIN_THREAD;
 #endif
 
-	s_pInstance->AddSubmodule(TSubmodule<Renderer>::Make(s_pInstance->m_pMainWindow.GetRawPtr(), RHI::EMsaaSamples::Samples_1, bIsEnabledVulkanValidationLayers));
+	s_pInstance->AddSubmodule(TSubmodule<Renderer>::Make(s_pInstance->m_pMainWindow.GetRawPtr(), RHI::EMsaaSamples::Samples_1, bIsEnabledVulkanValidationLayers, params.m_bIsNullRhi));
 	auto assetRegistry = s_pInstance->AddSubmodule(TSubmodule<AssetRegistry>::Make());
 
 	s_pInstance->AddSubmodule(TSubmodule<DefaultAssetInfoHandler>::Make(assetRegistry));
@@ -161,13 +173,27 @@ void App::Start()
 	TMap<std::string, std::function<void()>> consoleVars;
 	consoleVars["scan"] = std::bind(&AssetRegistry::ScanContentFolder, GetSubmodule<AssetRegistry>());
 	consoleVars["memory.benchmark"] = &Memory::RunMemoryBenchmark;
+	consoleVars["memory.mt.benchmark"] = &Memory::RunMultiThreadedMemoryBenchmark;
+	consoleVars["memory.block.benchmark"] = &Memory::RunBlockAllocatorBenchmark;
 	consoleVars["vector.benchmark"] = &Sailor::RunVectorBenchmark;
 	consoleVars["set.benchmark"] = &Sailor::RunSetBenchmark;
 	consoleVars["map.benchmark"] = &Sailor::RunMapBenchmark;
 	consoleVars["list.benchmark"] = &Sailor::RunListBenchmark;
 	consoleVars["octree.benchmark"] = &Sailor::RunOctreeBenchmark;
+	consoleVars["transforms.benchmark"] = &Sailor::RunTransformBenchmark;
+	consoleVars["queue.benchmark"] = &Sailor::RunConcurrentQueueBenchmark;
+	consoleVars["tasks.benchmark"] = &Sailor::Tasks::RunTasksBenchmark;
+	consoleVars["bvh.benchmark"] = &Sailor::Raytracing::RunBVHBenchmark;
+	consoleVars["lights.benchmark"] = &Sailor::Raytracing::RunLightSamplingBenchmark;
+	consoleVars["framegraph.aliasing"] = &Sailor::RunTransientResourcePlannerTests;
+	consoleVars["framegraph.schedule"] = &Sailor::Framegraph::RunFrameGraphRecordingScheduleTests;
+	consoleVars["framegraph.parallel"] = &Sailor::RHI::Renderer::ToggleParallelFrameGraphRecording;
 	consoleVars["stats.memory"] = &Sailor::RHI::Renderer::MemoryStats;
 
+#if defined(SAILOR_BUILD_WITH_NULL_RHI)
+	consoleVars["nullrhi.test"] = &Sailor::GraphicsDriver::Null::RunNullGraphicsDriverTests;
+#endif
+
 #ifdef SAILOR_EDITOR
 	TWeakPtr<World> pWorld = GetSubmodule<EngineLoop>()->CreateWorld("WorldEditor");
 #endif
@@ -19,6 +19,7 @@ namespace Sailor
 		bool m_bWaitForDebugger = false;
 		bool m_bRunConsole = true;
 		bool m_bIsEditor = false;
+		bool m_bIsNullRhi = false;
 		uint32_t m_editorPort = 32800;
 		HWND m_editorHwnd{};
 	};
@@ -0,0 +1,221 @@
+#pragma once
+#include <atomic>
+#include <concepts>
+#include <algorithm>
+#include "Tasks/Tasks.h"
+#include "Tasks/Scheduler.h"
+#include "Containers/Vector.h"
+#include "Memory/SharedPtr.hpp"
+
+namespace Sailor
+{
+	namespace Tasks
+	{
+		/* ParallelFor/ParallelReduce split the range [begin, end) between the worker threads and the calling thread.
+		*  There is one helper task per worker thread instead of one task per chunk, the helpers and the caller
+		*  grab the chunks from the shared cursor. The chunk size adapts to the remaining work (guided scheduling):
+		*  the big chunks at the beginning and the chunks of grainSize at the end to balance the tail.
+		*  The caller is blocked until the whole range is processed, while waiting it processes the chunks too.
+		*/
+		namespace Internal
+		{
+			class ParallelRange
+			{
+			public:
+
+				ParallelRange(size_t begin, size_t end, size_t grainSize, uint32_t numParticipants) :
+					m_end(end),
+					m_grainSize((std::max)(grainSize, (size_t)1)),
+					m_numParticipants(numParticipants),
+					m_next(begin),
+					m_numRemaining(end - begin)
+				{
+				}
+
+				bool TryClaim(size_t& outFirst, size_t& outLast)
+				{
+					size_t first = m_next.load(std::memory_order_relaxed);
+					while (first < m_end)
+					{
+						const size_t remaining = m_end - first;
+						const size_t chunk = (std::min)(remaining, (std::max)(m_grainSize, remaining / (2 * m_numParticipants)));
+
+						if (m_next.compare_exchange_weak(first, first + chunk, std::memory_order_relaxed))
+						{
+							outFirst = first;
+							outLast = first + chunk;
+							return true;
+						}
+					}
+
+					return false;
+				}
+
+				// The single completion counter, the release makes the chunk results visible to the caller
+				__forceinline void Complete(size_t numProcessed) { m_numRemaining.fetch_sub(numProcessed, std::memory_order_acq_rel); }
+				__forceinline bool IsFinished() const { return m_numRemaining.load(std::memory_order_acquire) == 0; }
+
+				void Wait() const
+				{
+					while (!IsFinished())
+					{
+						std::this_thread::yield();
+					}
+				}
+
+			protected:
+
+				const size_t m_end;
+				const size_t m_grainSize;
+				const uint32_t m_numParticipants;
+
+				alignas(64) std::atomic<size_t> m_next;
+				alignas(64) std::atomic<size_t> m_numRemaining;
+			};
+
+			__forceinline uint32_t GetNumHelpers(size_t numElements, size_t grainSize)
+			{
+				grainSize = (std::max)(grainSize, (size_t)1);
+
+				const size_t numChunks = (numElements + grainSize - 1) / grainSize;
+				const uint32_t numWorkers = App::GetSubmodule<Scheduler>()->GetNumThreads(EThreadType::Worker);
+
+				return numChunks > 1 ? (uint32_t)(std::min)((size_t)numWorkers, numChunks - 1) : 0u;
+			}
+		}
+
+		// Calls function(first, last) for the subranges of [begin, end)
+		template<typename TFunction>
+			requires std::invocable<TFunction&, size_t, size_t>
+		void ParallelFor(const std::string& name, size_t begin, size_t end, size_t grainSize, TFunction&& function)
+		{
+			SAILOR_PROFILE_FUNCTION();
+
+			if (begin >= end)
+			{
+				return;
+			}
+
+			const uint32_t numHelpers = Internal::GetNumHelpers(end - begin, grainSize);
+			if (numHelpers == 0)
+			{
+				function(begin, end);
+				return;
+			}
+
+			// The helpers could start after the range is processed, so the state is shared
+			struct State
+			{
+				State(size_t begin, size_t end, size_t grainSize, uint32_t numParticipants, TFunction& function) :
+					m_range(begin, end, grainSize, numParticipants), m_function(function) {}
+
+				void Process()
+				{
+					size_t first = 0;
+					size_t last = 0;
+					while (m_range.TryClaim(first, last))
+					{
+						m_function(first, last);
+						m_range.Complete(last - first);
+					}
+				}
+
+				Internal::ParallelRange m_range;
+				TFunction& m_function;
+			};
+
+			auto pState = TSharedPtr<State>::Make(begin, end, grainSize, numHelpers + 1, function);
+
+			for (uint32_t i = 0; i < numHelpers; i++)
+			{
+				Tasks::CreateTask(name, [pState]() { pState->Process(); })->Run();
+			}
+
+			pState->Process();
+			pState->m_range.Wait();
+		}
+
+		// Calls function(index) for each index of [begin, end)
+		template<typename TFunction>
+			requires std::invocable<TFunction&, size_t> && (!std::invocable<TFunction&, size_t, size_t>)
+		void ParallelFor(const std::string& name, size_t begin, size_t end, size_t grainSize, TFunction&& function)
+		{
+			ParallelFor(name, begin, end, grainSize, [&function](size_t first, size_t last)
+				{
+					for (size_t i = first; i < last; i++)
+					{
+						function(i);
+					}
+				});
+		}
+
+		/* Reduces [begin, end) with function(first, last, accumulator) -> accumulator,
+		*  the partial results of the participants are combined with reduce(lhs, rhs) on the calling thread.
+		*  The order of the combination is not defined, so reduce should be associative and commutative.
+		*/
+		template<typename TValue, typename TFunction, typename TReduce>
+			requires std::invocable<TFunction&, size_t, size_t, TValue>&& std::invocable<TReduce&, TValue, TValue>
+		TValue ParallelReduce(const std::string& name, size_t begin, size_t end, size_t grainSize, TValue identity, TFunction&& function, TReduce&& reduce)
+		{
+			SAILOR_PROFILE_FUNCTION();
+
+			if (begin >= end)
+			{
+				return identity;
+			}
+
+			const uint32_t numHelpers = Internal::GetNumHelpers(end - begin, grainSize);
+			if (numHelpers == 0)
+			{
+				return function(begin, end, std::move(identity));
+			}
+
+			struct State
+			{
+				State(size_t begin, size_t end, size_t grainSize, uint32_t numParticipants, TFunction& function, const TValue& identity) :
+					m_range(begin, end, grainSize, numParticipants), m_function(function)
+				{
+					m_partials.Reserve(numParticipants);
+					for (uint32_t i = 0; i < numParticipants; i++)
+					{
+						m_partials.Add(identity);
+					}
+				}
+
+				void Process(uint32_t participant)
+				{
+					size_t first = 0;
+					size_t last = 0;
+					while (m_range.TryClaim(first, last))
+					{
+						// Each participant owns its slot, the slot is written before the chunk is marked as completed
+						m_partials[participant] = m_function(first, last, std::move(m_partials[participant]));
+						m_range.Complete(last - first);
+					}
+				}
+
+				Internal::ParallelRange m_range;
+				TFunction& m_function;
+				TVector<TValue> m_partials;
+			};
+
+			auto pState = TSharedPtr<State>::Make(begin, end, grainSize, numHelpers + 1, function, identity);
+
+			for (uint32_t i = 0; i < numHelpers; i++)
+			{
+				Tasks::CreateTask(name, [pState, i]() { pState->Process(i + 1); })->Run();
+			}
+
+			pState->Process(0);
+			pState->m_range.Wait();
+
+			TValue res = std::move(pState->m_partials[0]);
+			for (uint32_t i = 1; i < pState->m_partials.Num(); i++)
+			{
+				res = reduce(std::move(res), std::move(pState->m_partials[i]));
+			}
+
+			return res;
+		}
+	}
+}
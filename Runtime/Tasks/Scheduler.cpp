@@ -12,12 +12,18 @@ using namespace std;
 using namespace Sailor;
 using namespace Sailor::Tasks;
 
+namespace
+{
+	// Used to push the tasks into the local deque when the work stealing is enabled
+	thread_local WorkerThread* t_pCurrentWorkerThread = nullptr;
+}
+
 WorkerThread::WorkerThread(
 	std::string threadName,
 	EThreadType threadType,
 	std::condition_variable& refresh,
 	std::mutex& mutex,
-	TVector<ITaskPtr>& pTasksQueue) :
+	TTaskQueue& pTasksQueue) :
 	m_threadName(std::move(threadName)),
 	m_threadType(threadType),
 	m_refresh(refresh),
@@ -79,6 +85,9 @@ void WorkerThread::ProcessTask(ITaskPtr& task)
 		task->Execute();
 		task.Clear();
 
+		// Decrement after the execution, so WaitIdle doesn't miss the dequeued task
+		App::GetSubmodule<Tasks::Scheduler>()->m_numInFlightTasks[(uint32_t)m_threadType]--;
+
 		m_bIsBusy = false;
 		SAILOR_PROFILE_END_BLOCK();
 	}
@@ -99,6 +108,7 @@ void WorkerThread::Process()
 #endif
 
 	m_threadId = GetCurrentThreadId();
+	t_pCurrentWorkerThread = this;
 
 	if (m_threadType == EThreadType::Render || m_threadType == EThreadType::RHI)
 	{
@@ -110,29 +120,96 @@ void WorkerThread::Process()
 	ITaskPtr pCurrentTask;
 	while (!scheduler->m_bIsTerminating)
 	{
+		if (m_threadType == EThreadType::Worker && scheduler->IsWorkStealingEnabled())
+		{
+			ProcessWorkStealing();
+			continue;
+		}
+
 		{
 			std::unique_lock<std::mutex> lk(m_execMutex);
 			m_refresh.wait(lk, [=, &pCurrentTask]()
 				{
 					const bool res = ((m_bExecFlag > 0) && (TryFetchTask(pCurrentTask) ||
 						scheduler->TryFetchNextAvailiableTask(pCurrentTask, m_threadType))) ||
-						(bool)scheduler->m_bIsTerminating;
+						(bool)scheduler->m_bIsTerminating ||
+						(m_threadType == EThreadType::Worker && scheduler->IsWorkStealingEnabled());
 					return res;
 				});
-			m_bExecFlag--;
+
+			if (m_bExecFlag > 0)
+			{
+				m_bExecFlag--;
+			}
 		}
 
 		ProcessTask(pCurrentTask);
 	}
 }
 
+uint32_t WorkerThread::NextRandom()
+{
+	// Xorshift, we don't need the quality here, only the cheap spread of victims
+	m_randomSeed ^= m_randomSeed << 13;
+	m_randomSeed ^= m_randomSeed >> 17;
+	m_randomSeed ^= m_randomSeed << 5;
+	return m_randomSeed;
+}
+
+void WorkerThread::ProcessWorkStealing()
+{
+	Scheduler* scheduler = App::GetSubmodule<Tasks::Scheduler>();
+
+	m_randomSeed = ((uint32_t)m_threadId * 2654435761u) | 1u;
+
+	uint32_t numSpins = 0;
+	ITaskPtr pCurrentTask;
+	while (!scheduler->m_bIsTerminating && scheduler->IsWorkStealingEnabled())
+	{
+		// The epoch is captured before looking for the work, 
+		// any task pushed after that would prevent the parking
+		const uint64_t epoch = scheduler->m_workStealingEpoch.load(std::memory_order_seq_cst);
+
+		if (TryFetchTask(pCurrentTask))
+		{
+			ProcessTask(pCurrentTask);
+			numSpins = 0;
+			continue;
+		}
+
+		bool bFromDeque = false;
+		if (scheduler->TryFetchTaskWorkStealing(pCurrentTask, this, bFromDeque))
+		{
+			ProcessTask(pCurrentTask);
+
+			// Decrement after the execution, so WaitIdle doesn't miss the task in flight
+			if (bFromDeque)
+			{
+				scheduler->m_numWorkStealingTasks--;
+			}
+
+			numSpins = 0;
+			continue;
+		}
+
+		if (++numSpins < scheduler->WorkStealingSpinsBeforePark)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		scheduler->ParkWorker(this, epoch);
+		numSpins = 0;
+	}
+}
+
 void Scheduler::Initialize()
 {
 	m_taskSyncPool.AddDefault(MaxTasksInPool);
 
 	for (uint32_t i = 0; i < MaxTasksInPool; i++)
 	{
-		m_freeList.push((uint16_t)(MaxTasksInPool - i - 1));
+		m_freeList.TryEnqueue((uint16_t)(MaxTasksInPool - i - 1));
 	}
 
 	m_mainThreadId = GetCurrentThreadId();
@@ -166,6 +243,7 @@ void Scheduler::Initialize()
 		m_threadTypes[newThread->GetThreadId()] = EThreadType::Worker;
 
 		m_workerThreads.Emplace(newThread);
+		m_stealingWorkers.Emplace(newThread);
 	}
 
 	for (uint32_t i = 0; i < numRHIThreads; i++)
@@ -180,13 +258,192 @@ void Scheduler::Initialize()
 		m_workerThreads.Emplace(newThread);
 	}
 
-	SAILOR_LOG("Initialize Tasks::Scheduler. Cores count: %d, Worker threads count: %zd", coresCount, m_workerThreads.Num());
+#ifdef SAILOR_TASKS_USE_WORK_STEALING
+	SetWorkStealingEnabled(true);
+#endif
+
+	SAILOR_LOG("Initialize Tasks::Scheduler. Cores count: %d, Worker threads count: %zd, Work stealing: %d", coresCount, m_workerThreads.Num(), IsWorkStealingEnabled());
+}
+
+void Scheduler::SetWorkStealingEnabled(bool bEnabled)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	if (bEnabled == IsWorkStealingEnabled())
+	{
+		return;
+	}
+
+	WaitIdle(EThreadType::Worker);
+
+	m_bWorkStealing = bEnabled;
+
+	// Wake up the workers in both modes, so they switch the processing loop
+	for (auto& worker : m_stealingWorkers)
+	{
+		worker->SetExecFlag();
+	}
+	m_refreshCondVar[(uint32_t)EThreadType::Worker].notify_all();
+
+	UnparkAllWorkers();
+}
+
+void Scheduler::ParkWorker(WorkerThread* pWorker, uint64_t epoch)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	m_parkedWorkersLock.Lock();
+	m_parkedWorkers.Add(pWorker);
+	m_numParkedWorkers++;
+	m_parkedWorkersLock.Unlock();
+
+	// Someone pushed the task after the worker had started to look for the work
+	if (epoch != m_workStealingEpoch.load(std::memory_order_seq_cst) || m_bIsTerminating || !IsWorkStealingEnabled())
+	{
+		m_parkedWorkersLock.Lock();
+		const size_t index = m_parkedWorkers.Find(pWorker);
+		if (index != -1)
+		{
+			m_parkedWorkers.RemoveAtSwap(index);
+			m_numParkedWorkers--;
+			m_parkedWorkersLock.Unlock();
+			return;
+		}
+		m_parkedWorkersLock.Unlock();
+
+		// The worker has been already unparked, consume the signal
+	}
+
+	pWorker->m_wakeUp.acquire();
+}
+
+void Scheduler::UnparkWorker(WorkerThread* pWorker)
+{
+	m_workStealingEpoch.fetch_add(1, std::memory_order_seq_cst);
+
+	if (m_numParkedWorkers.load(std::memory_order_seq_cst) == 0)
+	{
+		return;
+	}
+
+	m_parkedWorkersLock.Lock();
+
+	size_t index = -1;
+	if (pWorker)
+	{
+		index = m_parkedWorkers.Find(pWorker);
+	}
+	else if (m_parkedWorkers.Num() > 0)
+	{
+		index = m_parkedWorkers.Num() - 1;
+	}
+
+	if (index != -1)
+	{
+		WorkerThread* pParked = m_parkedWorkers[index];
+		m_parkedWorkers.RemoveAtSwap(index);
+		m_numParkedWorkers--;
+		pParked->m_wakeUp.release();
+	}
+
+	m_parkedWorkersLock.Unlock();
+}
+
+void Scheduler::UnparkAllWorkers()
+{
+	m_workStealingEpoch.fetch_add(1, std::memory_order_seq_cst);
+
+	m_parkedWorkersLock.Lock();
+	for (auto& pParked : m_parkedWorkers)
+	{
+		pParked->m_wakeUp.release();
+	}
+	m_parkedWorkers.Clear(false);
+	m_numParkedWorkers = 0;
+	m_parkedWorkersLock.Unlock();
+}
+
+void Scheduler::RunWorkStealing(const ITaskPtr& pTask)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	WorkerThread* pCurrentWorker = t_pCurrentWorkerThread;
+
+	// Only the owner could push into the deque, the tasks from other threads and 
+	// the tasks that are waiting for the dependencies go to the shared queue
+	if (pTask->IsReadyToStart() && pCurrentWorker && pCurrentWorker->GetThreadType() == EThreadType::Worker)
+	{
+		m_numWorkStealingTasks++;
+
+		pTask.GetRawPtr()->m_pinnedSelf = pTask;
+		pCurrentWorker->m_localDeque.Push(pTask.GetRawPtr());
+	}
+	else
+	{
+		EnqueueTask(pTask, EThreadType::Worker);
+	}
+
+	UnparkWorker();
+}
+
+bool Scheduler::TryUnpinTask(ITask* pRawTask, ITaskPtr& pOutTask)
+{
+	pOutTask = std::move(pRawTask->m_pinnedSelf);
+
+	if (pOutTask->IsReadyToStart())
+	{
+		return true;
+	}
+
+	// The task got the dependency after it was pushed, so let it wait in the shared queue
+	EnqueueTask(pOutTask, EThreadType::Worker);
+
+	m_numWorkStealingTasks--;
+	pOutTask.Clear();
+
+	return false;
+}
+
+bool Scheduler::TryFetchTaskWorkStealing(ITaskPtr& pOutTask, WorkerThread* pThief, bool& bOutFromDeque)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	bOutFromDeque = false;
+
+	ITask* pRawTask = nullptr;
+	if (pThief->m_localDeque.Pop(pRawTask) && TryUnpinTask(pRawTask, pOutTask))
+	{
+		bOutFromDeque = true;
+		return true;
+	}
+
+	if (TryFetchNextAvailiableTask(pOutTask, EThreadType::Worker))
+	{
+		return true;
+	}
+
+	const size_t numWorkers = m_stealingWorkers.Num();
+	const size_t firstVictim = pThief->NextRandom() % numWorkers;
+
+	for (size_t i = 0; i < numWorkers; i++)
+	{
+		WorkerThread* pVictim = m_stealingWorkers[(firstVictim + i) % numWorkers];
+
+		if (pVictim != pThief && pVictim->m_localDeque.Steal(pRawTask) && TryUnpinTask(pRawTask, pOutTask))
+		{
+			bOutFromDeque = true;
+			return true;
+		}
+	}
+
+	return false;
 }
 
 Scheduler::~Scheduler()
 {
 	m_bIsTerminating = true;
 
+	UnparkAllWorkers();
 	NotifyWorkerThread(EThreadType::Worker, true);
 	NotifyWorkerThread(EThreadType::Render, true);
 	NotifyWorkerThread(EThreadType::RHI, true);
@@ -198,6 +455,17 @@ Scheduler::~Scheduler()
 
 	App::GetSubmodule<Tasks::Scheduler>()->ProcessTasksOnMainThread();
 
+	// Release the tasks that were not executed
+	for (auto& worker : m_stealingWorkers)
+	{
+		ITask* pRawTask = nullptr;
+		while (worker->m_localDeque.Pop(pRawTask))
+		{
+			pRawTask->m_pinnedSelf.Clear();
+		}
+	}
+	m_stealingWorkers.Clear();
+
 	for (auto worker : m_workerThreads)
 	{
 		delete worker;
@@ -211,6 +479,19 @@ uint32_t Scheduler::GetNumWorkerThreads() const
 	return static_cast<uint32_t>(m_workerThreads.Num());
 }
 
+uint32_t Scheduler::GetNumThreads(EThreadType thread) const
+{
+	uint32_t res = 0;
+	for (const auto& worker : m_workerThreads)
+	{
+		if (worker->GetThreadType() == thread)
+		{
+			res++;
+		}
+	}
+	return res;
+}
+
 void Scheduler::ProcessTasksOnMainThread()
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -224,6 +505,8 @@ void Scheduler::ProcessTasksOnMainThread()
 			pCurrentTask->Execute();
 			pCurrentTask.Clear();
 
+			m_numInFlightTasks[(uint32_t)EThreadType::Main]--;
+
 			SAILOR_PROFILE_END_BLOCK();
 		}
 	}
@@ -281,18 +564,15 @@ void Scheduler::Run(const ITaskPtr& pTask, bool bAutoRunChainedTasks)
 	}
 
 	pTask.GetRawPtr()->OnEnqueue();
+	m_numInFlightTasks[(uint32_t)pTask->GetThreadType()]++;
 
+	if (pTask->GetThreadType() == EThreadType::Worker && IsWorkStealingEnabled())
 	{
-		std::mutex* pOutQueueMutex;
-		TVector<ITaskPtr>* pOutQueue;
-		std::condition_variable* pOutCondVar;
-
-		GetThreadSyncVarsByThreadType(pTask->GetThreadType(), pOutQueueMutex, pOutQueue, pOutCondVar);
-
-		const std::lock_guard<std::mutex> lock(*pOutQueueMutex);
-		pOutQueue->Add(pTask);
+		RunWorkStealing(pTask);
+		return;
 	}
 
+	EnqueueTask(pTask, pTask->GetThreadType());
 	NotifyWorkerThread(pTask->GetThreadType());
 }
 
@@ -317,28 +597,79 @@ void Scheduler::Run(const ITaskPtr& pTask, DWORD threadId, bool bAutoRunChainedT
 
 	if (result != -1)
 	{
+		m_numInFlightTasks[(uint32_t)m_workerThreads[result]->GetThreadType()]++;
+
 		m_workerThreads[result]->SetExecFlag();
 		m_workerThreads[result]->ForcelyPushTask(pTask);
+
+		if (m_workerThreads[result]->GetThreadType() == EThreadType::Worker && IsWorkStealingEnabled())
+		{
+			UnparkWorker(m_workerThreads[result]);
+		}
 		return;
 	}
 	check(m_mainThreadId == threadId);
 	// Add to Main thread if cannot find the thread in workers
+	m_numInFlightTasks[(uint32_t)EThreadType::Main]++;
+	EnqueueTask(pTask, EThreadType::Main);
+}
+
+void Scheduler::EnqueueTask(const ITaskPtr& pTask, EThreadType threadType)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	const uint32_t type = (uint32_t)threadType;
+
+	if (!pTask->IsReadyToStart())
+	{
+		const std::lock_guard<std::mutex> lock(m_queueMutex[type]);
+
+		// The counter is incremented before the check, 
+		// so OnTaskUnblocked either sees the pending task or we see the task is ready
+		m_numPendingTasks[type]++;
+
+		if (!pTask->IsReadyToStart())
+		{
+			m_pendingTasks[type].Add(pTask);
+			return;
+		}
+
+		m_pSharedTaskQueue[type].Enqueue(pTask);
+		m_numPendingTasks[type]--;
+		return;
+	}
+
+	m_pSharedTaskQueue[type].Enqueue(pTask);
+}
+
+void Scheduler::OnTaskUnblocked(const ITaskPtr& pTask)
+{
+	SAILOR_PROFILE_FUNCTION();
+
+	const uint32_t type = (uint32_t)pTask->GetThreadType();
+
+	if (m_numPendingTasks[type].load() > 0)
 	{
-		std::mutex* pOutQueueMutex;
-		TVector<ITaskPtr>* pOutQueue;
-		std::condition_variable* pOutCondVar;
+		const std::lock_guard<std::mutex> lock(m_queueMutex[type]);
 
-		GetThreadSyncVarsByThreadType(EThreadType::Main, pOutQueueMutex, pOutQueue, pOutCondVar);
+		const size_t index = m_pendingTasks[type].Find(pTask);
+		if (index != -1)
+		{
+			m_pendingTasks[type].RemoveAtSwap(index);
 
-		const std::lock_guard<std::mutex> lock(*pOutQueueMutex);
-		pOutQueue->Add(pTask);
+			// Enqueue before decrement to stay visible for WaitIdle
+			m_pSharedTaskQueue[type].Enqueue(pTask);
+			m_numPendingTasks[type]--;
+		}
 	}
+
+	NotifyWorkerThread(pTask->GetThreadType());
 }
 
 void Scheduler::GetThreadSyncVarsByThreadType(
 	EThreadType threadType,
 	std::mutex*& pOutQueueMutex,
-	TVector<ITaskPtr>*& pOutQueue,
+	TTaskQueue*& pOutQueue,
 	std::condition_variable*& pOutCondVar)
 {
 	SAILOR_PROFILE_FUNCTION();
@@ -353,28 +684,23 @@ bool Scheduler::TryFetchNextAvailiableTask(ITaskPtr& pOutTask, EThreadType threa
 	SAILOR_PROFILE_FUNCTION();
 
 	std::mutex* pOutQueueMutex;
-	TVector<ITaskPtr>* pOutQueue;
+	TTaskQueue* pOutQueue;
 	std::condition_variable* pOutCondVar;
 
 	GetThreadSyncVarsByThreadType(threadType, pOutQueueMutex, pOutQueue, pOutCondVar);
 
-	const std::lock_guard<std::mutex> lock(*pOutQueueMutex);
-
-	if (!(*pOutQueue).IsEmpty())
+	ITaskPtr pTask;
+	while (pOutQueue->TryDequeue(pTask))
 	{
-		const auto result = (*pOutQueue).FindIf(
-			[&](const ITaskPtr& Task)
-			{
-				return Task->IsReadyToStart();
-			});
-
-		if (result != -1)
+		if (pTask->IsReadyToStart())
 		{
-			pOutTask = (*pOutQueue)[result];
-			(*pOutQueue).RemoveAt(result);
-
+			pOutTask = std::move(pTask);
 			return true;
 		}
+
+		// The task got the dependency after it was enqueued
+		EnqueueTask(pTask, threadType);
+		pTask.Clear();
 	}
 
 	return false;
@@ -384,11 +710,25 @@ void Scheduler::NotifyWorkerThread(EThreadType threadType, bool bNotifyAllThread
 {
 	SAILOR_PROFILE_FUNCTION();
 	std::mutex* pOutQueueMutex;
-	TVector<ITaskPtr>* pOutQueue;
+	TTaskQueue* pOutQueue;
 	std::condition_variable* pOutCondVar;
 
 	GetThreadSyncVarsByThreadType(threadType, pOutQueueMutex, pOutQueue, pOutCondVar);
 
+	if (threadType == EThreadType::Worker && IsWorkStealingEnabled())
+	{
+		// Targeted wake up instead of the broadcast
+		if (bNotifyAllThreads)
+		{
+			UnparkAllWorkers();
+		}
+		else
+		{
+			UnparkWorker();
+		}
+		return;
+	}
+
 	for (uint32_t i = 0; i < m_workerThreads.Num(); i++)
 	{
 		if (m_workerThreads[i]->GetThreadType() == threadType)
@@ -414,7 +754,14 @@ EThreadType Scheduler::GetCurrentThreadType() const
 
 uint32_t Scheduler::GetNumTasks(EThreadType thread) const
 {
-	return (uint32_t)m_pSharedTaskQueue[(uint32_t)thread].Num();
+	uint32_t res = (uint32_t)m_pSharedTaskQueue[(uint32_t)thread].Num() + m_numPendingTasks[(uint32_t)thread].load();
+
+	if (thread == EThreadType::Worker)
+	{
+		res += m_numWorkStealingTasks.load();
+	}
+
+	return res;
 }
 
 void Scheduler::WaitIdle(const TSet<EThreadType>& threads)
@@ -428,7 +775,7 @@ void Scheduler::WaitIdle(const TSet<EThreadType>& threads)
 
 		for (const auto& thread : threads)
 		{
-			if (GetNumTasks(thread) > 0)
+			if (m_numInFlightTasks[(uint32_t)thread].load() > 0)
 			{
 				tasks.Insert(thread);
 			}
@@ -453,38 +800,12 @@ void Scheduler::WaitIdle(EThreadType type)
 {
 	SAILOR_PROFILE_FUNCTION();
 
-	std::mutex* pOutQueueMutex;
-	TVector<ITaskPtr>* pOutQueue;
-	std::condition_variable* pOutCondVar;
-	TVector<ITaskPtr> waitFor;
-
-	GetThreadSyncVarsByThreadType(type, pOutQueueMutex, pOutQueue, pOutCondVar);
-
+	// The lock-free queues cannot be snapshotted, so we're waiting for the counter.
+	// The task is counted from Run till the end of the execution, 
+	// so the tasks that are dequeued but not started yet are not missed.
+	while (m_numInFlightTasks[(uint32_t)type].load() > 0)
 	{
-		const std::unique_lock<std::mutex> lock(m_queueMutex[(uint8_t)type]);
-		waitFor = *pOutQueue;
-	}
-
-	do
-	{
-		for (auto& wait : waitFor)
-		{
-			wait->Wait();
-		}
-
-		{
-			const std::unique_lock<std::mutex> lock(m_queueMutex[(uint8_t)type]);
-			waitFor = *pOutQueue;
-		}
-
-	} while (waitFor.Num() != 0);
-
-	for (auto& worker : m_workerThreads)
-	{
-		if (worker->GetThreadType() == type)
-		{
-			worker->WaitIdle();
-		}
+		std::this_thread::yield();
 	}
 }
 
@@ -501,7 +822,7 @@ bool Scheduler::IsRendererThread() const
 uint16_t Scheduler::AcquireTaskSyncBlock()
 {
 	uint16_t last = 0;
-	if (m_freeList.try_pop(last))
+	if (m_freeList.TryDequeue(last))
 	{
 		m_taskSyncPool[last].m_bCompletionFlag = false;
 		return last;
@@ -514,5 +835,6 @@ uint16_t Scheduler::AcquireTaskSyncBlock()
 
 void Scheduler::ReleaseTaskSyncBlock(const ITask& task)
 {
-	m_freeList.push(task.m_taskSyncBlockHandle);
+	const bool bReleased = m_freeList.TryEnqueue(task.m_taskSyncBlockHandle);
+	check(bReleased);
 }
\ No newline at end of file
@@ -4,14 +4,15 @@
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <semaphore>
 #include "Sailor.h"
 #include "Core/Submodule.h"
+#include "Core/SpinLock.h"
 #include "Memory/UniquePtr.hpp"
+#include "Containers/WorkStealingDeque.h"
+#include "Containers/ConcurrentQueue.h"
 #include "Tasks/Tasks.h"
 
-// TODO: Implement ConcurrentList
-#include <concurrent_queue.h>
-
 #define SAILOR_ENQUEUE_TASK(Name, Lambda) Sailor::App::GetSubmodule<Tasks::Scheduler>()->Run(Sailor::Tasks::CreateTask(Name, Lambda))
 #define SAILOR_ENQUEUE_TASK_RENDER_THREAD(Name, Lambda) Sailor::App::GetSubmodule<Tasks::Scheduler>()->Run(Sailor::Tasks::CreateTask(Name, Lambda, Sailor::Tasks::EThreadType::Render))
 #define SAILOR_ENQUEUE_TASK_RHI_THREAD(Name, Lambda) Sailor::App::GetSubmodule<Tasks::Scheduler>()->Run(Sailor::Tasks::CreateTask(Name, Lambda, Sailor::Tasks::EThreadType::RHI))
@@ -23,6 +24,8 @@ namespace Sailor
 		class WorkerThread;
 		class Scheduler;
 
+		using TTaskQueue = TConcurrentQueue<ITaskPtr>;
+
 		class WorkerThread
 		{
 		public:
@@ -32,7 +35,7 @@ namespace Sailor
 				EThreadType threadType,
 				std::condition_variable& refresh,
 				std::mutex& mutex,
-				TVector<ITaskPtr>& pTasksQueue);
+				TTaskQueue& pTasksQueue);
 
 			SAILOR_API virtual ~WorkerThread() = default;
 
@@ -57,6 +60,10 @@ namespace Sailor
 			SAILOR_API void ProcessTask(ITaskPtr& task);
 			SAILOR_API bool TryFetchTask(ITaskPtr& pOutTask);
 
+			// Returns when the work stealing is disabled or the scheduler is terminating
+			SAILOR_API void ProcessWorkStealing();
+			SAILOR_API uint32_t NextRandom();
+
 			std::string m_threadName;
 			TUniquePtr<std::thread> m_pThread;
 
@@ -74,13 +81,22 @@ namespace Sailor
 			// Assigned from scheduler
 			std::condition_variable& m_refresh;
 			std::mutex& m_sharedQueueMutex;
-			TVector<ITaskPtr>& m_pSharedTaskQueue;
+			TTaskQueue& m_pSharedTaskQueue;
+
+			// Work stealing mode, the local deque is pushed/popped only by this thread, 
+			// other workers steal from the top.
+			TWorkStealingDeque<ITask*> m_localDeque;
+			std::binary_semaphore m_wakeUp{ 0 };
+			uint32_t m_randomSeed = 0;
+
+			friend class Scheduler;
 		};
 
 		class Scheduler final : public TSubmodule<Scheduler>
 		{
 			const uint8_t RHIThreadsNum = 2u;
 			const size_t MaxTasksInPool = 16384;
+			const uint32_t WorkStealingSpinsBeforePark = 64u;
 			static const uint32_t MaxThreadTypes = (uint32_t)magic_enum::enum_count<EThreadType>();
 
 		public:
@@ -97,6 +113,7 @@ namespace Sailor
 			SAILOR_API void WaitIdle(const TSet<EThreadType>& threads);
 
 			SAILOR_API uint32_t GetNumWorkerThreads() const;
+			SAILOR_API uint32_t GetNumThreads(EThreadType thread) const;
 			SAILOR_API uint32_t GetNumTasks(EThreadType thread) const;
 			SAILOR_API uint32_t GetNumRHIThreads() const { return RHIThreadsNum; }
 
@@ -119,6 +136,12 @@ namespace Sailor
 
 			SAILOR_API void RunChainedTasks(const ITaskPtr& pTask);
 
+			// Worker tasks are distributed through per-worker Chase-Lev deques, 
+			// idle workers steal from random victims and are parked/woken up one by one.
+			// Switching the mode waits for all worker tasks.
+			SAILOR_API void SetWorkStealingEnabled(bool bEnabled);
+			SAILOR_API bool IsWorkStealingEnabled() const { return m_bWorkStealing.load(std::memory_order_relaxed); }
+
 			SAILOR_API TaskSyncBlock& GetTaskSyncBlock(const ITask& task) { return m_taskSyncPool[task.m_taskSyncBlockHandle]; }
 			SAILOR_API uint16_t AcquireTaskSyncBlock();
 			SAILOR_API void ReleaseTaskSyncBlock(const ITask& task);
@@ -130,12 +153,31 @@ namespace Sailor
 			SAILOR_API void GetThreadSyncVarsByThreadType(
 				EThreadType threadType,
 				std::mutex*& pOutMutex,
-				TVector<ITaskPtr>*& pOutQueue,
+				TTaskQueue*& pOutQueue,
 				std::condition_variable*& pOutCondVar);
 
-			std::mutex m_queueMutex[MaxThreadTypes];
+			// Ready tasks go to the lock-free queue, the tasks with dependencies wait in the pending list
+			SAILOR_API void EnqueueTask(const ITaskPtr& pTask, EThreadType threadType);
+			SAILOR_API void OnTaskUnblocked(const ITaskPtr& pTask);
+
+			SAILOR_API void RunWorkStealing(const ITaskPtr& pTask);
+			SAILOR_API bool TryFetchTaskWorkStealing(ITaskPtr& pOutTask, WorkerThread* pThief, bool& bOutFromDeque);
+			SAILOR_API bool TryUnpinTask(ITask* pRawTask, ITaskPtr& pOutTask);
+
+			SAILOR_API void ParkWorker(WorkerThread* pWorker, uint64_t epoch);
+			SAILOR_API void UnparkWorker(WorkerThread* pWorker = nullptr);
+			SAILOR_API void UnparkAllWorkers();
+
 			std::condition_variable m_refreshCondVar[MaxThreadTypes];
-			TVector<ITaskPtr> m_pSharedTaskQueue[MaxThreadTypes];
+			TTaskQueue m_pSharedTaskQueue[MaxThreadTypes];
+
+			// Guards the pending tasks only
+			std::mutex m_queueMutex[MaxThreadTypes];
+			TVector<ITaskPtr> m_pendingTasks[MaxThreadTypes];
+			std::atomic<uint32_t> m_numPendingTasks[MaxThreadTypes]{};
+
+			// The tasks that are run but not executed yet, including the dequeued ones
+			std::atomic<uint32_t> m_numInFlightTasks[MaxThreadTypes]{};
 
 			std::atomic<uint32_t> m_numBusyThreads;
 			TVector<WorkerThread*> m_workerThreads;
@@ -145,14 +187,26 @@ namespace Sailor
 			DWORD m_renderingThreadId = -1;
 
 			// Task Synchronization primitives pool
-			concurrency::concurrent_queue<uint16_t> m_freeList{};
+			TConcurrentBoundedQueue<uint16_t> m_freeList{ MaxTasksInPool };
 			TVector<TaskSyncBlock> m_taskSyncPool{};
 			TMap<DWORD, EThreadType> m_threadTypes{};
 
+			// Work stealing
+			std::atomic<bool> m_bWorkStealing = false;
+			TVector<WorkerThread*> m_stealingWorkers{};
+			std::atomic<uint64_t> m_workStealingEpoch = 0;
+			std::atomic<uint32_t> m_numWorkStealingTasks = 0;
+
+			SpinLock m_parkedWorkersLock;
+			TVector<WorkerThread*> m_parkedWorkers{};
+			std::atomic<uint32_t> m_numParkedWorkers = 0;
+
 			friend class WorkerThread;
 
 			template<typename TResult, typename TArgs>
 			friend TaskPtr<TResult, TArgs> CreateTask(const std::string& name, typename TFunction<TResult, TArgs>::type lambda, EThreadType thread);
 		};
+
+		SAILOR_API void RunTasksBenchmark();
 	}
 }
\ No newline at end of file
@@ -82,7 +82,7 @@ void ITask::Complete()
 			{
 				if (--pJob->m_numBlockers == 0)
 				{
-					scheduler->NotifyWorkerThread(pJob->GetThreadType());
+					scheduler->OnTaskUnblocked(pJob);
 				}
 			}
 		}
@@ -137,6 +137,9 @@ namespace Sailor
 
 			TVector<TWeakPtr<ITask>> m_dependencies;
 
+			// Keeps the task alive while it is stored by raw pointer in the work stealing deques
+			ITaskPtr m_pinnedSelf;
+
 			std::string m_name; // TODO: remove name, to save 40 bytes
 
 			friend class Scheduler;
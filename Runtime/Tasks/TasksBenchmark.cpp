@@ -0,0 +1,268 @@
+#include "Tasks/Scheduler.h"
+#include "Tasks/Tasks.h"
+#include "Tasks/ParallelFor.h"
+#include "Core/Utils.h"
+#include <atomic>
+#include <memory>
+
+using namespace Sailor;
+using namespace Sailor::Tasks;
+using Timer = Utils::Timer;
+
+struct Result
+{
+	std::string m_mode;
+
+	Result() = default;
+	Result(std::string mode) : m_mode(mode) {}
+
+	size_t m_numTasks = 0;
+	size_t m_flatMs = 0;
+	size_t m_nestedMs = 0;
+	size_t m_perChunkTasksMs = 0;
+	size_t m_parallelForMs = 0;
+
+	bool m_bSanityPassed = false;
+
+	void PrintLog()
+	{
+		const double flatTasksPerSec = m_flatMs ? (double)m_numTasks * 1000.0 / (double)m_flatMs : 0.0;
+		const double nestedTasksPerSec = m_nestedMs ? (double)m_numTasks * 1000.0 / (double)m_nestedMs : 0.0;
+
+		SAILOR_LOG("\nScheduler mode: %s", m_mode.c_str());
+		SAILOR_LOG("Sanity check passed: %d", m_bSanityPassed);
+		SAILOR_LOG("Performance test spawn from main thread: %llums, %.0f tasks/sec", m_flatMs, flatTasksPerSec);
+		SAILOR_LOG("Performance test spawn from worker threads: %llums, %.0f tasks/sec", m_nestedMs, nestedTasksPerSec);
+		SAILOR_LOG("Performance test task per chunk: %llums", m_perChunkTasksMs);
+		SAILOR_LOG("Performance test ParallelFor: %llums\n", m_parallelForMs);
+	}
+};
+
+class TestCase_SchedulerPerformance
+{
+	// Should be less than Scheduler::MaxTasksInPool, since each alive task holds the sync block
+	static constexpr size_t BatchSize = 8192;
+	static constexpr size_t NumBatches = 32;
+	static constexpr size_t NumNestedRoots = 64;
+	static constexpr uint32_t WorkPerTask = 256;
+
+	static constexpr size_t ChunkSize = 64;
+	static constexpr size_t NumChunks = 2048;
+
+public:
+
+	static Result RunTests(bool bWorkStealing)
+	{
+		auto scheduler = App::GetSubmodule<Scheduler>();
+		const bool bWasEnabled = scheduler->IsWorkStealingEnabled();
+
+		scheduler->SetWorkStealingEnabled(bWorkStealing);
+
+		Result r(bWorkStealing ? "Work stealing" : "Shared queue");
+		r.m_numTasks = BatchSize * NumBatches;
+		r.m_flatMs = SpawnFromMainThread();
+		r.m_nestedMs = SpawnFromWorkerThreads();
+		r.m_perChunkTasksMs = TaskPerChunk();
+		r.m_parallelForMs = ParallelForChunks();
+		r.m_bSanityPassed = SanityCheck() && SanityCheckParallelFor();
+
+		scheduler->SetWorkStealingEnabled(bWasEnabled);
+
+		return r;
+	}
+
+	static __forceinline void DoWork(std::atomic<size_t>& counter)
+	{
+		volatile uint32_t acc = 0;
+		for (uint32_t i = 0; i < WorkPerTask; i++)
+		{
+			acc = acc + i;
+		}
+		counter++;
+	}
+
+	static size_t SpawnFromMainThread()
+	{
+		auto scheduler = App::GetSubmodule<Scheduler>();
+		std::atomic<size_t> counter = 0;
+
+		Timer timer;
+		timer.Start();
+		for (size_t batch = 0; batch < NumBatches; batch++)
+		{
+			for (size_t i = 0; i < BatchSize; i++)
+			{
+				Tasks::CreateTask("Benchmark", [&counter]() { DoWork(counter); })->Run();
+			}
+			scheduler->WaitIdle(EThreadType::Worker);
+		}
+		timer.Stop();
+
+		check(counter == BatchSize * NumBatches);
+		return timer.ResultMs();
+	}
+
+	static size_t SpawnFromWorkerThreads()
+	{
+		auto scheduler = App::GetSubmodule<Scheduler>();
+		std::atomic<size_t> counter = 0;
+
+		const size_t numChildren = BatchSize / NumNestedRoots - 1;
+
+		Timer timer;
+		timer.Start();
+		for (size_t batch = 0; batch < NumBatches; batch++)
+		{
+			for (size_t i = 0; i < NumNestedRoots; i++)
+			{
+				// The children are pushed into the local deque of the worker and stolen by idle workers
+				Tasks::CreateTask("Benchmark Root", [&counter, numChildren]()
+					{
+						for (size_t j = 0; j < numChildren; j++)
+						{
+							Tasks::CreateTask("Benchmark", [&counter]() { DoWork(counter); })->Run();
+						}
+						DoWork(counter);
+					})->Run();
+			}
+			scheduler->WaitIdle(EThreadType::Worker);
+		}
+		timer.Stop();
+
+		check(counter == BatchSize * NumBatches);
+		return timer.ResultMs();
+	}
+
+	static size_t TaskPerChunk()
+	{
+		std::atomic<size_t> counter = 0;
+		TVector<ITaskPtr> tasks;
+		tasks.Reserve(NumChunks);
+
+		Timer timer;
+		timer.Start();
+		for (size_t batch = 0; batch < NumBatches; batch++)
+		{
+			// The hand-rolled pattern: one task per chunk and the waits one by one
+			for (size_t i = 0; i < NumChunks; i++)
+			{
+				tasks.Add(Tasks::CreateTask("Benchmark Chunk", [&counter]()
+					{
+						for (size_t j = 0; j < ChunkSize; j++)
+						{
+							DoWork(counter);
+						}
+					})->Run());
+			}
+
+			for (auto& task : tasks)
+			{
+				task->Wait();
+			}
+			tasks.Clear();
+		}
+		timer.Stop();
+
+		check(counter == ChunkSize * NumChunks * NumBatches);
+		return timer.ResultMs();
+	}
+
+	static size_t ParallelForChunks()
+	{
+		std::atomic<size_t> counter = 0;
+
+		Timer timer;
+		timer.Start();
+		for (size_t batch = 0; batch < NumBatches; batch++)
+		{
+			Tasks::ParallelFor("Benchmark ParallelFor", 0, ChunkSize * NumChunks, ChunkSize,
+				[&counter](size_t first, size_t last)
+				{
+					for (size_t j = first; j < last; j++)
+					{
+						DoWork(counter);
+					}
+				});
+		}
+		timer.Stop();
+
+		check(counter == ChunkSize * NumChunks * NumBatches);
+		return timer.ResultMs();
+	}
+
+	static bool SanityCheckParallelFor()
+	{
+		const size_t count = 100003;
+
+		// Each index should be visited exactly once
+		std::unique_ptr<std::atomic<uint32_t>[]> visited(new std::atomic<uint32_t>[count]{});
+		Tasks::ParallelFor("Sanity ParallelFor", 0, count, 7, [&](size_t i) { visited[i]++; });
+
+		bool bRes = true;
+		for (size_t i = 0; i < count; i++)
+		{
+			bRes &= visited[i] == 1;
+		}
+
+		const uint64_t sum = Tasks::ParallelReduce<uint64_t>("Sanity ParallelReduce", 0, count, 13, 0ull,
+			[](size_t first, size_t last, uint64_t acc)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					acc += i;
+				}
+				return acc;
+			},
+			[](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+
+		bRes &= sum == (uint64_t)count * (count - 1) / 2;
+
+		// Empty and single chunk ranges are processed on the calling thread
+		bRes &= Tasks::ParallelReduce<uint64_t>("Sanity ParallelReduce", 5, 5, 1, 42ull,
+			[](size_t, size_t, uint64_t acc) { return acc + 1; },
+			[](uint64_t lhs, uint64_t rhs) { return lhs + rhs; }) == 42ull;
+
+		return bRes;
+	}
+
+	static bool SanityCheck()
+	{
+		auto scheduler = App::GetSubmodule<Scheduler>();
+
+		// Chained tasks and dependencies should be respected in both modes
+		std::atomic<uint32_t> counter = 0;
+		std::atomic<bool> bOrderPassed = true;
+
+		auto first = Tasks::CreateTaskWithResult<uint32_t>("Sanity", [&]() { return ++counter; });
+		auto second = first->Then<uint32_t>([&](uint32_t value) { bOrderPassed = bOrderPassed && value == 1; return ++counter; });
+		auto third = second->Then<void>([&](uint32_t value) { bOrderPassed = bOrderPassed && value == 2; ++counter; });
+
+		auto joined = Tasks::CreateTask("Sanity joined", [&]() { bOrderPassed = bOrderPassed && third->IsFinished(); ++counter; });
+		joined->Join(third);
+
+		joined->Run();
+		first->Run();
+
+		joined->Wait();
+		scheduler->WaitIdle(EThreadType::Worker);
+
+		return bOrderPassed && counter == 4;
+	}
+};
+
+void Sailor::Tasks::RunTasksBenchmark()
+{
+	printf("\nStarting Tasks benchmark...\n");
+
+	TVector<Result> res;
+
+	res.Add(TestCase_SchedulerPerformance::RunTests(false));
+	res.Add(TestCase_SchedulerPerformance::RunTests(true));
+
+	for (auto& r : res)
+	{
+		r.PrintLog();
+	}
+
+	printf("\n\n");
+}